@@ -3,7 +3,8 @@
  *
  *  \brief Problem name: Problem 1.
  *
- *  File with the data shared accross all threads.
+ *  File with the data shared accross all threads: a chunk, the counts of its words (see TEXTCOUNTS.h of libclestats)
+ *  and their sketch.
  *
  *  \author Francisco Gonalves Tiago Lucas - April 2020
  */
@@ -13,14 +14,15 @@
 
 #include <stdlib.h>
 #include "probConst.h"
+#include "TEXTCOUNTS.h"
 
 typedef struct
 {
    size_t filePosition;
    size_t numbBytes;
-   size_t numbWords;
-   size_t maxWordLength;
-   int bidi[MAX_SIZE_WORD][MAX_SIZE_WORD];
+   size_t sampleChunk;
+   TEXTCOUNTS counts;
+   unsigned char registers[HLL_REGISTERS];
 }CONTROLINFO;
 
 #endif /* end of include guard: CONTROLINFO_H */
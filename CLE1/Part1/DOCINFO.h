@@ -0,0 +1,47 @@
+/**
+ *  \file DOCINFO.h (interface file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  File with the data of a document to process, either a text file, a stream or a document of a corpus pack (the
+ *  first document of a pack holding its mapping), and whether it could not be opened.
+ *
+ *  \author Francisco Gonalves Tiago Lucas - April 2020
+ */
+ 
+#ifndef DOCINFO_H
+#define DOCINFO_H
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "READBLOCK.h"
+#include "RESUMESTATE.h"
+#include "STREAMINFO.h"
+
+typedef struct
+{
+   char *name;
+   char *path;
+   FILE *file;
+   const unsigned char *data;
+   uint64_t id;
+   size_t size;
+   size_t position;
+   int fd;
+   READBLOCK **ahead;
+   size_t numbAhead;
+   uint64_t nextOffset;
+   uint64_t contentHash;
+   bool contentHashed;
+   bool wordBoundary;
+   RESUMESTATE *resume;
+   STREAMINFO *stream;
+   unsigned char *pack;
+   size_t packSize;
+   bool failed;
+}DOCINFO;
+
+#endif /* end of include guard: DOCINFO_H */
@@ -0,0 +1,53 @@
+/**
+ *  \file JOBINFO.h (interface file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  Job: the documents of a run, or of a request to the server, with their schedule and their results, its options
+ *  (number of most frequent words, error of the samples) and its priority, the number of workers serving it and the
+ *  chunks handed out whose results are not saved yet.
+ *
+ *  \author Francisco Gonalves Tiago Lucas - April 2020
+ */
+ 
+#ifndef JOBINFO_H
+#define JOBINFO_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "probConst.h"
+#include "CONTROLINFO.h"
+#include "DOCINFO.h"
+#include "WORDENTRY.h"
+#include "WORDTABLE.h"
+#include "SAMPLEINFO.h"
+
+typedef struct
+{
+   DOCINFO *documents;
+   CONTROLINFO *results;
+   unsigned int numbFiles;
+   int *maxWordLEN;
+   bool *cached;
+   size_t *schedule;
+   size_t numbScheduled;
+   size_t filePosition;
+   size_t activeFiles[ACTIVE_FILES];
+   size_t numbActive;
+   size_t nextActive;
+   size_t numbTopWords;
+   WORDTABLE *words;
+   double sampleError;
+   SAMPLEINFO **samples;
+   int priority;
+   unsigned int numbWorkers;
+   size_t pending;
+   bool drained;
+   bool done;
+   pthread_mutex_t access;
+   pthread_cond_t finished;
+} JOBINFO;
+
+#endif /* end of include guard: JOBINFO_H */
@@ -0,0 +1,31 @@
+/**
+ *  \file READBLOCK.h (interface file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  Read of the read engine, with the buffer of the pool where the bytes are stored.
+ *
+ *  \author Francisco Gonalves Tiago Lucas - April 2020
+ */
+ 
+#ifndef READBLOCK_H
+#define READBLOCK_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+typedef struct
+{
+   int fd;
+   uint64_t offset;
+   size_t length;
+   unsigned char *buffer;
+   unsigned int index;
+   ssize_t result;
+   bool busy;
+   bool done;
+} READBLOCK;
+
+#endif /* end of include guard: READBLOCK_H */
@@ -0,0 +1,32 @@
+/**
+ *  \file RESUMESTATE.h (interface file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  State of a text file saved after a run, so that the next run only processes the text appended to it.
+ *
+ *  \author Francisco Gonalves Tiago Lucas - April 2020
+ */
+ 
+#ifndef RESUMESTATE_H
+#define RESUMESTATE_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "CONTROLINFO.h"
+
+typedef struct
+{
+   uint64_t fileSize;
+   int64_t modified;
+   int64_t modifiedNsec;
+   uint64_t inode;
+   uint64_t headHash;
+   uint64_t offset;
+   uint64_t tailHash;
+   CONTROLINFO prefix;
+   CONTROLINFO whole;
+} RESUMESTATE;
+
+#endif /* end of include guard: RESUMESTATE_H */
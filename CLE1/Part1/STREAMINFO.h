@@ -0,0 +1,48 @@
+/**
+ *  \file STREAMINFO.h (interface file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  Text read from a stream (standard input, a pipe or a compressed file), that cannot be read at a position: the
+ *  blocks filled in turn by its reader threads while the others are consumed, the part of the text each block
+ *  is for next, and the last bytes returned, kept to be given back.
+ *
+ *  \author Francisco Gonalves Tiago Lucas - April 2020
+ */
+ 
+#ifndef STREAMINFO_H
+#define STREAMINFO_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "probConst.h"
+#include "DECODERINFO.h"
+
+typedef struct
+{
+   DECODERINFO decoder;
+   bool started;
+   bool stopping;
+   bool ended;
+   unsigned int numbThreads;
+   unsigned int numbSlots;
+   pthread_t readers[DECODE_THREADS];
+   pthread_mutex_t access;
+   pthread_cond_t changed;
+   unsigned char *block[STREAM_SLOTS];
+   size_t capacity[STREAM_SLOTS];
+   size_t length[STREAM_SLOTS];
+   size_t part[STREAM_SLOTS];
+   bool full[STREAM_SLOTS];
+   bool last[STREAM_SLOTS];
+   size_t nextPart;
+   unsigned int current;
+   size_t offset;
+   unsigned char kept[MAX_K];
+   size_t keptLength;
+   size_t givenBack;
+} STREAMINFO;
+
+#endif /* end of include guard: STREAMINFO_H */
@@ -0,0 +1,23 @@
+/**
+ *  \file TUNING.h (interface file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  Parameters of a run which depend on the machine: number of bytes of a chunk of text and number of worker
+ *  threads.
+ *
+ *  \author Francisco Gonalves Tiago Lucas - April 2020
+ */
+ 
+#ifndef TUNING_H
+#define TUNING_H
+
+#include <stdlib.h>
+
+typedef struct
+{
+   size_t chunkSize;
+   unsigned int numbThreads;
+} TUNING;
+
+#endif /* end of include guard: TUNING_H */
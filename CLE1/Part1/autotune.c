@@ -0,0 +1,288 @@
+/**
+ *  \file autotune.c (implementation file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  \author Francisco Gonalves and Tiago Lucas - April 2020
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include "probConst.h"
+#include "CONTROLINFO.h"
+#include "TUNING.h"
+#include "autotune.h"
+#include "wordSketch.h"
+
+/** \brief parameters of the run */
+TUNING tuning = {K, NUMB_THREADS};
+
+/** \brief name of the profile of the host */
+static char profileName[PATH_MAX];
+
+/** \brief synthetic text of the calibration, its size and the position of its next chunk */
+static unsigned char *text;
+static size_t textSize, position;
+
+/** \brief number of bytes of a chunk of the configuration being run */
+static size_t chunkSize;
+
+/** \brief kernel being calibrated */
+static void (*processChunk)(unsigned char*, CONTROLINFO*);
+
+/** \brief results of the text, merged as the workers do */
+static CONTROLINFO total;
+
+/** \brief locking flag which warrants mutual exclusion inside the text and the results */
+static pthread_mutex_t accessT = PTHREAD_MUTEX_INITIALIZER;
+
+const char *tuningProfile(void)
+{
+  char host[HOST_NAME_MAX + 1] = "localhost";
+  const char *home = getenv("HOME");
+
+  if (profileName[0] == '\0'){
+    gethostname(host, sizeof(host));
+    host[HOST_NAME_MAX] = '\0';
+    snprintf(profileName, PATH_MAX, "%s/%s/%s-%s.tune", home != NULL ? home : ".", TUNING_DIR, host, TUNING_PROFILE);
+  }
+  return profileName;
+}
+
+bool loadTuning(void)
+{
+  FILE *f = fopen(tuningProfile(), "r");
+  TUNING t = tuning;
+  char line[256], key[64];
+  double value;
+  bool valid = true;
+
+  if (f == NULL)
+    return false;
+  while (fgets(line, sizeof(line), f) != NULL)
+    if (line[0] != '#' && sscanf(line, "%63s %lf", key, &value) == 2){
+      if (strcmp(key, "chunkSize") == 0){
+        valid = valid && value >= TUNE_MIN_K && value <= MAX_K;
+        t.chunkSize = value;
+      } else if (strcmp(key, "numbThreads") == 0){
+        valid = valid && value >= 1 && value <= MAX_THREADS;
+        t.numbThreads = value;
+      }
+    }
+  fclose(f);
+  if (!valid){
+    fprintf(stderr, "the profile %s has a parameter out of range, it is not used\n", profileName);
+    return false;
+  }
+  tuning = t;
+  return true;
+}
+
+bool saveTuning(void)
+{
+  char dirName[PATH_MAX], tempName[PATH_MAX + 4], host[HOST_NAME_MAX + 1] = "localhost";
+  const char *home = getenv("HOME");
+  FILE *f;
+
+  snprintf(dirName, PATH_MAX, "%s/%s", home != NULL ? home : ".", TUNING_DIR);
+  if (mkdir(dirName, 0755) != 0 && errno != EEXIST)
+    return false;
+  snprintf(tempName, sizeof(tempName), "%s.tmp", tuningProfile());
+  if ((f = fopen(tempName, "w")) == NULL)
+    return false;
+  gethostname(host, sizeof(host));
+  host[HOST_NAME_MAX] = '\0';
+  fprintf(f, "# %s, calibrated on %s\n", TUNING_PROFILE, host);
+  fprintf(f, "chunkSize %zu\n", tuning.chunkSize);
+  fprintf(f, "numbThreads %u\n", tuning.numbThreads);
+  if (fclose(f) != 0 || rename(tempName, profileName) != 0){
+    unlink(tempName);
+    return false;
+  }
+  return true;
+}
+
+/**
+ *  \brief Next pseudo random number (xorshift), the same text being made on every machine.
+ *
+ *  Internal operation.
+ */
+static uint64_t nextRandom(uint64_t *state)
+{
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+/**
+ *  \brief Make the synthetic text: words of 1 to 12 letters, some of them capitalized, accented (UTF-8) or with
+ *  an apostrophe, separated by spaces, punctuation and line breaks.
+ *
+ *  Internal operation.
+ */
+static void makeText(size_t size)
+{
+  static const char *const accented[] = {"\xC3\xA1", "\xC3\xA3", "\xC3\xA2", "\xC3\xA7", "\xC3\xA9", "\xC3\xAA",
+                                         "\xC3\xAD", "\xC3\xB3", "\xC3\xB5", "\xC3\xBA", "\xC3\x89", "\xC3\x87"};
+  static const char *const separators[] = {" ", " ", " ", " ", " ", ", ", ". ", "\n", " - ", "; "};
+  uint64_t state = 0x9E3779B97F4A7C15ULL;
+  size_t n = 0;
+
+  text = (unsigned char *) malloc(size + 16);
+  while (n < size){
+    size_t length = 1 + nextRandom(&state) % 12;
+    for (size_t i = 0; i < length && n < size; i++){
+      uint64_t r = nextRandom(&state) % 100;
+      char letter[2] = {0};
+      const char *c = letter;
+      if (r < 8)
+        c = accented[nextRandom(&state) % 12];
+      else if (r < 10 && i > 0)
+        c = r == 8 ? "'" : "\xE2\x80\x99";
+      else if (r < 12)
+        letter[0] = '0' + nextRandom(&state) % 10;
+      else
+        letter[0] = (i == 0 && r < 20 ? 'A' : 'a') + nextRandom(&state) % 26;
+      memcpy(text + n, c, strlen(c));
+      n += strlen(c);
+    }
+    const char *s = separators[nextRandom(&state) % 10];
+    memcpy(text + n, s, strlen(s));
+    n += strlen(s);
+  }
+  textSize = n;
+}
+
+/**
+ *  \brief Worker of the calibration: gets a chunk of the text, ending at a stop character, processes it and merges
+ *  its results, as the workers of the program do.
+ *
+ *  Internal operation.
+ */
+static void *processChunks(void *arg)
+{
+  unsigned char *buffer = (unsigned char *) calloc(MAX_K + 3, 1);
+  CONTROLINFO *ci = (CONTROLINFO *) calloc(1, sizeof(CONTROLINFO));
+  size_t n;
+
+  while (true){
+    pthread_mutex_lock(&accessT);
+    n = textSize - position < chunkSize ? textSize - position : chunkSize;
+    if (n == chunkSize)
+      while (n > 1 && strchr(" \n,.;-", text[position + n - 1]) == NULL)
+        n--;
+    memcpy(buffer, text + position, n);
+    position += n;
+    pthread_mutex_unlock(&accessT);
+    if (n == 0)
+      break;
+    memset(buffer + n, 0, 3);
+    ci->numbBytes = n;
+    processChunk(buffer, ci);
+
+    pthread_mutex_lock(&accessT);
+    total.numbBytes += ci->numbBytes;
+    total.counts.numbWords += ci->counts.numbWords;
+    if (ci->counts.maxWordLength > total.counts.maxWordLength)
+      total.counts.maxWordLength = ci->counts.maxWordLength;
+    ci->counts.numbWords = 0;
+    for (size_t i = 0; i < ci->counts.maxWordLength+1; i++)
+      for (size_t j = 0; j < ci->counts.maxWordLength; j++){
+        total.counts.bidi[i][j] += ci->counts.bidi[i][j];
+        ci->counts.bidi[i][j] = 0;
+      }
+    ci->counts.maxWordLength = 0;
+    mergeSketch(total.registers, ci->registers);
+    memset(ci->registers, 0, HLL_REGISTERS);
+    pthread_mutex_unlock(&accessT);
+  }
+  free(buffer);
+  free(ci);
+  return NULL;
+}
+
+/**
+ *  \brief Rate of a configuration, its fastest run.
+ *
+ *  Internal operation.
+ *
+ *  \return bytes per second
+ */
+static double runText(size_t chunk, unsigned int numbThreads)
+{
+  pthread_t threads[numbThreads];
+  struct timespec start, end;
+  double best = 0;
+
+  chunkSize = chunk;
+  for (int round = 0; round < TUNE_ROUNDS; round++){
+    position = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned int i = 0; i < numbThreads; i++)
+      if (pthread_create(&threads[i], NULL, processChunks, NULL) != 0){
+        perror ("error on creating the calibration threads");
+        exit (EXIT_FAILURE);
+      }
+    for (unsigned int i = 0; i < numbThreads; i++)
+      pthread_join(threads[i], NULL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double rate = textSize / ((end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+    best = rate > best ? rate : best;
+  }
+  printf("chunks of %6zu bytes, %3u threads: %8.1f MB/s\n", chunk, numbThreads, best / 1e6);
+  return best;
+}
+
+/**
+ *  \brief Chunk size which processes the text the fastest with a number of threads.
+ *
+ *  Internal operation.
+ */
+static size_t tuneChunkSize(unsigned int numbThreads)
+{
+  size_t chunk, best = TUNE_MIN_K;
+  double rate, bestRate = runText(TUNE_MIN_K, numbThreads);
+
+  for (chunk = 2 * TUNE_MIN_K; chunk <= MAX_K; chunk *= 2)
+    if ((rate = runText(chunk, numbThreads)) > bestRate * (1 + TUNE_MARGIN)){
+      best = chunk;
+      bestRate = rate;
+    }
+  return best;
+}
+
+void tuneText(void (*kernel)(unsigned char*, CONTROLINFO*), unsigned int maxThreads)
+{
+  unsigned int threads, best = 1;
+  double rate, bestRate;
+
+  processChunk = kernel;
+  makeText(TUNE_TEXT);
+  maxThreads = maxThreads < MAX_THREADS ? maxThreads : MAX_THREADS;
+  threads = tuning.numbThreads < maxThreads ? tuning.numbThreads : maxThreads;
+
+  tuning.chunkSize = tuneChunkSize(threads);
+  tuning.numbThreads = threads;
+  if (maxThreads > 1){                                  /* powers of two, and the number of CPUs */
+    bestRate = runText(tuning.chunkSize, 1);
+    for (threads = 2; threads < 2 * maxThreads; threads *= 2)
+      if ((rate = runText(tuning.chunkSize, threads < maxThreads ? threads : maxThreads)) > bestRate * (1 + TUNE_MARGIN)){
+        best = threads < maxThreads ? threads : maxThreads;
+        bestRate = rate;
+      }
+    tuning.numbThreads = best;
+    tuning.chunkSize = tuneChunkSize(tuning.numbThreads);
+  }
+  free(text);
+}
@@ -0,0 +1,66 @@
+/**
+ *  \file autotune.h (interface file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  Parameters of the run which depend on the machine, the number of bytes of a chunk (K) and the number of worker
+ *  threads: the defaults of probConst.h, replaced by the profile of the host when there is one, or found by a
+ *  calibration.
+ *
+ *  The calibration processes a synthetic text with the kernel of the program, the chunks being handed out and their
+ *  results merged under a lock as the workers do, and searches the chunk sizes and the numbers of threads one after
+ *  the other (chunk size, number of threads, then chunk size again for that number of threads), each configuration
+ *  being run TUNE_ROUNDS times and its fastest run kept. A larger configuration is only taken when it is more than
+ *  TUNE_MARGIN faster.
+ *
+ *  The profile is a text file, a parameter per line, named after the host and the program (TUNING_PROFILE) in the
+ *  directory TUNING_DIR of the home directory, so that a home directory shared by several machines keeps one for each.
+ *
+ *  \author Francisco Gonalves and Tiago Lucas - April 2020
+ */
+
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+#include <stdbool.h>
+
+#include "TUNING.h"
+#include "CONTROLINFO.h"
+
+/** \brief parameters of the run */
+extern TUNING tuning;
+
+/**
+ *  \brief Load the profile of the host into the parameters of the run.
+ *
+ *  Operation carried out by the main thread (by the dispatcher in the MPI program), before the work starts. A
+ *  profile with a parameter out of its range is ignored, with a message.
+ *
+ *  \return false if there is no profile, the defaults being kept
+ */
+extern bool loadTuning(void);
+
+/**
+ *  \brief Save the parameters of the run as the profile of the host, the directory being created if needed.
+ *
+ *  \return false on a write error
+ */
+extern bool saveTuning(void);
+
+/**
+ *  \brief Name of the profile of the host.
+ *
+ *  \return the name, in a static buffer
+ */
+extern const char *tuningProfile(void);
+
+/**
+ *  \brief Find the parameters of the run which process a text the fastest.
+ *
+ *  \param kernel     processing of a chunk, the one of the workers
+ *  \param maxThreads largest number of threads tried, 1 for the chunk size alone (the number of processes of the
+ *                    MPI program is given by mpirun)
+ */
+extern void tuneText(void (*kernel)(unsigned char*, CONTROLINFO*), unsigned int maxThreads);
+
+#endif /* AUTOTUNE_H */
@@ -0,0 +1,303 @@
+/**
+ *  \file jobServer.c (implementation file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  \author Francisco Gonalves and Tiago Lucas - April 2020
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "probConst.h"
+#include "JOBINFO.h"
+#include "sharedRegion.h"
+#include "jobServer.h"
+
+/** \brief socket of the server and its name */
+static int listener = -1;
+static struct sockaddr_un address;
+
+/** \brief the server was interrupted */
+static volatile sig_atomic_t stopping;
+
+/** \brief number of requests being served */
+static unsigned int numbRequests;
+
+/** \brief locking flag which warrants mutual exclusion inside the number of requests */
+static pthread_mutex_t accessS = PTHREAD_MUTEX_INITIALIZER;
+
+/** \brief signaled when a request is served */
+static pthread_cond_t served = PTHREAD_COND_INITIALIZER;
+
+/**
+ *  \brief Signals which stop the server.
+ *
+ *  Internal operation.
+ */
+static void serverSignals(sigset_t *signals)
+{
+  sigemptyset(signals);
+  sigaddset(signals, SIGINT);
+  sigaddset(signals, SIGTERM);
+}
+
+/**
+ *  \brief Handler of SIGINT and SIGTERM, the accept of the main thread being interrupted.
+ *
+ *  Internal operation.
+ */
+static void stopServer(int signal)
+{
+  stopping = 1;
+}
+
+/**
+ *  \brief Write exactly count bytes.
+ *
+ *  Internal operation.
+ */
+static bool writeAll(int fd, const void *buffer, size_t count)
+{
+  while (count > 0){
+    ssize_t n = write(fd, buffer, count);
+    if (n <= 0)
+      return false;
+    buffer = (const char *) buffer + n;
+    count -= n;
+  }
+  return true;
+}
+
+/**
+ *  \brief Read a request, up to its empty word.
+ *
+ *  Internal operation.
+ *
+ *  \return the words of the request, NULL if the client left or it is longer than REQUEST_MAX
+ */
+static char *readRequest(int fd, size_t *length)
+{
+  size_t size = 4096, n = 0;
+  char *request = (char *) malloc(size);
+  ssize_t count;
+
+  while (n < 2 || request[n - 1] != '\0' || request[n - 2] != '\0'){
+    if (n == size && (size *= 2) > REQUEST_MAX){
+      free(request);
+      return NULL;
+    }
+    request = (char *) realloc(request, size);
+    if ((count = read(fd, request + n, size - n)) <= 0){
+      free(request);
+      return NULL;
+    }
+    n += count;
+  }
+  *length = n;
+  return request;
+}
+
+/**
+ *  \brief Serve a request: its documents are a job whose results are written back once they are complete.
+ *
+ *  Internal operation, carried out by the thread of the request.
+ */
+static void *serveRequest(void *arg)
+{
+  int fd = (int) (intptr_t) arg;
+  sigset_t signals;
+  size_t length, numbFiles = 0;
+  char *request, *word, *value, **files, *reason = NULL;
+  int numbTopWords = 0, priority = 0;
+  double sampleError = 0;
+  bool names = false;
+  JOBINFO *job;
+  FILE *out;
+
+  serverSignals(&signals);
+  pthread_sigmask(SIG_BLOCK, &signals, NULL);
+  if ((request = readRequest(fd, &length)) == NULL)
+    close(fd);
+  else {
+    files = (char **) malloc(sizeof(char *) * length);
+    for (word = request; *word != '\0'; word += strlen(word) + 1){
+      value = word + strlen(word) + 1;
+      if (names)
+        files[numbFiles++] = word;
+      else if (strcmp(word, "--") == 0)
+        names = true;
+      else if (*value == '\0'){                                                     /* an option without its value */
+        reason = "invalid request";
+        break;
+      }else {
+        if (strcmp(word, "-w") == 0)
+          numbTopWords = atoi(value);
+        else if (strcmp(word, "-s") == 0)
+          sampleError = atof(value);
+        else if (strcmp(word, "-n") == 0)
+          priority = atoi(value);
+        else
+          reason = "invalid request";
+        word = value;
+      }
+    }
+    if (numbTopWords < 0)
+      reason = "invalid number of words";
+    else if (sampleError < 0 || sampleError >= 1)
+      reason = "invalid relative error";
+    for (size_t i = 0; i < numbFiles && reason == NULL; i++)
+      if (strcmp(files[i], "-") == 0)
+        reason = "the standard input of a client can not be read";
+
+    out = fdopen(fd, "w");
+    job = newJob(priority);
+    presentTopWords(job, numbTopWords);
+    presentSampling(job, sampleError);
+    if (reason == NULL && !presentDataFileNames(job, files, numbFiles))
+      reason = "no documents to process";
+    if (reason == NULL){
+      submitJob(job);
+      waitJob(job);
+      fprintf(out, "ok\n");
+    }else
+      fprintf(out, "error %s\n", reason);
+    printResults(job, out);            /* the job is released, whatever its outcome, a file not read is an error line */
+    fclose(out);
+    free(files);
+    free(request);
+  }
+
+  pthread_mutex_lock(&accessS);
+  numbRequests--;
+  pthread_cond_signal(&served);
+  pthread_mutex_unlock(&accessS);
+  return NULL;
+}
+
+bool startServer(const char *socketName)
+{
+  sigset_t signals;
+
+  if (strlen(socketName) >= sizeof(address.sun_path)){
+    errno = ENAMETOOLONG;
+    return false;
+  }
+  address.sun_family = AF_UNIX;
+  strcpy(address.sun_path, socketName);
+  if ((listener = socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
+    return false;
+  unlink(socketName);
+  if (bind(listener, (struct sockaddr *) &address, sizeof(address)) != 0 || listen(listener, MAX_JOBS) != 0){
+    close(listener);
+    return false;
+  }
+  serverSignals(&signals);
+  pthread_sigmask(SIG_BLOCK, &signals, NULL);
+  signal(SIGPIPE, SIG_IGN);                                          /* a client which leaves is not waited for */
+  return true;
+}
+
+void runServer(void)
+{
+  struct sigaction action;
+  sigset_t signals;
+  pthread_t thread;
+  int fd;
+
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = stopServer;                                      /* not restarted, accept returns EINTR */
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+  serverSignals(&signals);
+  pthread_sigmask(SIG_UNBLOCK, &signals, NULL);
+
+  while (!stopping)
+    if ((fd = accept(listener, NULL, NULL)) >= 0){
+      pthread_mutex_lock(&accessS);
+      if (numbRequests == MAX_JOBS){
+        pthread_mutex_unlock(&accessS);
+        dprintf(fd, "error too many requests\n");
+        close(fd);
+        continue;
+      }
+      numbRequests++;
+      pthread_mutex_unlock(&accessS);
+      if (pthread_create(&thread, NULL, serveRequest, (void *) (intptr_t) fd) != 0){
+        perror("error on creating the thread of a request");
+        close(fd);
+        pthread_mutex_lock(&accessS);
+        numbRequests--;
+        pthread_mutex_unlock(&accessS);
+      }else
+        pthread_detach(thread);
+    }else if (errno != EINTR && errno != ECONNABORTED)
+      perror("error on accepting a request");
+
+  close(listener);
+  unlink(address.sun_path);
+  pthread_mutex_lock(&accessS);
+  while (numbRequests > 0)
+    pthread_cond_wait(&served, &accessS);
+  pthread_mutex_unlock(&accessS);
+}
+
+bool requestJob(const char *socketName, int numbTopWords, double sampleError, int priority, char *files[],
+                unsigned int numbFiles)
+{
+  struct sockaddr_un server;
+  char path[PATH_MAX];
+  char *request = NULL, *line = NULL;
+  size_t length = 0, size = 0;
+  FILE *in, *f;
+  bool ok, replied;
+  int fd;
+
+  if ((f = open_memstream(&request, &length)) == NULL)
+    return false;
+  fprintf(f, "-w%c%d%c-s%c%.17g%c-n%c%d%c--%c", 0, numbTopWords, 0, 0, sampleError, 0, 0, priority, 0, 0);
+  for (unsigned int i = 0; i < numbFiles; i++){
+    const char *name = files[i] + (files[i][0] == '@');                /* the names inside a list are sent as such */
+    if (strcmp(files[i], "-") == 0 || realpath(name, path) == NULL)
+      snprintf(path, sizeof(path), "%s", name);                                 /* reported by the server */
+    fprintf(f, "%s%s%c", files[i][0] == '@' ? "@" : "", path, 0);
+  }
+  fputc(0, f);
+  fclose(f);
+
+  memset(&server, 0, sizeof(server));
+  server.sun_family = AF_UNIX;
+  strncpy(server.sun_path, socketName, sizeof(server.sun_path) - 1);
+  if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0 || connect(fd, (struct sockaddr *) &server, sizeof(server)) != 0
+      || !writeAll(fd, request, length)){
+    perror(socketName);
+    free(request);
+    return false;
+  }
+  free(request);
+
+  in = fdopen(fd, "r");
+  replied = getline(&line, &size, in) >= 0;
+  if ((ok = replied && strcmp(line, "ok\n") == 0)){
+    while (getline(&line, &size, in) >= 0)
+      if (strncmp(line, "error ", 6) == 0){                                      /* a file the server could not read */
+        fprintf(stderr, "%s", line + 6);
+        ok = false;
+      }else
+        fputs(line, stdout);
+  }else
+    fprintf(stderr, "the request failed: %s", replied && strncmp(line, "error ", 6) == 0 ? line + 6 : "no reply\n");
+  free(line);
+  fclose(in);
+  return ok;
+}
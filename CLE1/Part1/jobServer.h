@@ -0,0 +1,62 @@
+/**
+ *  \file jobServer.h (interface file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  Server of the word statistics of documents on a Unix domain socket: the worker threads, their buffers and the
+ *  result cache are kept from a request to the next, so that a small request does not pay for the start of a
+ *  process. Each request is served by a thread of its own, its documents being a job of the shared region whose
+ *  chunks are handed out to the workers with the ones of the other requests (see sharedRegion.h), and its results
+ *  are written back once they are complete. At most MAX_JOBS requests are served at a time.
+ *
+ *  A request is the words of a command line, each one ended by a NUL character, the last one being empty: the
+ *  options -w n (most frequent words), -s error (sampling) and -n priority, then --, then the files. The names are
+ *  taken from the directory of the server, the client sending them as absolute names. The reply is a line, ok or
+ *  error and the reason, followed by the results, where a file which could not be read is a line error and its name.
+ *
+ *  \author Francisco Gonalves and Tiago Lucas - April 2020
+ */
+
+#ifndef JOBSERVER_H
+#define JOBSERVER_H
+
+#include <stdbool.h>
+
+/**
+ *  \brief Create the socket of the server.
+ *
+ *  Operation carried out by the main thread, before the workers are started: SIGINT and SIGTERM are blocked, so that
+ *  the threads started afterwards leave them to the main thread.
+ *
+ *  \param *socketName name of the socket, replacing the one of a server which was killed
+ *
+ *  \return false if the socket could not be created
+ */
+extern bool startServer(const char *socketName);
+
+/**
+ *  \brief Serve the requests until the process is interrupted (SIGINT or SIGTERM), then wait for the requests being
+ *  served and remove the socket.
+ *
+ *  Operation carried out by the main thread, once the workers are started.
+ */
+extern void runServer(void);
+
+/**
+ *  \brief Send a request to a server and print its results.
+ *
+ *  Operation carried out by the main thread of a client.
+ *
+ *  \param *socketName   name of the socket of the server
+ *  \param numbTopWords  number of most frequent words printed for each file, 0 not to count them
+ *  \param sampleError   relative error of the samples, 0 to process the documents whole
+ *  \param priority      the requests of a higher priority are served first
+ *  \param files         names of the files
+ *  \param numbFiles     number of files
+ *
+ *  \return false if the server could not be reached, the request failed or a file could not be read
+ */
+extern bool requestJob(const char *socketName, int numbTopWords, double sampleError, int priority, char *files[],
+                       unsigned int numbFiles);
+
+#endif /* JOBSERVER_H */
@@ -0,0 +1,130 @@
+/**
+ *  \file packTool.c (implementation file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  Packing of many small text files (or other packs) into a single corpus pack.
+ *  Separate program, built from this file, corpusPack.c, fileList.c, readEngine.c, streamReader.c and textDecoder.c
+ *  (linked with zlib); it has a main of its own, so it is left out of the build of prob1.
+ *
+ *  \author Francisco Gonalves Tiago Lucas - April 2020
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "PACKENTRY.h"
+#include "DOCINFO.h"
+#include "corpusPack.h"
+
+/** \brief size of the buffer used to copy the documents */
+#define  PACK_COPY           (1 << 20)
+
+/** \brief alignment of the data section */
+#define  PACK_ALIGN          4096
+
+/**
+ *  \brief Write exactly count bytes at a position.
+ *
+ *  Internal operation.
+ */
+static bool writeAt(int fd, const void *buffer, size_t count, off_t position)
+{
+  while (count > 0){
+    ssize_t n = pwrite(fd, buffer, count, position);
+    if (n <= 0)
+      return false;
+    buffer = (const char *) buffer + n;
+    count -= n;
+    position += n;
+  }
+  return true;
+}
+
+int main (int argc, char *argv[])
+{
+  int opt, out;
+  char *outputName = NULL;
+  DOCINFO *documents;
+  PACKENTRY *index;
+  size_t numbDocuments, i, n;
+  unsigned char header[PACK_HEADER] = {0};
+  unsigned char *buffer;
+  uint32_t version = PACK_VERSION;
+  uint64_t namesSize = 0, indexOffset = PACK_HEADER, namesOffset, dataOffset, offset;
+
+  while ((opt = getopt (argc, argv, "o:")) != -1)
+    switch (opt){
+      case 'o': outputName = optarg;
+                break;
+      default:  fprintf(stderr, "Usage: %s -o output files\n", argv[0]);
+                exit(EXIT_FAILURE);
+    }
+  if (outputName == NULL || optind == argc){
+    fprintf(stderr, "Usage: %s -o output files\n", argv[0]);
+    exit(EXIT_FAILURE);
+  }
+
+  if ((numbDocuments = listDocuments(argv + optind, argc - optind, &documents)) == 0)
+    exit(EXIT_FAILURE);
+  index = (PACKENTRY *) calloc(numbDocuments, sizeof(PACKENTRY));
+  buffer = (unsigned char *) malloc(PACK_COPY);
+  if ((out = open(outputName, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0){
+    perror ("error on creating the output file");
+    exit(EXIT_FAILURE);
+  }
+
+  /* layout: header, index, names and the aligned data */
+  namesOffset = indexOffset + sizeof(PACKENTRY) * numbDocuments;
+  for (i = 0; i < numbDocuments; i++){
+    index[i].id = i;
+    index[i].nameOffset = namesSize;
+    if (!writeAt(out, documents[i].name, strlen(documents[i].name) + 1, namesOffset + namesSize)){
+      perror ("error on writing the output file");
+      exit(EXIT_FAILURE);
+    }
+    namesSize += strlen(documents[i].name) + 1;
+  }
+  dataOffset = offset = (namesOffset + namesSize + PACK_ALIGN - 1) / PACK_ALIGN * PACK_ALIGN;
+
+  for (i = 0; i < numbDocuments; i++){
+    if (!openDocument(&documents[i])){
+      perror (documents[i].path);
+      exit(EXIT_FAILURE);
+    }
+    index[i].offset = offset;
+    do {
+      n = readDocument(&documents[i], buffer, PACK_COPY);
+      if (!writeAt(out, buffer, n, offset)){
+        perror ("error on writing the output file");
+        exit(EXIT_FAILURE);
+      }
+      offset += n;
+    } while (n == PACK_COPY);
+    index[i].size = offset - index[i].offset;
+  }
+
+  memcpy(header, PACK_MAGIC, 8);
+  memcpy(header + 8, &version, sizeof(uint32_t));
+  memcpy(header + 16, &numbDocuments, sizeof(uint64_t));
+  memcpy(header + 24, &indexOffset, sizeof(uint64_t));
+  memcpy(header + 32, &namesOffset, sizeof(uint64_t));
+  memcpy(header + 40, &namesSize, sizeof(uint64_t));
+  memcpy(header + 48, &dataOffset, sizeof(uint64_t));
+  if (!writeAt(out, index, sizeof(PACKENTRY) * numbDocuments, indexOffset) || !writeAt(out, header, PACK_HEADER, 0)
+      || close(out) != 0){
+    perror ("error on writing the output file");
+    exit(EXIT_FAILURE);
+  }
+  printf("%zu documents packed in %s\n", numbDocuments, outputName);
+
+  closeDocuments(documents, numbDocuments);
+  free(index);
+  free(buffer);
+  exit(EXIT_SUCCESS);
+}
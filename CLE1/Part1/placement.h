@@ -0,0 +1,76 @@
+/**
+ *  \file placement.h (interface file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  Placement of the worker threads on the CPUs of the NUMA nodes, each worker being bound to a CPU when it is
+ *  created: compact (the CPUs of a node before the ones of the next node), scatter (the nodes in turn) or an
+ *  explicit list of CPUs. Only the CPUs the process is allowed to run on are used, so that the binding given by
+ *  a job launcher (mpirun, taskset, numactl) is respected. The memory a worker allocates is placed on its node
+ *  the first time it writes to it.
+ *
+ *  \author Francisco Gonalves and Tiago Lucas - April 2020
+ */
+
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+/** \brief threads left where the system puts them */
+#define  PLACE_NONE          0
+
+/** \brief the CPUs of a node before the ones of the next node */
+#define  PLACE_COMPACT       1
+
+/** \brief a CPU of each node in turn */
+#define  PLACE_SCATTER       2
+
+/** \brief the CPUs of a list, in its order */
+#define  PLACE_LIST          3
+
+/**
+ *  \brief Choose the CPUs of the workers, from the nodes of the system and the CPUs the process may run on.
+ *
+ *  \param policy PLACE_COMPACT, PLACE_SCATTER or PLACE_LIST
+ *  \param *list with PLACE_LIST, the CPUs in the form 0,2,4-7
+ *
+ *  \return false if there is no CPU to place the workers on (they are then left where the system puts them)
+ */
+extern bool startPlacement(int policy, const char *list);
+
+/**
+ *  \brief Bind a worker to its CPU through the attributes it is created with, nothing is done without placement.
+ *
+ *  \param *attr attributes of the thread
+ *  \param worker number of the worker, the CPUs being used in turn when there are fewer of them
+ */
+extern void placeThread(pthread_attr_t *attr, unsigned int worker);
+
+/**
+ *  \brief Node of the CPU of a worker.
+ *
+ *  \param worker number of the worker
+ *
+ *  \return node, -1 without placement
+ */
+extern int workerNode(unsigned int worker);
+
+/**
+ *  \brief Number of NUMA nodes of the system.
+ *
+ *  \return number of nodes, 1 where they are not known
+ */
+extern unsigned int numbNodes(void);
+
+/**
+ *  \brief Describe the CPUs the calling thread may run on and their nodes, as in CPUs 0-3,8 (node 0).
+ *
+ *  \param *text where the description is stored
+ *  \param size size of text
+ */
+extern void describeBinding(char *text, size_t size);
+
+#endif /* PLACEMENT_H */
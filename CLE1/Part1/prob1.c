@@ -17,9 +17,34 @@
 #include <sys/types.h>
 #include <time.h>
 #include <math.h>
+#include <string.h>
+#include <unistd.h>
 
 #include "probConst.h"
 #include "sharedRegion.h"
+#include "readEngine.h"
+#include "HASHSTATE.h"
+#include "resultCache.h"
+#include "CONTROLINFO.h"
+#include "RESUMESTATE.h"
+#include "DOCINFO.h"
+#include "documentCache.h"
+#include "WORDENTRY.h"
+#include "WORDTABLE.h"
+#include "wordTable.h"
+#include "wordSketch.h"
+#include "placement.h"
+#include "PERFCOUNTS.h"
+#include "perfCounters.h"
+#include "TRACEEVENT.h"
+#include "traceLog.h"
+#include "progressMetrics.h"
+#include "TUNING.h"
+#include "autotune.h"
+#include "JOBINFO.h"
+#include "jobServer.h"
+#include "ANALYZER.h"
+#include "textAnalyzer.h"
 
 
 /** \brief workerThread life cycle routine */
@@ -28,143 +53,324 @@ static void *processText (void *id);
 /** \brief Result creation and storage */
 void process(unsigned char*, CONTROLINFO*);
 
+/** \brief kernels whose hardware counters are reported */
+static const char *const kernelNames[] = {"scanText"};
+
 /** \brief worker threads return status array */
-int statusWorkers[NUMB_THREADS];
+int statusWorkers[MAX_THREADS];
 
 /** \brief worker threads response */
 int *status_p;
 
+/** \brief worker threads and their identifications */
+static pthread_t threads_id[MAX_THREADS];
+static unsigned int worker_threads[MAX_THREADS];
+
+/** \brief Start the worker threads */
+static void startWorkers (void);
+
+/** \brief Wait for the worker threads to leave */
+static void joinWorkers (void);
+
 /**
  *  \brief Main thread.
  *
  *  Its role is starting the simulation by generating the worker threads and waiting for their termination.
+ *
+ *  Options:
+ *     -i engine   read the text files through the asynchronous read engine: uring (io_uring, or threads where it
+ *                 is not available) or threads (a pool of threads calling pread)
+ *     -q n        read engine: number of reads outstanding at once (default READ_DEPTH)
+ *     -c dir      keep the results of each document in the result cache dir (created if needed, at most
+ *                 CACHE_LIMIT bytes), documents already seen are not processed again
+ *     -R          with -c, a text file that only grew since the last run is resumed from its saved state, only the
+ *                 appended text being read (its size, time of modification and some of its bytes are checked
+ *                 instead of its whole content)
+ *     -w n        print the n most frequent words of each file (the result cache is then not used)
+ *     -s error    estimate the results of each document of at least SAMPLE_MIN bytes from a random sample of its
+ *                 chunks, until the margin of error of its number of words is below the relative error given (for
+ *                 instance 0.01), and print the margins of error (the result cache is then not used)
+ *     -p policy   bind each worker to a CPU: compact (the CPUs of a NUMA node before the ones of the next node),
+ *                 scatter (the nodes in turn) or a list of CPUs such as 0,2,4-7; the buffers and the word tables
+ *                 of a worker are then on its node, where it writes them first
+ *     -P          count the cycles, instructions, cache misses and branch misses of each worker over each chunk
+ *                 and report them per worker and per kernel (see perfCounters.h)
+ *     -T file     record the timeline of the workers (chunks fetched, computation, merges, lock waits) and write
+ *                 it to file as a Chrome trace (see traceLog.h)
+ *     -M file     export the progress of the run (bytes read, words counted, progress of each file, rate of each
+ *                 worker, estimated time left) to file as a Prometheus textfile, rewritten every METRICS_PERIOD
+ *                 seconds (see progressMetrics.h)
+ *     -U          calibrate the number of bytes of a chunk and the number of worker threads on this host (see
+ *                 autotune.h) and save them as its profile, which the next runs load, then process the files if any
+ *     -D socket   serve the requests sent to the Unix domain socket given, several at a time, keeping the worker
+ *                 threads from a request to the next, until interrupted (see jobServer.h); -i, -q, -c, -R, -p and -U
+ *                 apply to every request, -P, -T and -M are not used
+ *     -C socket   send the files as a request to the server listening on the socket given, with the options -w and
+ *                 -s, and print its results
+ *     -n priority with -C, the priority of the request, the chunks of the requests of a higher priority being handed
+ *                 out first (default 0)
+ *
+ *  A file named - is the standard input, read as a stream like a pipe (see streamReader.h). With no files and the
+ *  standard input redirected, it is the only file. A file compressed with gzip, or zstd when built with HAVE_ZSTD,
+ *  is decompressed by threads of its own while its chunks are processed (see textDecoder.h).
+ *
+ *  The number of bytes of a chunk and the number of worker threads are the ones of the profile of the host when
+ *  there is one, K and NUMB_THREADS otherwise.
  */
 
 int main (int argc, char *argv[]) {
 
-   if(argc < 2) {
+   int opt;
+   int engine = READ_SYNC;
+   unsigned int readDepth = READ_DEPTH;
+   bool resume = false;
+   char *cacheDir = NULL;
+   int numbTopWords = 0;
+   double sampleError = 0;
+   char *standardInput[] = {"-"};
+   int placement = PLACE_NONE;
+   char *cpuList = NULL;
+   bool counters = false;
+   char *traceName = NULL;
+   char *metricsName = NULL;
+   bool autotune = false;
+   char *serverName = NULL;
+   char *clientName = NULL;
+   int priority = 0;
+
+   while ((opt = getopt (argc, argv, "i:q:c:Rw:s:p:PT:M:UD:C:n:")) != -1)
+      switch (opt) {
+         case 'i': if (strcmp (optarg, "uring") == 0)
+                      engine = READ_URING;
+                   else if (strcmp (optarg, "threads") == 0)
+                      engine = READ_THREADS;
+                   else {
+                      printf("Unknown read engine %s\n", optarg);
+                      exit(EXIT_FAILURE);
+                   }
+                   break;
+         case 'q': if ((readDepth = atoi (optarg)) == 0){
+                      printf("Invalid number of reads %s\n", optarg);
+                      exit(EXIT_FAILURE);
+                   }
+                   break;
+         case 'c': cacheDir = optarg;
+                   break;
+         case 'R': resume = true;
+                   break;
+         case 'w': if ((numbTopWords = atoi (optarg)) <= 0){
+                      printf("Invalid number of words %s\n", optarg);
+                      exit(EXIT_FAILURE);
+                   }
+                   break;
+         case 's': if ((sampleError = atof (optarg)) <= 0 || sampleError >= 1){
+                      printf("Invalid relative error %s\n", optarg);
+                      exit(EXIT_FAILURE);
+                   }
+                   break;
+         case 'p': if (strcmp (optarg, "compact") == 0)
+                      placement = PLACE_COMPACT;
+                   else if (strcmp (optarg, "scatter") == 0)
+                      placement = PLACE_SCATTER;
+                   else {
+                      placement = PLACE_LIST;
+                      cpuList = optarg;
+                   }
+                   break;
+         case 'P': counters = true;
+                   break;
+         case 'T': traceName = optarg;
+                   break;
+         case 'M': metricsName = optarg;
+                   break;
+         case 'U': autotune = true;
+                   break;
+         case 'D': serverName = optarg;
+                   break;
+         case 'C': clientName = optarg;
+                   break;
+         case 'n': priority = atoi (optarg);
+                   break;
+         default:  printf("Usage: %s [-i engine] [-q reads] [-c cache] [-R] [-w words] [-s error] [-p placement] [-P] [-T trace] [-M metrics] [-U] [-D socket] [-C socket [-n priority]] files\n", argv[0]);
+                   exit(EXIT_FAILURE);
+      }
+   if (clientName != NULL){                                           /* the server does the work */
+      struct timespec t0, t1;
+      clock_gettime (CLOCK_MONOTONIC, &t0);
+      if (!requestJob (clientName, numbTopWords, sampleError, priority, argv + optind, argc - optind))
+         exit (EXIT_FAILURE);
+      clock_gettime (CLOCK_MONOTONIC, &t1);
+      printf ("\nElapsed time = %.6f s\n", (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9);
+      exit (EXIT_SUCCESS);
+   }
+   if (serverName != NULL && (counters || traceName != NULL || metricsName != NULL)){
+      fprintf(stderr, "the counters, the timeline and the metrics are not used by the server\n");
+      counters = false;
+      traceName = metricsName = NULL;
+   }
+   loadTuning ();
+   if (autotune){
+      tuneText (process, sysconf (_SC_NPROCESSORS_ONLN));
+      if (!saveTuning ())
+         perror ("error on saving the profile");
+      printf("%zu bytes per chunk, %u worker threads, profile %s\n", tuning.chunkSize, tuning.numbThreads, tuningProfile ());
+      if (optind >= argc && serverName == NULL)
+         exit (EXIT_SUCCESS);
+   }
+   if (placement != PLACE_NONE)
+      startPlacement (placement, cpuList);
+   if (counters)
+      startCounters (tuning.numbThreads, 1);
+   if (traceName != NULL && !startTrace (tuning.numbThreads, TRACE_EVENTS))
+      fprintf(stderr, "the timeline could not be allocated, it is not recorded\n");
+   if (metricsName != NULL && !startMetrics (metricsName, tuning.numbThreads))
+      perror ("error on writing the metrics, they are not exported");
+   if (engine != READ_SYNC && startReadEngine (engine, readDepth, READ_BLOCK) == READ_SYNC)
+      fprintf(stderr, "the read engine could not be started, reading synchronously\n");
+   if (cacheDir != NULL && numbTopWords > 0)                       /* the words of a cached document are not kept */
+      fprintf(stderr, "the result cache is not used with -w, all the documents are processed\n");
+   else if (cacheDir != NULL && sampleError > 0)                /* looking a document up reads the whole of it */
+      fprintf(stderr, "the result cache is not used with -s\n");
+   else if (cacheDir != NULL && !openResultCache (cacheDir, CACHE_LIMIT))
+      fprintf(stderr, "the result cache %s could not be opened, it is not used\n", cacheDir);
+   if (resume && !resultCacheActive ())
+      fprintf(stderr, "-R needs the result cache (-c), the files are read whole\n");
+   else if (resume)
+      enableResume ();
+
+   if (serverName != NULL){
+      if (!startServer (serverName)){                              /* before the workers, which leave it the signals */
+         perror ("error on creating the socket of the server");
+         exit (EXIT_FAILURE);
+      }
+      startWorkers ();
+      printf("Serving requests on %s\n", serverName);
+      fflush (stdout);
+      runServer ();
+      closeJobs ();
+      joinWorkers ();
+      stopReadEngine ();
+      closeResultCache ();
+      exit (EXIT_SUCCESS);
+   }
+
+   if(optind >= argc && isatty (STDIN_FILENO)) {
       printf("Please insert text files to be processed as arguments!");
       exit(EXIT_FAILURE);
    } else {
         double t0, t1;
-        int i;
-      
-        unsigned int worker_threads[NUMB_THREADS];
-        pthread_t threads_id[NUMB_THREADS];
-        
-        for (i = 0; i < NUMB_THREADS; i++)
-            worker_threads[i] = i;
+        bool ok;
+        JOBINFO *job = newJob (0);
 
+        presentTopWords (job, numbTopWords);
+        presentSampling (job, sampleError);
         t0 = ((double) clock ()) / CLOCKS_PER_SEC;
-        presentDataFileNames(argv + 1, --argc);
-
-        for (i = 0; i < NUMB_THREADS; i++)
-            if (pthread_create (&threads_id[i], NULL, processText, &worker_threads[i]) != 0){ 
-                perror ("error on creating worker threads");
-                exit (EXIT_FAILURE);
-            }
-        
-        for (i = 0; i < NUMB_THREADS; i++)
-            if (pthread_join (threads_id[i], (void *) &status_p) != 0){ 
-                perror ("error on joining");
-                exit (EXIT_FAILURE);
-            }
+        if (optind < argc ? !presentDataFileNames(job, argv + optind, argc - optind)
+                          : !presentDataFileNames(job, standardInput, 1)){           /* a pipe or a redirection */
+            fprintf(stderr, "no documents to process\n");
+            exit(EXIT_FAILURE);
+        }
+        submitJob (job);
+        closeJobs ();                                                   /* the workers leave once it is handed out */
+
+        startWorkers ();
+        joinWorkers ();
       
-      printResults();
+      stopMetrics ();
+      ok = printResults(job, stdout);
+      printCounters ("worker", kernelNames);
+      if (traceName != NULL){
+         TRACEEVENT *events;
+         size_t numbEvents = collectTrace (0, &events);
+         if (!writeTrace (traceName, events, numbEvents))
+            perror ("error on writing the timeline");
+         free (events);
+         stopTrace ();
+      }
+      stopReadEngine ();
+      closeResultCache ();
 
       t1 = ((double) clock ()) / CLOCKS_PER_SEC;
       printf ("\nElapsed time = %.6f s\n", t1 - t0);
-      exit (EXIT_SUCCESS);
+      exit (ok ? EXIT_SUCCESS : EXIT_FAILURE);
    }
    
 }
 
+static void startWorkers (void) {
+   pthread_attr_t attr;
+
+   for (unsigned int i = 0; i < tuning.numbThreads; i++){
+      worker_threads[i] = i;
+      pthread_attr_init (&attr);
+      placeThread (&attr, i);                                            /* on its CPU from the start */
+      if (pthread_create (&threads_id[i], &attr, processText, &worker_threads[i]) != 0){
+         perror ("error on creating worker threads");
+         exit (EXIT_FAILURE);
+      }
+      pthread_attr_destroy (&attr);
+   }
+}
+
+static void joinWorkers (void) {
+   for (unsigned int i = 0; i < tuning.numbThreads; i++)
+      if (pthread_join (threads_id[i], (void *) &status_p) != 0){
+         perror ("error on joining");
+         exit (EXIT_FAILURE);
+      }
+}
+
 static void *processText(void *threadId) {
 
    unsigned int id = *((unsigned int *) threadId);
-   unsigned char dataToBeProcessed[K+1];
+   unsigned char dataToBeProcessed[MAX_K+1];
    CONTROLINFO ci = {0};
-   while (getAPieceOfData (id, dataToBeProcessed, &ci))
+   ANALYZER analyzer;                                             /* started on the results of each chunk */
+   JOBINFO *job, *held;
+   WORDTABLE *words;                                              /* one per file, NULL if the words are not counted */
+   int group[PERF_EVENTS];
+   PERFCOUNTS start, total = {0};
+
+   double t = traceClock ();
+
+   openCounters (group);
+   while (waitForJobs (id))                                       /* the server keeps the workers between requests */
    {
-        process(dataToBeProcessed, &ci);
-        savePartialResults (id, &ci);
+      held = NULL;
+      words = NULL;
+      while (getAPieceOfData (id, dataToBeProcessed, &ci, &job))
+      {
+           traceSpan (id, TRACE_FETCH, t);
+           if (job != held){                                      /* the words of a job are merged as a whole */
+              saveWordTables (id, held, words);
+              words = newWordTables (job);
+              held = job;
+           }
+           t = traceClock ();
+           readCounters (group, &start);
+           startAnalyzer (&analyzer, &ci.counts, ci.registers, words == NULL ? NULL : &words[ci.filePosition]);
+           feedAnalyzer (&analyzer, dataToBeProcessed, ci.numbBytes);
+           finishAnalyzer (&analyzer);
+           countUnit (group, &start, &total, ci.numbBytes);
+           traceSpan (id, TRACE_COMPUTE, t);
+           t = traceClock ();
+           savePartialResults (id, job, &ci);
+           traceSpan (id, TRACE_MERGE, t);
+           t = traceClock ();
+      }
+      saveWordTables (id, held, words);
    }
+   saveCounters (id, 0, &total);
+   closeCounters (group);
    //printf("left - %i\n", id);
    statusWorkers[id] = EXIT_SUCCESS;
    pthread_exit (&statusWorkers[id]);
 }
 
 void process(unsigned char *dataToBeProcessed, CONTROLINFO *ci) {
-    char cha;
-    bool inWord = false;
-    int skip, nVowels = 0, nCharacters = 0, maxWordLength = 0, length = ci->numbBytes;
-    
-    for (int i = 0; i < length; i++) {
-    	skip = 0;
-        if((char)dataToBeProcessed[i] == (char)0xC3) {
-        	skip = 1;
-            i += 1;
-        } else if((char)dataToBeProcessed[i] == (char)0xE2) {
-        	skip = 2;
-            i += 2;
-		}
-        cha = dataToBeProcessed[i];
-
-		if (cha >= 48 && cha <= 57) {
-			inWord = true;
-            nCharacters++;
-        } else if (skip == 0 && cha >= 65 && cha <= 90) {
-            inWord = true;
-            nCharacters++;
-        	if (cha == 65 || cha == 69 || cha == 73 || cha == 79 || cha == 85)
-        		nVowels++;
-        } else if (skip == 0 && cha >= 97 && cha <= 122) {
-            inWord = true;
-            nCharacters++;
-        	if (cha == 97 || cha == 101 || cha == 105 || cha == 111 || cha == 117)
-        		nVowels++;
-        } else if (skip == 0 && cha == '_') {
-            inWord = true;
-            nCharacters++;
-		} else if ((skip == 0 && cha == (char)0x27) || (skip == 2 && cha == (char)0x98) || (skip == 2 && cha == 0x99)) {
-            ;
-		} else if (skip == 1) {
-			if (cha == (char)0xA7 || cha == (char)0x87) {
-            	inWord = true;
-	            nCharacters++;
-	        } else if (cha == (char)0xA1 || cha == (char)0xA0 || cha == (char)0xA2 || cha == (char)0xA3 || cha == (char)0x81 || cha == (char)0x80 || cha == (char)0x82 || cha == (char)0x83) {
-	            inWord = true;
-	            nCharacters++;
-	            nVowels++;
-	        } else if (cha == (char)0xA9 || cha == (char)0xA8 || cha == (char)0xAA || cha == (char)0x89 || cha == (char)0x88 || cha == (char)0x8A) {
-	            inWord = true;
-	            nCharacters++;
-	            nVowels++;
-	        } else if (cha == (char)0xAD || cha == (char)0xAC || cha == (char)0x8D || cha == (char)0x8C) {
-	            inWord = true;
-	            nCharacters++;
-	            nVowels++;
-	        } else if (cha == (char)0xB3 || cha == (char)0xB2 || cha == (char)0xB4 || cha == (char)0xB5 || cha == (char)0x93 || cha == (char)0x92 || cha == (char)0x94 || cha == (char)0x95) {
-	    		inWord = true;
-	            nCharacters++;
-	            nVowels++;
-	        } else if (cha == (char)0xBA || cha == (char)0xB9 || cha == (char)0x9A || cha == (char)0x99) {
-	            inWord = true;
-	            nCharacters++;
-	            nVowels++;
-	    	}
-        } else if (inWord && (skip == 0 && isValidStopCharacter(cha) == 1) || (inWord && skip == 2 && isValidStopCharacter(cha) == 3) ) {
-            ci->bidi[nVowels][nCharacters - 1]++;
-            ci->numbWords++;
-            if (nCharacters > maxWordLength)
-            	maxWordLength = nCharacters;
-            //printf("Chars: %lu, Vowels: %lu\n",nCharacters,nVowels);
-            nCharacters = 0;
-            nVowels = 0;
-            inWord = false;
-        }
-    }
-    
-    if (maxWordLength > ci->maxWordLength)
-		ci->maxWordLength = maxWordLength;
+    ANALYZER analyzer;
+
+    startAnalyzer(&analyzer, &ci->counts, ci->registers, NULL);
+    feedAnalyzer(&analyzer, dataToBeProcessed, ci->numbBytes);
+    finishAnalyzer(&analyzer);
 }
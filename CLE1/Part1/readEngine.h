@@ -0,0 +1,102 @@
+/**
+ *  \file readEngine.h (interface file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  Asynchronous read engine: keeps up to depth reads outstanding, possibly over many files, each one into a
+ *  buffer of a fixed pool. The reads are done by io_uring, the buffers being registered with the kernel, or, where
+ *  io_uring is not available, by a pool of threads calling pread.
+ *
+ *  \author Francisco Gonalves and Tiago Lucas - April 2020
+ */
+
+#ifndef READENGINE_H
+#define READENGINE_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "READBLOCK.h"
+
+/** \brief plain blocking reads, the engine is not used */
+#define  READ_SYNC           0
+
+/** \brief reads done by io_uring */
+#define  READ_URING          1
+
+/** \brief reads done by a pool of threads */
+#define  READ_THREADS        2
+
+/**
+ *  \brief Start the read engine.
+ *
+ *  \param engine READ_URING or READ_THREADS
+ *  \param depth number of reads outstanding at most, which is also the number of buffers of the pool
+ *  \param blockSize size of a buffer
+ *
+ *  \return engine started, READ_THREADS if io_uring is not available, READ_SYNC if it could not be started
+ */
+extern int startReadEngine(int engine, unsigned int depth, size_t blockSize);
+
+/**
+ *  \brief Whether the read engine was started.
+ */
+extern bool readEngineActive(void);
+
+/**
+ *  \brief Size of the buffers of the pool.
+ */
+extern size_t readBlockSize(void);
+
+/**
+ *  \brief Number of reads outstanding at most.
+ */
+extern unsigned int readQueueDepth(void);
+
+/**
+ *  \brief Start a read of at most a buffer.
+ *
+ *  \param fd descriptor of the file
+ *  \param offset position of the first byte
+ *  \param length number of bytes (at most the size of a buffer)
+ *  \param wait whether to wait for a free buffer
+ *
+ *  \return the read, NULL if all the buffers are in use and wait is false
+ */
+extern READBLOCK *submitRead(int fd, uint64_t offset, size_t length, bool wait);
+
+/**
+ *  \brief Wait for a read to complete, its bytes being in b->buffer and their number in b->result.
+ *
+ *  \param *b read
+ *
+ *  \return false on a read error
+ */
+extern bool waitRead(READBLOCK *b);
+
+/**
+ *  \brief Give the buffer of a completed read back to the pool.
+ *
+ *  \param *b read
+ */
+extern void releaseRead(READBLOCK *b);
+
+/**
+ *  \brief Read count bytes at a position, in reads of a buffer all outstanding at the same time.
+ *
+ *  \param fd descriptor of the file
+ *  \param *buffer where the bytes are stored
+ *  \param count number of bytes
+ *  \param offset position of the first byte
+ *
+ *  \return false on a read error or if the file is shorter
+ */
+extern bool engineReadAt(int fd, void *buffer, size_t count, uint64_t offset);
+
+/**
+ *  \brief Stop the read engine, all the reads must have been released.
+ */
+extern void stopReadEngine(void);
+
+#endif /* READENGINE_H */
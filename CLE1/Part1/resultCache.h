@@ -0,0 +1,105 @@
+/**
+ *  \file resultCache.h (interface file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  On-disk cache of results, addressed by a 64-bit key derived from the content hash (XXH64) of the input and from
+ *  the parameters the result depends on, so that an input already seen is not processed again on a later run.
+ *
+ *  Each entry is a file of the cache directory, named by its key, with a header (magic, version, key, size of the
+ *  result and hash of the result) that is checked on every lookup; a damaged entry is removed. The directory is kept
+ *  under a size limit by removing the least recently used entries (a lookup refreshes the time of its entry).
+ *
+ *  \author Francisco Gonalves and Tiago Lucas - April 2020
+ */
+
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "HASHSTATE.h"
+
+/**
+ *  \brief Start a content hash.
+ *
+ *  \param *h state of the hash
+ *  \param seed seed of the hash
+ */
+extern void hashStart(HASHSTATE *h, uint64_t seed);
+
+/**
+ *  \brief Add the next bytes to a content hash.
+ *
+ *  \param *h state of the hash
+ *  \param *data bytes
+ *  \param size number of bytes
+ */
+extern void hashUpdate(HASHSTATE *h, const void *data, size_t size);
+
+/**
+ *  \brief Hash of the bytes added so far, the state is left unchanged (more bytes may be added).
+ *
+ *  \param *h state of the hash
+ *
+ *  \return hash
+ */
+extern uint64_t hashDigest(const HASHSTATE *h);
+
+/**
+ *  \brief Content hash of a block of bytes.
+ *
+ *  \param *data bytes
+ *  \param size number of bytes
+ *  \param seed seed of the hash
+ *
+ *  \return hash
+ */
+extern uint64_t hashBytes(const void *data, size_t size, uint64_t seed);
+
+/**
+ *  \brief Open the cache, the directory is created if it does not exist.
+ *
+ *  \param *directory directory of the entries
+ *  \param limit size of the directory, in bytes, above which the least recently used entries are removed
+ *
+ *  \return false if the directory could not be used, the cache being then disabled
+ */
+extern bool openResultCache(const char *directory, uint64_t limit);
+
+/**
+ *  \brief Whether the cache was opened.
+ */
+extern bool resultCacheActive(void);
+
+/**
+ *  \brief Look up a result.
+ *
+ *  \param key key of the result
+ *  \param *data where the result is stored
+ *  \param size size of the result
+ *
+ *  \return false if there is no valid entry of that key and size
+ */
+extern bool cacheLookup(uint64_t key, void *data, size_t size);
+
+/**
+ *  \brief Store a result, replacing the entry of the same key (the entry is written apart and then renamed, so
+ *  that a run that stops halfway never leaves a damaged entry under the key).
+ *
+ *  \param key key of the result
+ *  \param *data result
+ *  \param size size of the result
+ *
+ *  \return false if the entry could not be written
+ */
+extern bool cacheStore(uint64_t key, const void *data, size_t size);
+
+/**
+ *  \brief Close the cache, removing the least recently used entries while the directory is above its limit.
+ */
+extern void closeResultCache(void);
+
+#endif /* RESULTCACHE_H */
@@ -0,0 +1,213 @@
+/**
+ *  \file sampling.c (implementation file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  \author Francisco Gonalves and Tiago Lucas - April 2020
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "probConst.h"
+#include "CONTROLINFO.h"
+#include "TUNING.h"
+#include "autotune.h"
+#include "DOCINFO.h"
+#include "SAMPLEINFO.h"
+#include "corpusPack.h"
+#include "wordSketch.h"
+#include "sampling.h"
+
+/** \brief size of a chunk of a sample, its text starting up to as many bytes before it (at most a chunk in all) */
+#define  SAMPLE_CHUNK        (tuning.chunkSize / 2)
+
+/** \brief the step of the order of the chunks of a stratum is below it, so that it never overflows */
+#define  MAX_STEP            (1 << 24)
+
+/**
+ *  \brief Whether a byte ends a word whatever comes after it (a stop character of a single byte).
+ *
+ *  Internal operation.
+ */
+static bool isWordBoundary(unsigned char c)
+{
+  return c != '\0' && strchr(" \t\n-\"()[].,:;?!", c) != NULL;
+}
+
+/**
+ *  \brief Greatest common divisor.
+ *
+ *  Internal operation.
+ */
+static uint64_t gcd(uint64_t a, uint64_t b)
+{
+  while (b != 0){
+    uint64_t r = a % b;
+    a = b;
+    b = r;
+  }
+  return a;
+}
+
+SAMPLEINFO *startSample(uint64_t size, unsigned int seed)
+{
+  SAMPLEINFO *s = (SAMPLEINFO *) calloc(1, sizeof(SAMPLEINFO));
+
+  if (s == NULL){
+    perror("error on allocating a sample");
+    exit(EXIT_FAILURE);
+  }
+  s->size = size;
+  s->numbChunks = (size + SAMPLE_CHUNK - 1) / SAMPLE_CHUNK;
+  s->numbStrata = s->numbChunks < SAMPLE_STRATA ? s->numbChunks : SAMPLE_STRATA;
+  for (size_t h = 0; h < s->numbStrata; h++){
+    uint64_t n;
+    s->first[h] = h * s->numbChunks / s->numbStrata;
+    n = s->numbInStratum[h] = (h + 1) * s->numbChunks / s->numbStrata - s->first[h];
+    do                                                            /* a step prime to n visits every chunk once */
+      s->step[h] = 1 + (uint64_t) rand_r(&seed) % (n < MAX_STEP ? n : MAX_STEP);
+    while (gcd(s->step[h], n) != 1);
+    s->shift[h] = (uint64_t) rand_r(&seed) % n;
+  }
+  return s;
+}
+
+bool nextSampleChunk(SAMPLEINFO *s, size_t *chunk)
+{
+  if (s->finished)
+    return false;
+  for (size_t tries = 0; tries < s->numbStrata; tries++){
+    size_t h = s->nextStratum++ % s->numbStrata;
+    if (s->taken[h] < s->numbInStratum[h]){
+      *chunk = s->first[h] + (s->step[h] * s->taken[h] + s->shift[h]) % s->numbInStratum[h];
+      s->taken[h]++;
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t readSampleChunk(DOCINFO *d, size_t chunk, unsigned char *buffer)
+{
+  uint64_t start = (uint64_t) chunk * SAMPLE_CHUNK,
+           from = start < SAMPLE_CHUNK ? 0 : start - SAMPLE_CHUNK,       /* the word going on at its start */
+           end = start + SAMPLE_CHUNK < d->size ? start + SAMPLE_CHUNK : d->size;
+  size_t n = readDocumentAt(d, buffer, end - from, from), first, last;
+
+  if (n < end - from)                                                          /* the file got shorter */
+    end = from + n;
+  first = 0;
+  if (chunk > 0){
+    for (first = start - from; first > 0 && !isWordBoundary(buffer[first - 1]); first--)
+      ;
+    if (first == 0)                                        /* a word longer than a chunk, counted from the chunk */
+      first = start - from;
+  }
+  last = end - from;
+  if (end < d->size){
+    for (last = end - from; last > start - from && !isWordBoundary(buffer[last - 1]); last--)
+      ;
+    if (last == start - from)                                        /* same as the start of the next chunk */
+      last = end - from;
+    if (last < first)
+      last = first;
+  }
+  memmove(buffer, buffer + first, last - first);
+  memset(buffer + (last - first), 0, tuning.chunkSize + 1 - (last - first));
+  return last - first;
+}
+
+/**
+ *  \brief Variance of the estimate of a count, from the chunks of each stratum (with the correction for the chunks
+ *  of a stratum not taken).
+ *
+ *  Internal operation.
+ */
+static double countVariance(const SAMPLEINFO *s, size_t x)
+{
+  double variance = 0;
+
+  for (size_t h = 0; h < s->numbStrata; h++){
+    double n = s->done[h], N = s->numbInStratum[h];
+    if (n >= 2){
+      double spread = (s->sumSquares[h][x] - s->sum[h][x] * s->sum[h][x] / n) / (n - 1);
+      variance += N * N * (1 - n / N) * (spread > 0 ? spread : 0) / n;
+    }
+  }
+  return variance;
+}
+
+/**
+ *  \brief Estimate of a count, each stratum extrapolated from its chunks.
+ *
+ *  Internal operation.
+ */
+static double countEstimate(const SAMPLEINFO *s, size_t x)
+{
+  double estimate = 0;
+
+  for (size_t h = 0; h < s->numbStrata; h++)
+    if (s->done[h] > 0)
+      estimate += s->sum[h][x] * s->numbInStratum[h] / s->done[h];
+  return estimate;
+}
+
+CONTROLINFO *addSample(SAMPLEINFO *s, const CONTROLINFO *ci, double error)
+{
+  size_t stratum = s->numbStrata - 1, x, y, h;
+  double count[MAX_SIZE_WORD + 1] = {0};
+  uint64_t done = 0;
+
+  while (stratum > 0 && s->first[stratum] > ci->sampleChunk)
+    stratum--;
+  count[0] = ci->counts.numbWords;
+  for (y = 0; y < ci->counts.maxWordLength; y++)
+    for (x = 0; x <= ci->counts.maxWordLength; x++)
+      count[y + 1] += ci->counts.bidi[x][y];
+  for (x = 0; x <= MAX_SIZE_WORD; x++){
+    s->sum[stratum][x] += count[x];
+    s->sumSquares[stratum][x] += count[x] * count[x];
+  }
+  s->done[stratum]++;
+
+  /* complete once every stratum has two chunks and the margin of error of the number of words is small enough */
+  for (h = 0; h < s->numbStrata; h++){
+    if (s->done[h] < 2 && s->done[h] < s->numbInStratum[h])
+      return &s->strata[stratum];
+    done += s->done[h];
+  }
+  if (done == s->numbChunks || SAMPLE_Z * sqrt(countVariance(s, 0)) <= error * countEstimate(s, 0))
+    s->finished = true;
+  return &s->strata[stratum];
+}
+
+double sampleResults(const SAMPLEINFO *s, CONTROLINFO *ci, double *margin)
+{
+  size_t h, x, y;
+  uint64_t done = 0;
+
+  ci->numbBytes = s->size;
+  ci->counts.numbWords = llround(countEstimate(s, 0));
+  ci->counts.maxWordLength = 0;
+  memset(ci->counts.bidi, 0, sizeof(ci->counts.bidi));
+  for (h = 0; h < s->numbStrata; h++){
+    if (s->done[h] == 0)
+      continue;
+    double weight = (double) s->numbInStratum[h] / s->done[h];
+    for (x = 0; x < MAX_SIZE_WORD; x++)
+      for (y = 0; y < MAX_SIZE_WORD; y++)
+        ci->counts.bidi[x][y] += lround(s->strata[h].counts.bidi[x][y] * weight);
+    if (s->strata[h].counts.maxWordLength > ci->counts.maxWordLength)
+      ci->counts.maxWordLength = s->strata[h].counts.maxWordLength;
+    mergeSketch(ci->registers, s->strata[h].registers);
+    done += s->done[h];
+  }
+  for (x = 0; x <= MAX_SIZE_WORD; x++)
+    margin[x] = SAMPLE_Z * sqrt(countVariance(s, x));
+  return s->numbChunks == 0 ? 1 : (double) done / s->numbChunks;
+}
@@ -9,86 +9,417 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <unistd.h>
 #include <pthread.h>
 #include <errno.h>
+#include <string.h>
 
 #include "probConst.h"
 #include "CONTROLINFO.h"
+#include "DOCINFO.h"
+#include "corpusPack.h"
+#include "fileList.h"
+#include "HASHSTATE.h"
+#include "resultCache.h"
+#include "documentCache.h"
+#include "WORDENTRY.h"
+#include "WORDTABLE.h"
+#include "wordTable.h"
+#include "wordSketch.h"
+#include "SAMPLEINFO.h"
+#include "sampling.h"
+#include "TRACEEVENT.h"
+#include "traceLog.h"
+#include "progressMetrics.h"
+#include "TUNING.h"
+#include "autotune.h"
+#include "JOBINFO.h"
+#include "ANALYZER.h"
+#include "textAnalyzer.h"
 
 /** \brief producer threads return status array */
-extern int statusWorkers[NUMB_THREADS];
+extern int statusWorkers[MAX_THREADS];
 
-/** \brief names of files to process */
-char *filesToProcess[MAX_FILES];
+/** \brief jobs whose chunks are being handed out, in the order they were submitted */
+static JOBINFO *jobs[MAX_JOBS];
 
-/** \brief results of processed text */
-CONTROLINFO* results;
+/** \brief number of jobs whose chunks are being handed out */
+static unsigned int numbJobs;
 
-/** \brief number of files to process */
-unsigned int numbFiles;
+/** \brief job each worker was last given a chunk of, NULL for none */
+static JOBINFO *serving[MAX_THREADS];
 
-/** \brief file pointer */
-int filePosition;
-
-/** \brief byte pointer inside file */
-static FILE* filePointer;
+/** \brief no more jobs are submitted */
+static bool closed;
 
 /** \brief locking flag which warrants mutual exclusion inside the monitor */
 pthread_mutex_t accessF = PTHREAD_MUTEX_INITIALIZER;
 
-/** \brief locking flag which warrants mutual exclusion inside the monitor */
-pthread_mutex_t accessR = PTHREAD_MUTEX_INITIALIZER;
-
-/** \brief flag which warrants that the data transfer region is initialized exactly once */
-pthread_once_t init = PTHREAD_ONCE_INIT;
+/** \brief locking flag which warrants mutual exclusion inside the listing of the documents and the result cache */
+static pthread_mutex_t accessC = PTHREAD_MUTEX_INITIALIZER;
 
-/** \brief byte pointer inside file */
-int *maxWordLEN;
+/** \brief workers wait for a job to be submitted or the jobs to be closed */
+static pthread_cond_t arrival = PTHREAD_COND_INITIALIZER;
 
-int isValidStopCharacter(char);
+/** \brief processing of a chunk of text, by the worker threads */
+extern void process(unsigned char*, CONTROLINFO*);
 
 /**
- *  \brief Initialization of the results region.
+ *  \brief Signal that the results of a job are complete, once its chunks are handed out, their results saved and
+ *  the word tables of the workers merged.
  *
- *  Internal monitor operation.
+ *  Internal monitor operation, inside the monitor of the results of the job.
  */
-void initialization (void)
+static void checkCompletion(JOBINFO *job)
 {
-  results = (CONTROLINFO*)calloc(numbFiles, sizeof(CONTROLINFO));
-  maxWordLEN = calloc(numbFiles, sizeof(int));
-  filePosition = 0;                                      /* shared region filePosition is 0 */
+  if (job->drained && job->pending == 0 && !job->done){
+    job->done = true;
+    pthread_cond_broadcast(&job->finished);
+  }
 }
 
+/**
+ *  \brief New job, with no documents yet.
+ *
+ *  Operation carried out by the main thread, or by the thread of a request to the server.
+ *
+ *  \param priority the chunks of the jobs of a higher priority are handed out first
+ *
+ *  \return job
+ */
+JOBINFO *newJob(int priority)
+{
+  JOBINFO *job = (JOBINFO *)calloc(1, sizeof(JOBINFO));
+
+  job->priority = priority;
+  pthread_mutex_init(&job->access, NULL);
+  pthread_cond_init(&job->finished, NULL);
+  return job;
+}
 
 /**
  *  \brief Insert the names of the files to be processed in an array.
  *
- *  Operation carried out by the main thread.
+ *  Operation carried out by the main thread, or by the thread of a request to the server.
+ *
+ *  A corpus pack is expanded into its documents, each one having its own results. The documents are started largest
+ *  first, so that a big one is not left alone at the end of the run.
+ *
+ *  With the result cache open, a document whose results are cached is not processed, and only the text appended to
+ *  a document since its results were cached is, unless the words are counted or the documents sampled.
  *
+ *  When sampling, a sample of the chunks of each document of at least SAMPLE_MIN bytes is processed instead of the
+ *  whole document. A stream is neither looked up nor sampled.
+ *
+ *  \param *job job
  *  \param listOfFiles names of files to process
  *  \param size number of text files to be processed
+ *
+ *  \return false if there is nothing to process or a corpus pack is damaged
+ */
+
+bool presentDataFileNames(JOBINFO *job, char *listOfFiles[], unsigned int size){
+  bool lookup = job->numbTopWords == 0 && job->sampleError == 0;     /* the words and the samples are not cached */
+  pthread_mutex_lock(&accessC);                                        /* several requests to the server at once */
+  unsigned int numbFiles = job->numbFiles = listDocuments(listOfFiles, size, &job->documents);
+  if (numbFiles == 0){
+    pthread_mutex_unlock(&accessC);
+    return false;
+  }
+  job->results = (CONTROLINFO*)calloc(numbFiles, sizeof(CONTROLINFO));
+  job->maxWordLEN = calloc(numbFiles, sizeof(int));
+  job->cached = (bool *)calloc(numbFiles, sizeof(bool));
+  if (job->numbTopWords > 0)
+    job->words = (WORDTABLE *)calloc(numbFiles, sizeof(WORDTABLE));
+  if (job->sampleError > 0)
+    job->samples = (SAMPLEINFO **)calloc(numbFiles, sizeof(SAMPLEINFO *));
+
+  uint64_t *cost = (uint64_t *) malloc(sizeof(uint64_t) * numbFiles);
+  for (size_t i = 0; i < numbFiles; i++){
+    job->cached[i] = lookup && lookupDocument(&job->documents[i], &job->results[i]) == CACHE_HIT;  /* a prefix moves it */
+    job->results[i].filePosition = i;
+    job->maxWordLEN[i] = job->results[i].counts.maxWordLength;
+    cost[i] = job->documents[i].size - job->documents[i].position;
+    if (job->samples != NULL && job->documents[i].size >= SAMPLE_MIN && job->documents[i].stream == NULL)
+      job->samples[i] = startSample(job->documents[i].size, i);
+  }
+  presentMetricFiles(numbFiles);
+  for (size_t i = 0; i < numbFiles; i++)
+    nameMetricFile(i, job->documents[i].name, job->cached[i] || job->documents[i].stream != NULL ? 0 : cost[i]);
+  job->schedule = largestFirst(cost, numbFiles);
+  pthread_mutex_unlock(&accessC);
+  free(cost);
+  for (size_t i = job->numbScheduled = 0; i < numbFiles; i++)
+    if (!job->cached[job->schedule[i]])
+      job->schedule[job->numbScheduled++] = job->schedule[i];
+  return true;
+}
+
+
+/**
+ *  \brief Process a sample of the chunks of the large documents, and extrapolate their results.
+ *
+ *  Operation carried out before the names of the files are inserted.
+ *
+ *  \param *job job
+ *  \param error relative error of the number of words of a document at which its sample is complete
+ */
+void presentSampling(JOBINFO *job, double error)
+{
+  job->sampleError = error;
+}
+
+/**
+ *  \brief Set the number of most frequent words printed for each file.
+ *
+ *  Operation carried out before the names of the files are inserted.
+ *
+ *  \param *job job
+ *  \param k number of words, 0 not to count them
+ */
+void presentTopWords(JOBINFO *job, int k)
+{
+  job->numbTopWords = k;
+}
+
+/**
+ *  \brief Hand the chunks of a job out to the workers.
+ *
+ *  Operation carried out once the names of the files are inserted.
+ *
+ *  A job whose documents were all found in the result cache is complete at once. At most MAX_JOBS jobs are handed
+ *  out at a time.
+ *
+ *  \param *job job
+ */
+void submitJob(JOBINFO *job)
+{
+  pthread_mutex_lock(&accessF);
+  if (job->numbScheduled == 0)
+    job->drained = job->done = true;
+  else {
+    jobs[numbJobs++] = job;
+    pthread_cond_broadcast(&arrival);
+  }
+  pthread_mutex_unlock(&accessF);
+}
+
+/**
+ *  \brief Wait until the results of a job are complete.
+ *
+ *  Operation carried out by the thread of a request to the server.
+ *
+ *  \param *job job
+ */
+void waitJob(JOBINFO *job)
+{
+  pthread_mutex_lock(&job->access);
+  while (!job->done)
+    pthread_cond_wait(&job->finished, &job->access);
+  pthread_mutex_unlock(&job->access);
+}
+
+/**
+ *  \brief No more jobs are submitted, the workers leave once the ones submitted are handed out.
+ *
+ *  Operation carried out by the main thread.
+ */
+void closeJobs(void)
+{
+  pthread_mutex_lock(&accessF);
+  closed = true;
+  pthread_cond_broadcast(&arrival);
+  pthread_mutex_unlock(&accessF);
+}
+
+/**
+ *  \brief Wait until a job has chunks to hand out.
+ *
+ *  Operation carried out by the worker threads.
+ *
+ *  \param workerId identification
+ *
+ *  \return false once the jobs are closed and handed out
+ */
+bool waitForJobs(unsigned int workerId)
+{
+  bool any;
+
+  if ((statusWorkers[workerId] = pthread_mutex_lock (&accessF)) != 0){                                   /* enter monitor */
+    errno = statusWorkers[workerId];                                                            /* save error in errno */
+    perror ("error on entering monitor(CF)");
+    statusWorkers[workerId] = EXIT_FAILURE;
+    pthread_exit (&statusWorkers[workerId]);
+  }
+
+  while (numbJobs == 0 && !closed)
+    pthread_cond_wait(&arrival, &accessF);
+  any = numbJobs > 0;
+
+  if ((statusWorkers[workerId] = pthread_mutex_unlock (&accessF)) != 0){                                 /* exit monitor */
+    errno = statusWorkers[workerId];                                                            /* save error in errno */
+    perror ("error on exiting monitor(CF)");
+    statusWorkers[workerId] = EXIT_FAILURE;
+    pthread_exit (&statusWorkers[workerId]);
+  }
+  return any;
+}
+
+/**
+ *  \brief Job whose next chunk a worker is given: one of the highest priority, the one the worker was serving unless
+ *  another one has fewer workers, the first submitted otherwise.
+ *
+ *  Internal monitor operation.
+ *
+ *  \return position of the job, -1 if there is none
+ */
+static int chooseJob(unsigned int workerId)
+{
+  JOBINFO *own = serving[workerId];
+  unsigned int load, bestLoad = 0;
+  int best = -1;
+
+  for (unsigned int i = 0; i < numbJobs; i++){
+    load = jobs[i]->numbWorkers - (jobs[i] == own ? 1 : 0);                      /* the other workers serving it */
+    if (best < 0 || jobs[i]->priority > jobs[best]->priority
+        || (jobs[i]->priority == jobs[best]->priority && load < bestLoad)){
+      best = i;
+      bestLoad = load;
+    }
+  }
+  if (best >= 0 && jobs[best] != own){
+    if (own != NULL)
+      own->numbWorkers--;
+    jobs[best]->numbWorkers++;
+    serving[workerId] = jobs[best];
+  }
+  return best;
+}
+
+/**
+ *  \brief Remove a job whose chunks are all handed out, it being complete once their results are saved.
+ *
+ *  Internal monitor operation.
+ */
+static void removeJob(int position)
+{
+  JOBINFO *job = jobs[position];
+
+  for (unsigned int i = position + 1; i < numbJobs; i++)                 /* in the order they were submitted */
+    jobs[i - 1] = jobs[i];
+  numbJobs--;
+  for (unsigned int i = 0; i < MAX_THREADS; i++)
+    if (serving[i] == job)
+      serving[i] = NULL;
+  pthread_mutex_lock(&job->access);
+  job->drained = true;
+  checkCompletion(job);
+  pthread_mutex_unlock(&job->access);
+}
+
+/**
+ *  \brief Select the document of a job whose next chunk is handed out, the next one of the active documents.
+ *
+ *  Internal monitor operation.
+ *
+ *  \return false if every chunk of the job has been handed out
  */
+static bool nextDocument(JOBINFO *job, CONTROLINFO *ci)
+{
+  SAMPLEINFO *s;
+
+  while (true){
+    while (job->numbActive < ACTIVE_FILES && job->filePosition < job->numbScheduled)   /* start the largest pending */
+      job->activeFiles[job->numbActive++] = job->schedule[job->filePosition++];
+    setQueueDepth(job->numbActive + job->numbScheduled - job->filePosition);
+
+    if (job->numbActive == 0)
+      return false;
+    job->nextActive %= job->numbActive;
+    s = job->samples == NULL ? NULL : job->samples[job->activeFiles[job->nextActive]];
+    if (s == NULL || nextSampleChunk(s, &ci->sampleChunk))
+      return true;
+    job->activeFiles[job->nextActive] = job->activeFiles[--job->numbActive];    /* enough of the document sampled */
+  }
+}
 
-void presentDataFileNames(char *listOfFiles[], unsigned int size){
-  numbFiles = size;
-  for(int i = 0; i < size; i++)
-    filesToProcess[i] = listOfFiles[i];
+/**
+ *  \brief Word tables where a worker counts the words of each file of a job.
+ *
+ *  Operation carried out by the worker threads, the results of the job not being complete until they are saved.
+ *
+ *  \param *job job
+ *
+ *  \return a table per file, NULL if the words are not counted
+ */
+WORDTABLE *newWordTables(JOBINFO *job)
+{
+  if (job->numbTopWords == 0)
+    return NULL;
+  pthread_mutex_lock(&job->access);
+  job->pending++;
+  pthread_mutex_unlock(&job->access);
+  return (WORDTABLE *)calloc(job->numbFiles, sizeof(WORDTABLE));
 }
 
+/**
+ *  \brief Merge the word tables of a worker into the ones of the files of a job, and release them.
+ *
+ *  Operation carried out by the worker threads, once they are given the chunks of another job or there is no more
+ *  data.
+ *
+ *  \param workerId identification
+ *  \param *job     job, NULL for none
+ *  \param *tables  tables returned by newWordTables
+ */
+void saveWordTables(unsigned int workerId, JOBINFO *job, WORDTABLE *tables)
+{
+  if (tables == NULL)
+    return;
+
+  if ((statusWorkers[workerId] = pthread_mutex_lock (&job->access)) != 0){                               /* enter monitor */
+    errno = statusWorkers[workerId];                                                            /* save error in errno */
+    perror ("error on entering monitor(CF)");
+    statusWorkers[workerId] = EXIT_FAILURE;
+    pthread_exit (&statusWorkers[workerId]);
+  }
+
+  for (size_t i = 0; i < job->numbFiles; i++){
+    mergeWordTable(&job->words[i], &tables[i]);
+    freeWordTable(&tables[i]);
+  }
+  job->pending--;
+  checkCompletion(job);
+
+  if ((statusWorkers[workerId] = pthread_mutex_unlock (&job->access)) != 0){
+    errno = statusWorkers[workerId];
+    perror ("error on exiting monitor(CF)");
+    statusWorkers[workerId] = EXIT_FAILURE;
+    pthread_exit (&statusWorkers[workerId]);
+  }
+  free(tables);
+}
 
 /**
  *  \brief Get data from the files.
  *
  *  Operation carried out by the worker threads.
  *
+ *  The chunk is one of the job chooseJob selects, the jobs whose chunks are all handed out being removed. The chunks
+ *  of a sampled document are its next sampled chunks, until its sample is complete.
+ *
  *  \param workerId				identification
  *  \param *dataToBeProcessed	pointer to the array with the data to process.
  *  \param *ci					pointer to the shared data structure.
+ *  \param **job				where the job of the data is stored.
  *
+ *  \return false if no job has data left
  */
-bool getAPieceOfData(unsigned int workerId, unsigned char *dataToBeProcessed, CONTROLINFO *ci)
+bool getAPieceOfData(unsigned int workerId, unsigned char *dataToBeProcessed, CONTROLINFO *ci, JOBINFO **job)
 {
+  double t = traceClock();
+  int n;
 
   if ((statusWorkers[workerId] = pthread_mutex_lock (&accessF)) != 0){                                   /* enter monitor */
     errno = statusWorkers[workerId];                                                            /* save error in errno */
@@ -96,9 +427,13 @@ bool getAPieceOfData(unsigned int workerId, unsigned char *dataToBeProcessed, CO
     statusWorkers[workerId] = EXIT_FAILURE;
     pthread_exit (&statusWorkers[workerId]);
   }
-  pthread_once (&init, initialization);                                              /* internal data initialization */
+  traceSpan(workerId, TRACE_LOCK_WAIT, t);
+  t = traceClock();
 
-  if(filePosition == numbFiles){
+  while ((n = chooseJob(workerId)) >= 0 && !nextDocument(jobs[n], ci))
+    removeJob(n);
+  if(n < 0){
+    traceSpan(workerId, TRACE_LOCK_HELD, t);
     if ((statusWorkers[workerId] = pthread_mutex_unlock (&accessF)) != 0){                                 /* exit monitor */
     errno = statusWorkers[workerId];                                                            /* save error in errno */
     perror ("error on exiting monitor(CF)");
@@ -107,29 +442,42 @@ bool getAPieceOfData(unsigned int workerId, unsigned char *dataToBeProcessed, CO
     }
     return false;
   }
+  JOBINFO *j = *job = jobs[n];
+  SAMPLEINFO *s = j->samples == NULL ? NULL : j->samples[j->activeFiles[j->nextActive]];
   size_t i, aux;
-  
-  if(filePointer == NULL)
-    filePointer = fopen(filesToProcess[filePosition], "rb");
-  
-  ci->filePosition = filePosition;
-  i = fread(dataToBeProcessed, 1, K, filePointer);
-
-  if(i < K) {
-    filePosition++;
-    fclose(filePointer);
-    filePointer = NULL;
+  DOCINFO *d = &j->documents[j->activeFiles[j->nextActive]];
+
+  ci->filePosition = j->activeFiles[j->nextActive];
+  if (s != NULL){
+    i = readSampleChunk(d, ci->sampleChunk, dataToBeProcessed);
+    j->nextActive++;
+  }else if(!openDocument(d)){                                          /* reported instead of its results */
+    perror(d->path);
+    d->failed = true;
+    i = 0;
+  }else
+    i = readDocument(d, dataToBeProcessed, tuning.chunkSize);                /* a copy from the mapping for a pack */
+
+  if (s != NULL)
+    ;
+  else if(i < tuning.chunkSize) {
+    j->activeFiles[j->nextActive] = j->activeFiles[--j->numbActive];                 /* the document is done */
   }else{
+    j->nextActive++;
     aux = i;
     while(isValidStopCharacter(dataToBeProcessed[i-1]) == 0 && i > 0){
       i--;
     }
     if(i == 0)
       i = aux;
-    fseek(filePointer, i-K,SEEK_CUR);
+    unreadDocument(d, tuning.chunkSize-i);
   }
   ci->numbBytes = i;
+  pthread_mutex_lock(&j->access);                                          /* the results of the chunk are awaited */
+  j->pending++;
+  pthread_mutex_unlock(&j->access);
 
+  traceSpan(workerId, TRACE_LOCK_HELD, t);
   if ((statusWorkers[workerId] = pthread_mutex_unlock (&accessF)) != 0){                                 /* exit monitor */
     errno = statusWorkers[workerId];                                                            /* save error in errno */
     perror ("error on exiting monitor(CF)");
@@ -142,38 +490,67 @@ bool getAPieceOfData(unsigned int workerId, unsigned char *dataToBeProcessed, CO
 /**
  *  \brief Get a value from the data transfer region.
  *
- *  Operation carried out by the main thread.
+ *  Operation carried out by the worker threads.
+ *
+ *  The results of a chunk of a sampled document are added to its sample, inside the monitor of the data (where the
+ *  sample is completed), the other ones to the results of their document, inside the monitor of the results of the
+ *  job.
  *
  *  \param workerId identification
+ *  \param *job     job of the data
  *  \param *ci		pointer to the shared data structure
  *
  *  \return value
  */
-void savePartialResults(unsigned int workerId, CONTROLINFO *ci)
-{                                                                          
+void savePartialResults(unsigned int workerId, JOBINFO *job, CONTROLINFO *ci)
+{
+  size_t filePosition = ci->filePosition;
+  SAMPLEINFO *s = job->samples == NULL ? NULL : job->samples[filePosition];
+  pthread_mutex_t *access = s == NULL ? &job->access : &accessF;
+  CONTROLINFO *into = &job->results[filePosition];
+  double t = traceClock();
 
-  if ((statusWorkers[workerId] = pthread_mutex_lock (&accessR)) != 0){                                   /* enter monitor */
+  countWork(workerId, filePosition, ci->numbBytes, ci->numbBytes, ci->counts.numbWords);
+
+  if ((statusWorkers[workerId] = pthread_mutex_lock (access)) != 0){                                     /* enter monitor */
     errno = statusWorkers[workerId];                                                            /* save error in errno */
     perror ("error on entering monitor(CF)");
     statusWorkers[workerId] = EXIT_FAILURE;
     pthread_exit (&statusWorkers[workerId]);
   }
+  traceSpan(workerId, TRACE_LOCK_WAIT, t);
+  t = traceClock();
+
+  if (s != NULL)
+    into = addSample(s, ci, job->sampleError);                            /* the results of the stratum of the chunk */
+  into->numbBytes += ci->numbBytes;
+  into->counts.numbWords += ci->counts.numbWords;
+  if (ci->counts.maxWordLength > into->counts.maxWordLength) {                                  /* the chunks come from several files */
+    into->counts.maxWordLength = ci->counts.maxWordLength;
+    if (s == NULL)
+      job->maxWordLEN[filePosition] = ci->counts.maxWordLength;
+  }
+  ci->counts.numbWords = 0;
 
-  size_t filePosition = ci->filePosition;
-  results[filePosition].numbBytes += ci->numbBytes;
-  results[filePosition].numbWords += ci->numbWords;
-  results[filePosition].maxWordLength = ci->maxWordLength;
-  maxWordLEN[filePosition] = ci->maxWordLength;
-  ci->numbWords = 0;
-
-  for (size_t i = 0; i < ci->maxWordLength+1; i++){
-    for (size_t j = 0; j < ci->maxWordLength; j++){
-          results[filePosition].bidi[i][j] += ci->bidi[i][j];
-          ci->bidi[i][j] = 0;
+  for (size_t i = 0; i < ci->counts.maxWordLength+1; i++){
+    for (size_t j = 0; j < ci->counts.maxWordLength; j++){
+          into->counts.bidi[i][j] += ci->counts.bidi[i][j];
+          ci->counts.bidi[i][j] = 0;
     }
   }
-
-  if ((statusWorkers[workerId] = pthread_mutex_unlock (&accessR)) != 0){
+  ci->counts.maxWordLength = 0;
+  mergeSketch(into->registers, ci->registers);
+  memset(ci->registers, 0, HLL_REGISTERS);
+
+  if (s != NULL)
+    pthread_mutex_lock(&job->access);
+  job->pending--;
+  checkCompletion(job);
+  if (s != NULL)
+    pthread_mutex_unlock(&job->access);
+
+  traceSpan(workerId, TRACE_LOCK_HELD, t);
+  if ((statusWorkers[workerId] = pthread_mutex_unlock (access)) != 0){
     errno = statusWorkers[workerId];
     perror ("error on exiting monitor(CF)");
     statusWorkers[workerId] = EXIT_FAILURE;
@@ -183,80 +560,121 @@ void savePartialResults(unsigned int workerId, CONTROLINFO *ci)
 
 
 /**
- *  \brief Print the results of each file.
+ *  \brief Print the results of each file of a job, and release the job.
+ *
+ *  Operation carried out by main thread, or by the thread of a request to the server, once the job is complete.
+ *
+ *  A file which could not be opened has a line error and its name instead of its results, which are not cached.
  *
- *  Operation carried out by main thread.
+ *  \param *job job
+ *  \param *out where the results are printed
  *
+ *  \return false if a file could not be opened
  */
-void printResults(){
+bool printResults(JOBINFO *job, FILE *out){
 
   size_t x, y, i, max_len;
 
-  for (i = 0; i < numbFiles; i++){
+  double margin[MAX_SIZE_WORD + 1], fraction = 1;
+  SAMPLEINFO *s;
+  CONTROLINFO *results = job->results;
+  int *maxWordLEN = job->maxWordLEN;
+  WORDTABLE *words = job->words;
+  bool ok = true;
+
+  for (i = 0; i < job->numbFiles; i++){
+    s = job->samples == NULL ? NULL : job->samples[i];
+    if (job->documents[i].failed){
+      fprintf(out, "error %s could not be read\n", job->documents[i].name);
+      free(s);
+      if (words != NULL)
+        freeWordTable(&words[i]);
+      ok = false;
+      continue;
+    }
+    if (s != NULL){                                                   /* estimates, never stored in the cache */
+      fraction = sampleResults(s, &results[i], margin);
+      maxWordLEN[i] = results[i].counts.maxWordLength;
+      free(s);
+    }
+    else if (!job->cached[i]){
+      pthread_mutex_lock(&accessC);
+      storeDocument(&job->documents[i], &results[i], process);
+      pthread_mutex_unlock(&accessC);
+    }
     max_len = maxWordLEN[i];
     
-    printf("File name: %s\n", filesToProcess[i]);
-    printf("Total number of words: %lu \n", results[i].numbWords);
-    printf("Word length\n");
+    fprintf(out, "File name: %s\n", job->documents[i].name);
+    fprintf(out, "Total number of words: %lu \n", results[i].counts.numbWords);
+    if (s != NULL)
+      fprintf(out, "Sample of %.2f%% of the text, margin of error: +/- %.0f \n", fraction * 100, margin[0]);
+    fprintf(out, "Number of distinct words (estimate): %.0f \n", sketchEstimate(results[i].registers));
+    fprintf(out, "Word length\n");
 
     int Words[maxWordLEN[i]];
-    printf(" ");
+    fprintf(out, " ");
     for (y = 0; y < max_len; y++){
       Words[y] = 0;
-      printf("%*d\t", ALIGNMENT, y+1);
+      fprintf(out, "%*d\t", ALIGNMENT, y+1);
       for (x = 0; x <= max_len; x++)
-        Words[y] += results[i].bidi[x][y];
+        Words[y] += results[i].counts.bidi[x][y];
     }
-    printf("\n\n");
+    fprintf(out, "\n\n");
 
-    printf(" ");
+    fprintf(out, " ");
     for (x = 0; x < max_len; x++)
-      printf("%*d\t", ALIGNMENT, Words[x]);
+      fprintf(out, "%*d\t", ALIGNMENT, Words[x]);
     
-    printf("\n\n");
+    fprintf(out, "\n\n");
+
+    if (s != NULL){                                                              /* margins of error of the counts */
+      fprintf(out, " ");
+      for (x = 0; x < max_len; x++)
+        fprintf(out, "+/-%*.0f\t", ALIGNMENT - 3, margin[x + 1]);
+      fprintf(out, "\n\n");
+    }
 
-    printf(" ");
+    fprintf(out, " ");
     for (x = 0; x < max_len; x++)
-      printf("%*.2f\t", ALIGNMENT, (double) Words[x]/results[i].numbWords*100);
+      fprintf(out, "%*.2f\t", ALIGNMENT, (double) Words[x]/results[i].counts.numbWords*100);
 
-    printf("\n\n");
+    fprintf(out, "\n\n");
     
     for (x = 0; x < max_len + 1; x++){
-    printf("%i",x);
+    fprintf(out, "%i",x);
       for (y = 0; y < max_len; y++){
         if(x > y+1)
-          printf("\t");
+          fprintf(out, "\t");
         else if (Words[y] == 0)
-          printf("%*.1f\t", ALIGNMENT, 0);
+          fprintf(out, "%*.1f\t", ALIGNMENT, 0);
         else
-          printf("%*.1f\t", ALIGNMENT, (double) results[i].bidi[x][y]/Words[y]*100);
+          fprintf(out, "%*.1f\t", ALIGNMENT, (double) results[i].counts.bidi[x][y]/Words[y]*100);
           
       }
-    printf("\n\n");
+    fprintf(out, "\n\n");
+    }
+
+    if (words != NULL){
+      size_t k = job->numbTopWords < words[i].numbWords ? job->numbTopWords : words[i].numbWords;
+      WORDENTRY *top = (WORDENTRY *) malloc(sizeof(WORDENTRY) * (k + 1));
+      size_t n = topWords(&words[i], top, job->numbTopWords);
+      fprintf(out, "Most frequent words\n");
+      for (x = 0; x < n; x++)
+        fprintf(out, " %*lu\t%.*s\n", ALIGNMENT, top[x].count, (int) top[x].length, top[x].word);
+      fprintf(out, "\n");
+      free(top);
+      freeWordTable(&words[i]);
     }
   }
   free(results);
-}
-
-/**
- *  \brief Validate if a character is a stop character.
- *
- *  Operation carried out by all threads.
- *
- * \param character		character to which the validation is done.
- *
- * \return 				0 if the character provided is not a stop character, otherwise is the number of bytes the character should have. Can be used as true/false.
- *
- */
-int isValidStopCharacter(char character) {
-  char separation[15] = { (char)0x20, (char)0x9, (char)0xA, '-', '"', '(', ')', '[', ']', '.', ',', ':', ';', '?', '!' };
-  char separation3[4] = { (char)0x9C, (char)0x9D, (char)0x93, (char)0xA6 };
-  int x;
-  for (x = 0; x < 15; x++)
-    if (character == separation[x])
-      return 1;
-  for (x = 0; x < 4; x++)
-    if (character == separation3[x])
-      return 3;
-  return 0;
+  free(maxWordLEN);
+  free(job->cached);
+  free(job->schedule);
+  free(words);
+  free(job->samples);
+  closeDocuments(job->documents, job->numbFiles);
+  pthread_mutex_destroy(&job->access);
+  pthread_cond_destroy(&job->finished);
+  free(job);
+  return ok;
 }
@@ -10,17 +10,114 @@
 #define SHAREDREGION_H
 
 #include "CONTROLINFO.h"
+#include "WORDENTRY.h"
+#include "WORDTABLE.h"
+#include "JOBINFO.h"
+#include <stdio.h>
 #include <stdbool.h>
 
+/**
+ *  \brief New job, with no documents yet.
+ *
+ *  Operation carried out by the main thread, or by the thread of a request to the server.
+ *
+ *  \param priority the chunks of the jobs of a higher priority are handed out first
+ *
+ *  \return job
+ */
+extern JOBINFO *newJob(int priority);
+
 /**
  *  \brief Insert the names of the files to be processed in an array.
  *
- *  Operation carried out by the main thread.
+ *  Operation carried out by the main thread, or by the thread of a request to the server.
  *
+ *  \param *job job
  *  \param listOfFiles names of files to process
  *  \param size number of text files to be processed
+ *
+ *  \return false if there is nothing to process or a corpus pack is damaged
+ */
+extern bool presentDataFileNames(JOBINFO *job, char *listOfFiles[], unsigned int size);
+
+/**
+ *  \brief Process a sample of the chunks of the large documents, and extrapolate their results.
+ *
+ *  Operation carried out before the names of the files are inserted.
+ *
+ *  \param *job job
+ *  \param error relative error of the number of words of a document at which its sample is complete
+ */
+extern void presentSampling(JOBINFO *job, double error);
+
+/**
+ *  \brief Set the number of most frequent words printed for each file.
+ *
+ *  Operation carried out before the names of the files are inserted.
+ *
+ *  \param *job job
+ *  \param k number of words, 0 not to count them
+ */
+extern void presentTopWords(JOBINFO *job, int k);
+
+/**
+ *  \brief Hand the chunks of a job out to the workers.
+ *
+ *  Operation carried out once the names of the files are inserted, at most MAX_JOBS jobs being handed out at a time.
+ *
+ *  \param *job job
+ */
+extern void submitJob(JOBINFO *job);
+
+/**
+ *  \brief Wait until the results of a job are complete.
+ *
+ *  Operation carried out by the thread of a request to the server.
+ *
+ *  \param *job job
+ */
+extern void waitJob(JOBINFO *job);
+
+/**
+ *  \brief No more jobs are submitted, the workers leave once the ones submitted are handed out.
+ *
+ *  Operation carried out by the main thread.
+ */
+extern void closeJobs(void);
+
+/**
+ *  \brief Wait until a job has chunks to hand out.
+ *
+ *  Operation carried out by the worker threads.
+ *
+ *  \param workerId identification
+ *
+ *  \return false once the jobs are closed and handed out
+ */
+extern bool waitForJobs(unsigned int workerId);
+
+/**
+ *  \brief Word tables where a worker counts the words of each file of a job.
+ *
+ *  Operation carried out by the worker threads, the results of the job not being complete until they are saved.
+ *
+ *  \param *job job
+ *
+ *  \return a table per file, NULL if the words are not counted
+ */
+extern WORDTABLE *newWordTables(JOBINFO *job);
+
+/**
+ *  \brief Merge the word tables of a worker into the ones of the files of a job, and release them.
+ *
+ *  Operation carried out by the worker threads, once they are given the chunks of another job or there is no more
+ *  data.
+ *
+ *  \param workerId identification
+ *  \param *job     job, NULL for none
+ *  \param *tables  tables returned by newWordTables
  */
-extern void presentDataFileNames(char *listOfFiles[], unsigned int size);
+extern void saveWordTables(unsigned int workerId, JOBINFO *job, WORDTABLE *tables);
 
 /**
  *  \brief Get data from the files.
@@ -30,40 +127,37 @@ extern void presentDataFileNames(char *listOfFiles[], unsigned int size);
  *  \param workerId				identification
  *  \param *dataToBeProcessed	pointer to the array with the data to process.
  *  \param *ci					pointer to the shared data structure.
+ *  \param **job				where the job of the data is stored.
  *
+ *  \return false if no job has data left
  */
-extern bool getAPieceOfData(unsigned int workerId, unsigned char* dataToBeProcessed, CONTROLINFO* ci);
+extern bool getAPieceOfData(unsigned int workerId, unsigned char* dataToBeProcessed, CONTROLINFO* ci, JOBINFO **job);
 
 /**
  *  \brief Get a value from the data transfer region.
  *
- *  Operation carried out by the main thread.
+ *  Operation carried out by the worker threads.
  *
  *  \param workerId identification
+ *  \param *job     job of the data
  *  \param *ci		pointer to the shared data structure
  *
  *  \return value
  */
-extern void savePartialResults(unsigned int workerId, CONTROLINFO *ci);
-
-/**
- *  \brief Print the results of each file.
- *
- *  Operation carried out by main thread.
- *
- */
-extern void printResults(void);
+extern void savePartialResults(unsigned int workerId, JOBINFO *job, CONTROLINFO *ci);
 
 /**
- *  \brief Validate if a character is a stop character.
+ *  \brief Print the results of each file of a job, and release the job.
  *
- *  Operation carried out by all threads.
+ *  Operation carried out by main thread, or by the thread of a request to the server, once the job is complete.
  *
- * \param character		character to which the validation is done.
+ *  A file which could not be opened has a line error and its name instead of its results.
  *
- * \return 				0 if the character provided is not a stop character, otherwise is the number of bytes the character should have. Can be used as true/false.
+ *  \param *job job
+ *  \param *out where the results are printed
  *
+ *  \return false if a file could not be opened
  */
-extern int isValidStopCharacter(char character);
+extern bool printResults(JOBINFO *job, FILE *out);
 
 #endif /* SHAREDREGION_H */
@@ -17,10 +17,15 @@
 
 typedef struct
 {
-   bool processing;
    size_t filePosition;
    size_t numbSamples;
    size_t rxyIndex;
+   size_t leaf;
+   size_t leafSize;
+   size_t numbLags;
+   bool query;
+   bool fft;
+   bool single;
    double result;
 } CONTROLINFO;
 
@@ -0,0 +1,26 @@
+/**
+ *  \file HASHSTATE.h (interface file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  State of a content hash (XXH64) computed over consecutive pieces of data.
+ *
+ *  \author Francisco Gonçalves Tiago Lucas - April 2020
+ */
+ 
+#ifndef HASHSTATE_H
+#define HASHSTATE_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+typedef struct
+{
+   uint64_t seed;
+   uint64_t acc[4];
+   uint64_t total;
+   unsigned char buffer[32];
+   size_t numbBuffered;
+} HASHSTATE;
+
+#endif /* end of include guard: HASHSTATE_H */
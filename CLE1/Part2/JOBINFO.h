@@ -0,0 +1,69 @@
+/**
+ *  \file JOBINFO.h (interface file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  Job: the signal files of a run, or of a request to the server, with their schedule and their results, its options
+ *  (lag window, peaks, split of the sums, autocorrelation, storage as float, error report), the signals and pairs of
+ *  the batch mode, the streams of the streaming mode, its priority, the number of workers serving it and the pieces
+ *  of work handed out whose results are not saved yet.
+ *
+ *  \author Francisco Gonçalves Tiago Lucas - April 2020
+ */
+ 
+#ifndef JOBINFO_H
+#define JOBINFO_H
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "probConst.h"
+#include "FILEINFO.h"
+#include "SIGNALINFO.h"
+#include "PAIRINFO.h"
+#include "STREAMINFO.h"
+
+typedef struct
+{
+   char **filesToProcess;
+   char **filePaths;
+   size_t *fileRecords;
+   FILEINFO *filesManager;
+   unsigned int numbFiles;
+   size_t *schedule;
+   size_t filePosition;
+   size_t activeFiles[ACTIVE_FILES];
+   size_t numbActive;
+   size_t nextActive;
+   bool lagQuery;
+   size_t queryFirstLag;
+   size_t queryLastLag;
+   unsigned int queryPeaks;
+   size_t splitLeaf;
+   bool forceAutocorrelation;
+   bool singleStorage;
+   bool errorReport;
+   SIGNALINFO *signals;
+   size_t numbSignals;
+   PAIRINFO *pairs;
+   size_t numbPairs;
+   size_t numbSkipped;
+   size_t nextSignal;
+   size_t nextPair;
+   size_t *signalOrder;
+   size_t *pairOrder;
+   FILE *outputFile;
+   STREAMINFO *streams;
+   size_t streamBlock;
+   int priority;
+   unsigned int numbWorkers;
+   size_t pending;
+   bool drained;
+   bool done;
+   pthread_mutex_t access;
+   pthread_cond_t finished;
+} JOBINFO;
+
+#endif /* end of include guard: JOBINFO_H */
@@ -0,0 +1,27 @@
+/**
+ *  \file SIGNALRECORD.h (interface file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  Entry of the table of contents of a signal container, referencing one (x, y, expected) record.
+ *  It is stored as is in the file, so only fixed size fields are used.
+ *
+ *  \author Francisco Gonçalves Tiago Lucas - April 2020
+ */
+ 
+#ifndef SIGNALRECORD_H
+#define SIGNALRECORD_H
+
+#include <stdint.h>
+
+typedef struct
+{
+   uint64_t numbSamples;
+   uint32_t sampleType;
+   uint32_t reserved;
+   double scale;
+   uint64_t offset[3];
+   uint64_t checksum[3];
+} SIGNALRECORD;
+
+#endif /* end of include guard: SIGNALRECORD_H */
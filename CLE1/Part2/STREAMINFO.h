@@ -0,0 +1,32 @@
+/**
+ *  \file STREAMINFO.h (interface file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  File with the data shared accross all threads, referencing a signal file read in blocks (streaming mode).
+ *
+ *  \author Francisco Gonçalves Tiago Lucas - April 2020
+ */
+ 
+#ifndef STREAMINFO_H
+#define STREAMINFO_H
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "SIGNALRECORD.h"
+#include "ERRORSTATS.h"
+
+typedef struct
+{
+   int fd;
+   FILE *spool;
+   int outputFd;
+   SIGNALRECORD record;
+   double sampleError;
+   size_t numbSamples;
+   size_t nextLag;
+   size_t lagsDone;
+   ERRORSTATS errors;
+} STREAMINFO;
+
+#endif /* end of include guard: STREAMINFO_H */
@@ -0,0 +1,24 @@
+/**
+ *  \file TUNING.h (interface file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  Parameters of a run which depend on the machine: number of worker threads, number of lags handed to a worker at
+ *  a time in the lag query mode and crossover of the FFT engine.
+ *
+ *  \author Francisco Gonçalves Tiago Lucas - April 2020
+ */
+ 
+#ifndef TUNING_H
+#define TUNING_H
+
+#include <stdlib.h>
+
+typedef struct
+{
+   unsigned int numbThreads;
+   size_t lagBlock;
+   double fftCrossover;
+} TUNING;
+
+#endif /* end of include guard: TUNING_H */
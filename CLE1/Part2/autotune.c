@@ -0,0 +1,309 @@
+/**
+ *  \file autotune.c (implementation file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - April 2020
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <complex.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include "probConst.h"
+#include "CONTROLINFO.h"
+#include "TUNING.h"
+#include "autotune.h"
+#include "fft.h"
+
+/** \brief parameters of the run */
+TUNING tuning = {NUMB_THREADS, LAG_BLOCK, FFT_CROSSOVER};
+
+/** \brief name of the profile of the host */
+static char profileName[PATH_MAX];
+
+/** \brief synthetic signals of the calibration, their correlation and their number of samples */
+static double *x, *y, *rxy;
+static size_t numbSamples;
+
+/** \brief next lag to compute and number of lags handed out at a time, 0 for a lag at a time */
+static size_t nextLag, blockSize;
+
+/** \brief kernels being calibrated */
+static void (*correlateLag)(const double*, const double*, CONTROLINFO*);
+static void (*correlateRange)(const double*, const double*, CONTROLINFO*, double*);
+
+/** \brief locking flag which warrants mutual exclusion inside the lags and the results */
+static pthread_mutex_t accessT = PTHREAD_MUTEX_INITIALIZER;
+
+const char *tuningProfile(void)
+{
+  char host[HOST_NAME_MAX + 1] = "localhost";
+  const char *home = getenv("HOME");
+
+  if (profileName[0] == '\0'){
+    gethostname(host, sizeof(host));
+    host[HOST_NAME_MAX] = '\0';
+    snprintf(profileName, PATH_MAX, "%s/%s/%s-%s.tune", home != NULL ? home : ".", TUNING_DIR, host, TUNING_PROFILE);
+  }
+  return profileName;
+}
+
+bool loadTuning(void)
+{
+  FILE *f = fopen(tuningProfile(), "r");
+  TUNING t = tuning;
+  char line[256], key[64];
+  double value;
+  bool valid = true;
+
+  if (f == NULL)
+    return false;
+  while (fgets(line, sizeof(line), f) != NULL)
+    if (line[0] != '#' && sscanf(line, "%63s %lf", key, &value) == 2){
+      if (strcmp(key, "numbThreads") == 0){
+        valid = valid && value >= 1 && value <= MAX_THREADS;
+        t.numbThreads = value;
+      } else if (strcmp(key, "lagBlock") == 0){
+        valid = valid && value >= 1 && value <= TUNE_MAX_BLOCK;
+        t.lagBlock = value;
+      } else if (strcmp(key, "fftCrossover") == 0){
+        valid = valid && value > 0;
+        t.fftCrossover = value;
+      }
+    }
+  fclose(f);
+  if (!valid){
+    fprintf(stderr, "the profile %s has a parameter out of range, it is not used\n", profileName);
+    return false;
+  }
+  tuning = t;
+  return true;
+}
+
+bool saveTuning(void)
+{
+  char dirName[PATH_MAX], tempName[PATH_MAX + 4], host[HOST_NAME_MAX + 1] = "localhost";
+  const char *home = getenv("HOME");
+  FILE *f;
+
+  snprintf(dirName, PATH_MAX, "%s/%s", home != NULL ? home : ".", TUNING_DIR);
+  if (mkdir(dirName, 0755) != 0 && errno != EEXIST)
+    return false;
+  snprintf(tempName, sizeof(tempName), "%s.tmp", tuningProfile());
+  if ((f = fopen(tempName, "w")) == NULL)
+    return false;
+  gethostname(host, sizeof(host));
+  host[HOST_NAME_MAX] = '\0';
+  fprintf(f, "# %s, calibrated on %s\n", TUNING_PROFILE, host);
+  fprintf(f, "numbThreads %u\n", tuning.numbThreads);
+  fprintf(f, "lagBlock %zu\n", tuning.lagBlock);
+  fprintf(f, "fftCrossover %.2f\n", tuning.fftCrossover);
+  if (fclose(f) != 0 || rename(tempName, profileName) != 0){
+    unlink(tempName);
+    return false;
+  }
+  return true;
+}
+
+/**
+ *  \brief Seconds of the monotonic clock.
+ *
+ *  Internal operation.
+ */
+static double now(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+/**
+ *  \brief Make the synthetic signals, uniform in [-1, 1[ (xorshift, the same signals on every machine).
+ *
+ *  Internal operation.
+ */
+static void makeSignals(size_t n)
+{
+  uint64_t state = 0x9E3779B97F4A7C15ULL;
+
+  x = (double *) malloc(sizeof(double) * n);
+  y = (double *) malloc(sizeof(double) * n);
+  rxy = (double *) malloc(sizeof(double) * n);
+  for (size_t i = 0; i < 2 * n; i++){
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    (i < n ? x : y)[i % n] = (double) (state >> 11) / (1ULL << 52) - 1;
+  }
+}
+
+/**
+ *  \brief Worker of the calibration: gets a lag or a block of lags, correlates it and stores it, as the workers of
+ *  the program do.
+ *
+ *  Internal operation.
+ */
+static void *timeLagBlocks(void *arg)
+{
+  CONTROLINFO ci = {0};
+  double *values = (double *) malloc(sizeof(double) * (blockSize > 0 ? blockSize : 1));
+  size_t first, count;
+
+  ci.numbSamples = numbSamples;
+  ci.leafSize = numbSamples;
+  while (true){
+    pthread_mutex_lock(&accessT);
+    first = nextLag;
+    count = blockSize == 0 ? 1 : blockSize;
+    count = first + count < numbSamples ? count : numbSamples - first;
+    nextLag += count;
+    pthread_mutex_unlock(&accessT);
+    if (count == 0)
+      break;
+    ci.rxyIndex = first;
+    if (blockSize == 0){
+      ci.result = 0;
+      correlateLag(x, y, &ci);
+      values[0] = ci.result;
+    } else {
+      ci.numbLags = count;
+      correlateRange(x, y, &ci, values);
+    }
+
+    pthread_mutex_lock(&accessT);
+    memcpy(rxy + first, values, sizeof(double) * count);
+    pthread_mutex_unlock(&accessT);
+  }
+  free(values);
+  return NULL;
+}
+
+/**
+ *  \brief Rate of a configuration, its fastest run.
+ *
+ *  Internal operation.
+ *
+ *  \return lags per second
+ */
+static double runLags(unsigned int numbThreads, size_t block)
+{
+  pthread_t threads[numbThreads];
+  double start, best = 0;
+
+  blockSize = block;
+  for (int round = 0; round < TUNE_ROUNDS; round++){
+    nextLag = 0;
+    start = now();
+    for (unsigned int i = 0; i < numbThreads; i++)
+      if (pthread_create(&threads[i], NULL, timeLagBlocks, NULL) != 0){
+        perror ("error on creating the calibration threads");
+        exit (EXIT_FAILURE);
+      }
+    for (unsigned int i = 0; i < numbThreads; i++)
+      pthread_join(threads[i], NULL);
+    double rate = numbSamples / (now() - start);
+    best = rate > best ? rate : best;
+  }
+  if (block == 0)
+    printf("%3u threads, a lag at a time: %10.0f lags/s\n", numbThreads, best);
+  else
+    printf("%3u threads, blocks of %4zu lags: %10.0f lags/s\n", numbThreads, block, best);
+  return best;
+}
+
+/**
+ *  \brief Crossover of the FFT engine on a signal of n samples: the number of lags the direct method computes in the
+ *  time of the FFT engine, over log2(n).
+ *
+ *  Internal operation.
+ *
+ *  \return the crossover, 0 if the scratch memory of the FFT engine could not be allocated
+ */
+static double measureCrossover(size_t n)
+{
+  double complex *X = (double complex *) malloc(sizeof(double complex) * n),
+                 *Y = (double complex *) malloc(sizeof(double complex) * n),
+                 *work = (double complex *) malloc(sizeof(double complex) * n);
+  double values[TUNE_LAGS], start, direct = INFINITY, fft = INFINITY;
+  CONTROLINFO ci = {0};
+  bool done = true;
+
+  ci.numbSamples = n;
+  ci.numbLags = TUNE_LAGS < n ? TUNE_LAGS : n;
+  for (int round = 0; round < TUNE_ROUNDS && done; round++){
+    start = now();
+    correlateRange(x, y, &ci, values);
+    direct = fmin(direct, (now() - start) / ci.numbLags);
+    start = now();
+    done = fftRealSpectrum(x, n, X) && fftRealSpectrum(y, n, Y) && fftCircularCorrelation(X, Y, n, rxy, work);
+    fft = fmin(fft, now() - start);
+  }
+  free(X);
+  free(Y);
+  free(work);
+  if (!done)
+    return 0;
+  printf("%7zu samples: direct %.3g s per lag, FFT engine %.3g s, crossover %.2f\n", n, direct, fft,
+         fft / direct / log2((double) n));
+  return fft / direct / log2((double) n);
+}
+
+void tuneCorrelation(void (*lag)(const double*, const double*, CONTROLINFO*),
+                     void (*lagRange)(const double*, const double*, CONTROLINFO*, double*),
+                     unsigned int maxThreads)
+{
+  unsigned int threads, best = 1;
+  size_t block, n;
+  double rate, bestRate, crossover, sum = 0;
+  int numbSizes = 0;
+
+  correlateLag = lag;
+  correlateRange = lagRange;
+  maxThreads = maxThreads < MAX_THREADS ? maxThreads : MAX_THREADS;
+
+  /* number of threads and block of lags, on a signal of TUNE_SAMPLES samples */
+  makeSignals(TUNE_SAMPLES);
+  numbSamples = TUNE_SAMPLES;
+  bestRate = runLags(1, 0);
+  for (threads = 2; threads < 2 * maxThreads; threads *= 2)                 /* powers of two, and the number of CPUs */
+    if ((rate = runLags(threads < maxThreads ? threads : maxThreads, 0)) > bestRate * (1 + TUNE_MARGIN)){
+      best = threads < maxThreads ? threads : maxThreads;
+      bestRate = rate;
+    }
+  tuning.numbThreads = best;
+  tuning.lagBlock = 1;
+  bestRate = runLags(tuning.numbThreads, 1);
+  for (block = 2; block <= TUNE_MAX_BLOCK; block *= 2)
+    if ((rate = runLags(tuning.numbThreads, block)) > bestRate * (1 + TUNE_MARGIN)){
+      tuning.lagBlock = block;
+      bestRate = rate;
+    }
+  free(x);
+  free(y);
+  free(rxy);
+
+  /* crossover of the FFT engine, on signals of several sizes */
+  makeSignals(TUNE_MAX_SAMPLES);
+  for (n = TUNE_MIN_SAMPLES; n <= TUNE_MAX_SAMPLES; n *= 4)
+    if ((crossover = measureCrossover(n)) > 0){
+      sum += crossover;
+      numbSizes++;
+    }
+  if (numbSizes > 0)
+    tuning.fftCrossover = sum / numbSizes;
+  free(x);
+  free(y);
+  free(rxy);
+}
@@ -0,0 +1,69 @@
+/**
+ *  \file autotune.h (interface file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  Parameters of the run which depend on the machine, the number of worker threads, the number of lags of a block
+ *  of the lag query mode and the crossover of the FFT engine: the defaults of probConst.h, replaced by the profile of
+ *  the host when there is one, or found by a calibration.
+ *
+ *  The calibration correlates synthetic signals with the kernels of the program. The number of threads is the one
+ *  which computes the lags of a signal of TUNE_SAMPLES samples the fastest, a lag at a time under a lock as the
+ *  workers do, and the block of lags the one of the lag query mode for that number of threads. Each configuration is
+ *  run TUNE_ROUNDS times and its fastest run kept, a larger one only being taken when it is more than TUNE_MARGIN
+ *  faster. The crossover is the number of lags the direct method computes in the time of the FFT engine, over the
+ *  logarithm of the number of samples, averaged over signals of TUNE_MIN_SAMPLES to TUNE_MAX_SAMPLES samples.
+ *
+ *  The profile is a text file, a parameter per line, named after the host and the program (TUNING_PROFILE) in the
+ *  directory TUNING_DIR of the home directory, so that a home directory shared by several machines keeps one for each.
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - April 2020
+ */
+
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+#include <stdbool.h>
+
+#include "TUNING.h"
+#include "CONTROLINFO.h"
+
+/** \brief parameters of the run */
+extern TUNING tuning;
+
+/**
+ *  \brief Load the profile of the host into the parameters of the run.
+ *
+ *  Operation carried out by the main thread, before the work starts. A profile with a parameter out of its range is
+ *  ignored, with a message.
+ *
+ *  \return false if there is no profile, the defaults being kept
+ */
+extern bool loadTuning(void);
+
+/**
+ *  \brief Save the parameters of the run as the profile of the host, the directory being created if needed.
+ *
+ *  \return false on a write error
+ */
+extern bool saveTuning(void);
+
+/**
+ *  \brief Name of the profile of the host.
+ *
+ *  \return the name, in a static buffer
+ */
+extern const char *tuningProfile(void);
+
+/**
+ *  \brief Find the parameters of the run which correlate signals the fastest.
+ *
+ *  \param lag        correlation of a lag, the kernel of the workers
+ *  \param lagRange   correlation of a block of lags, the kernel of the lag query mode
+ *  \param maxThreads largest number of threads tried
+ */
+extern void tuneCorrelation(void (*lag)(const double*, const double*, CONTROLINFO*),
+                            void (*lagRange)(const double*, const double*, CONTROLINFO*, double*),
+                            unsigned int maxThreads);
+
+#endif /* AUTOTUNE_H */
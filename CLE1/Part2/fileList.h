@@ -0,0 +1,43 @@
+/**
+ *  \file fileList.h (interface file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  Expansion of the arguments of the command line into the files to process, and ordering of the files by the
+ *  amount of work they carry.
+ *
+ *     name                   the file itself
+ *     directory              every file in the directory and its subdirectories, in name order
+ *     @list                  every name listed in the file list, one per line (expanded in turn)
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - April 2020
+ */
+
+#ifndef FILELIST_H
+#define FILELIST_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+/**
+ *  \brief Expand the arguments of the command line into the names of the files to process.
+ *
+ *  \param *args[] arguments
+ *  \param numbArgs number of arguments
+ *  \param ***names where the array of names is stored, each name being a copy
+ *
+ *  \return number of names
+ */
+extern size_t expandFileNames(char *args[], size_t numbArgs, char ***names);
+
+/**
+ *  \brief Order of the files, largest amount of work first (LPT), ties kept in the order of the command line.
+ *
+ *  \param *cost amount of work of each file
+ *  \param numbFiles number of files
+ *
+ *  \return array with the indices of the files, in the order they should be started
+ */
+extern size_t *largestFirst(const uint64_t *cost, size_t numbFiles);
+
+#endif /* FILELIST_H */
@@ -0,0 +1,73 @@
+/**
+ *  \file jobServer.h (interface file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  Server of the correlation of signal files on a Unix domain socket: the worker threads, their buffers and the
+ *  result cache are kept from a request to the next, so that a small request does not pay for the start of a
+ *  process. Each request is served by a thread of its own, its files being a job of the shared region whose lags are
+ *  handed out to the workers with the ones of the other requests, those of a higher priority first (see
+ *  sharedRegion.h), and its results are written back once they are complete. At most MAX_JOBS requests are served at
+ *  a time. The lag and lag query modes are served, the batch and streaming modes are not.
+ *
+ *  A request is the words of a command line, each one ended by a NUL character, the last one being empty: the
+ *  options -r first:last (lag window), -k n (peaks), -S n (split of the sums), -A (autocorrelation), -f (storage as
+ *  float), -e (error report) and -n priority, then --, then the files. The names are taken from the directory of
+ *  the server, the client sending them as absolute names. The reply is a line, ok or error and the reason, followed
+ *  by the results and, when a file could not be read or was not computed completely, a last line error and the
+ *  reason.
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - April 2020
+ */
+
+#ifndef JOBSERVER_H
+#define JOBSERVER_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+/**
+ *  \brief Create the socket of the server.
+ *
+ *  Operation carried out by the main thread, before the workers are started: SIGINT and SIGTERM are blocked, so that
+ *  the threads started afterwards leave them to the main thread.
+ *
+ *  \param *socketName name of the socket, replacing the one of a server which was killed
+ *
+ *  \return false if the socket could not be created
+ */
+extern bool startServer(const char *socketName);
+
+/**
+ *  \brief Serve the requests until the process is interrupted (SIGINT or SIGTERM), then wait for the requests being
+ *  served and remove the socket.
+ *
+ *  Operation carried out by the main thread, once the workers are started.
+ */
+extern void runServer(void);
+
+/**
+ *  \brief Send a request to a server and print its results.
+ *
+ *  Operation carried out by the main thread of a client.
+ *
+ *  \param *socketName      name of the socket of the server
+ *  \param query            lag query mode, with the window and the peaks given
+ *  \param firstLag         first lag of the window
+ *  \param lastLag          last lag of the window
+ *  \param numbPeaks        number of peaks to report, 0 to keep every lag of the window
+ *  \param leafSize         number of samples of each part of the sum of a lag, 0 to not split (lag mode)
+ *  \param autocorrelation  every file is taken as an autocorrelation
+ *  \param single           x and y are stored as float
+ *  \param errorReport      the errors of the results of each file are reported
+ *  \param priority         the requests of a higher priority are served first
+ *  \param files            names of the files
+ *  \param numbFiles        number of files
+ *
+ *  \return false if the server could not be reached, the request failed or a file could not be read or computed
+ */
+extern bool requestJob(const char *socketName, bool query, size_t firstLag, size_t lastLag, unsigned int numbPeaks,
+                       size_t leafSize, bool autocorrelation, bool single, bool errorReport, int priority,
+                       char *files[], unsigned int numbFiles);
+
+#endif /* JOBSERVER_H */
@@ -0,0 +1,223 @@
+/**
+ *  \file perfCounters.c (implementation file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - April 2020
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "PERFCOUNTS.h"
+#include "perfCounters.h"
+
+/** \brief events of a group, the first one leading it */
+static const uint64_t events[PERF_EVENTS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                             PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+/** \brief the counters are read */
+static bool counting;
+
+/** \brief events the processor counts */
+static bool available[PERF_EVENTS];
+
+/** \brief totals of each thread over each kernel */
+static PERFCOUNTS *table;
+
+/** \brief number of threads and of kernels of the table */
+static unsigned int numbThreads, numbKernels;
+
+/** \brief locking flag which warrants mutual exclusion inside the table */
+static pthread_mutex_t accessC = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ *  \brief Open a counter of the calling thread, in user space only (so that a perf_event_paranoid of 2 allows it).
+ *
+ *  Internal operation.
+ *
+ *  \return file descriptor, -1 on error
+ */
+static int openEvent(unsigned int event, int leader)
+{
+  struct perf_event_attr attr;
+
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = events[event];
+  attr.disabled = leader < 0;                                          /* the whole group is enabled at once */
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return (int) syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+}
+
+bool startCounters(unsigned int threads, unsigned int kernels)
+{
+  int leader;
+
+  if ((leader = openEvent(0, -1)) < 0){
+    fprintf(stderr, "the hardware counters are not available (%s), they are not counted\n", strerror(errno));
+    return false;
+  }
+  available[0] = true;
+  for (unsigned int i = 1; i < PERF_EVENTS; i++){
+    int fd = openEvent(i, leader);
+    if ((available[i] = fd >= 0))
+      close(fd);
+  }
+  close(leader);
+
+  if ((table = (PERFCOUNTS *) calloc((size_t) threads * kernels, sizeof(PERFCOUNTS))) == NULL)
+    return false;
+  numbThreads = threads;
+  numbKernels = kernels;
+  counting = true;
+  return true;
+}
+
+void openCounters(int *group)
+{
+  for (unsigned int i = 0; i < PERF_EVENTS; i++)
+    group[i] = -1;
+  if (!counting)
+    return;
+  for (unsigned int i = 0; i < PERF_EVENTS; i++)
+    if (available[i] && (group[i] = openEvent(i, group[0])) < 0 && i == 0)
+      return;
+  ioctl(group[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(group[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void readCounters(const int *group, PERFCOUNTS *now)
+{
+  struct { uint64_t nr, enabled, running, values[PERF_EVENTS]; } data;
+  uint64_t values[PERF_EVENTS] = {0};
+  double scale;
+
+  memset(now, 0, sizeof(PERFCOUNTS));
+  if (group[0] < 0 || read(group[0], &data, sizeof(data)) < (ssize_t) (3 * sizeof(uint64_t)))
+    return;
+  scale = data.running > 0 ? (double) data.enabled / data.running : 1;           /* multiplexed with other groups */
+  for (unsigned int i = 0, k = 0; i < PERF_EVENTS && k < data.nr; i++)
+    if (group[i] >= 0)
+      values[i] = (uint64_t) (data.values[k++] * scale);
+  now->cycles = values[0];
+  now->instructions = values[1];
+  now->cacheMisses = values[2];
+  now->branchMisses = values[3];
+}
+
+void countUnit(const int *group, const PERFCOUNTS *start, PERFCOUNTS *total, uint64_t bytes)
+{
+  PERFCOUNTS now;
+
+  readCounters(group, &now);
+  if (group[0] >= 0){
+    total->cycles += now.cycles - start->cycles;
+    total->instructions += now.instructions - start->instructions;
+    total->cacheMisses += now.cacheMisses - start->cacheMisses;
+    total->branchMisses += now.branchMisses - start->branchMisses;
+  }
+  total->bytes += bytes;
+  total->units++;
+}
+
+void saveCounters(unsigned int thread, unsigned int kernel, const PERFCOUNTS *total)
+{
+  PERFCOUNTS *t;
+
+  if (!counting || thread >= numbThreads || kernel >= numbKernels)
+    return;
+  pthread_mutex_lock(&accessC);
+  t = &table[thread * numbKernels + kernel];
+  t->cycles += total->cycles;
+  t->instructions += total->instructions;
+  t->cacheMisses += total->cacheMisses;
+  t->branchMisses += total->branchMisses;
+  t->bytes += total->bytes;
+  t->units += total->units;
+  pthread_mutex_unlock(&accessC);
+}
+
+void closeCounters(int *group)
+{
+  for (unsigned int i = PERF_EVENTS; i > 0; i--)                               /* the leader last */
+    if (group[i - 1] >= 0){
+      close(group[i - 1]);
+      group[i - 1] = -1;
+    }
+}
+
+PERFCOUNTS *counterTable(void)
+{
+  return counting ? table : NULL;
+}
+
+/**
+ *  \brief Print a line of the report.
+ *
+ *  Internal operation.
+ */
+static void printLine(const char *label, const PERFCOUNTS *c)
+{
+  char cache[32] = "n/a", branch[32] = "n/a";
+
+  if (c->units == 0)
+    return;
+  if (available[2])
+    snprintf(cache, sizeof(cache), "%.3f", c->instructions > 0 ? 1000.0 * c->cacheMisses / c->instructions : 0);
+  if (available[3])
+    snprintf(branch, sizeof(branch), "%.3f", c->instructions > 0 ? 1000.0 * c->branchMisses / c->instructions : 0);
+  printf("%s: %lu units, IPC %.2f, LLC misses %s and branch misses %s per 1000 instructions, %.3f bytes per cycle\n",
+         label, c->units, c->cycles > 0 ? (double) c->instructions / c->cycles : 0, cache, branch,
+         c->cycles > 0 ? (double) c->bytes / c->cycles : 0);
+}
+
+void printCounters(const char *threadLabel, const char *const kernelNames[])
+{
+  char label[128];
+
+  if (!counting)
+    return;
+  printf("\nHardware counters\n");
+  for (unsigned int t = 0; t < numbThreads; t++){
+    PERFCOUNTS sum = {0};
+    for (unsigned int k = 0; k < numbKernels; k++){
+      sum.cycles += table[t * numbKernels + k].cycles;
+      sum.instructions += table[t * numbKernels + k].instructions;
+      sum.cacheMisses += table[t * numbKernels + k].cacheMisses;
+      sum.branchMisses += table[t * numbKernels + k].branchMisses;
+      sum.bytes += table[t * numbKernels + k].bytes;
+      sum.units += table[t * numbKernels + k].units;
+    }
+    snprintf(label, sizeof(label), "%s %u", threadLabel, t);
+    printLine(label, &sum);
+  }
+  for (unsigned int k = 0; k < numbKernels; k++){
+    PERFCOUNTS sum = {0};
+    for (unsigned int t = 0; t < numbThreads; t++){
+      sum.cycles += table[t * numbKernels + k].cycles;
+      sum.instructions += table[t * numbKernels + k].instructions;
+      sum.cacheMisses += table[t * numbKernels + k].cacheMisses;
+      sum.branchMisses += table[t * numbKernels + k].branchMisses;
+      sum.bytes += table[t * numbKernels + k].bytes;
+      sum.units += table[t * numbKernels + k].units;
+    }
+    snprintf(label, sizeof(label), "%s", kernelNames[k]);
+    printLine(label, &sum);
+  }
+  free(table);
+  table = NULL;
+  counting = false;
+}
@@ -0,0 +1,97 @@
+/**
+ *  \file perfCounters.h (interface file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  Hardware counters of the threads, through perf_event_open: a group of counters (cycles, instructions, last
+ *  level cache misses, branch misses) per thread, read before and after each work unit and added per thread and
+ *  per kernel, then reported as instructions per cycle, misses per thousand instructions and bytes per cycle.
+ *  Where perf is not available (no PMU, perf_event_paranoid), nothing is counted and the run goes on; a counter
+ *  the processor does not have is reported as n/a.
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - April 2020
+ */
+
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "PERFCOUNTS.h"
+
+/** \brief number of counters of a group: cycles, instructions, last level cache misses and branch misses */
+#define  PERF_EVENTS         4
+
+/**
+ *  \brief Start counting: check that the counters can be opened and create the table of the totals.
+ *
+ *  Operation carried out by the main thread, before the threads are created.
+ *
+ *  \param numbThreads number of threads (or processes) counted
+ *  \param numbKernels number of kernels
+ *
+ *  \return false if perf is not available (the reason is printed), nothing being counted then
+ */
+extern bool startCounters(unsigned int numbThreads, unsigned int numbKernels);
+
+/**
+ *  \brief Open the counters of the calling thread.
+ *
+ *  \param *group where the PERF_EVENTS file descriptors of the group are stored, all -1 when nothing is counted
+ */
+extern void openCounters(int *group);
+
+/**
+ *  \brief Read the counters of a group.
+ *
+ *  \param *group group of the calling thread
+ *  \param *now where the values are stored, all 0 when nothing is counted
+ */
+extern void readCounters(const int *group, PERFCOUNTS *now);
+
+/**
+ *  \brief Add a work unit to a total: the counters since they were read before it, and the bytes it went through.
+ *
+ *  \param *group group of the calling thread
+ *  \param *start counters read before the unit
+ *  \param *total where the unit is added
+ *  \param bytes bytes the unit went through
+ */
+extern void countUnit(const int *group, const PERFCOUNTS *start, PERFCOUNTS *total, uint64_t bytes);
+
+/**
+ *  \brief Add the total of a thread over a kernel to the table.
+ *
+ *  \param thread number of the thread
+ *  \param kernel number of the kernel
+ *  \param *total counters of the thread over the kernel
+ */
+extern void saveCounters(unsigned int thread, unsigned int kernel, const PERFCOUNTS *total);
+
+/**
+ *  \brief Close the counters of the calling thread.
+ *
+ *  \param *group group of the calling thread
+ */
+extern void closeCounters(int *group);
+
+/**
+ *  \brief Table of the totals, numbKernels per thread, to gather it from other processes.
+ *
+ *  \return table, NULL when nothing is counted
+ */
+extern PERFCOUNTS *counterTable(void);
+
+/**
+ *  \brief Print the counters of each thread and of each kernel.
+ *
+ *  Operation carried out by the main thread, once the threads ended.
+ *
+ *  \param *threadLabel what a thread is called in the report (thread, process)
+ *  \param *kernelNames[] name of each kernel
+ */
+extern void printCounters(const char *threadLabel, const char *const kernelNames[]);
+
+#endif /* PERFCOUNTERS_H */
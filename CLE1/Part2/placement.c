@@ -0,0 +1,209 @@
+/**
+ *  \file placement.c (implementation file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - April 2020
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sched.h>
+#include <dirent.h>
+#include <pthread.h>
+
+#include "placement.h"
+
+/** \brief directory of the NUMA nodes of the system */
+#define  NODE_DIRECTORY      "/sys/devices/system/node"
+
+/** \brief CPUs of the workers, in the order they are given to them */
+static int *cpus;
+
+/** \brief number of CPUs of the workers, 0 without placement */
+static size_t numbCpus;
+
+/** \brief node of each CPU, 0 where it is not known */
+static int cpuNode[CPU_SETSIZE];
+
+/** \brief number of nodes */
+static unsigned int nodes = 1;
+
+/**
+ *  \brief Parse a list of CPUs in the form 0,2,4-7.
+ *
+ *  Internal operation.
+ *
+ *  \return number of CPUs stored in list (at most CPU_SETSIZE), 0 if the text is not a valid list
+ */
+static size_t parseCpuList(const char *text, int *list)
+{
+  size_t n = 0;
+  char *end;
+
+  while (*text != '\0' && *text != '\n'){
+    long first = strtol(text, &end, 10), last = first;
+    if (end == text || first < 0)
+      return 0;
+    if (*end == '-'){
+      text = end + 1;
+      last = strtol(text, &end, 10);
+      if (end == text || last < first)
+        return 0;
+    }
+    for (long cpu = first; cpu <= last && cpu < CPU_SETSIZE && n < CPU_SETSIZE; cpu++)
+      list[n++] = (int) cpu;
+    text = *end == ',' ? end + 1 : end;
+    if (*end != ',' && *end != '\0' && *end != '\n')
+      return 0;
+  }
+  return n;
+}
+
+/**
+ *  \brief Read the CPUs of each node of the system.
+ *
+ *  Internal operation.
+ */
+static void readTopology(void)
+{
+  static bool read;
+  static int list[CPU_SETSIZE];
+  DIR *dir;
+  struct dirent *entry;
+
+  if (read)
+    return;
+  read = true;
+  if ((dir = opendir(NODE_DIRECTORY)) == NULL)                                      /* a single node */
+    return;
+  while ((entry = readdir(dir)) != NULL){
+    char name[512], text[4096];
+    unsigned int node;
+    FILE *file;
+    size_t n;
+    if (sscanf(entry->d_name, "node%u", &node) != 1)
+      continue;
+    snprintf(name, sizeof(name), "%s/%s/cpulist", NODE_DIRECTORY, entry->d_name);
+    if ((file = fopen(name, "r")) == NULL)
+      continue;
+    if (fgets(text, sizeof(text), file) != NULL)
+      for (n = parseCpuList(text, list); n > 0; n--)
+        cpuNode[list[n - 1]] = node;
+    fclose(file);
+    nodes = node + 1 > nodes ? node + 1 : nodes;
+  }
+  closedir(dir);
+}
+
+bool startPlacement(int policy, const char *list)
+{
+  cpu_set_t allowed;
+  size_t i, n = 0;
+  int *chosen;
+
+  readTopology();
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0){
+    perror("error on getting the CPUs of the process");
+    return false;
+  }
+  chosen = (int *) malloc(sizeof(int) * CPU_SETSIZE);
+  cpus = (int *) malloc(sizeof(int) * CPU_SETSIZE);
+
+  if (policy == PLACE_LIST){
+    size_t listed = parseCpuList(list, chosen);
+    if (listed == 0)
+      fprintf(stderr, "invalid list of CPUs %s\n", list);
+    for (i = 0; i < listed; i++)
+      if (CPU_ISSET(chosen[i], &allowed))                              /* the binding of the launcher is kept */
+        chosen[n++] = chosen[i];
+  }
+  else
+    for (unsigned int node = 0; node < nodes; node++)                  /* by node, then by number inside a node */
+      for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        if (cpuNode[cpu] == (int) node && CPU_ISSET(cpu, &allowed))
+          chosen[n++] = cpu;
+
+  if (policy == PLACE_SCATTER)                                       /* the k-th CPU of each node, for each k */
+    for (size_t k = 0; numbCpus < n; k++)
+      for (unsigned int node = 0; node < nodes; node++){
+        size_t seen = 0;
+        for (i = 0; i < n; i++)
+          if (cpuNode[chosen[i]] == (int) node && seen++ == k){
+            cpus[numbCpus++] = chosen[i];
+            break;
+          }
+      }
+  else
+    for (i = 0; i < n; i++)
+      cpus[numbCpus++] = chosen[i];
+  free(chosen);
+
+  if (numbCpus == 0){
+    fprintf(stderr, "no CPU to place the workers on, they are not placed\n");
+    free(cpus);
+    cpus = NULL;
+    return false;
+  }
+  return true;
+}
+
+void placeThread(pthread_attr_t *attr, unsigned int worker)
+{
+  cpu_set_t set;
+
+  if (numbCpus == 0)
+    return;
+  CPU_ZERO(&set);
+  CPU_SET(cpus[worker % numbCpus], &set);
+  if (pthread_attr_setaffinity_np(attr, sizeof(set), &set) != 0)
+    perror("error on placing a worker");
+}
+
+int workerNode(unsigned int worker)
+{
+  return numbCpus == 0 ? -1 : cpuNode[cpus[worker % numbCpus]];
+}
+
+unsigned int numbNodes(void)
+{
+  readTopology();
+  return nodes;
+}
+
+void describeBinding(char *text, size_t size)
+{
+  cpu_set_t allowed;
+  bool onNode[CPU_SETSIZE] = {false}, first = true;
+  size_t length;
+  int cpu, last;
+
+  readTopology();
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0){
+    snprintf(text, size, "CPUs unknown");
+    return;
+  }
+  length = snprintf(text, size, "CPUs ");
+  for (cpu = 0; cpu < CPU_SETSIZE && length < size; cpu = last + 1){               /* ranges of CPUs */
+    if (!CPU_ISSET(cpu, &allowed)){
+      last = cpu;
+      continue;
+    }
+    for (last = cpu; last + 1 < CPU_SETSIZE && CPU_ISSET(last + 1, &allowed); last++)
+      onNode[cpuNode[last]] = true;
+    onNode[cpuNode[last]] = true;
+    length += last > cpu ? snprintf(text + length, size - length, "%s%d-%d", length > 5 ? "," : "", cpu, last)
+                         : snprintf(text + length, size - length, "%s%d", length > 5 ? "," : "", cpu);
+  }
+  for (unsigned int node = 0; node < nodes && length < size; node++)
+    if (onNode[node]){
+      length += snprintf(text + length, size - length, "%s%u", first ? " (node " : ",", node);
+      first = false;
+    }
+  if (length < size)
+    snprintf(text + length, size - length, ")");
+}
@@ -18,32 +18,445 @@
 #include <sys/types.h>
 #include <time.h>
 #include <math.h>
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+#include <complex.h>
 
 #include "probConst.h"
 #include "sharedRegion.h"
+#include "READBLOCK.h"
+#include "readEngine.h"
+#include "HASHSTATE.h"
+#include "resultCache.h"
+#include "fft.h"
+#include "streamCorrelation.h"
+#include "placement.h"
+#include "PERFCOUNTS.h"
+#include "perfCounters.h"
+#include "TRACEEVENT.h"
+#include "traceLog.h"
+#include "progressMetrics.h"
+#include "TUNING.h"
+#include "autotune.h"
+#include "signalCorrelator.h"
+#include "resultCheck.h"
+#include "JOBINFO.h"
+#include "jobServer.h"
 
 
-/** \brief workerThread life cycle routine */
+/** \brief workerThread life cycle routine of the lag and lag query modes, the jobs of the server included */
 static void *process (void *id);
 
-/** \brief Result creation and storage */
-void circularCrossCorrelation(double*, double*, CONTROLINFO*);
+/** \brief workerThread life cycle routine of the batch mode, spectra computation */
+static void *processSpectra (void *id);
+
+/** \brief workerThread life cycle routine of the batch mode, pairs correlation */
+static void *processPairs (void *id);
+
+/** \brief workerThread life cycle routine of the streaming mode */
+static void *processStream (void *id);
+
+/** \brief kernels whose hardware counters are reported, numbered by the KERNEL_ constants */
+static const char *const kernelNames[] = {"circularCrossCorrelation", "lagRangeCorrelation", "fft of a lag block",
+                                          "correlateStreamBlock", "fftRealSpectrum", "fftCircularCorrelation"};
+
+#define  KERNEL_CIRCULAR     0
+#define  KERNEL_LAG_RANGE    1
+#define  KERNEL_LAG_FFT      2
+#define  KERNEL_STREAM       3
+#define  KERNEL_SPECTRUM     4
+#define  KERNEL_PAIR         5
+#define  NUMB_KERNELS        6
 
 /** \brief worker threads return status array */
-int statusWorkers[NUMB_THREADS];
+int statusWorkers[MAX_THREADS];
 
 /** \brief worker threads response */
 int *status_p;
 
+/** \brief number of samples (and lags) of a block in the streaming mode */
+static size_t streamBlockSize = STREAM_BLOCK;
+
+/** \brief job of the batch and streaming modes, which are run alone */
+static JOBINFO *runJob;
+
+/** \brief worker threads and their identifications */
+static pthread_t threads_id[MAX_THREADS];
+static unsigned int worker_threads[MAX_THREADS];
+
+/**
+ *  \brief Add the part of the sum of a lag a piece of work stands for to its result (libclestats kernel).
+ *
+ *  Operation carried out by the workers.
+ *
+ *  \param *x    first signal
+ *  \param *y    second signal
+ *  \param *ci   lag, part of the sum and result
+ */
+static void circularCrossCorrelation(const double *x, const double *y, CONTROLINFO *ci) {
+
+   size_t first = ci->leaf * ci->leafSize;                          /* only a part of the sum when it is split */
+   size_t last = first + ci->leafSize < ci->numbSamples ? first + ci->leafSize : ci->numbSamples;
+
+   ci->result += correlateLagPart (x, y, ci->numbSamples, ci->rxyIndex, first, last);
+}
+
+/**
+ *  \brief Calculate the circular cross correlation for the block of lags of a piece of work (libclestats kernel).
+ *
+ *  Operation carried out by the workers.
+ *
+ *  \param *x       first signal
+ *  \param *y       second signal
+ *  \param *ci      number of samples, first lag and number of lags
+ *  \param *values  where the correlation of the lags is stored
+ */
+static void lagRangeCorrelation(const double *x, const double *y, CONTROLINFO *ci, double *values) {
+   correlateLags (x, y, ci->numbSamples, ci->rxyIndex, ci->numbLags, values);
+}
+
+/**
+ *  \brief circularCrossCorrelation for signals stored as float.
+ *
+ *  Operation carried out by the workers.
+ */
+static void circularCrossCorrelationSingle(const float *x, const float *y, CONTROLINFO *ci) {
+
+   size_t first = ci->leaf * ci->leafSize;
+   size_t last = first + ci->leafSize < ci->numbSamples ? first + ci->leafSize : ci->numbSamples;
+
+   ci->result += correlateLagPartSingle (x, y, ci->numbSamples, ci->rxyIndex, first, last);
+}
+
+/**
+ *  \brief lagRangeCorrelation for signals stored as float.
+ *
+ *  Operation carried out by the workers.
+ */
+static void lagRangeCorrelationSingle(const float *x, const float *y, CONTROLINFO *ci, double *values) {
+   correlateLagsSingle (x, y, ci->numbSamples, ci->rxyIndex, ci->numbLags, values);
+}
+
+/**
+ *  \brief Create the worker threads with the given life cycle routine.
+ *
+ *  Operation carried out by the main thread.
+ */
+static void startWorkers(void *(*routine) (void *)) {
+
+   pthread_attr_t attr;
+   int i;
+
+   for (i = 0; i < tuning.numbThreads; i++){
+      worker_threads[i] = i;
+      pthread_attr_init (&attr);
+      placeThread (&attr, i);                                         /* on its CPU from the start */
+      if (pthread_create (&threads_id[i], &attr, routine, &worker_threads[i]) != 0){ 
+         perror ("error on creating worker threads");
+         exit (EXIT_FAILURE);
+      }
+      pthread_attr_destroy (&attr);
+   }
+}
+
+/**
+ *  \brief Wait for the termination of the worker threads.
+ *
+ *  Operation carried out by the main thread.
+ *
+ *  \return false if a worker thread ended with an error
+ */
+static bool joinWorkers(void) {
+
+   int i;
+   bool ok = true;
+
+   for (i = 0; i < tuning.numbThreads; i++)
+      if (pthread_join (threads_id[i], (void *)&status_p) != 0){ 
+         perror ("error on joining");
+         exit (EXIT_FAILURE);
+      }
+      else if (*status_p != EXIT_SUCCESS)
+         ok = false;
+   return ok;
+}
+
+/**
+ *  \brief Create the worker threads with the given life cycle routine and wait for their termination.
+ *
+ *  Operation carried out by the main thread.
+ *
+ *  \return false if a worker thread ended with an error
+ */
+static bool runWorkers(void *(*routine) (void *)) {
+
+   startWorkers (routine);
+   return joinWorkers ();
+}
+
+/**
+ *  \brief Read a count given as the argument of an option.
+ *
+ *  Operation carried out by the main thread.
+ *
+ *  \param text  argument of the option
+ *  \param max   largest count allowed
+ *  \param value where the count is stored
+ *
+ *  \return false if the argument is not a whole number from 1 to max
+ */
+static bool parseCount(const char *text, long max, long *value) {
+
+   char *end;
+
+   errno = 0;
+   *value = strtol (text, &end, 10);
+   return (end != text) && (*end == '\0') && (errno == 0) && (*value > 0) && (*value <= max);
+}
+
 /**
  *  \brief Main thread.
  *
  *  Its role is starting the simulation by generating the worker threads and waiting for their termination.
+ *
+ *  Options:
+ *     -a          batch mode: correlate every distinct signal (x and y of each file) with every other one
+ *     -t n        batch mode: the signals of the first n files are templates, correlated with all the others
+ *     -o file     batch mode: write the full rxy vector of every pair to file
+ *                 streaming mode: directory where the rxy of each file is written (default: current directory)
+ *     -r a:b      lag query mode: only compute the lags a to b
+ *     -k n        lag query mode: only report the n highest peaks (of the whole signal or of the lags given by -r)
+ *     -s          streaming mode: read the signals in blocks (bounded memory), "-" reads a file from stdin
+ *     -b n        streaming mode: number of samples of a block
+ *     -A          take every file as an autocorrelation (y is ignored), files whose x and y are equal are always
+ *                 detected as such: only the lags 0 to n/2 are computed, the others are mirrored
+ *     -S n        split the sum of each lag in parts of n samples, spread over the workers and reduced by a pairwise
+ *                 sum, so that the result does not depend on the number of workers
+ *     -i engine   read the signals through the asynchronous read engine: uring (io_uring, or threads where it is
+ *                 not available) or threads (a pool of threads calling pread)
+ *     -q n        read engine: number of reads outstanding at once (default READ_DEPTH)
+ *     -c dir      keep the rxy of each file in the result cache dir (created if needed, at most CACHE_LIMIT bytes),
+ *                 files whose signals were already correlated with the same parameters are not computed again
+ *     -p policy   bind each worker to a CPU: compact (the CPUs of a NUMA node before the ones of the next node),
+ *                 scatter (the nodes in turn) or a list of CPUs such as 0,2,4-7; the buffers of a worker are then
+ *                 on its node, and the signals of a file are copied once to each node whose workers correlate it
+ *     -P          count the cycles, instructions, cache misses and branch misses of each worker over each unit of
+ *                 work and report them per worker and per kernel (see perfCounters.h), the bytes of a unit being
+ *                 the bytes of the signals it goes through
+ *     -T file     record the timeline of the workers (units of work fetched, computation, merges, lock waits) and
+ *                 write it to file as a Chrome trace (see traceLog.h)
+ *     -M file     export the progress of the run (lags completed on each file, rate of each worker, files waiting,
+ *                 estimated time left) to file as a Prometheus textfile, rewritten every METRICS_PERIOD seconds
+ *                 (see progressMetrics.h)
+ *     -U          calibrate the number of worker threads, the block of lags of the lag query mode and the crossover
+ *                 of the FFT engine on this host (see autotune.h) and save them as its profile, which the next runs
+ *                 load, then process the files if any
+ *     -f          store x and y as float (lag and lag query modes), half the bytes the workers go through on long
+ *                 signals: the samples are converted as they are read and the sums are still accumulated in double,
+ *                 so the only error is the rounding of the samples to float, which the check against the expected
+ *                 results allows for (none for samples stored as float in the file, see signalCorrelator.h)
+ *     -E a:r:u    tolerances of the check against the expected results: a lag is correct when its error is within
+ *                 the largest of a and r times the expected value, on top of the error the run allows for, or within
+ *                 u units in the last place (see resultCheck.h); none by default
+ *     -e          report, for each file, the largest absolute error and its lag, the largest relative and ulp
+ *                 errors, the first lag out of tolerance, a histogram of the relative errors and the error bound of
+ *                 its samples (lag, lag query and streaming modes)
+ *     -D socket   serve the requests of the lag and lag query modes sent to the Unix domain socket given, several
+ *                 at a time, keeping the worker threads from a request to the next, until interrupted (see
+ *                 jobServer.h); -i, -q, -c, -p, -E and -U apply to every request, -P, -T and -M are not used
+ *     -C socket   send the files as a request to the server listening on the socket given, with the options -r, -k,
+ *                 -S, -A, -f and -e, and print its results
+ *     -n priority with -C, the priority of the request, the lags of the requests of a higher priority being handed
+ *                 out first (default 0)
+ *
+ *  The files may be given as directories (every file in them) or as @list (the files listed in list, one per line).
+ *  The number of worker threads, the block of lags and the crossover are the ones of the profile of the host when
+ *  there is one, NUMB_THREADS, LAG_BLOCK and FFT_CROSSOVER otherwise.
  */
 
 int main (int argc, char *argv[]) {
 
-   if(argc < 2)
+   int opt;
+   bool batch = false;
+   unsigned int numbTemplates = 0;
+   char *outputName = NULL;
+   bool query = false;
+   size_t firstLag = 0, lastLag = (size_t) -1;
+   unsigned int numbPeaks = 0;
+   bool stream = false;
+   size_t leafSize = 0;
+   int engine = READ_SYNC;
+   unsigned int readDepth = READ_DEPTH;
+   int placement = PLACE_NONE;
+   char *cpuList = NULL;
+   bool counters = false;
+   char *traceName = NULL;
+   char *metricsName = NULL;
+   bool autotune = false;
+   bool single = false;
+   bool autocorrelation = false;
+   bool errorReport = false;
+   char *serverName = NULL;
+   char *clientName = NULL;
+   int priority = 0;
+   bool ok;
+   long count;
+
+   while ((opt = getopt (argc, argv, "at:o:r:k:sb:S:Ai:q:c:p:PT:M:UfE:eD:C:n:")) != -1)
+      switch (opt) {
+         case 'a': batch = true;
+                   break;
+         case 't': batch = true;
+                   if (!parseCount (optarg, UINT_MAX, &count)){
+                      printf("Invalid number of templates %s\n", optarg);
+                      exit(EXIT_FAILURE);
+                   }
+                   numbTemplates = count;
+                   break;
+         case 'o': outputName = optarg;
+                   break;
+         case 'r': query = true;
+                   if (sscanf (optarg, "%lu:%lu", &firstLag, &lastLag) != 2 || firstLag > lastLag){
+                      printf("Invalid lag window %s, expected first:last\n", optarg);
+                      exit(EXIT_FAILURE);
+                   }
+                   break;
+         case 'k': query = true;
+                   if (!parseCount (optarg, UINT_MAX, &count)){
+                      printf("Invalid number of peaks %s\n", optarg);
+                      exit(EXIT_FAILURE);
+                   }
+                   numbPeaks = count;
+                   break;
+         case 's': stream = true;
+                   break;
+         case 'b': if ((streamBlockSize = atol (optarg)) == 0){
+                      printf("Invalid block size %s\n", optarg);
+                      exit(EXIT_FAILURE);
+                   }
+                   break;
+         case 'S': if (!parseCount (optarg, LONG_MAX, &count)){
+                      printf("Invalid leaf size %s\n", optarg);
+                      exit(EXIT_FAILURE);
+                   }
+                   leafSize = count;
+                   break;
+         case 'A': autocorrelation = true;
+                   break;
+         case 'i': if (strcmp (optarg, "uring") == 0)
+                      engine = READ_URING;
+                   else if (strcmp (optarg, "threads") == 0)
+                      engine = READ_THREADS;
+                   else {
+                      printf("Unknown read engine %s\n", optarg);
+                      exit(EXIT_FAILURE);
+                   }
+                   break;
+         case 'q': if ((readDepth = atoi (optarg)) == 0){
+                      printf("Invalid number of reads %s\n", optarg);
+                      exit(EXIT_FAILURE);
+                   }
+                   break;
+         case 'c': if (!openResultCache (optarg, CACHE_LIMIT))
+                      fprintf(stderr, "the result cache %s could not be opened, it is not used\n", optarg);
+                   break;
+         case 'p': if (strcmp (optarg, "compact") == 0)
+                      placement = PLACE_COMPACT;
+                   else if (strcmp (optarg, "scatter") == 0)
+                      placement = PLACE_SCATTER;
+                   else {
+                      placement = PLACE_LIST;
+                      cpuList = optarg;
+                   }
+                   break;
+         case 'P': counters = true;
+                   break;
+         case 'T': traceName = optarg;
+                   break;
+         case 'M': metricsName = optarg;
+                   break;
+         case 'U': autotune = true;
+                   break;
+         case 'f': single = true;
+                   break;
+         case 'E': if (!parseTolerance (optarg)){
+                      printf("Invalid tolerances %s, expected absolute:relative:ulps\n", optarg);
+                      exit(EXIT_FAILURE);
+                   }
+                   break;
+         case 'e': errorReport = true;
+                   break;
+         case 'D': serverName = optarg;
+                   break;
+         case 'C': clientName = optarg;
+                   break;
+         case 'n': priority = atoi (optarg);
+                   break;
+         default:  printf("Usage: %s [-a] [-t templates] [-o output] [-r first:last] [-k peaks] [-s] [-b block] [-S leaf] [-A] [-i engine] [-q reads] [-c cache] [-p placement] [-P] [-T trace] [-M metrics] [-U] [-f] [-E a:r:u] [-e] [-D socket] [-C socket [-n priority]] files\n", argv[0]);
+                   exit(EXIT_FAILURE);
+      }
+   if (single && (batch || stream)){
+      printf("The signals are only stored as float in the lag and lag query modes\n");
+      exit(EXIT_FAILURE);
+   }
+   if ((serverName != NULL || clientName != NULL) && (batch || stream)){
+      printf("The server only serves the lag and lag query modes\n");
+      exit(EXIT_FAILURE);
+   }
+   if (clientName != NULL){                                           /* the server does the work */
+      struct timespec t0, t1;
+      clock_gettime (CLOCK_MONOTONIC, &t0);
+      if (!requestJob (clientName, query, firstLag, lastLag, numbPeaks, leafSize, autocorrelation, single, errorReport,
+                       priority, argv + optind, argc - optind))
+         exit (EXIT_FAILURE);
+      clock_gettime (CLOCK_MONOTONIC, &t1);
+      printf ("\nElapsed time = %.6f s\n", (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9);
+      exit (EXIT_SUCCESS);
+   }
+   if (serverName != NULL && (counters || traceName != NULL || metricsName != NULL)){
+      fprintf(stderr, "the counters, the timeline and the metrics are not used by the server\n");
+      counters = false;
+      traceName = metricsName = NULL;
+   }
+   loadTuning ();
+   if (autotune){
+      tuneCorrelation (circularCrossCorrelation, lagRangeCorrelation, sysconf (_SC_NPROCESSORS_ONLN));
+      if (!saveTuning ())
+         perror ("error on saving the profile");
+      printf("%u worker threads, blocks of %zu lags, FFT crossover %.2f, profile %s\n", tuning.numbThreads,
+             tuning.lagBlock, tuning.fftCrossover, tuningProfile ());
+      if (optind >= argc && serverName == NULL)
+         exit (EXIT_SUCCESS);
+   }
+   if (placement != PLACE_NONE)
+      startPlacement (placement, cpuList);
+   if (counters)
+      startCounters (tuning.numbThreads, NUMB_KERNELS);
+   if (traceName != NULL && !startTrace (tuning.numbThreads, TRACE_EVENTS))
+      fprintf(stderr, "the timeline could not be allocated, it is not recorded\n");
+   if (metricsName != NULL && !startMetrics (metricsName, tuning.numbThreads))
+      perror ("error on writing the metrics, they are not exported");
+   if (engine != READ_SYNC && startReadEngine (engine, readDepth, READ_BLOCK) == READ_SYNC)
+      fprintf(stderr, "the read engine could not be started, reading synchronously\n");
+
+   if (serverName != NULL){
+      if (!startServer (serverName)){                              /* before the workers, which leave it the signals */
+         perror ("error on creating the socket of the server");
+         exit (EXIT_FAILURE);
+      }
+      startWorkers (process);
+      printf("Serving requests on %s\n", serverName);
+      fflush (stdout);
+      runServer ();
+      closeJobs ();
+      joinWorkers ();
+      stopReadEngine ();
+      closeResultCache ();
+      exit (EXIT_SUCCESS);
+   }
+
+   if(optind >= argc)
    {
       printf("Please insert text files to be processed as arguments!");
       exit(EXIT_FAILURE);
@@ -52,37 +465,62 @@ int main (int argc, char *argv[]) {
    else
    {
       double t0, t1;
-      int rc, i;
-      
-      unsigned int worker_threads[NUMB_THREADS];
-      pthread_t threads_id[NUMB_THREADS];
+      JOBINFO *job = newJob (0);
 
+      if (autocorrelation)
+         presentAutocorrelation (job);
+      if (single)
+         presentSingleStorage (job);
+      if (errorReport)
+         presentErrorReport (job);
+      t0 = ((double) clock ()) / CLOCKS_PER_SEC;
+      presentDataFileNames(job, argv + optind, argc - optind);
 
-      for (i = 0; i < NUMB_THREADS; i++)
-         worker_threads[i] = i;
+      if (batch) {
+         runJob = job;
+         if (!loadSignals(job, numbTemplates, outputName))
+            exit(EXIT_FAILURE);
+         ok = runWorkers(processSpectra);                     /* each spectrum is computed only once */
+         ok = runWorkers(processPairs) && ok;
 
-      t0 = ((double) clock ()) / CLOCKS_PER_SEC;
-      presentDataFileNames(argv + 1, --argc);
+         printf ("\nFinal report\n");
+         printPairResults(job, stdout);
+      } else if (stream) {
+         runJob = job;
+         if (!presentStreams(job, streamBlockSize, outputName != NULL ? outputName : "."))
+            exit(EXIT_FAILURE);
+         ok = runWorkers(processStream);
 
-      for (i = 0; i < NUMB_THREADS; i++)
-         if (pthread_create (&threads_id[i], NULL, process, &worker_threads[i]) != 0){ 
-            perror ("error on creating worker threads");
-            exit (EXIT_FAILURE);
-         }
-        
-      for (i = 0; i < NUMB_THREADS; i++)
-         if (pthread_join (threads_id[i], (void *)&status_p) != 0){ 
-            perror ("error on joining");
-            exit (EXIT_FAILURE);
-         }
+         printf ("\nFinal report\n");
+         ok = printStreamResults(job, stdout) && ok;
+      } else {
+         if (query)
+            presentLagQuery(job, firstLag, lastLag, numbPeaks);
+         else
+            presentSplitSum(job, leafSize);
+         submitJob(job);
+         closeJobs();                                                   /* the workers leave once it is handed out */
+         ok = runWorkers(process);
 
-      
-      printf ("\nFinal report\n");
-      printResults();
+         printf ("\nFinal report\n");
+         ok = printResults(job, stdout) && ok;
+      }
 
+      stopMetrics ();
+      printCounters ("worker", kernelNames);
+      if (traceName != NULL){
+         TRACEEVENT *events;
+         size_t numbEvents = collectTrace (0, &events);
+         if (!writeTrace (traceName, events, numbEvents))
+            perror ("error on writing the timeline");
+         free (events);
+         stopTrace ();
+      }
+      stopReadEngine ();
+      closeResultCache ();
       t1 = ((double) clock ()) / CLOCKS_PER_SEC;
       printf ("\nElapsed time = %.6f s\n", t1 - t0);
-      exit (EXIT_SUCCESS);
+      exit (ok ? EXIT_SUCCESS : EXIT_FAILURE);
    }
    
 }
@@ -90,29 +528,196 @@ int main (int argc, char *argv[]) {
 static void *process(void *threadId) {
 
    unsigned int id = *((unsigned int *) threadId);
-   double x[DEFAULT_SIZE_SIGNAL];
-   double y[DEFAULT_SIZE_SIGNAL];
+   const void *x, *y;
    CONTROLINFO ci = (CONTROLINFO) {0};
-   ci.filePosition = -1;
-   ci.processing = false;
-   while (getAPieceOfData (id, x, y, &ci))
-   { 
-      circularCrossCorrelation(x, y, &ci);
-      savePartialResults (id, &ci);
+   JOBINFO *job;
+   double *values = NULL;
+   double complex *work = NULL;
+   size_t size = 0;
+   int group[PERF_EVENTS];
+   PERFCOUNTS start, total = {0}, range = {0}, window = {0};
+   double t = traceClock ();
+
+   openCounters (group);
+   while (waitForJobs (id))                                       /* the server keeps the workers between requests */
+      while (getAPieceOfData (id, &x, &y, &ci, &job))
+      {
+         traceSpan (id, TRACE_FETCH, t);
+         t = traceClock ();
+         if (!ci.query) {                                         /* a lag, or a part of its sum */
+            readCounters (group, &start);
+            if (ci.single)
+               circularCrossCorrelationSingle(x, y, &ci);
+            else
+               circularCrossCorrelation(x, y, &ci);
+            countUnit (group, &start, &total, 2 * (ci.single ? sizeof(float) : sizeof(double))
+                                              * (ci.leafSize < ci.numbSamples ? ci.leafSize : ci.numbSamples));
+            traceSpan (id, TRACE_COMPUTE, t);
+            t = traceClock ();
+            savePartialResults (id, job, &ci);
+         } else {                                                 /* a block of lags of the window */
+            if (ci.numbLags > size) {                             /* only the block, never the whole signal */
+               size = ci.numbLags;
+               values = (double *) realloc (values, sizeof(double) * size);
+               work = (double complex *) realloc (work, sizeof(double complex) * lagBlockWork (size));
+            }
+            readCounters (group, &start);
+            if (ci.fft) {                                         /* overlap-save over the block */
+               bool done = work != NULL
+                           && (ci.single ? correlateLagBlockSingle (x, y, ci.numbSamples, ci.rxyIndex, ci.numbLags,
+                                                                    values, work)
+                                         : correlateLagBlock (x, y, ci.numbSamples, ci.rxyIndex, ci.numbLags, values,
+                                                              work));
+               if (!done){
+                  perror ("error on correlating a file");
+                  statusWorkers[id] = EXIT_FAILURE;
+                  pthread_exit (&statusWorkers[id]);
+               }
+               countUnit (group, &start, &window, 2 * (ci.single ? sizeof(float) : sizeof(double)) * ci.numbSamples);
+            } else {
+               if (ci.single)
+                  lagRangeCorrelationSingle (x, y, &ci, values);
+               else
+                  lagRangeCorrelation (x, y, &ci, values);
+               countUnit (group, &start, &range, 2 * (ci.single ? sizeof(float) : sizeof(double)) * ci.numbSamples);
+            }
+            traceSpan (id, TRACE_COMPUTE, t);
+            t = traceClock ();
+            saveLagBlock (id, job, &ci, values);
+         }
+         traceSpan (id, TRACE_MERGE, t);
+         t = traceClock ();
+      }
+   saveCounters (id, KERNEL_CIRCULAR, &total);
+   saveCounters (id, KERNEL_LAG_RANGE, &range);
+   saveCounters (id, KERNEL_LAG_FFT, &window);
+   closeCounters (group);
+
+   free (values);
+   free (work);
+   statusWorkers[id] = EXIT_SUCCESS;
+   pthread_exit (&statusWorkers[id]);
+
+}
+
+static void *processStream(void *threadId) {
+
+   unsigned int id = *((unsigned int *) threadId);
+   CONTROLINFO ci = (CONTROLINFO) {0};
+   STREAMINFO *s;
+   STREAMBLOCK block;
+   double *values = (double *) malloc (sizeof(double) * streamBlockSize);
+   int group[PERF_EVENTS];
+   PERFCOUNTS start, total = {0};
+   double t;
+
+   if (values == NULL || !initStreamBlock (&block, streamBlockSize)){
+      perror ("error on allocating the stream buffers");
+      statusWorkers[id] = EXIT_FAILURE;
+      pthread_exit (&statusWorkers[id]);
+   }
+
+   openCounters (group);
+   t = traceClock ();
+   while (getAStreamBlock (id, runJob, &ci, &s))
+   {
+      traceSpan (id, TRACE_FETCH, t);
+      t = traceClock ();
+      readCounters (group, &start);
+      if (!correlateStreamBlock (s, &block, ci.rxyIndex, ci.numbLags, values)){
+         perror ("error on reading a signal");
+         statusWorkers[id] = EXIT_FAILURE;
+         pthread_exit (&statusWorkers[id]);
+      }
+      countUnit (group, &start, &total, 2 * sizeof(double) * s->numbSamples);
+      traceSpan (id, TRACE_COMPUTE, t);
+      t = traceClock ();
+      ERRORSTATS errors = {0};
+      verifyStreamBlock (s, &block, ci.rxyIndex, ci.numbLags, values, &errors);
+      saveStreamBlock (id, runJob, &ci, values, &errors);
+      traceSpan (id, TRACE_MERGE, t);
+      t = traceClock ();
    }
+   saveCounters (id, KERNEL_STREAM, &total);
+   closeCounters (group);
 
+   freeStreamBlock (&block);
+   free (values);
    statusWorkers[id] = EXIT_SUCCESS;
    pthread_exit (&statusWorkers[id]);
+}
+
+static void *processSpectra(void *threadId) {
+
+   unsigned int id = *((unsigned int *) threadId);
+   SIGNALINFO *signal;
+   int group[PERF_EVENTS];
+   PERFCOUNTS start, total = {0};
+   double t = traceClock ();
+
+   openCounters (group);
+   while (getASignal (id, runJob, &signal))
+   {
+      traceSpan (id, TRACE_FETCH, t);
+      t = traceClock ();
+      readCounters (group, &start);
+      signal->spectrum = (double complex *) malloc (sizeof(double complex) * signal->numbSamples);
+      if (signal->spectrum == NULL || !fftRealSpectrum (signal->samples, signal->numbSamples, signal->spectrum)){
+         perror ("error on computing the spectrum");
+         statusWorkers[id] = EXIT_FAILURE;
+         pthread_exit (&statusWorkers[id]);
+      }
+      countUnit (group, &start, &total, sizeof(double) * signal->numbSamples);
+      traceSpan (id, TRACE_COMPUTE, t);
+      t = traceClock ();
+   }
+   saveCounters (id, KERNEL_SPECTRUM, &total);
+   closeCounters (group);
 
+   statusWorkers[id] = EXIT_SUCCESS;
+   pthread_exit (&statusWorkers[id]);
 }
 
-void circularCrossCorrelation(double *x, double *y, CONTROLINFO *ci) {
+static void *processPairs(void *threadId) {
 
-   size_t i, j;
-   size_t n = ci->numbSamples;
-   size_t temp = ci->rxyIndex; 
+   unsigned int id = *((unsigned int *) threadId);
+   PAIRINFO *pair;
+   SIGNALINFO *first, *second;
+   double *rxy = NULL;
+   double complex *work = NULL;
+   size_t size = 0;
+   int group[PERF_EVENTS];
+   PERFCOUNTS start, total = {0};
+   double t = traceClock ();
 
-   for(j = 0; j < n; j++){
-      ci->result += x[j] * y[(temp+j)%n];
+   openCounters (group);
+   while (getAPair (id, runJob, &pair, &first, &second))
+   {
+      traceSpan (id, TRACE_FETCH, t);
+      t = traceClock ();
+      readCounters (group, &start);
+      if (pair->numbSamples > size) {
+         size = pair->numbSamples;
+         rxy = (double *) realloc (rxy, sizeof(double) * size);
+         work = (double complex *) realloc (work, sizeof(double complex) * size);
+      }
+      if (rxy == NULL || work == NULL || !fftCircularCorrelation (first->spectrum, second->spectrum, pair->numbSamples, rxy, work)){
+         perror ("error on correlating a pair");
+         statusWorkers[id] = EXIT_FAILURE;
+         pthread_exit (&statusWorkers[id]);
+      }
+      countUnit (group, &start, &total, 2 * sizeof(double complex) * pair->numbSamples);
+      traceSpan (id, TRACE_COMPUTE, t);
+      t = traceClock ();
+      savePairResults (id, runJob, pair, rxy);
+      traceSpan (id, TRACE_MERGE, t);
+      t = traceClock ();
    }
+   saveCounters (id, KERNEL_PAIR, &total);
+   closeCounters (group);
+
+   free (rxy);
+   free (work);
+   statusWorkers[id] = EXIT_SUCCESS;
+   pthread_exit (&statusWorkers[id]);
 }
@@ -13,14 +13,86 @@
 
 /* Generic parameters */
 
-/** \brief number of worker Threads */
+/** \brief default number of worker Threads (see autotune.h) */
 #define  NUMB_THREADS          4
 
-/** \brief max number of files that can be processed  */
-#define  MAX_FILES           50
+/** \brief largest number of worker Threads */
+#define  MAX_THREADS           256
 
-/** \brief standard number of signals per each file */
-#define  DEFAULT_SIZE_SIGNAL      70000
+/** \brief number of files whose work is handed out at the same time */
+#define  ACTIVE_FILES        4
 
+/** \brief max number of jobs handed out at the same time, and of requests served at once by the server */
+#define  MAX_JOBS            64
+
+/** \brief max size of a request to the server */
+#define  REQUEST_MAX         (1 << 20)
+
+/** \brief default number of lags handed to a worker at a time in the lag query mode (see autotune.h) */
+#define  LAG_BLOCK           64
+
+/** \brief max number of peaks of the top-k query */
+#define  MAX_PEAKS           64
+
+/** \brief lag windows wider than FFT_CROSSOVER * log2(samples) use the FFT engine instead of the direct one */
+#define  FFT_CROSSOVER       8
+
+/** \brief number of lags handed to a worker at a time when the lag window uses the FFT engine (overlap-save) */
+#define  FFT_LAG_BLOCK       16384
+
+/** \brief relative tolerance of the results computed with the FFT engine */
+#define  FFT_TOLERANCE       1e-9
+
+/** \brief number of bins of the histogram of the relative errors: exact, one per decade from 1e-16 to 1e-1, above */
+#define  ERROR_BINS          18
+
+/** \brief default number of samples (and lags) of a block in the streaming mode */
+#define  STREAM_BLOCK        65536
+
+/** \brief default number of reads outstanding of the read engine */
+#define  READ_DEPTH          32
+
+/** \brief size of a buffer of the read engine */
+#define  READ_BLOCK          (1 << 18)
+
+/** \brief size of the result cache above which the least recently used results are removed */
+#define  CACHE_LIMIT         (1ULL << 30)
+
+/** \brief size of the buffer used to spool the standard input to disk */
+#define  STREAM_COPY         65536
+
+
+/** \brief number of events of the timeline kept per thread */
+#define  TRACE_EVENTS        (1 << 16)
+
+/** \brief seconds between two writings of the progress metrics */
+#define  METRICS_PERIOD      5
+
+/** \brief number of samples of the signals the number of threads and the block of lags are calibrated on */
+#define  TUNE_SAMPLES        4096
+
+/** \brief largest number of lags of a block tried by the calibration */
+#define  TUNE_MAX_BLOCK      1024
+
+/** \brief number of samples of the smallest signal the crossover of the FFT engine is calibrated on */
+#define  TUNE_MIN_SAMPLES    (1 << 10)
+
+/** \brief number of samples of the largest one, the sizes between them growing fourfold */
+#define  TUNE_MAX_SAMPLES    (1 << 16)
+
+/** \brief number of lags the direct method computes to be timed */
+#define  TUNE_LAGS           64
+
+/** \brief number of runs of each configuration of the calibration, the fastest one being kept */
+#define  TUNE_ROUNDS         3
+
+/** \brief relative gain below which the calibration keeps the smaller configuration */
+#define  TUNE_MARGIN         0.02
+
+/** \brief directory of the tuning profiles, in the home directory */
+#define  TUNING_DIR          ".cle"
+
+/** \brief name of the tuning profile of the program, after the host */
+#define  TUNING_PROFILE      "prob2"
 
 #endif /* PROBCONST_H_ */
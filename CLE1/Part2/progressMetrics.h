@@ -0,0 +1,76 @@
+/**
+ *  \file progressMetrics.h (interface file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  Progress of a run, exported while it goes on as a Prometheus textfile (for the textfile collector of the node
+ *  exporter), rewritten every METRICS_PERIOD seconds by a thread of its own and once more at the end: bytes read,
+ *  words counted, work done and to do on each file (bytes of a text, lags of a signal), units of work, bytes and
+ *  rate of each worker, documents waiting or in progress, progress and estimated time left.
+ *
+ *  The counters are updated with atomic additions where the results of a unit of work are merged. In the MPI
+ *  programs the dispatcher counts the results each worker sends back, so they are aggregated over the processes
+ *  without any message of their own. When the export is not started, an update is a test of a flag.
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - April 2020
+ */
+
+#ifndef PROGRESSMETRICS_H
+#define PROGRESSMETRICS_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ *  \brief Start the export.
+ *
+ *  Operation carried out by the main thread (by the dispatcher in the MPI programs), before the work starts.
+ *
+ *  \param *name       name of the textfile, replaced atomically (written to name.tmp, then renamed)
+ *  \param numbWorkers number of workers (threads or processes), numbered from 0
+ *
+ *  \return false if the textfile can not be written, nothing being exported then
+ */
+extern bool startMetrics(const char *name, unsigned int numbWorkers);
+
+/**
+ *  \brief Set the number of files of the run.
+ *
+ *  \param numbFiles number of files
+ */
+extern void presentMetricFiles(size_t numbFiles);
+
+/**
+ *  \brief Name a file and set its work.
+ *
+ *  \param file     number of the file
+ *  \param *name    name, kept (not copied)
+ *  \param numbWork work to do on it, 0 if it is not known (a stream) or there is none (its results are cached)
+ */
+extern void nameMetricFile(size_t file, const char *name, uint64_t numbWork);
+
+/**
+ *  \brief Count a unit of work whose results were merged.
+ *
+ *  \param worker   worker which did it
+ *  \param file     file it belongs to
+ *  \param numbWork work done (the units of nameMetricFile)
+ *  \param bytes    bytes it went through
+ *  \param numbWords words counted, 0 for a signal
+ */
+extern void countWork(unsigned int worker, size_t file, uint64_t numbWork, uint64_t bytes, uint64_t numbWords);
+
+/**
+ *  \brief Set the number of documents waiting or in progress.
+ *
+ *  \param depth number of documents
+ */
+extern void setQueueDepth(uint64_t depth);
+
+/**
+ *  \brief Stop the export, the textfile being written a last time.
+ */
+extern void stopMetrics(void);
+
+#endif /* PROGRESSMETRICS_H */
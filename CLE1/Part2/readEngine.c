@@ -0,0 +1,436 @@
+/**
+ *  \file readEngine.c (implementation file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - April 2020
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#include "READBLOCK.h"
+#include "readEngine.h"
+
+/** \brief engine in use */
+static int engineType = READ_SYNC;
+
+/** \brief number of buffers of the pool, and of reads outstanding at most */
+static unsigned int depth;
+
+/** \brief size of a buffer */
+static size_t blockSize;
+
+/** \brief reads, one per buffer of the pool */
+static READBLOCK *blocks;
+
+/** \brief memory of the buffers */
+static unsigned char *pool;
+
+/** \brief locking flag which warrants mutual exclusion inside the engine */
+static pthread_mutex_t accessE = PTHREAD_MUTEX_INITIALIZER;
+
+/** \brief a read completed or a buffer was released */
+static pthread_cond_t changed = PTHREAD_COND_INITIALIZER;
+
+/** \brief io_uring: descriptor of the ring and whether the buffers were registered */
+static int ringFd = -1;
+static bool registered;
+
+/** \brief io_uring: submission and completion queues, shared with the kernel */
+static unsigned *sqHead, *sqTail, *sqMask, *sqArray, *cqHead, *cqTail, *cqMask;
+static struct io_uring_sqe *sqes;
+static struct io_uring_cqe *cqes;
+static void *sqRing, *cqRing;
+static size_t sqRingSize, cqRingSize, sqesSize;
+
+/** \brief io_uring: a thread is waiting for completions in the kernel */
+static bool reaping;
+
+/** \brief threads: the reader threads */
+static pthread_t *readers;
+
+/** \brief threads: reads waiting for a reader, in a circular queue */
+static READBLOCK **pending;
+static unsigned int pendingHead, numbPending;
+
+/** \brief threads: there are reads waiting for a reader, or the engine is stopping */
+static pthread_cond_t work = PTHREAD_COND_INITIALIZER;
+static bool stopping;
+
+/**
+ *  \brief pread until count bytes were read or the end of the file.
+ *
+ *  Internal operation.
+ *
+ *  \return number of bytes read, -errno on an error
+ */
+static ssize_t readFully(int fd, unsigned char *buffer, size_t count, uint64_t offset)
+{
+  size_t done = 0;
+
+  while (done < count){
+    ssize_t n = pread(fd, buffer + done, count - done, offset + done);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0)
+      return -errno;
+    if (n == 0)
+      break;
+    done += n;
+  }
+  return done;
+}
+
+/**
+ *  \brief Life cycle of a reader thread of the thread pool engine.
+ *
+ *  Internal operation.
+ */
+static void *reader(void *arg)
+{
+  pthread_mutex_lock(&accessE);
+  while (true){
+    while (numbPending == 0 && !stopping)
+      pthread_cond_wait(&work, &accessE);
+    if (numbPending == 0)
+      break;
+    READBLOCK *b = pending[pendingHead];
+    pendingHead = (pendingHead + 1) % depth;
+    numbPending--;
+    pthread_mutex_unlock(&accessE);
+
+    ssize_t result = readFully(b->fd, b->buffer, b->length, b->offset);
+
+    pthread_mutex_lock(&accessE);
+    b->result = result;
+    b->done = true;
+    pthread_cond_broadcast(&changed);
+  }
+  pthread_mutex_unlock(&accessE);
+  return NULL;
+}
+
+/**
+ *  \brief Set up the io_uring ring and register the buffers of the pool.
+ *
+ *  Internal operation.
+ *
+ *  \return false if io_uring is not available
+ */
+static bool startRing(void)
+{
+  struct io_uring_params p;
+  struct iovec *iov;
+
+  memset(&p, 0, sizeof(p));
+  if ((ringFd = syscall(__NR_io_uring_setup, depth, &p)) < 0)
+    return false;
+
+  sqRingSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  cqRingSize = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+  if (p.features & IORING_FEAT_SINGLE_MMAP)
+    sqRingSize = cqRingSize = sqRingSize > cqRingSize ? sqRingSize : cqRingSize;
+  sqRing = mmap(NULL, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+  cqRing = (p.features & IORING_FEAT_SINGLE_MMAP) ? sqRing
+           : mmap(NULL, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+  sqesSize = p.sq_entries * sizeof(struct io_uring_sqe);
+  sqes = mmap(NULL, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+  if (sqRing == MAP_FAILED || cqRing == MAP_FAILED || sqes == MAP_FAILED){
+    close(ringFd);
+    ringFd = -1;
+    return false;
+  }
+  sqHead = (unsigned *) ((char *) sqRing + p.sq_off.head);
+  sqTail = (unsigned *) ((char *) sqRing + p.sq_off.tail);
+  sqMask = (unsigned *) ((char *) sqRing + p.sq_off.ring_mask);
+  sqArray = (unsigned *) ((char *) sqRing + p.sq_off.array);
+  cqHead = (unsigned *) ((char *) cqRing + p.cq_off.head);
+  cqTail = (unsigned *) ((char *) cqRing + p.cq_off.tail);
+  cqMask = (unsigned *) ((char *) cqRing + p.cq_off.ring_mask);
+  cqes = (struct io_uring_cqe *) ((char *) cqRing + p.cq_off.cqes);
+
+  iov = (struct iovec *) malloc(sizeof(struct iovec) * depth);               /* pinned once, no mapping per read */
+  for (unsigned int i = 0; i < depth; i++){
+    iov[i].iov_base = blocks[i].buffer;
+    iov[i].iov_len = blockSize;
+  }
+  registered = syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_BUFFERS, iov, depth) == 0;
+  free(iov);
+  return true;
+}
+
+/**
+ *  \brief Move the completions of the io_uring ring to their reads.
+ *
+ *  Internal operation, inside the engine lock.
+ */
+static void reapCompletions(void)
+{
+  unsigned head = *cqHead;
+
+  while (head != __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)){
+    struct io_uring_cqe *cqe = &cqes[head & *cqMask];
+    READBLOCK *b = &blocks[cqe->user_data];
+    b->result = cqe->res;
+    b->done = true;
+    head++;
+  }
+  __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+}
+
+/**
+ *  \brief Start the read engine.
+ *
+ *  \param engine READ_URING or READ_THREADS
+ *  \param numbBuffers number of reads outstanding at most, which is also the number of buffers of the pool
+ *  \param size size of a buffer
+ *
+ *  \return engine started, READ_THREADS if io_uring is not available, READ_SYNC if it could not be started
+ */
+int startReadEngine(int engine, unsigned int numbBuffers, size_t size)
+{
+  unsigned int i;
+
+  if (engine == READ_SYNC || numbBuffers == 0)
+    return READ_SYNC;
+  depth = numbBuffers;
+  blockSize = (size + 4095) / 4096 * 4096;                                    /* whole pages, for O_DIRECT files too */
+  blocks = (READBLOCK *) calloc(depth, sizeof(READBLOCK));
+  if (blocks == NULL || posix_memalign((void **) &pool, 4096, depth * blockSize) != 0){
+    free(blocks);
+    return READ_SYNC;
+  }
+  for (i = 0; i < depth; i++){
+    blocks[i].buffer = pool + i * blockSize;
+    blocks[i].index = i;
+  }
+
+  if (engine == READ_URING && startRing()){
+    engineType = READ_URING;
+    return engineType;
+  }
+
+  pending = (READBLOCK **) malloc(sizeof(READBLOCK *) * depth);
+  readers = (pthread_t *) malloc(sizeof(pthread_t) * depth);
+  pendingHead = numbPending = 0;
+  stopping = false;
+  for (i = 0; i < depth; i++)
+    if (pthread_create(&readers[i], NULL, reader, NULL) != 0){
+      perror ("error on creating the reader threads");
+      exit (EXIT_FAILURE);
+    }
+  engineType = READ_THREADS;
+  return engineType;
+}
+
+/**
+ *  \brief Whether the read engine was started.
+ */
+bool readEngineActive(void)
+{
+  return engineType != READ_SYNC;
+}
+
+/**
+ *  \brief Size of the buffers of the pool.
+ */
+size_t readBlockSize(void)
+{
+  return blockSize;
+}
+
+/**
+ *  \brief Number of reads outstanding at most.
+ */
+unsigned int readQueueDepth(void)
+{
+  return depth;
+}
+
+/**
+ *  \brief Start a read of at most a buffer.
+ *
+ *  \param fd descriptor of the file
+ *  \param offset position of the first byte
+ *  \param length number of bytes (at most the size of a buffer)
+ *  \param wait whether to wait for a free buffer
+ *
+ *  \return the read, NULL if all the buffers are in use and wait is false
+ */
+READBLOCK *submitRead(int fd, uint64_t offset, size_t length, bool wait)
+{
+  READBLOCK *b = NULL;
+  unsigned int i;
+
+  pthread_mutex_lock(&accessE);
+  while (true){
+    for (i = 0; i < depth && blocks[i].busy; i++)
+      ;
+    if (i < depth || !wait)
+      break;
+    pthread_cond_wait(&changed, &accessE);
+  }
+  if (i == depth){
+    pthread_mutex_unlock(&accessE);
+    return NULL;
+  }
+
+  b = &blocks[i];
+  b->busy = true;
+  b->done = false;
+  b->fd = fd;
+  b->offset = offset;
+  b->length = length < blockSize ? length : blockSize;
+  b->result = 0;
+
+  if (engineType == READ_URING){
+    unsigned tail = *sqTail, index = tail & *sqMask;
+    struct io_uring_sqe *sqe = &sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = registered ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t) (uintptr_t) b->buffer;
+    sqe->len = b->length;
+    sqe->off = offset;
+    sqe->buf_index = i;
+    sqe->user_data = i;
+    sqArray[index] = index;
+    __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+    if (syscall(__NR_io_uring_enter, ringFd, 1, 0, 0, NULL, 0) < 0){
+      b->result = -errno;
+      b->done = true;
+    }
+  } else {
+    pending[(pendingHead + numbPending) % depth] = b;
+    numbPending++;
+    pthread_cond_signal(&work);
+  }
+  pthread_mutex_unlock(&accessE);
+  return b;
+}
+
+/**
+ *  \brief Wait for a read to complete, its bytes being in b->buffer and their number in b->result.
+ *
+ *  With io_uring, one of the waiting threads collects the completions for all of them.
+ *
+ *  \param *b read
+ *
+ *  \return false on a read error
+ */
+bool waitRead(READBLOCK *b)
+{
+  bool ok;
+
+  pthread_mutex_lock(&accessE);
+  while (!b->done){
+    if (engineType == READ_URING && !reaping){
+      reaping = true;
+      if (*cqHead == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)){
+        pthread_mutex_unlock(&accessE);
+        syscall(__NR_io_uring_enter, ringFd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+        pthread_mutex_lock(&accessE);
+      }
+      reapCompletions();
+      reaping = false;
+      pthread_cond_broadcast(&changed);
+    } else
+      pthread_cond_wait(&changed, &accessE);
+  }
+  ok = b->result >= 0;
+  pthread_mutex_unlock(&accessE);
+  return ok;
+}
+
+/**
+ *  \brief Give the buffer of a completed read back to the pool.
+ *
+ *  \param *b read
+ */
+void releaseRead(READBLOCK *b)
+{
+  waitRead(b);                                                                /* the kernel may still write to it */
+  pthread_mutex_lock(&accessE);
+  b->busy = false;
+  pthread_cond_broadcast(&changed);
+  pthread_mutex_unlock(&accessE);
+}
+
+/**
+ *  \brief Read count bytes at a position, in reads of a buffer all outstanding at the same time.
+ *
+ *  \param fd descriptor of the file
+ *  \param *buffer where the bytes are stored
+ *  \param count number of bytes
+ *  \param offset position of the first byte
+ *
+ *  \return false on a read error or if the file is shorter
+ */
+bool engineReadAt(int fd, void *buffer, size_t count, uint64_t offset)
+{
+  READBLOCK **inFlight = (READBLOCK **) malloc(sizeof(READBLOCK *) * depth), *b;
+  unsigned int first = 0, numb = 0;
+  size_t submitted = 0;
+  bool ok = true;
+
+  while (numb > 0 || (ok && submitted < count)){
+    while (ok && submitted < count && numb < depth){                          /* keep the queue full */
+      if ((b = submitRead(fd, offset + submitted, count - submitted, numb == 0)) == NULL)
+        break;                                                                /* wait for ours, not for others */
+      inFlight[(first + numb++) % depth] = b;
+      submitted += b->length;
+    }
+    b = inFlight[first];
+    first = (first + 1) % depth;
+    numb--;
+    if (!waitRead(b) || (size_t) b->result != b->length)
+      ok = false;
+    else
+      memcpy((unsigned char *) buffer + (b->offset - offset), b->buffer, b->length);
+    releaseRead(b);
+  }
+  free(inFlight);
+  return ok;
+}
+
+/**
+ *  \brief Stop the read engine, all the reads must have been released.
+ */
+void stopReadEngine(void)
+{
+  unsigned int i;
+
+  if (engineType == READ_URING){
+    munmap(sqes, sqesSize);
+    if (cqRing != sqRing)
+      munmap(cqRing, cqRingSize);
+    munmap(sqRing, sqRingSize);
+    close(ringFd);
+    ringFd = -1;
+  } else if (engineType == READ_THREADS){
+    pthread_mutex_lock(&accessE);
+    stopping = true;
+    pthread_cond_broadcast(&work);
+    pthread_mutex_unlock(&accessE);
+    for (i = 0; i < depth; i++)
+      pthread_join(readers[i], NULL);
+    free(readers);
+    free(pending);
+  }
+  if (engineType != READ_SYNC){
+    free(pool);
+    free(blocks);
+  }
+  engineType = READ_SYNC;
+}
@@ -0,0 +1,380 @@
+/**
+ *  \file resultCache.c (implementation file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - April 2020
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "HASHSTATE.h"
+#include "resultCache.h"
+
+/** \brief primes of XXH64 */
+#define  PRIME1              11400714785074694791ULL
+#define  PRIME2              14029467366897019727ULL
+#define  PRIME3              1609587929392839161ULL
+#define  PRIME4              9650029242287828579ULL
+#define  PRIME5              2870177450012600261ULL
+
+/** \brief first bytes of an entry */
+#define  CACHE_MAGIC         "CLECACHE"
+
+/** \brief version of the layout of an entry */
+#define  CACHE_VERSION       1
+
+/** \brief size of the header of an entry: magic, version, key, size and hash of the result */
+#define  CACHE_HEADER        40
+
+/** \brief directory of the entries, NULL if the cache is disabled */
+static char *cacheDirectory;
+
+/** \brief size of the directory above which entries are removed */
+static uint64_t cacheLimit;
+
+/** \brief entry of the directory, to be ordered by the time of its last use */
+typedef struct
+{
+   char *name;
+   time_t used;
+   uint64_t size;
+} CACHEFILE;
+
+/**
+ *  \brief Rotation to the left.
+ *
+ *  Internal operation.
+ */
+static uint64_t rotate(uint64_t x, int r)
+{
+  return (x << r) | (x >> (64 - r));
+}
+
+/**
+ *  \brief Add a lane of 8 bytes to an accumulator.
+ *
+ *  Internal operation.
+ */
+static uint64_t hashRound(uint64_t acc, uint64_t lane)
+{
+  acc += lane * PRIME2;
+  acc = rotate(acc, 31);
+  return acc * PRIME1;
+}
+
+/**
+ *  \brief Merge an accumulator into the hash.
+ *
+ *  Internal operation.
+ */
+static uint64_t hashMerge(uint64_t hash, uint64_t acc)
+{
+  hash ^= hashRound(0, acc);
+  return hash * PRIME1 + PRIME4;
+}
+
+/**
+ *  \brief Lane of 8 bytes, little endian.
+ *
+ *  Internal operation.
+ */
+static uint64_t lane64(const unsigned char *p)
+{
+  uint64_t v = 0;
+  for (int i = 7; i >= 0; i--)
+    v = (v << 8) | p[i];
+  return v;
+}
+
+/**
+ *  \brief Start a content hash.
+ *
+ *  \param *h state of the hash
+ *  \param seed seed of the hash
+ */
+void hashStart(HASHSTATE *h, uint64_t seed)
+{
+  h->seed = seed;
+  h->acc[0] = seed + PRIME1 + PRIME2;
+  h->acc[1] = seed + PRIME2;
+  h->acc[2] = seed;
+  h->acc[3] = seed - PRIME1;
+  h->total = 0;
+  h->numbBuffered = 0;
+}
+
+/**
+ *  \brief Add the next bytes to a content hash.
+ *
+ *  \param *h state of the hash
+ *  \param *data bytes
+ *  \param size number of bytes
+ */
+void hashUpdate(HASHSTATE *h, const void *data, size_t size)
+{
+  const unsigned char *p = data;
+
+  h->total += size;
+  if (h->numbBuffered + size < 32){                                           /* not a whole stripe yet */
+    memcpy(h->buffer + h->numbBuffered, p, size);
+    h->numbBuffered += size;
+    return;
+  }
+  if (h->numbBuffered > 0){
+    size_t n = 32 - h->numbBuffered;
+    memcpy(h->buffer + h->numbBuffered, p, n);
+    for (int i = 0; i < 4; i++)
+      h->acc[i] = hashRound(h->acc[i], lane64(h->buffer + 8 * i));
+    p += n;
+    size -= n;
+    h->numbBuffered = 0;
+  }
+  for (; size >= 32; p += 32, size -= 32)                                     /* stripes of 4 lanes */
+    for (int i = 0; i < 4; i++)
+      h->acc[i] = hashRound(h->acc[i], lane64(p + 8 * i));
+  memcpy(h->buffer, p, size);
+  h->numbBuffered = size;
+}
+
+/**
+ *  \brief Hash of the bytes added so far, the state is left unchanged (more bytes may be added).
+ *
+ *  \param *h state of the hash
+ *
+ *  \return hash
+ */
+uint64_t hashDigest(const HASHSTATE *h)
+{
+  const unsigned char *p = h->buffer;
+  size_t n = h->numbBuffered;
+  uint64_t hash;
+
+  if (h->total >= 32){
+    hash = rotate(h->acc[0], 1) + rotate(h->acc[1], 7) + rotate(h->acc[2], 12) + rotate(h->acc[3], 18);
+    for (int i = 0; i < 4; i++)
+      hash = hashMerge(hash, h->acc[i]);
+  }
+  else
+    hash = h->seed + PRIME5;
+  hash += h->total;
+
+  for (; n >= 8; p += 8, n -= 8){
+    hash ^= hashRound(0, lane64(p));
+    hash = rotate(hash, 27) * PRIME1 + PRIME4;
+  }
+  if (n >= 4){
+    uint64_t v = (uint64_t) p[0] | (uint64_t) p[1] << 8 | (uint64_t) p[2] << 16 | (uint64_t) p[3] << 24;
+    hash ^= v * PRIME1;
+    hash = rotate(hash, 23) * PRIME2 + PRIME3;
+    p += 4;
+    n -= 4;
+  }
+  for (; n > 0; p++, n--){
+    hash ^= *p * PRIME5;
+    hash = rotate(hash, 11) * PRIME1;
+  }
+
+  hash ^= hash >> 33;                                                         /* avalanche */
+  hash *= PRIME2;
+  hash ^= hash >> 29;
+  hash *= PRIME3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+/**
+ *  \brief Content hash of a block of bytes.
+ *
+ *  \param *data bytes
+ *  \param size number of bytes
+ *  \param seed seed of the hash
+ *
+ *  \return hash
+ */
+uint64_t hashBytes(const void *data, size_t size, uint64_t seed)
+{
+  HASHSTATE h;
+
+  hashStart(&h, seed);
+  hashUpdate(&h, data, size);
+  return hashDigest(&h);
+}
+
+/**
+ *  \brief Path of the entry of a key, in a buffer of the caller.
+ *
+ *  Internal operation.
+ */
+static char *entryPath(uint64_t key, char *path, size_t size)
+{
+  snprintf(path, size, "%s/%016llx.res", cacheDirectory, (unsigned long long) key);
+  return path;
+}
+
+/**
+ *  \brief Open the cache, the directory is created if it does not exist.
+ *
+ *  \param *directory directory of the entries
+ *  \param limit size of the directory, in bytes, above which the least recently used entries are removed
+ *
+ *  \return false if the directory could not be used, the cache being then disabled
+ */
+bool openResultCache(const char *directory, uint64_t limit)
+{
+  struct stat st;
+
+  if (mkdir(directory, 0755) != 0 && errno != EEXIST)
+    return false;
+  if (stat(directory, &st) != 0 || !S_ISDIR(st.st_mode) || access(directory, R_OK | W_OK | X_OK) != 0)
+    return false;
+  cacheDirectory = strdup(directory);
+  cacheLimit = limit;
+  return true;
+}
+
+/**
+ *  \brief Whether the cache was opened.
+ */
+bool resultCacheActive(void)
+{
+  return cacheDirectory != NULL;
+}
+
+/**
+ *  \brief Look up a result.
+ *
+ *  \param key key of the result
+ *  \param *data where the result is stored
+ *  \param size size of the result
+ *
+ *  \return false if there is no valid entry of that key and size
+ */
+bool cacheLookup(uint64_t key, void *data, size_t size)
+{
+  char path[4096];
+  unsigned char header[CACHE_HEADER];
+  uint32_t version;
+  uint64_t entryKey, entrySize, entryHash;
+  bool valid;
+  int fd;
+
+  if (cacheDirectory == NULL || (fd = open(entryPath(key, path, sizeof(path)), O_RDONLY)) < 0)
+    return false;
+  valid = read(fd, header, CACHE_HEADER) == CACHE_HEADER && memcmp(header, CACHE_MAGIC, 8) == 0;
+  if (valid){
+    memcpy(&version, header + 8, sizeof(uint32_t));
+    memcpy(&entryKey, header + 16, sizeof(uint64_t));
+    memcpy(&entrySize, header + 24, sizeof(uint64_t));
+    memcpy(&entryHash, header + 32, sizeof(uint64_t));
+    valid = version == CACHE_VERSION && entryKey == key && entrySize == size
+            && read(fd, data, size) == (ssize_t) size && hashBytes(data, size, key) == entryHash;
+  }
+  if (valid)
+    futimens(fd, NULL);                                                       /* most recently used */
+  close(fd);
+  if (!valid)                                                                 /* damaged or stale, never used again */
+    unlink(path);
+  return valid;
+}
+
+/**
+ *  \brief Store a result, replacing the entry of the same key (the entry is written apart and then renamed, so
+ *  that a run that stops halfway never leaves a damaged entry under the key).
+ *
+ *  \param key key of the result
+ *  \param *data result
+ *  \param size size of the result
+ *
+ *  \return false if the entry could not be written
+ */
+bool cacheStore(uint64_t key, const void *data, size_t size)
+{
+  char path[4096], temporary[4200];
+  unsigned char header[CACHE_HEADER] = {0};
+  uint32_t version = CACHE_VERSION;
+  uint64_t entrySize = size, entryHash = hashBytes(data, size, key);
+  bool written;
+  int fd;
+
+  if (cacheDirectory == NULL)
+    return false;
+  entryPath(key, path, sizeof(path));
+  snprintf(temporary, sizeof(temporary), "%s.%d.tmp", path, (int) getpid());
+  if ((fd = open(temporary, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0)
+    return false;
+  memcpy(header, CACHE_MAGIC, 8);
+  memcpy(header + 8, &version, sizeof(uint32_t));
+  memcpy(header + 16, &key, sizeof(uint64_t));
+  memcpy(header + 24, &entrySize, sizeof(uint64_t));
+  memcpy(header + 32, &entryHash, sizeof(uint64_t));
+  written = write(fd, header, CACHE_HEADER) == CACHE_HEADER && write(fd, data, size) == (ssize_t) size;
+  if (close(fd) != 0 || !written || rename(temporary, path) != 0){
+    unlink(temporary);
+    return false;
+  }
+  return true;
+}
+
+/**
+ *  \brief Order of the entries, least recently used first, for qsort.
+ *
+ *  Internal operation.
+ */
+static int compareUse(const void *a, const void *b)
+{
+  const CACHEFILE *x = a, *y = b;
+  return x->used < y->used ? -1 : x->used > y->used;
+}
+
+/**
+ *  \brief Close the cache, removing the least recently used entries while the directory is above its limit.
+ */
+void closeResultCache(void)
+{
+  DIR *dir;
+  struct dirent *e;
+  CACHEFILE *files = NULL;
+  size_t numbFiles = 0, size = 0, i;
+  uint64_t total = 0;
+  char path[4096];
+
+  if (cacheDirectory == NULL)
+    return;
+  if ((dir = opendir(cacheDirectory)) != NULL){
+    while ((e = readdir(dir)) != NULL){
+      struct stat st;
+      size_t length = strlen(e->d_name);
+      if (length < 4 || strcmp(e->d_name + length - 4, ".res") != 0)
+        continue;
+      snprintf(path, sizeof(path), "%s/%s", cacheDirectory, e->d_name);
+      if (stat(path, &st) != 0)
+        continue;
+      if (numbFiles == size)
+        files = (CACHEFILE *) realloc(files, sizeof(CACHEFILE) * (size = 2 * size + 16));
+      files[numbFiles].name = strdup(path);
+      files[numbFiles].used = st.st_mtime;
+      files[numbFiles++].size = st.st_size;
+      total += st.st_size;
+    }
+    closedir(dir);
+  }
+  qsort(files, numbFiles, sizeof(CACHEFILE), compareUse);
+  for (i = 0; i < numbFiles; i++){
+    if (total > cacheLimit && unlink(files[i].name) == 0)
+      total -= files[i].size;
+    free(files[i].name);
+  }
+  free(files);
+  free(cacheDirectory);
+  cacheDirectory = NULL;
+}
@@ -0,0 +1,142 @@
+/**
+ *  \file resultCheck.c (implementation file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - April 2020
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <math.h>
+
+#include "probConst.h"
+#include "TOLERANCE.h"
+#include "ERRORSTATS.h"
+#include "resultCheck.h"
+
+/** \brief tolerances of the run, none by default */
+TOLERANCE tolerance = {0, 0, 0};
+
+bool parseTolerance(const char *text)
+{
+  TOLERANCE t;
+  char end;
+
+  if (sscanf(text, "%lf:%lf:%" SCNu64 "%c", &t.absolute, &t.relative, &t.ulps, &end) != 3 || !(t.absolute >= 0)
+      || !(t.relative >= 0))
+    return false;
+  tolerance = t;
+  return true;
+}
+
+/**
+ *  \brief Distance of two doubles in units in the last place, the number of doubles between them.
+ *
+ *  Internal operation.
+ *
+ *  \return the distance, UINT64_MAX if one is not a number
+ */
+static uint64_t ulpDistance(double a, double b)
+{
+  int64_t i, j;
+
+  if (isnan(a) || isnan(b))
+    return UINT64_MAX;
+  memcpy(&i, &a, sizeof(double));
+  memcpy(&j, &b, sizeof(double));
+  if (i < 0)                                                         /* ordered as the doubles, -0 and +0 together */
+    i = INT64_MIN - i;
+  if (j < 0)
+    j = INT64_MIN - j;
+  return i > j ? (uint64_t) i - (uint64_t) j : (uint64_t) j - (uint64_t) i;
+}
+
+/**
+ *  \brief Bin of the histogram of a relative error.
+ *
+ *  Internal operation.
+ */
+static int errorBin(double error, double relative)
+{
+  int bin;
+
+  if (error == 0)
+    return 0;
+  if (relative >= 1e-1)
+    return ERROR_BINS - 1;
+  bin = (int) floor(log10(relative)) + ERROR_BINS;
+  return bin < 1 ? 1 : bin > ERROR_BINS - 2 ? ERROR_BINS - 2 : bin;
+}
+
+bool withinTolerance(double expected, double value, double bound)
+{
+  double error = fabs(expected - value);
+
+  return error <= bound + fmax(tolerance.absolute, tolerance.relative * fabs(expected))
+         || (tolerance.ulps > 0 && ulpDistance(expected, value) <= tolerance.ulps);
+}
+
+bool checkLag(ERRORSTATS *errors, size_t lag, double expected, double value, double bound)
+{
+  double error = fabs(expected - value), relative;
+  uint64_t ulps = ulpDistance(expected, value);
+  bool correct = withinTolerance(expected, value, bound);
+
+  if (isnan(error))                                                        /* worse than any other error */
+    error = INFINITY;
+  relative = error == 0 ? 0 : error / fabs(expected);
+  if (errors->numbChecked++ == 0 || error > errors->maxError){
+    errors->maxError = error;
+    errors->maxErrorLag = lag;
+  }
+  errors->maxRelative = fmax(errors->maxRelative, relative);
+  errors->maxUlps = ulps > errors->maxUlps ? ulps : errors->maxUlps;
+  errors->histogram[errorBin(error, relative)]++;
+  if (!correct && (errors->numbErrors++ == 0 || lag < errors->firstError))
+    errors->firstError = lag;
+  return correct;
+}
+
+void mergeErrors(ERRORSTATS *into, const ERRORSTATS *from)
+{
+  if (from->numbChecked == 0)
+    return;
+  if (into->numbChecked == 0 || from->maxError > into->maxError){
+    into->maxError = from->maxError;
+    into->maxErrorLag = from->maxErrorLag;
+  }
+  if (from->numbErrors > 0 && (into->numbErrors == 0 || from->firstError < into->firstError))
+    into->firstError = from->firstError;
+  into->maxRelative = fmax(into->maxRelative, from->maxRelative);
+  into->maxUlps = from->maxUlps > into->maxUlps ? from->maxUlps : into->maxUlps;
+  into->numbChecked += from->numbChecked;
+  into->numbErrors += from->numbErrors;
+  for (int bin = 0; bin < ERROR_BINS; bin++)
+    into->histogram[bin] += from->histogram[bin];
+}
+
+void printErrors(FILE *out, const ERRORSTATS *errors, double bound)
+{
+  if (errors->numbChecked == 0)
+    return;
+  fprintf(out, "   max absolute error %.3e at lag %lu, max relative error %.3e, max %llu ulps, error bound of the samples %.3e\n",
+          errors->maxError, errors->maxErrorLag, errors->maxRelative, (unsigned long long) errors->maxUlps, bound);
+  if (errors->numbErrors > 0)
+    fprintf(out, "   first lag out of tolerance %lu\n", errors->firstError);
+  fprintf(out, "   relative errors:");
+  for (int bin = 0; bin < ERROR_BINS; bin++)
+    if (errors->histogram[bin] > 0){
+      if (bin == 0)
+        fprintf(out, " exact %lu", errors->histogram[bin]);
+      else if (bin == ERROR_BINS - 1)
+        fprintf(out, " >=1e-1 %lu", errors->histogram[bin]);
+      else
+        fprintf(out, " <1e%d %lu", bin - ERROR_BINS + 1, errors->histogram[bin]);
+    }
+  fprintf(out, "\n");
+}
@@ -0,0 +1,83 @@
+/**
+ *  \file resultCheck.h (interface file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  Check of the results against the expected ones, a lag at a time, by whichever process or thread has the result
+ *  at hand as soon as it is computed, the errors of each file being merged afterwards (see ERRORSTATS.h).
+ *
+ *  A lag is correct when |expected - result| <= bound + max(absolute, relative * |expected|), bound being the error
+ *  the computation of that lag is allowed (the samples stored as float or int16, a sum added in another order, the
+ *  FFT engine), or when the result is at most ulps units in the last place away from the expected value. With no
+ *  tolerance and no bound, the check is exact.
+ *
+ *  The relative error of a lag is |expected - result| / |expected|; its decade picks the bin of the histogram, from
+ *  exact (bin 0) through below 1e-16 (bin 1) up to 1e-1 and above (bin ERROR_BINS - 1).
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - April 2020
+ */
+
+#ifndef RESULTCHECK_H
+#define RESULTCHECK_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "TOLERANCE.h"
+#include "ERRORSTATS.h"
+
+/** \brief tolerances of the run, none by default */
+extern TOLERANCE tolerance;
+
+/**
+ *  \brief Set the tolerances of the run from their text.
+ *
+ *  \param *text absolute:relative:ulps, such as 0:1e-12:4
+ *
+ *  \return false if the text is not valid, the tolerances being kept
+ */
+extern bool parseTolerance(const char *text);
+
+/**
+ *  \brief Whether a result is within the tolerances of its expected value.
+ *
+ *  \param expected expected value
+ *  \param value    result
+ *  \param bound    error the computation of the lag is allowed
+ *
+ *  \return true if it is correct
+ */
+extern bool withinTolerance(double expected, double value, double bound);
+
+/**
+ *  \brief Check a lag, its error being added to the errors of its file.
+ *
+ *  \param *errors  errors of the file
+ *  \param lag      lag
+ *  \param expected expected value
+ *  \param value    result
+ *  \param bound    error the computation of the lag is allowed
+ *
+ *  \return true if it is correct
+ */
+extern bool checkLag(ERRORSTATS *errors, size_t lag, double expected, double value, double bound);
+
+/**
+ *  \brief Add the errors of a part of the lags of a file to the ones of the file.
+ *
+ *  \param *into errors of the file
+ *  \param *from errors of the part
+ */
+extern void mergeErrors(ERRORSTATS *into, const ERRORSTATS *from);
+
+/**
+ *  \brief Print the errors of a file: the largest ones with their location, the first lag out of tolerance and the
+ *  histogram of the relative errors.
+ *
+ *  \param *out    where the errors are printed
+ *  \param *errors errors of the file
+ *  \param bound   error bound of the samples of the file
+ */
+extern void printErrors(FILE *out, const ERRORSTATS *errors, double bound);
+
+#endif /* RESULTCHECK_H */
@@ -10,133 +10,643 @@
 #include <unistd.h>
 #include <pthread.h>
 #include <errno.h>
-#include <stdio.h> 
+#include <stdio.h>
+#include <string.h>
+#include <complex.h>
+#include <math.h>
+#include <float.h>
+#include <fcntl.h>
+#include <stdint.h>
 
 #include "probConst.h"
 #include "FILEINFO.h"
 #include "CONTROLINFO.h"
+#include "SIGNALINFO.h"
+#include "PAIRINFO.h"
+#include "LAGPEAK.h"
+#include "STREAMINFO.h"
+#include "streamCorrelation.h"
+#include "SIGNALRECORD.h"
+#include "signalFile.h"
+#include "fileList.h"
+#include "HASHSTATE.h"
+#include "resultCache.h"
+#include "placement.h"
+#include "TRACEEVENT.h"
+#include "traceLog.h"
+#include "progressMetrics.h"
+#include "TUNING.h"
+#include "autotune.h"
+#include "TOLERANCE.h"
+#include "ERRORSTATS.h"
+#include "resultCheck.h"
+#include "JOBINFO.h"
 
 
 /** \brief producer threads return status array */
-extern int statusWorkers[NUMB_THREADS];
+extern int statusWorkers[MAX_THREADS];
 
-/** \brief names of files to process */
-char* filesToProcess[MAX_FILES];
+/** \brief jobs whose lags are being handed out, in the order they were submitted */
+static JOBINFO *jobs[MAX_JOBS];
 
-/** \brief array with information for each file file */
-FILEINFO *filesManager;
+/** \brief number of jobs whose lags are being handed out */
+static unsigned int numbJobs;
 
-/** \brief number of files to process */
-unsigned int numbFiles;
+/** \brief job each worker was last given a piece of work of, NULL for none */
+static JOBINFO *serving[MAX_THREADS];
 
-/** \brief file position in array with all names */
-unsigned int filePosition;
-
-/** \brief file pointer */
-static FILE* filePointer;
+/** \brief no more jobs are submitted */
+static bool closed;
 
 /** \brief locking flag which warrants mutual exclusion inside the monitor */
 pthread_mutex_t accessF = PTHREAD_MUTEX_INITIALIZER;
 
-/** \brief locking flag which warrants mutual exclusion inside the monitor */
-pthread_mutex_t accessR = PTHREAD_MUTEX_INITIALIZER;
+/** \brief locking flag which warrants mutual exclusion inside the listing of the files and the result cache */
+static pthread_mutex_t accessC = PTHREAD_MUTEX_INITIALIZER;
+
+/** \brief workers wait for a job to be submitted or the jobs to be closed */
+static pthread_cond_t arrival = PTHREAD_COND_INITIALIZER;
+
+static bool loadSignalFile(JOBINFO *job, size_t fileId);
+
+/**
+ *  \brief Signal that the results of a job are complete, once its lags are handed out and their results saved.
+ *
+ *  Internal monitor operation, inside the monitor of the results of the job.
+ */
+static void checkCompletion(JOBINFO *job)
+{
+  if (job->drained && job->pending == 0 && !job->done){
+    job->done = true;
+    pthread_cond_broadcast(&job->finished);
+  }
+}
+
+/**
+ *  \brief Number of bytes of a sample of x or y.
+ *
+ *  Internal operation.
+ */
+static size_t sampleBytes(JOBINFO *job)
+{
+  return job->singleStorage ? sizeof(float) : sizeof(double);
+}
+
+/**
+ *  \brief Allocate memory for the samples of x or y, as float or as double.
+ *
+ *  Internal operation.
+ */
+static void *allocSignal(JOBINFO *job, size_t count)
+{
+  return job->singleStorage ? (void *) allocSingles(count) : (void *) allocSamples(count);
+}
+
+/**
+ *  \brief Key of the rxy of a file in the result cache: content hash of its signals and the parameters the result
+ *  depends on.
+ *
+ *  Internal monitor operation.
+ */
+static uint64_t resultKey(JOBINFO *job, FILEINFO *fi)
+{
+  uint64_t parameters[3] = {fi->numbSamples, fi->autocorrelation, job->splitLeaf};
+  HASHSTATE h;
+
+  hashStart(&h, 0);                                                       /* floats and doubles are keyed apart */
+  hashUpdate(&h, job->singleStorage ? (void *) fi->xSingle : (void *) fi->x, sampleBytes(job) * fi->numbSamples);
+  if (!fi->autocorrelation)
+    hashUpdate(&h, job->singleStorage ? (void *) fi->ySingle : (void *) fi->y, sampleBytes(job) * fi->numbSamples);
+  return hashBytes(parameters, sizeof(parameters), hashDigest(&h));
+}
+
+/**
+ *  \brief Choose the file of the next piece of work of a job: the active files are served in round robin and, once
+ *  one has handed out all its work, the largest file not started yet takes its place.
+ *
+ *  Internal monitor operation.
+ *
+ *  \param *job job
+ *  \param workerId worker identification
+ *  \param workLeft whether a file still has work to hand out
+ *  \param load whether the signals of a file are loaded when it is started
+ *  \param *fileId where the file is stored
+ *
+ *  \return false if all the work of the job was handed out
+ */
+static bool scheduleFile(JOBINFO *job, unsigned int workerId, bool (*workLeft)(JOBINFO *, size_t), bool load,
+                         size_t *fileId)
+{
+  FILEINFO *files = job->filesManager;
+
+  while (true){
+    while (job->numbActive < ACTIVE_FILES && job->filePosition < job->numbFiles){      /* start the largest pending ones */
+      size_t id = job->schedule[job->filePosition++];
+      if (load && !files[id].read && !loadSignalFile(job, id)){                   /* left out, the others go on */
+        fprintf(stderr, "error on reading %s\n", job->filesToProcess[id]);
+        files[id].failed = true;
+        continue;
+      }
+      if (load)
+        files[id].node = workerNode(workerId);                           /* where the signals were written first */
+      job->activeFiles[job->numbActive++] = id;
+    }
+    setQueueDepth(job->numbActive + job->numbFiles - job->filePosition);
+    if (job->numbActive == 0)
+      return false;
+    job->nextActive %= job->numbActive;
+    if (workLeft(job, job->activeFiles[job->nextActive])){
+      *fileId = job->activeFiles[job->nextActive++];
+      return true;
+    }
+    job->activeFiles[job->nextActive] = job->activeFiles[--job->numbActive];         /* all its work was handed out */
+  }
+}
+
+/**
+ *  \brief Signals of a file for a worker: with the workers placed on several NUMA nodes, the copy of the node of the
+ *  worker, made the first time a worker of that node needs it (and so placed on that node), the signals read being
+ *  on the node of the worker that loaded them.
+ *
+ *  Internal monitor operation.
+ */
+static void signalsOfNode(JOBINFO *job, unsigned int workerId, FILEINFO *fi, const void **x, const void **y)
+{
+  int node = workerNode(workerId);
+  size_t bytes = sampleBytes(job) * fi->numbSamples;
+
+  *x = job->singleStorage ? (const void *) fi->xSingle : (const void *) fi->x;
+  *y = job->singleStorage ? (const void *) fi->ySingle : (const void *) fi->y;
+  if (node < 0 || node == fi->node || numbNodes() < 2)
+    return;
+  if (fi->copies == NULL)
+    fi->copies = (void**)calloc(2 * numbNodes(), sizeof(void*));
+  if (fi->copies[2*node] == NULL && (fi->copies[2*node] = allocSignal(job, fi->numbSamples)) != NULL){
+    memcpy(fi->copies[2*node], *x, bytes);
+    if (*y == *x)
+      fi->copies[2*node+1] = fi->copies[2*node];
+    else if ((fi->copies[2*node+1] = allocSignal(job, fi->numbSamples)) != NULL)
+      memcpy(fi->copies[2*node+1], *y, bytes);
+  }
+  if (fi->copies[2*node] != NULL && fi->copies[2*node+1] != NULL){            /* else the signals read are shared */
+    *x = fi->copies[2*node];
+    *y = fi->copies[2*node+1];
+  }
+}
+
+/**
+ *  \brief Release the copies of the signals of a file on the NUMA nodes.
+ *
+ *  Internal operation.
+ */
+static void freeCopies(FILEINFO *fi)
+{
+  if (fi->copies == NULL)
+    return;
+  for (unsigned int node = 0; node < numbNodes(); node++){
+    if (fi->copies[2*node+1] != fi->copies[2*node])
+      free(fi->copies[2*node+1]);
+    free(fi->copies[2*node]);
+  }
+  free(fi->copies);
+}
+
+/**
+ *  \brief Release the signals of a file and their copies.
+ *
+ *  Internal operation.
+ */
+static void freeSignals(FILEINFO *fi)
+{
+  if (fi->y != fi->x)
+    free(fi->y);
+  free(fi->x);
+  if (fi->ySingle != fi->xSingle)
+    free(fi->ySingle);
+  free(fi->xSingle);
+  freeCopies(fi);
+}
+
+/**
+ *  \brief Release a job, once its results are printed.
+ *
+ *  Internal operation.
+ */
+static void freeJob(JOBINFO *job)
+{
+  freeSignalRecords(job->filePaths, job->fileRecords, job->filesToProcess, job->numbFiles);
+  free(job->filesManager);
+  free(job->schedule);
+  pthread_mutex_destroy(&job->access);
+  pthread_cond_destroy(&job->finished);
+  free(job);
+}
+
+/**
+ *  \brief Whether there are lags of a file still to hand out, the mirrored half of an autocorrelation excluded.
+ *
+ *  Internal monitor operation.
+ */
+static bool lagsLeft(JOBINFO *job, size_t fileId)
+{
+  FILEINFO *fi = &job->filesManager[fileId];
+  return fi->rxyIndex < (fi->autocorrelation ? fi->numbSamples / 2 + 1 : fi->numbSamples);
+}
+
+/**
+ *  \brief Whether there are lags of the lag window of a file still to hand out.
+ *
+ *  Internal monitor operation.
+ */
+static bool windowLeft(JOBINFO *job, size_t fileId)
+{
+  return job->filesManager[fileId].rxyIndex <= job->filesManager[fileId].lastLag;
+}
+
+/**
+ *  \brief Whether there are blocks of a stream still to hand out.
+ *
+ *  Internal monitor operation.
+ */
+static bool blocksLeft(JOBINFO *job, size_t fileId)
+{
+  return job->streams[fileId].nextLag < job->streams[fileId].numbSamples;
+}
 
-/** \brief flag which warrants that the data transfer region is initialized exactly once */
-pthread_once_t init = PTHREAD_ONCE_INIT;
+/**
+ *  \brief Pairwise (tree) sum of the parts of a lag, always in the same order.
+ *
+ *  Internal monitor operation.
+ */
+static double pairwiseSum(double *parts, size_t numbParts)
+{
+  if (numbParts == 1)
+    return parts[0];
+  return pairwiseSum(parts, numbParts / 2) + pairwiseSum(parts + numbParts / 2, numbParts - numbParts / 2);
+}
+
+/**
+ *  \brief Error a lag of a file is allowed on top of the tolerances of the run (see resultCheck.h).
+ *
+ *  When the sum of each lag was split, the result is not added in the same order as the expected one, so it is
+ *  compared with the error bound of a sum of n terms, 2 * n * eps * sqrt(sum x^2 * sum y^2). The same holds for the
+ *  mirrored half of an autocorrelation. The lag windows computed with the FFT engine are allowed FFT_TOLERANCE of
+ *  the expected value. Samples stored as float or int16 add the error bound of their type.
+ *
+ *  Internal operation.
+ */
+static double lagBound(JOBINFO *job, FILEINFO *fi, size_t lag)
+{
+  if (job->lagQuery){
+    double expected = fabs(fi->expected[lag - fi->firstLag]);
+    return fi->lastLag + 1 - fi->firstLag > tuning.fftCrossover * log2((double)fi->numbSamples)
+           ? FFT_TOLERANCE * (expected > 1 ? expected : 1) + fi->sampleError : fi->sampleError;
+  }
+  return fi->sampleError + (fi->numbLeaves > 1 || (fi->autocorrelation && lag > fi->numbSamples / 2)
+                            ? 2 * fi->numbSamples * DBL_EPSILON * fi->norm : 0);
+}
 
 /**
- *  \brief Initialization of the shared region.
+ *  \brief Store the result of a lag, and of its mirror lag n - lag when the file is an autocorrelation, and check
+ *  them against the expected ones as they arrive.
  *
  *  Internal monitor operation.
  */
-void initialization (void)
+static void storeLag(JOBINFO *job, FILEINFO *fi, size_t lag, double value)
+{
+  fi->result[lag] = value;
+  checkLag(&fi->errors, lag, fi->expected[lag], value, lagBound(job, fi, lag));
+  if (fi->autocorrelation && lag > 0 && fi->numbSamples - lag != lag){              /* r[n-k] = r[k] */
+    fi->result[fi->numbSamples - lag] = value;
+    checkLag(&fi->errors, fi->numbSamples - lag, fi->expected[fi->numbSamples - lag], value,
+             lagBound(job, fi, fi->numbSamples - lag));
+  }
+}
+
+/**
+ *  \brief New job, with no files yet.
+ *
+ *  Operation carried out by the main thread, or by the thread of a request to the server.
+ *
+ *  \param priority the lags of the jobs of a higher priority are handed out first
+ *
+ *  \return job
+ */
+JOBINFO *newJob(int priority)
+{
+  JOBINFO *job = (JOBINFO *)calloc(1, sizeof(JOBINFO));
+
+  job->priority = priority;
+  job->queryLastLag = (size_t) -1;
+  pthread_mutex_init(&job->access, NULL);
+  pthread_cond_init(&job->finished, NULL);
+  return job;
+}
+
+/**
+ *  \brief Take every file of a job as an autocorrelation, y being ignored.
+ *
+ *  Files whose x and y are equal are always detected as such.
+ *
+ *  Operation carried out before the job is submitted.
+ *
+ *  \param *job job
+ */
+void presentAutocorrelation(JOBINFO *job)
 {
-  filePosition = 0;                                        /* shared region filepointer and byte pointer are both 0 */
-  filesManager = (FILEINFO*)malloc(sizeof(FILEINFO)*numbFiles);
-  filePointer = NULL;
+  job->forceAutocorrelation = true;
+}
+
+/**
+ *  \brief Split the sum of each lag in parts of leafSize samples, reduced by a pairwise sum.
+ *
+ *  Operation carried out before the job is submitted.
+ *
+ *  \param *job job
+ *  \param leafSize number of samples of each part, 0 to not split
+ */
+void presentSplitSum(JOBINFO *job, size_t leafSize)
+{
+  job->splitLeaf = leafSize;
+}
+
+/**
+ *  \brief Store x and y as float, half the bytes the workers go through, the sums being still in double.
+ *
+ *  Operation carried out before the job is submitted.
+ *
+ *  \param *job job
+ */
+void presentSingleStorage(JOBINFO *job)
+{
+  job->singleStorage = true;
+}
+
+/**
+ *  \brief Report the errors of the results of each file: the largest ones and where, and their histogram (see
+ *  resultCheck.h).
+ *
+ *  Operation carried out before the job is submitted.
+ *
+ *  \param *job job
+ */
+void presentErrorReport(JOBINFO *job)
+{
+  job->errorReport = true;
 }
 
 
 /**
  *  \brief Insert the names of the files to be processed in an array.
  *
- *  Operation carried out by the main thread.
+ *  Operation carried out by the main thread, or by the thread of a request to the server.
  *
+ *  The size of every record is read up front, the files being started largest first (the work of a file grows with
+ *  the square of its size), so that a big file is not left alone at the end of the run.
+ *
+ *  \param *job job
  *  \param listOfFiles names of files to process
  *  \param size number of text files to be processed
+ *
+ *  \return false if there are no files to process
+ */
+bool presentDataFileNames(JOBINFO *job, char *listOfFiles[], unsigned int size){
+  pthread_mutex_lock(&accessC);                                        /* several requests to the server at once */
+  unsigned int numbFiles = job->numbFiles = listSignalRecords(listOfFiles, size, &job->filePaths, &job->fileRecords,
+                                                              &job->filesToProcess);           /* each record apart */
+
+  uint64_t *cost = (uint64_t*)calloc(numbFiles > 0 ? numbFiles : 1, sizeof(uint64_t));
+  presentMetricFiles(numbFiles);
+  for (size_t i = 0; i < numbFiles; i++){
+    SIGNALRECORD r;
+    int fd;
+    nameMetricFile(i, job->filesToProcess[i], 0);                                /* its lags are known once loaded */
+    if (strcmp(job->filePaths[i], "-") != 0 && (fd = open(job->filePaths[i], O_RDONLY)) >= 0){
+      if (readSignalHeader(fd, job->fileRecords[i], &r, NULL))
+        cost[i] = (uint64_t) r.numbSamples * r.numbSamples;
+      close(fd);
+    }
+  }
+  job->schedule = largestFirst(cost, numbFiles);
+  pthread_mutex_unlock(&accessC);
+  free(cost);
+  job->filesManager = (FILEINFO*)calloc(numbFiles > 0 ? numbFiles : 1, sizeof(FILEINFO));
+  return numbFiles > 0;
+}
+
+/**
+ *  \brief Hand the lags of a job out to the workers.
+ *
+ *  Operation carried out once the names of the files and the options of the job are inserted.
+ *
+ *  A job with no files is complete at once. At most MAX_JOBS jobs are handed out at a time.
+ *
+ *  \param *job job
  */
-void presentDataFileNames(char *listOfFiles[], unsigned int size){
-  numbFiles = size;
-  for(int i = 0; i < size; i++)
-    filesToProcess[i] = listOfFiles[i];
+void submitJob(JOBINFO *job)
+{
+  pthread_mutex_lock(&accessF);
+  if (job->numbFiles == 0)
+    job->drained = job->done = true;
+  else {
+    jobs[numbJobs++] = job;
+    pthread_cond_broadcast(&arrival);
+  }
+  pthread_mutex_unlock(&accessF);
 }
 
+/**
+ *  \brief Wait until the results of a job are complete.
+ *
+ *  Operation carried out by the thread of a request to the server.
+ *
+ *  \param *job job
+ */
+void waitJob(JOBINFO *job)
+{
+  pthread_mutex_lock(&job->access);
+  while (!job->done)
+    pthread_cond_wait(&job->finished, &job->access);
+  pthread_mutex_unlock(&job->access);
+}
 
 /**
- *  \brief Store a value in the data transfer region.
+ *  \brief No more jobs are submitted, the workers leave once the ones submitted are handed out.
+ *
+ *  Operation carried out by the main thread.
+ */
+void closeJobs(void)
+{
+  pthread_mutex_lock(&accessF);
+  closed = true;
+  pthread_cond_broadcast(&arrival);
+  pthread_mutex_unlock(&accessF);
+}
+
+/**
+ *  \brief Wait until a job has lags to hand out.
  *
  *  Operation carried out by the worker threads.
  *
  *  \param workerId worker identification
- *  \param *x pointer to the array with first signals of the pair
- *  \param *x pointer to the array with second signals of the pair
- *  \param *ci pointer to the shared data structure
+ *
+ *  \return false once the jobs are closed and handed out
  */
-bool getAPieceOfData(unsigned int workerId, double *x, double *y, CONTROLINFO *ci)
+bool waitForJobs(unsigned int workerId)
 {
+  bool any;
+
   if ((statusWorkers[workerId] = pthread_mutex_lock (&accessF)) != 0)                                   /* enter monitor */
-  { 
+  {
     errno = statusWorkers[workerId];                                                            /* save error in errno */
     perror ("error on entering monitor(CF)");
     statusWorkers[workerId] = EXIT_FAILURE;
     pthread_exit (&statusWorkers[workerId]);
   }
-  pthread_once (&init, initialization);                                              /* internal data initialization */
-  
-  if(filePosition == numbFiles){
-    if ((statusWorkers[workerId] = pthread_mutex_unlock (&accessF)) != 0){                                 /* exit monitor */
+
+  while (numbJobs == 0 && !closed)
+    pthread_cond_wait(&arrival, &accessF);
+  any = numbJobs > 0;
+
+  if ((statusWorkers[workerId] = pthread_mutex_unlock (&accessF)) != 0)                                 /* exit monitor */
+  {
     errno = statusWorkers[workerId];                                                            /* save error in errno */
     perror ("error on exiting monitor(CF)");
     statusWorkers[workerId] = EXIT_FAILURE;
     pthread_exit (&statusWorkers[workerId]);
-    }
-    return false;
   }
+  return any;
+}
+
+/**
+ *  \brief Job whose next piece of work a worker is given: one of the highest priority, the one the worker was
+ *  serving unless another one has fewer workers, the first submitted otherwise.
+ *
+ *  Internal monitor operation.
+ *
+ *  \return position of the job, -1 if there is none
+ */
+static int chooseJob(unsigned int workerId)
+{
+  JOBINFO *own = serving[workerId];
+  unsigned int load, bestLoad = 0;
+  int best = -1;
 
-  if(!ci->processing){
-    
-    filePointer = fopen(filesToProcess[filePosition], "rb");
-    size_t samples;
-    size_t i = fread(&samples, sizeof(int), 1, filePointer);
+  for (unsigned int i = 0; i < numbJobs; i++){
+    load = jobs[i]->numbWorkers - (jobs[i] == own ? 1 : 0);                      /* the other workers serving it */
+    if (best < 0 || jobs[i]->priority > jobs[best]->priority
+        || (jobs[i]->priority == jobs[best]->priority && load < bestLoad)){
+      best = i;
+      bestLoad = load;
+    }
+  }
+  if (best >= 0 && jobs[best] != own){
+    if (own != NULL)
+      own->numbWorkers--;
+    jobs[best]->numbWorkers++;
+    serving[workerId] = jobs[best];
+  }
+  return best;
+}
 
-    ci->numbSamples = samples;
-    ci->filePosition = filePosition;
-    ci->processing = true;
-    ci->rxyIndex = 0;
+/**
+ *  \brief Remove a job whose lags are all handed out, it being complete once their results are saved.
+ *
+ *  Internal monitor operation.
+ */
+static void removeJob(int position)
+{
+  JOBINFO *job = jobs[position];
 
-    fread(x, sizeof(double), samples, filePointer);
-    fread(y, sizeof(double), samples, filePointer);
+  for (unsigned int i = position + 1; i < numbJobs; i++)                 /* in the order they were submitted */
+    jobs[i - 1] = jobs[i];
+  numbJobs--;
+  for (unsigned int i = 0; i < MAX_THREADS; i++)
+    if (serving[i] == job)
+      serving[i] = NULL;
+  pthread_mutex_lock(&job->access);
+  job->drained = true;
+  checkCompletion(job);
+  pthread_mutex_unlock(&job->access);
+}
 
-    if(filesManager[filePosition].read == false){
 
-      double real[samples];
-      fread(real, sizeof(double), samples, filePointer);
-      filesManager[filePosition].read = true;
-      filesManager[filePosition].rxyIndex = 0;
-      filesManager[filePosition].filePosition = filePosition;
-      filesManager[filePosition].numbSamples = samples;
+/**
+ *  \brief Store a value in the data transfer region.
+ *
+ *  Operation carried out by the worker threads.
+ *
+ *  The piece of work is one of the job chooseJob selects, the jobs whose lags are all handed out being removed: a
+ *  lag, or a part of its sum, or, for a job of the lag query mode, a block of lags of the window.
+ *
+ *  \param workerId worker identification
+ *  \param **x pointer to the array with first signals of the pair
+ *  \param **y pointer to the array with second signals of the pair
+ *  \param *ci pointer to the shared data structure, set with the file and the lags to compute
+ *  \param **job where the job of the piece of work is stored
+ *
+ *  \return false if no job has lags left
+ */
+bool getAPieceOfData(unsigned int workerId, const void **x, const void **y, CONTROLINFO *ci, JOBINFO **job)
+{
+  FILEINFO *fi = NULL;
+  size_t fileId;
+  int n;
+  double t = traceClock();
 
-      for (size_t t = 0; t < samples; t++){
-        filesManager[filePosition].expected[t]= real[t];
-      }
+  if ((statusWorkers[workerId] = pthread_mutex_lock (&accessF)) != 0)                                   /* enter monitor */
+  {
+    errno = statusWorkers[workerId];                                                            /* save error in errno */
+    perror ("error on entering monitor(CF)");
+    statusWorkers[workerId] = EXIT_FAILURE;
+    pthread_exit (&statusWorkers[workerId]);
+  }
+  traceSpan(workerId, TRACE_LOCK_WAIT, t);
+  t = traceClock();
 
+  while ((n = chooseJob(workerId)) >= 0                                            /* each file is read only once */
+         && !scheduleFile(jobs[n], workerId, jobs[n]->lagQuery ? windowLeft : lagsLeft, true, &fileId))
+    removeJob(n);
+  if(n < 0){
+    traceSpan(workerId, TRACE_LOCK_HELD, t);
+    if ((statusWorkers[workerId] = pthread_mutex_unlock (&accessF)) != 0){                                 /* exit monitor */
+    errno = statusWorkers[workerId];                                                            /* save error in errno */
+    perror ("error on exiting monitor(CF)");
+    statusWorkers[workerId] = EXIT_FAILURE;
+    pthread_exit (&statusWorkers[workerId]);
     }
-    
-    fclose(filePointer);
-    
+    return false;
   }
 
+  JOBINFO *j = *job = jobs[n];
+  fi = &j->filesManager[fileId];
+  ci->numbSamples = fi->numbSamples;
+  ci->filePosition = fileId;
+  ci->rxyIndex = fi->rxyIndex;
+  ci->single = j->singleStorage;
+  ci->query = j->lagQuery;
+  ci->result = 0;
+  if (j->lagQuery){
+    size_t window = fi->lastLag + 1 - fi->firstLag;
+    ci->fft = window > tuning.fftCrossover * log2((double)fi->numbSamples);        /* blocks of wide windows by FFT */
+    ci->numbLags = fi->lastLag + 1 - fi->rxyIndex;
+    if (ci->numbLags > (ci->fft ? FFT_LAG_BLOCK : tuning.lagBlock))
+      ci->numbLags = ci->fft ? FFT_LAG_BLOCK : tuning.lagBlock;
+    fi->rxyIndex += ci->numbLags;
+  } else {
+    ci->leaf = fi->nextLeaf;
+    ci->leafSize = fi->numbLeaves == 1 ? fi->numbSamples : j->splitLeaf;
+    if (++fi->nextLeaf == fi->numbLeaves){                                      /* all the parts of the lag were handed out */
+      fi->nextLeaf = 0;
+      fi->rxyIndex++;
+    }
+  }
+  signalsOfNode(j, workerId, fi, x, y);
+  pthread_mutex_lock(&j->access);                                          /* the results of the piece are awaited */
+  j->pending++;
+  pthread_mutex_unlock(&j->access);
 
+  traceSpan(workerId, TRACE_LOCK_HELD, t);
   if ((statusWorkers[workerId] = pthread_mutex_unlock (&accessF)) != 0)                                 /* exit monitor */
   {
     errno = statusWorkers[workerId];                                                            /* save error in errno */
@@ -144,43 +654,59 @@ bool getAPieceOfData(unsigned int workerId, double *x, double *y, CONTROLINFO *c
     statusWorkers[workerId] = EXIT_FAILURE;
     pthread_exit (&statusWorkers[workerId]);
   }
-  
-  return true;   
+
+  return true;
 }
 
 /**
  *  \brief Get a value from the data transfer region and save it in result data storage.
  *
- *  Operation carried out by the worker threads.
+ *  Operation carried out by the worker threads, inside the monitor of the results of the job.
  *
  *  \param workerId worker identification
+ *  \param *job job of the piece of work
  *	\param *ci pointer to the shared data structure
  *
  *  \return value
  */
-void savePartialResults(unsigned int workerId, CONTROLINFO *ci)
-{                                                                          
+void savePartialResults(unsigned int workerId, JOBINFO *job, CONTROLINFO *ci)
+{
+  double t = traceClock();
+  uint64_t lagsDone = 0;
 
-  if ((statusWorkers[workerId] = pthread_mutex_lock (&accessR)) != 0)                                   /* enter monitor */
-  { 
+  if ((statusWorkers[workerId] = pthread_mutex_lock (&job->access)) != 0)                               /* enter monitor */
+  {
     errno = statusWorkers[workerId];                                                            /* save error in errno */
     perror ("error on entering monitor(CF)");
     statusWorkers[workerId] = EXIT_FAILURE;
     pthread_exit (&statusWorkers[workerId]);
   }
+  traceSpan(workerId, TRACE_LOCK_WAIT, t);
+  t = traceClock();
 
-  filesManager[ci->filePosition].result[ci->rxyIndex] = ci->result;
-  filesManager[ci->filePosition].rxyIndex++;
-  ci->rxyIndex = filesManager[ci->filePosition].rxyIndex;
-  ci->result = 0;
-  if(filesManager[ci->filePosition].rxyIndex == filesManager[ci->filePosition].numbSamples){
-    filePosition++;
-    ci->filePosition++;
-    ci->processing = false;
+  FILEINFO *fi = &job->filesManager[ci->filePosition];
+  if (fi->numbLeaves == 1){
+    storeLag(job, fi, ci->rxyIndex, ci->result);
+    lagsDone = 1;
+  } else {
+    if (fi->partials[ci->rxyIndex] == NULL)
+      fi->partials[ci->rxyIndex] = (double*)malloc(sizeof(double)*fi->numbLeaves);
+    fi->partials[ci->rxyIndex][ci->leaf] = ci->result;
+    if (++fi->leavesDone[ci->rxyIndex] == fi->numbLeaves){                        /* same tree whatever the worker */
+      storeLag(job, fi, ci->rxyIndex, pairwiseSum(fi->partials[ci->rxyIndex], fi->numbLeaves));
+      free(fi->partials[ci->rxyIndex]);
+      fi->partials[ci->rxyIndex] = NULL;
+      lagsDone = 1;
+    }
   }
+  countWork(workerId, ci->filePosition, lagsDone, 2 * sampleBytes(job) * (ci->leafSize < fi->numbSamples ? ci->leafSize : fi->numbSamples), 0);
+  ci->result = 0;
+  job->pending--;
+  checkCompletion(job);
 
-  if ((statusWorkers[workerId] = pthread_mutex_unlock (&accessR)) != 0)                                   /* exit monitor */
-  { 
+  traceSpan(workerId, TRACE_LOCK_HELD, t);
+  if ((statusWorkers[workerId] = pthread_mutex_unlock (&job->access)) != 0)                             /* exit monitor */
+  {
     errno = statusWorkers[workerId];                                                             /* save error in errno */
     perror ("error on exiting monitor(CF)");
     statusWorkers[workerId] = EXIT_FAILURE;
@@ -189,27 +715,755 @@ void savePartialResults(unsigned int workerId, CONTROLINFO *ci)
 }
 
 /**
- *  \brief Print all the results stored in result data storage.
+ *  \brief Print the results of the lag query mode.
  *
- *  Operation carried out by the main thread.
+ *  The lags of the window were checked by the workers as they saved their blocks, those of the peaks included.
+ *
+ *  Internal operation.
  *
+ *  \return false if a file could not be read or not all the lags of its window were checked
  */
-void printResults(){
-  
-  size_t i, x, numbErrors;
+static bool printQueryResults(JOBINFO *job, FILE *out)
+{
+  size_t i, x;
+  bool ok = true;
 
-  for (i = 0; i < numbFiles; i++){
-    numbErrors = 0;
-    for (x = 0; x < filesManager[i].numbSamples; x++){
-      if (filesManager[i].expected[x] != filesManager[i].result[x]) {
-          numbErrors++;
-      }
+  for (i = 0; i < job->numbFiles; i++){
+    FILEINFO *fi = &job->filesManager[i];
+    if (fi->failed){
+      fprintf(out, "File %s could not be read.\n", job->filesToProcess[i]);
+      ok = false;
+    }
+    else if (fi->firstLag >= fi->numbSamples)                      /* the window starts past the end of the signal */
+      fprintf(out, "File %s has no lags %lu to %lu, its signals have %lu samples.\n", job->filesToProcess[i],
+              job->queryFirstLag, job->queryLastLag, fi->numbSamples);
+    else if (fi->errors.numbChecked != fi->lastLag + 1 - fi->firstLag){                    /* a worker left the run */
+      fprintf(out, "File %s was not computed completely, %lu of its %lu lags were checked.\n", job->filesToProcess[i],
+              fi->errors.numbChecked, fi->lastLag + 1 - fi->firstLag);
+      ok = false;
+    }
+    else if (job->queryPeaks == 0){
+      if (fi->errors.numbErrors == 0)
+        fprintf(out, "File %s was calculated correctly for lags %lu to %lu.\n", job->filesToProcess[i], fi->firstLag,
+                fi->lastLag);
+      else
+        fprintf(out, "File %s had %lu errors in lags %lu to %lu.\n", job->filesToProcess[i], fi->errors.numbErrors,
+                fi->firstLag, fi->lastLag);
+    }
+    else {
+      fprintf(out, "File %s, top %lu peaks in lags %lu to %lu:\n", job->filesToProcess[i], fi->numbPeaks, fi->firstLag,
+              fi->lastLag);
+      for (x = 0; x < fi->numbPeaks; x++)
+        fprintf(out, "   lag %lu: %f%s\n", fi->peaks[x].lag, fi->peaks[x].value,
+                withinTolerance(fi->expected[fi->peaks[x].lag - fi->firstLag], fi->peaks[x].value,
+                                lagBound(job, fi, fi->peaks[x].lag)) ? "" : " (wrong)");
+    }
+    if (job->errorReport && !fi->failed && fi->firstLag < fi->numbSamples)
+      printErrors(out, &fi->errors, fi->sampleError);
+    freeSignals(fi);
+    free(fi->result);
+    free(fi->expected);
+    free(fi->peaks);
+  }
+
+  freeJob(job);
+  return ok;
+}
+
+/**
+ *  \brief Print the results of each file of a job, and release the job.
+ *
+ *  The lags were checked as they were stored (see storeLag), those found in the result cache by the worker which
+ *  loaded the file. The rxy computed are kept in the result cache, when it is open, if all of their lags are right.
+ *
+ *  Operation carried out by the main thread, or by the thread of a request to the server, once the job is complete.
+ *
+ *  \param *job job
+ *  \param *out where the results are printed
+ *
+ *  \return false if a file could not be read or not all of its lags were checked
+ */
+bool printResults(JOBINFO *job, FILE *out){
+
+  size_t i;
+  bool ok = true;
+  FILEINFO *filesManager = job->filesManager;
+
+  if (job->lagQuery)
+    return printQueryResults(job, out);
+  for (i = 0; i < job->numbFiles; i++){
+    if (filesManager[i].failed){
+      fprintf(out, "File %s could not be read.\n", job->filesToProcess[i]);
+      ok = false;
+    } else if (filesManager[i].errors.numbChecked != filesManager[i].numbSamples){  /* a worker left the run */
+      fprintf(out, "File %s was not computed completely, %lu of its %lu lags were checked.\n", job->filesToProcess[i],
+              filesManager[i].errors.numbChecked, filesManager[i].numbSamples);
+      ok = false;
+    } else {
+      if (!filesManager[i].cached && filesManager[i].errors.numbErrors == 0 && resultCacheActive()){  /* only right ones */
+        pthread_mutex_lock(&accessC);
+        cacheStore(filesManager[i].cacheKey, filesManager[i].result, sizeof(double) * filesManager[i].numbSamples);
+        pthread_mutex_unlock(&accessC);
+      }
+      if(filesManager[i].errors.numbErrors==0)
+        fprintf(out, "File %s was calculated correctly.\n", job->filesToProcess[i]);
+      else
+        fprintf(out, "File %s had %lu errors in total.\n", job->filesToProcess[i], filesManager[i].errors.numbErrors);
+    }
+    if (job->errorReport && !filesManager[i].failed)
+      printErrors(out, &filesManager[i].errors, filesManager[i].sampleError);
+    freeSignals(&filesManager[i]);
+    free(filesManager[i].result);
+    free(filesManager[i].expected);
+    free(filesManager[i].partials);
+    free(filesManager[i].leavesDone);
+  }
+
+  freeJob(job);
+  return ok;
+}
+
+/**
+ *  \brief Read both signals of a file, keeping only the ones not seen before.
+ *
+ *  Internal operation.
+ *
+ *  \param *job job
+ *  \param fileId index of the file in filesToProcess
+ *  \param isTemplate true if the signals of this file are templates
+ *
+ *  \return false if the file could not be read
+ */
+static bool loadSignalsOfFile(JOBINFO *job, size_t fileId, bool isTemplate)
+{
+  SIGNALINFO *signals = job->signals;
+  int fd;
+  size_t samples;
+  size_t c, s;
+  SIGNALRECORD r;
+
+  if ((fd = open(job->filePaths[fileId], O_RDONLY)) < 0){
+    perror ("error on file opening for reading");
+    return false;
+  }
+  if (!readSignalHeader(fd, job->fileRecords[fileId], &r, NULL)){
+    fprintf(stderr, "error on reading the size of the signals in %s\n", job->filesToProcess[fileId]);
+    close(fd);
+    return false;
+  }
+  samples = r.numbSamples;
+
+  for (c = 0; c < 2; c++){
+    double *data = allocSamples(samples);
+    if (data == NULL || !readSignalSamples(fd, &r, c, 0, samples, data)){
+      fprintf(stderr, "error on reading the signals in %s\n", job->filesToProcess[fileId]);
+      free(data);
+      close(fd);
+      return false;
+    }
+    for (s = 0; s < job->numbSignals; s++)                                    /* the same signal is only correlated once */
+      if (signals[s].numbSamples == (size_t)samples && signals[s].isTemplate == isTemplate
+          && memcmp(signals[s].samples, data, sizeof(double)*samples) == 0)
+        break;
+    if (s < job->numbSignals){
+      free(data);
+      continue;
+    }
+    signals[job->numbSignals].isTemplate = isTemplate;
+    signals[job->numbSignals].filePosition = fileId;
+    signals[job->numbSignals].component = c == 0 ? 'x' : 'y';
+    signals[job->numbSignals].numbSamples = samples;
+    signals[job->numbSignals].samples = data;
+    signals[job->numbSignals].spectrum = NULL;
+    job->numbSignals++;
+  }
+
+  close(fd);
+  return true;
+}
+
+/**
+ *  \brief Load the signals of the batch (all-pairs) mode and list the pairs to correlate.
+ *
+ *  Operation carried out by the main thread, before the worker threads are created.
+ *
+ *  \param *job job
+ *  \param numbTemplates number of files, at the start of the list, whose signals are templates (0 for all pairs)
+ *  \param outputName name of the file where the full rxy vectors are written, NULL for only the peaks
+ *
+ *  \return false if the signals could not be loaded
+ */
+bool loadSignals(JOBINFO *job, unsigned int numbTemplates, char *outputName)
+{
+  size_t i, j;
+  long offset = 0;
+  SIGNALINFO *signals;
+  PAIRINFO *pairs;
+
+  signals = job->signals = (SIGNALINFO*)calloc(2*job->numbFiles, sizeof(SIGNALINFO));
+  job->numbSignals = 0;
+  for (i = 0; i < job->numbFiles; i++)
+    if (!loadSignalsOfFile(job, i, i < numbTemplates))
+      return false;
+
+  pairs = job->pairs = (PAIRINFO*)malloc(sizeof(PAIRINFO)*(job->numbSignals*job->numbSignals/2+1));
+  job->numbPairs = job->numbSkipped = 0;
+  for (i = 0; i < job->numbSignals; i++)
+    for (j = i+1; j < job->numbSignals; j++){
+      if (numbTemplates > 0 && signals[i].isTemplate == signals[j].isTemplate)
+        continue;
+      if (signals[i].numbSamples != signals[j].numbSamples){
+        job->numbSkipped++;
+        continue;
+      }
+      pairs[job->numbPairs].first = i;                                          /* templates are loaded first */
+      pairs[job->numbPairs].second = j;
+      pairs[job->numbPairs].numbSamples = signals[i].numbSamples;
+      pairs[job->numbPairs].outputOffset = offset;
+      offset += 3*sizeof(int) + sizeof(double)*signals[i].numbSamples;
+      job->numbPairs++;
+    }
+
+  job->outputFile = NULL;
+  if (outputName != NULL && (job->outputFile = fopen(outputName, "wb")) == NULL){
+    perror ("error on file opening for writing");
+    return false;
+  }
+  uint64_t *cost = (uint64_t*)malloc(sizeof(uint64_t)*((job->numbSignals > job->numbPairs ? job->numbSignals
+                                                                                            : job->numbPairs) + 1));
+  for (i = 0; i < job->numbSignals; i++)
+    cost[i] = signals[i].numbSamples;
+  job->signalOrder = largestFirst(cost, job->numbSignals);
+  for (i = 0; i < job->numbPairs; i++)
+    cost[i] = pairs[i].numbSamples;
+  job->pairOrder = largestFirst(cost, job->numbPairs);
+  free(cost);
+  job->nextSignal = job->nextPair = 0;
+  return true;
+}
+
+/**
+ *  \brief Get a signal whose spectrum is still to be computed.
+ *
+ *  Operation carried out by the worker threads.
+ *
+ *  \param workerId worker identification
+ *  \param *job job
+ *  \param **signal pointer to the signal
+ *
+ *  \return false if there are no more signals
+ */
+bool getASignal(unsigned int workerId, JOBINFO *job, SIGNALINFO **signal)
+{
+  bool available;
+
+  if ((statusWorkers[workerId] = pthread_mutex_lock (&accessF)) != 0)                                   /* enter monitor */
+  {
+    errno = statusWorkers[workerId];                                                            /* save error in errno */
+    perror ("error on entering monitor(CF)");
+    statusWorkers[workerId] = EXIT_FAILURE;
+    pthread_exit (&statusWorkers[workerId]);
+  }
+
+  if ((available = job->nextSignal < job->numbSignals))
+    *signal = &job->signals[job->signalOrder[job->nextSignal++]];
+
+  if ((statusWorkers[workerId] = pthread_mutex_unlock (&accessF)) != 0)                                 /* exit monitor */
+  {
+    errno = statusWorkers[workerId];                                                            /* save error in errno */
+    perror ("error on exiting monitor(CF)");
+    statusWorkers[workerId] = EXIT_FAILURE;
+    pthread_exit (&statusWorkers[workerId]);
+  }
+  return available;
+}
+
+/**
+ *  \brief Get a pair of signals still to be correlated.
+ *
+ *  Operation carried out by the worker threads, after all the spectra have been computed.
+ *
+ *  \param workerId worker identification
+ *  \param *job job
+ *  \param **pair pointer to the pair
+ *  \param **first pointer to the first signal of the pair
+ *  \param **second pointer to the second signal of the pair
+ *
+ *  \return false if there are no more pairs
+ */
+bool getAPair(unsigned int workerId, JOBINFO *job, PAIRINFO **pair, SIGNALINFO **first, SIGNALINFO **second)
+{
+  bool available;
+
+  if ((statusWorkers[workerId] = pthread_mutex_lock (&accessF)) != 0)                                   /* enter monitor */
+  {
+    errno = statusWorkers[workerId];                                                            /* save error in errno */
+    perror ("error on entering monitor(CF)");
+    statusWorkers[workerId] = EXIT_FAILURE;
+    pthread_exit (&statusWorkers[workerId]);
+  }
+
+  if ((available = job->nextPair < job->numbPairs)){
+    *pair = &job->pairs[job->pairOrder[job->nextPair++]];
+    *first = &job->signals[(*pair)->first];
+    *second = &job->signals[(*pair)->second];
+  }
+
+  if ((statusWorkers[workerId] = pthread_mutex_unlock (&accessF)) != 0)                                 /* exit monitor */
+  {
+    errno = statusWorkers[workerId];                                                            /* save error in errno */
+    perror ("error on exiting monitor(CF)");
+    statusWorkers[workerId] = EXIT_FAILURE;
+    pthread_exit (&statusWorkers[workerId]);
+  }
+  return available;
+}
+
+/**
+ *  \brief Save the correlation of a pair of signals: its peak and, if requested, the full rxy vector.
+ *
+ *  Operation carried out by the worker threads.
+ *
+ *  \param workerId worker identification
+ *  \param *job job
+ *  \param *pair pointer to the pair
+ *  \param *rxy circular cross correlation of the pair
+ */
+void savePairResults(unsigned int workerId, JOBINFO *job, PAIRINFO *pair, double *rxy)
+{
+  size_t k;
+  int header[3];
+
+  pair->peakLag = 0;
+  for (k = 1; k < pair->numbSamples; k++)
+    if (rxy[k] > rxy[pair->peakLag])
+      pair->peakLag = k;
+  pair->peakValue = rxy[pair->peakLag];
+  countWork(workerId, SIZE_MAX, 0, 2 * sizeof(double complex) * pair->numbSamples, 0);     /* no file of its own */
+
+  if (job->outputFile == NULL)
+    return;
+
+  if ((statusWorkers[workerId] = pthread_mutex_lock (&job->access)) != 0)                               /* enter monitor */
+  {
+    errno = statusWorkers[workerId];                                                            /* save error in errno */
+    perror ("error on entering monitor(CF)");
+    statusWorkers[workerId] = EXIT_FAILURE;
+    pthread_exit (&statusWorkers[workerId]);
+  }
+
+  header[0] = pair->first;
+  header[1] = pair->second;
+  header[2] = pair->numbSamples;
+  fseek(job->outputFile, pair->outputOffset, SEEK_SET);
+  fwrite(header, sizeof(int), 3, job->outputFile);
+  fwrite(rxy, sizeof(double), pair->numbSamples, job->outputFile);
+
+  if ((statusWorkers[workerId] = pthread_mutex_unlock (&job->access)) != 0)                             /* exit monitor */
+  {
+    errno = statusWorkers[workerId];                                                             /* save error in errno */
+    perror ("error on exiting monitor(CF)");
+    statusWorkers[workerId] = EXIT_FAILURE;
+    pthread_exit (&statusWorkers[workerId]);
+  }
+}
+
+/**
+ *  \brief Print the peak of every pair correlated in the batch mode, and release the job.
+ *
+ *  Operation carried out by the main thread.
+ *
+ *  \param *job job
+ *  \param *out where the results are printed
+ */
+void printPairResults(JOBINFO *job, FILE *out)
+{
+  size_t i;
+  SIGNALINFO *signals = job->signals;
+  PAIRINFO *pairs = job->pairs;
+
+  for (i = 0; i < job->numbPairs; i++){
+    SIGNALINFO *a = &signals[pairs[i].first], *b = &signals[pairs[i].second];
+    fprintf(out, "Signals %s:%c and %s:%c have their peak at lag %lu with value %f.\n",
+            job->filesToProcess[a->filePosition], a->component, job->filesToProcess[b->filePosition], b->component,
+            pairs[i].peakLag, pairs[i].peakValue);
+  }
+  if (job->numbSkipped > 0)
+    fprintf(out, "%lu pairs were skipped because the signals have different sizes.\n", job->numbSkipped);
+
+  if (job->outputFile != NULL)
+    fclose(job->outputFile);
+  for (i = 0; i < job->numbSignals; i++){
+    free(signals[i].samples);
+    free(signals[i].spectrum);
+  }
+  free(signals);
+  free(pairs);
+  free(job->signalOrder);
+  free(job->pairOrder);
+  freeJob(job);
+}
+
+/**
+ *  \brief Insert a lag in a list of peaks sorted by decreasing value, keeping at most max of them.
+ *
+ *  Operation carried out by all threads.
+ *
+ *  \param *peaks list of peaks
+ *  \param *numbPeaks number of peaks in the list
+ *  \param max max number of peaks
+ *  \param lag lag to insert
+ *  \param value value of the correlation at that lag
+ */
+void insertPeak(LAGPEAK *peaks, size_t *numbPeaks, size_t max, size_t lag, double value)
+{
+  size_t i = *numbPeaks;
+
+  if (i == max){
+    if (max == 0 || value <= peaks[max-1].value)
+      return;
+    i--;
+  }
+  else
+    (*numbPeaks)++;
+  for (; i > 0 && value > peaks[i-1].value; i--)
+    peaks[i] = peaks[i-1];
+  peaks[i].lag = lag;
+  peaks[i].value = value;
+}
+
+/**
+ *  \brief Set the lag window and the number of peaks of a job of the lag query mode.
+ *
+ *  Operation carried out before the job is submitted.
+ *
+ *  \param *job job
+ *  \param firstLag first lag of the window
+ *  \param lastLag last lag of the window (clamped to the size of each file)
+ *  \param numbPeaks number of peaks to report, 0 to keep every lag of the window
+ */
+void presentLagQuery(JOBINFO *job, size_t firstLag, size_t lastLag, unsigned int numbPeaks)
+{
+  job->queryFirstLag = firstLag;
+  job->queryLastLag = lastLag;
+  job->queryPeaks = numbPeaks > MAX_PEAKS ? MAX_PEAKS : numbPeaks;
+  job->lagQuery = true;
+}
+
+/**
+ *  \brief Load both signals of a file and the expected values of the lag window (the whole signal outside the
+ *  lag query mode).
+ *
+ *  Internal monitor operation.
+ *
+ *  \param *job job
+ *  \param fileId index of the file in filesToProcess
+ *
+ *  \return false if the file could not be read
+ */
+static bool loadSignalFile(JOBINFO *job, size_t fileId)
+{
+  FILEINFO *fi = &job->filesManager[fileId];
+  bool single = job->singleStorage;
+  SIGNALRECORD r;
+  int fd;
+  size_t samples;
+  size_t window;
+
+  if ((fd = open(job->filePaths[fileId], O_RDONLY)) < 0)
+    return false;
+  if (!readSignalHeader(fd, job->fileRecords[fileId], &r, NULL)){
+    close(fd);
+    return false;
+  }
+  samples = r.numbSamples;
+  fi->read = true;
+  fi->filePosition = fileId;
+  fi->numbSamples = samples;
+  fi->firstLag = job->queryFirstLag < samples ? job->queryFirstLag : samples;
+  fi->lastLag = job->queryLastLag < samples ? job->queryLastLag : samples - 1;
+  fi->rxyIndex = fi->firstLag;
+  window = fi->lastLag + 1 - fi->firstLag;
+
+  if (single){                                                      /* converted as they are read, never as double */
+    fi->xSingle = allocSingles(samples);
+    fi->ySingle = allocSingles(samples);
+  } else {
+    fi->x = allocSamples(samples);
+    fi->y = allocSamples(samples);
+  }
+  fi->expected = (double*)malloc(sizeof(double)*(window+1));
+  if (job->queryPeaks == 0)
+    fi->result = (double*)malloc(sizeof(double)*(window+1));                    /* only the lag window is kept */
+  else
+    fi->peaks = (LAGPEAK*)malloc(sizeof(LAGPEAK)*job->queryPeaks);
+  fi->numbPeaks = 0;
+
+  if (!(single ? readSignalSingles(fd, &r, 0, 0, samples, fi->xSingle)
+                 && readSignalSingles(fd, &r, 1, 0, samples, fi->ySingle)
+               : readSignalSamples(fd, &r, 0, 0, samples, fi->x) && readSignalSamples(fd, &r, 1, 0, samples, fi->y))
+      || !readSignalSamples(fd, &r, 2, fi->firstLag, window, fi->expected)
+      || (window < samples && !verifySignalSection(fd, &r, 2))){                      /* a part is not verified */
+    close(fd);
+    return false;
+  }
+  close(fd);
+
+  if (single){
+    fi->autocorrelation = job->forceAutocorrelation || memcmp(fi->xSingle, fi->ySingle, sizeof(float)*samples) == 0;
+    if (fi->autocorrelation){                                                        /* a single copy of the signal */
+      free(fi->ySingle);
+      fi->ySingle = fi->xSingle;
+    }
+  } else {
+    fi->autocorrelation = job->forceAutocorrelation || memcmp(fi->x, fi->y, sizeof(double)*samples) == 0;
+    if (fi->autocorrelation){                                                        /* a single copy of the signal */
+      free(fi->y);
+      fi->y = fi->x;
+    }
+  }
+
+  double xx = 0, yy = 0;                                                             /* bounds of the rounding errors */
+  for (size_t t = 0; t < samples; t++){
+    double xt = single ? fi->xSingle[t] : fi->x[t], yt = single ? fi->ySingle[t] : fi->y[t];
+    xx += xt * xt;
+    yy += yt * yt;
+  }
+  fi->norm = sqrt(xx * yy);
+  fi->sampleError = sampleErrorBound(&r, xx, yy);
+  if (single && r.sampleType != SAMPLE_FLOAT)                                  /* rounded to float when they were read */
+    fi->sampleError += singleErrorBound(xx, yy);
+
+  fi->numbLeaves = job->splitLeaf == 0 ? 1 : (samples + job->splitLeaf - 1) / job->splitLeaf;
+  if (!job->lagQuery && resultCacheActive()){                                       /* rxy of the same signals */
+    fi->cacheKey = resultKey(job, fi);
+    pthread_mutex_lock(&accessC);
+    fi->cached = cacheLookup(fi->cacheKey, fi->result, sizeof(double) * samples);
+    pthread_mutex_unlock(&accessC);
+    if (fi->cached){
+      fi->rxyIndex = samples;                                                        /* no lag to hand out */
+      for (size_t lag = 0; lag < samples; lag++)
+        checkLag(&fi->errors, lag, fi->expected[lag], fi->result[lag], lagBound(job, fi, lag));
+      return true;
+    }
+  }
+  nameMetricFile(fileId, job->filesToProcess[fileId],
+                 job->lagQuery ? window : fi->autocorrelation ? samples / 2 + 1 : samples);
+  if (fi->numbLeaves > 1){
+    fi->partials = (double**)calloc(samples, sizeof(double*));
+    fi->leavesDone = (size_t*)calloc(samples, sizeof(size_t));
+  }
+  return true;
+}
+
+/**
+ *  \brief Save a block of lags of the lag query mode.
+ *
+ *  The peaks of the block are selected by the worker, outside the monitor, and then merged with the peaks of the file
+ *  inside the monitor of the results of the job.
+ *
+ *  Operation carried out by the worker threads.
+ *
+ *  \param workerId worker identification
+ *  \param *job job of the block
+ *  \param *ci pointer to the shared data structure
+ *  \param *values correlation at each lag of the block
+ */
+void saveLagBlock(unsigned int workerId, JOBINFO *job, CONTROLINFO *ci, double *values)
+{
+  FILEINFO *fi = &job->filesManager[ci->filePosition];
+  LAGPEAK peaks[MAX_PEAKS];
+  ERRORSTATS errors = {0};
+  size_t i, numbPeaks = 0;
+
+  for (i = 0; job->queryPeaks > 0 && i < ci->numbLags; i++)                             /* partial selection */
+    insertPeak(peaks, &numbPeaks, job->queryPeaks, ci->rxyIndex + i, values[i]);
+  for (i = 0; i < ci->numbLags; i++)                                           /* checked before the monitor */
+    checkLag(&errors, ci->rxyIndex + i, fi->expected[ci->rxyIndex + i - fi->firstLag], values[i],
+             lagBound(job, fi, ci->rxyIndex + i));
+  countWork(workerId, ci->filePosition, ci->numbLags, 2 * sampleBytes(job) * ci->numbSamples, 0);
+
+  if ((statusWorkers[workerId] = pthread_mutex_lock (&job->access)) != 0)                               /* enter monitor */
+  {
+    errno = statusWorkers[workerId];                                                            /* save error in errno */
+    perror ("error on entering monitor(CF)");
+    statusWorkers[workerId] = EXIT_FAILURE;
+    pthread_exit (&statusWorkers[workerId]);
+  }
+
+  if (job->queryPeaks == 0)
+    memcpy(fi->result + (ci->rxyIndex - fi->firstLag), values, sizeof(double)*ci->numbLags);
+  for (i = 0; i < numbPeaks; i++)
+    insertPeak(fi->peaks, &fi->numbPeaks, job->queryPeaks, peaks[i].lag, peaks[i].value);
+  mergeErrors(&fi->errors, &errors);
+  job->pending--;
+  checkCompletion(job);
+
+  if ((statusWorkers[workerId] = pthread_mutex_unlock (&job->access)) != 0)                             /* exit monitor */
+  {
+    errno = statusWorkers[workerId];                                                             /* save error in errno */
+    perror ("error on exiting monitor(CF)");
+    statusWorkers[workerId] = EXIT_FAILURE;
+    pthread_exit (&statusWorkers[workerId]);
+  }
+}
+
+/**
+ *  \brief Open the signal files of the streaming mode and create their output files.
+ *
+ *  Operation carried out by the main thread, before the worker threads are created.
+ *
+ *  \param *job job
+ *  \param blockSize number of lags handed to a worker at a time
+ *  \param outputDirectory directory where the rxy of each file is written
+ *
+ *  \return false if a file could not be opened or created
+ */
+bool presentStreams(JOBINFO *job, size_t blockSize, char *outputDirectory)
+{
+  size_t i;
+  STREAMINFO *streams;
+
+  job->streamBlock = blockSize;
+  streams = job->streams = (STREAMINFO*)calloc(job->numbFiles, sizeof(STREAMINFO));
+  for (i = 0; i < job->numbFiles; i++){
+    if (!openStream(job->filePaths[i], job->fileRecords[i], &streams[i])
+        || !verifySignalSection(streams[i].fd, &streams[i].record, 0)               /* the blocks are not verified */
+        || !verifySignalSection(streams[i].fd, &streams[i].record, 1)
+        || !verifySignalSection(streams[i].fd, &streams[i].record, 2)){
+      fprintf(stderr, "error on opening %s\n", job->filesToProcess[i]);
+      return false;
+    }
+    if (!createStreamOutput(job->filesToProcess[i], outputDirectory, &streams[i])){
+      perror ("error on creating the output file");
+      return false;
+    }
+    nameMetricFile(i, job->filesToProcess[i], streams[i].numbSamples);
+  }
+  job->filePosition = 0;
+  job->numbActive = job->nextActive = 0;
+  return true;
+}
+
+/**
+ *  \brief Get a block of lags of the streaming mode.
+ *
+ *  Operation carried out by the worker threads.
+ *
+ *  \param workerId worker identification
+ *  \param *job job
+ *  \param *ci pointer to the shared data structure, set with the file, the first lag and the number of lags
+ *  \param **s pointer to the stream of the file
+ *
+ *  \return false if there are no more lags
+ */
+bool getAStreamBlock(unsigned int workerId, JOBINFO *job, CONTROLINFO *ci, STREAMINFO **s)
+{
+  bool available;
+  size_t fileId;
+
+  if ((statusWorkers[workerId] = pthread_mutex_lock (&accessF)) != 0)                                   /* enter monitor */
+  {
+    errno = statusWorkers[workerId];                                                            /* save error in errno */
+    perror ("error on entering monitor(CF)");
+    statusWorkers[workerId] = EXIT_FAILURE;
+    pthread_exit (&statusWorkers[workerId]);
+  }
+
+  if ((available = scheduleFile(job, workerId, blocksLeft, false, &fileId))){
+    STREAMINFO *stream = &job->streams[fileId];
+    ci->filePosition = fileId;
+    ci->numbSamples = stream->numbSamples;
+    ci->rxyIndex = stream->nextLag;
+    ci->numbLags = stream->numbSamples - stream->nextLag < job->streamBlock ? stream->numbSamples - stream->nextLag
+                                                                             : job->streamBlock;
+    stream->nextLag += ci->numbLags;
+    *s = stream;
+  }
+
+  if ((statusWorkers[workerId] = pthread_mutex_unlock (&accessF)) != 0)                                 /* exit monitor */
+  {
+    errno = statusWorkers[workerId];                                                            /* save error in errno */
+    perror ("error on exiting monitor(CF)");
+    statusWorkers[workerId] = EXIT_FAILURE;
+    pthread_exit (&statusWorkers[workerId]);
+  }
+  return available;
+}
+
+/**
+ *  \brief Save a block of lags of the streaming mode, written straight to the output file.
+ *
+ *  Operation carried out by the worker threads.
+ *
+ *  \param workerId worker identification
+ *  \param *job job
+ *  \param *ci pointer to the shared data structure
+ *  \param *values correlation at each lag of the block
+ *  \param *errors errors of the lags of the block, checked by the worker
+ */
+void saveStreamBlock(unsigned int workerId, JOBINFO *job, CONTROLINFO *ci, double *values, const ERRORSTATS *errors)
+{
+  STREAMINFO *s = &job->streams[ci->filePosition];
+
+  if (!writeStreamBlock(s, ci->rxyIndex, ci->numbLags, values)){                /* pwrite, no lock needed */
+    perror ("error on writing the output file");
+    statusWorkers[workerId] = EXIT_FAILURE;
+    pthread_exit (&statusWorkers[workerId]);
+  }
+  countWork(workerId, ci->filePosition, ci->numbLags, 2 * sizeof(double) * s->numbSamples, 0);
+
+  if ((statusWorkers[workerId] = pthread_mutex_lock (&job->access)) != 0)                               /* enter monitor */
+  {
+    errno = statusWorkers[workerId];                                                            /* save error in errno */
+    perror ("error on entering monitor(CF)");
+    statusWorkers[workerId] = EXIT_FAILURE;
+    pthread_exit (&statusWorkers[workerId]);
+  }
+
+  s->lagsDone += ci->numbLags;
+  mergeErrors(&s->errors, errors);
+
+  if ((statusWorkers[workerId] = pthread_mutex_unlock (&job->access)) != 0)                             /* exit monitor */
+  {
+    errno = statusWorkers[workerId];                                                             /* save error in errno */
+    perror ("error on exiting monitor(CF)");
+    statusWorkers[workerId] = EXIT_FAILURE;
+    pthread_exit (&statusWorkers[workerId]);
+  }
+}
+
+/**
+ *  \brief Print the results of the streaming mode, and release the job.
+ *
+ *  Operation carried out by the main thread.
+ *
+ *  \param *job job
+ *  \param *out where the results are printed
+ *
+ *  \return false if not all the lags of a file were checked
+ */
+bool printStreamResults(JOBINFO *job, FILE *out)
+{
+  size_t i;
+  bool ok = true;
+  STREAMINFO *streams = job->streams;
+
+  for (i = 0; i < job->numbFiles; i++){
+    if (streams[i].errors.numbChecked != streams[i].numbSamples){                         /* a worker left the run */
+      fprintf(out, "File %s was not computed completely, %lu of its %lu lags were checked.\n", job->filesToProcess[i],
+              streams[i].errors.numbChecked, streams[i].numbSamples);
+      ok = false;
     }
-    if(numbErrors==0)
-      printf("File %s was calculated correctly.\n", filesToProcess[i]);
-    else 
-      printf("File %s had %i errors in total.\n", filesToProcess[i], numbErrors);
+    else if (streams[i].errors.numbErrors == 0)
+      fprintf(out, "File %s was calculated correctly.\n", job->filesToProcess[i]);
+    else
+      fprintf(out, "File %s had %lu errors in total.\n", job->filesToProcess[i], streams[i].errors.numbErrors);
+    if (job->errorReport)
+      printErrors(out, &streams[i].errors, streams[i].sampleError);
+    closeStream(&streams[i]);
   }
-  
-  free(filesManager);
+  free(streams);
+  freeJob(job);
+  return ok;
 }
@@ -3,23 +3,85 @@
  *
  *  \brief Problem name: Problem 2.
  *
+ *  The monitor state of a run lives in a job (see JOBINFO.h): its files, their schedule and their results, and its
+ *  options. The jobs of the lag and lag query modes are handed out together, by priority, to the same workers, so
+ *  that the server serves several requests at once (see jobServer.h); the batch and streaming modes run a single job
+ *  of their own.
+ *
  *  \author Francisco Gonçalves and Tiago Lucas - April 2019
  */
 #ifndef SHAREDREGION_H
 #define SHAREDREGION_H
 
 #include "CONTROLINFO.h"
+#include "SIGNALINFO.h"
+#include "PAIRINFO.h"
+#include "LAGPEAK.h"
+#include "STREAMINFO.h"
+#include "ERRORSTATS.h"
+#include "JOBINFO.h"
+#include <stdio.h>
 #include <stdbool.h>
 
+/**
+ *  \brief New job, with no files yet.
+ *
+ *  Operation carried out by the main thread, or by the thread of a request to the server.
+ *
+ *  \param priority the lags of the jobs of a higher priority are handed out first
+ *
+ *  \return job
+ */
+extern JOBINFO *newJob(int priority);
+
 /**
  *  \brief Insert the names of the files to be processed in an array.
  *
- *  Operation carried out by the main thread.
+ *  Operation carried out by the main thread, or by the thread of a request to the server.
  *
+ *  \param *job job
  *  \param listOfFiles names of files to process
  *  \param size number of text files to be processed
+ *
+ *  \return false if there are no files to process
  */
-extern void presentDataFileNames(char *listOfFiles[], unsigned int size);
+extern bool presentDataFileNames(JOBINFO *job, char *listOfFiles[], unsigned int size);
+
+/**
+ *  \brief Hand the lags of a job out to the workers (lag and lag query modes).
+ *
+ *  Operation carried out once the names of the files and the options of the job are inserted.
+ *
+ *  \param *job job
+ */
+extern void submitJob(JOBINFO *job);
+
+/**
+ *  \brief Wait until the results of a job are complete.
+ *
+ *  Operation carried out by the thread of a request to the server.
+ *
+ *  \param *job job
+ */
+extern void waitJob(JOBINFO *job);
+
+/**
+ *  \brief No more jobs are submitted, the workers leave once the ones submitted are handed out.
+ *
+ *  Operation carried out by the main thread.
+ */
+extern void closeJobs(void);
+
+/**
+ *  \brief Wait until a job has lags to hand out.
+ *
+ *  Operation carried out by the worker threads.
+ *
+ *  \param workerId worker identification
+ *
+ *  \return false once the jobs are closed and handed out
+ */
+extern bool waitForJobs(unsigned int workerId);
 
 /**
  *  \brief Store a value in the data transfer region.
@@ -27,11 +89,15 @@ extern void presentDataFileNames(char *listOfFiles[], unsigned int size);
  *  Operation carried out by the worker threads.
  *
  *  \param workerId worker identification
- *  \param *x pointer to the array with first signals of the pair
- *  \param *x pointer to the array with second signals of the pair
- *  \param *ci pointer to the shared data structure
+ *  \param **x pointer to the array with first signals of the pair, of float when ci->single is set, else of double
+ *  \param **y pointer to the array with second signals of the pair
+ *  \param *ci pointer to the shared data structure, set with the file and the lag to compute or, when ci->query is
+ *             set, the first lag and the number of lags of a block of the lag window
+ *  \param **job where the job of the piece of work is stored
+ *
+ *  \return false if no job has lags left
  */
-extern bool getAPieceOfData(unsigned int workerId, double *x, double *y, CONTROLINFO *ci);
+extern bool getAPieceOfData(unsigned int workerId, const void **x, const void **y, CONTROLINFO *ci, JOBINFO **job);
 
 /**
  *  \brief Get a value from the data transfer region and save it in result data storage.
@@ -39,18 +105,219 @@ extern bool getAPieceOfData(unsigned int workerId, double *x, double *y, CONTROL
  *  Operation carried out by the worker threads.
  *
  *  \param workerId worker identification
+ *  \param *job job of the piece of work
  *	\param *ci pointer to the shared data structure
  *
  *  \return value
  */
-extern void savePartialResults(unsigned int workerId, CONTROLINFO *ci);
+extern void savePartialResults(unsigned int workerId, JOBINFO *job, CONTROLINFO *ci);
 
 /**
- *  \brief Print all the results stored in result data storage.
+ *  \brief Print the results of each file of a job of the lag or lag query mode, and release the job.
+ *
+ *  Operation carried out by the main thread, or by the thread of a request to the server, once the job is complete.
+ *
+ *  \param *job job
+ *  \param *out where the results are printed
+ *
+ *  \return false if a file could not be read or not all of its lags were checked
+ */
+extern bool printResults(JOBINFO *job, FILE *out);
+
+/**
+ *  \brief Load the signals of the batch (all-pairs) mode and list the pairs to correlate.
+ *
+ *  Operation carried out by the main thread, before the worker threads are created.
+ *
+ *  \param *job job
+ *  \param numbTemplates number of files, at the start of the list, whose signals are templates (0 for all pairs)
+ *  \param outputName name of the file where the full rxy vectors are written, NULL for only the peaks
+ *
+ *  \return false if the signals could not be loaded
+ */
+extern bool loadSignals(JOBINFO *job, unsigned int numbTemplates, char *outputName);
+
+/**
+ *  \brief Get a signal whose spectrum is still to be computed.
+ *
+ *  Operation carried out by the worker threads.
+ *
+ *  \param workerId worker identification
+ *  \param *job job
+ *  \param **signal pointer to the signal
+ *
+ *  \return false if there are no more signals
+ */
+extern bool getASignal(unsigned int workerId, JOBINFO *job, SIGNALINFO **signal);
+
+/**
+ *  \brief Get a pair of signals still to be correlated.
+ *
+ *  Operation carried out by the worker threads, after all the spectra have been computed.
+ *
+ *  \param workerId worker identification
+ *  \param *job job
+ *  \param **pair pointer to the pair
+ *  \param **first pointer to the first signal of the pair
+ *  \param **second pointer to the second signal of the pair
+ *
+ *  \return false if there are no more pairs
+ */
+extern bool getAPair(unsigned int workerId, JOBINFO *job, PAIRINFO **pair, SIGNALINFO **first, SIGNALINFO **second);
+
+/**
+ *  \brief Save the correlation of a pair of signals: its peak and, if requested, the full rxy vector.
+ *
+ *  Operation carried out by the worker threads.
+ *
+ *  \param workerId worker identification
+ *  \param *job job
+ *  \param *pair pointer to the pair
+ *  \param *rxy circular cross correlation of the pair
+ */
+extern void savePairResults(unsigned int workerId, JOBINFO *job, PAIRINFO *pair, double *rxy);
+
+/**
+ *  \brief Print the peak of every pair correlated in the batch mode, and release the job.
  *
  *  Operation carried out by the main thread.
  *
+ *  \param *job job
+ *  \param *out where the results are printed
+ */
+extern void printPairResults(JOBINFO *job, FILE *out);
+
+/**
+ *  \brief Insert a lag in a list of peaks sorted by decreasing value, keeping at most max of them.
+ *
+ *  Operation carried out by all threads.
+ *
+ *  \param *peaks list of peaks
+ *  \param *numbPeaks number of peaks in the list
+ *  \param max max number of peaks
+ *  \param lag lag to insert
+ *  \param value value of the correlation at that lag
+ */
+extern void insertPeak(LAGPEAK *peaks, size_t *numbPeaks, size_t max, size_t lag, double value);
+
+/**
+ *  \brief Set the lag window and the number of peaks of a job of the lag query mode.
+ *
+ *  Operation carried out before the job is submitted.
+ *
+ *  \param *job job
+ *  \param firstLag first lag of the window
+ *  \param lastLag last lag of the window (clamped to the size of each file)
+ *  \param numbPeaks number of peaks to report, 0 to keep every lag of the window
+ */
+extern void presentLagQuery(JOBINFO *job, size_t firstLag, size_t lastLag, unsigned int numbPeaks);
+
+/**
+ *  \brief Take every file of a job as an autocorrelation, y being ignored.
+ *
+ *  Files whose x and y are equal are always detected as such.
+ *
+ *  Operation carried out before the job is submitted.
+ *
+ *  \param *job job
+ */
+extern void presentAutocorrelation(JOBINFO *job);
+
+/**
+ *  \brief Split the sum of each lag in parts of leafSize samples, reduced by a pairwise sum.
+ *
+ *  Operation carried out before the job is submitted.
+ *
+ *  \param *job job
+ *  \param leafSize number of samples of each part, 0 to not split
+ */
+extern void presentSplitSum(JOBINFO *job, size_t leafSize);
+
+/**
+ *  \brief Store x and y as float, half the bytes the workers go through, the sums being still in double.
+ *
+ *  The results are checked against the expected ones with the error bound of the rounding of the samples to float,
+ *  none for samples stored as float in the file.
+ *
+ *  Operation carried out before the job is submitted.
+ *
+ *  \param *job job
+ */
+extern void presentSingleStorage(JOBINFO *job);
+
+/**
+ *  \brief Report the errors of the results of each file: the largest ones and where, and their histogram (see
+ *  resultCheck.h).
+ *
+ *  Operation carried out before the job is submitted.
+ *
+ *  \param *job job
+ */
+extern void presentErrorReport(JOBINFO *job);
+
+/**
+ *  \brief Save a block of lags of the lag query mode.
+ *
+ *  Operation carried out by the worker threads.
+ *
+ *  \param workerId worker identification
+ *  \param *job job of the block
+ *  \param *ci pointer to the shared data structure
+ *  \param *values correlation at each lag of the block
+ */
+extern void saveLagBlock(unsigned int workerId, JOBINFO *job, CONTROLINFO *ci, double *values);
+
+/**
+ *  \brief Open the signal files of the streaming mode and create their output files.
+ *
+ *  Operation carried out by the main thread, before the worker threads are created.
+ *
+ *  \param *job job
+ *  \param blockSize number of lags handed to a worker at a time
+ *  \param outputDirectory directory where the rxy of each file is written
+ *
+ *  \return false if a file could not be opened or created
+ */
+extern bool presentStreams(JOBINFO *job, size_t blockSize, char *outputDirectory);
+
+/**
+ *  \brief Get a block of lags of the streaming mode.
+ *
+ *  Operation carried out by the worker threads.
+ *
+ *  \param workerId worker identification
+ *  \param *job job
+ *  \param *ci pointer to the shared data structure, set with the file, the first lag and the number of lags
+ *  \param **s pointer to the stream of the file
+ *
+ *  \return false if there are no more lags
+ */
+extern bool getAStreamBlock(unsigned int workerId, JOBINFO *job, CONTROLINFO *ci, STREAMINFO **s);
+
+/**
+ *  \brief Save a block of lags of the streaming mode, written straight to the output file.
+ *
+ *  Operation carried out by the worker threads.
+ *
+ *  \param workerId worker identification
+ *  \param *job job
+ *  \param *ci pointer to the shared data structure
+ *  \param *values correlation at each lag of the block
+ *  \param *errors errors of the lags of the block, checked by the worker (see verifyStreamBlock)
+ */
+extern void saveStreamBlock(unsigned int workerId, JOBINFO *job, CONTROLINFO *ci, double *values,
+                            const ERRORSTATS *errors);
+
+/**
+ *  \brief Print the results of the streaming mode, and release the job.
+ *
+ *  Operation carried out by the main thread.
+ *
+ *  \param *job job
+ *  \param *out where the results are printed
+ *
+ *  \return false if not all the lags of a file were checked
  */
-extern void printResults(void);
+extern bool printStreamResults(JOBINFO *job, FILE *out);
 
 #endif /* SHAREDREGION_H */
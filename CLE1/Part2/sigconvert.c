@@ -0,0 +1,213 @@
+/**
+ *  \file sigconvert.c (implementation file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  Conversion of signal files (legacy or containers) into a single signal container, one record per input record.
+ *  Separate program, built from this file, signalFile.c, fileList.c and readEngine.c.
+ *
+ *  \author Francisco Gonçalves Tiago Lucas - April 2020
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <math.h>
+
+#include "probConst.h"
+#include "SIGNALRECORD.h"
+#include "signalFile.h"
+
+/** \brief number of samples converted at a time */
+#define  CHUNK  (STREAM_COPY / sizeof(double))
+
+/**
+ *  \brief Write exactly count bytes at a position.
+ *
+ *  Internal operation.
+ */
+static bool writeAt(int fd, const void *buffer, size_t count, off_t position)
+{
+  while (count > 0){
+    ssize_t n = pwrite(fd, buffer, count, position);
+    if (n <= 0)
+      return false;
+    buffer = (const char *) buffer + n;
+    count -= n;
+    position += n;
+  }
+  return true;
+}
+
+/**
+ *  \brief Next multiple of SIGNAL_ALIGN.
+ *
+ *  Internal operation.
+ */
+static uint64_t align(uint64_t offset)
+{
+  return (offset + SIGNAL_ALIGN - 1) / SIGNAL_ALIGN * SIGNAL_ALIGN;
+}
+
+/**
+ *  \brief Copy a section of a record, converting its samples to the type of the output record.
+ *
+ *  Internal operation.
+ *
+ *  \return false on a read or write error
+ */
+static bool copySection(int in, const SIGNALRECORD *from, int out, SIGNALRECORD *to, int array)
+{
+  double buffer[CHUNK];
+  char raw[CHUNK * sizeof(double)];
+  uint32_t type = array == 2 ? SAMPLE_DOUBLE : to->sampleType;
+  size_t size = type == SAMPLE_DOUBLE ? sizeof(double) : type == SAMPLE_FLOAT ? sizeof(float) : sizeof(int16_t);
+  uint64_t checksum = SIGNAL_CHECKSUM_SEED;
+
+  for (size_t i = 0; i < from->numbSamples; i += CHUNK){
+    size_t count = from->numbSamples - i < CHUNK ? from->numbSamples - i : CHUNK;
+    if (!readSignalSamples(in, from, array, i, count, buffer))
+      return false;
+    for (size_t j = 0; j < count; j++)
+      if (type == SAMPLE_DOUBLE)
+        ((double *) raw)[j] = buffer[j];
+      else if (type == SAMPLE_FLOAT)
+        ((float *) raw)[j] = (float) buffer[j];
+      else
+        ((int16_t *) raw)[j] = (int16_t) lrint(buffer[j] / to->scale);
+    if (!writeAt(out, raw, count * size, to->offset[array] + i * size))
+      return false;
+    checksum = signalChecksum(checksum, raw, count * size);
+  }
+  to->checksum[array] = checksum;
+  return true;
+}
+
+/**
+ *  \brief Main function.
+ *
+ *  \param argc number of words of the command line
+ *  \param argv list of words of the command line
+ *
+ *  Options:
+ *     -f type     type of the samples of x and y: double, float or int16 (scaled to the largest sample),
+ *                 by default the type of each input record
+ *     -o file     output container
+ *
+ *  \return status of operation
+ */
+int main (int argc, char *argv[])
+{
+  int opt, in, out;
+  int type = -1;
+  char *outputName = NULL;
+  char **paths, **labels;
+  size_t *records, numbRecords, i;
+  SIGNALRECORD *from, *to;
+  unsigned char header[SIGNAL_HEADER] = {0};
+  uint64_t offset;
+
+  while ((opt = getopt (argc, argv, "f:o:")) != -1)
+    switch (opt){
+      case 'f': if (strcmp(optarg, "double") == 0)
+                  type = SAMPLE_DOUBLE;
+                else if (strcmp(optarg, "float") == 0)
+                  type = SAMPLE_FLOAT;
+                else if (strcmp(optarg, "int16") == 0)
+                  type = SAMPLE_INT16;
+                else {
+                  fprintf(stderr, "Unknown sample type %s\n", optarg);
+                  exit(EXIT_FAILURE);
+                }
+                break;
+      case 'o': outputName = optarg;
+                break;
+      default:  fprintf(stderr, "Usage: %s [-f double|float|int16] -o output files\n", argv[0]);
+                exit(EXIT_FAILURE);
+    }
+  if (outputName == NULL || optind == argc){
+    fprintf(stderr, "Usage: %s [-f double|float|int16] -o output files\n", argv[0]);
+    exit(EXIT_FAILURE);
+  }
+
+  numbRecords = listSignalRecords(argv + optind, argc - optind, &paths, &records, &labels);
+  from = (SIGNALRECORD *) malloc(sizeof(SIGNALRECORD) * numbRecords);
+  to = (SIGNALRECORD *) calloc(numbRecords, sizeof(SIGNALRECORD));
+  if ((out = open(outputName, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0){
+    perror ("error on creating the output file");
+    exit(EXIT_FAILURE);
+  }
+
+  /* layout: header, table of contents and the aligned sections */
+  offset = align(SIGNAL_HEADER + sizeof(SIGNALRECORD) * numbRecords);
+  for (i = 0; i < numbRecords; i++){
+    if ((in = open(paths[i], O_RDONLY)) < 0 || !readSignalHeader(in, records[i], &from[i], NULL)){
+      fprintf(stderr, "error on reading %s\n", labels[i]);
+      exit(EXIT_FAILURE);
+    }
+    close(in);
+    to[i].numbSamples = from[i].numbSamples;
+    to[i].sampleType = type < 0 ? from[i].sampleType : (uint32_t) type;                /* samples already rounded stay so */
+    to[i].scale = 1;
+    for (int a = 0; a < 3; a++){
+      uint32_t t = a == 2 ? SAMPLE_DOUBLE : to[i].sampleType;
+      size_t size = t == SAMPLE_DOUBLE ? sizeof(double) : t == SAMPLE_FLOAT ? sizeof(float) : sizeof(int16_t);
+      to[i].offset[a] = offset;
+      offset = align(offset + size * to[i].numbSamples);
+    }
+  }
+
+  /* sections, an int16 record is scaled to its largest sample first */
+  for (i = 0; i < numbRecords; i++){
+    in = open(paths[i], O_RDONLY);
+    for (int a = 0; a < 3; a++)                                        /* the sections are read in parts */
+      if (!verifySignalSection(in, &from[i], a)){
+        fprintf(stderr, "error on reading %s\n", labels[i]);
+        exit(EXIT_FAILURE);
+      }
+    if (to[i].sampleType == SAMPLE_INT16){
+      double buffer[CHUNK], max = 0;
+      for (int a = 0; a < 2; a++)
+        for (size_t j = 0; j < from[i].numbSamples; j += CHUNK){
+          size_t count = from[i].numbSamples - j < CHUNK ? from[i].numbSamples - j : CHUNK;
+          if (!readSignalSamples(in, &from[i], a, j, count, buffer)){
+            fprintf(stderr, "error on reading %s\n", labels[i]);
+            exit(EXIT_FAILURE);
+          }
+          for (size_t k = 0; k < count; k++)
+            max = fabs(buffer[k]) > max ? fabs(buffer[k]) : max;
+        }
+      to[i].scale = max > 0 ? max / INT16_MAX : 1;
+    }
+    for (int a = 0; a < 3; a++)
+      if (!copySection(in, &from[i], out, &to[i], a)){
+        fprintf(stderr, "error on converting %s\n", labels[i]);
+        exit(EXIT_FAILURE);
+      }
+    close(in);
+  }
+
+  /* table of contents and header, last */
+  uint32_t version = SIGNAL_VERSION, count = numbRecords, recordSize = sizeof(SIGNALRECORD);
+  uint64_t tocOffset = SIGNAL_HEADER, tocChecksum = signalChecksum(SIGNAL_CHECKSUM_SEED, to, sizeof(SIGNALRECORD) * numbRecords);
+  memcpy(header, SIGNAL_MAGIC, strlen(SIGNAL_MAGIC));
+  memcpy(header + 8, &version, sizeof(uint32_t));
+  memcpy(header + 12, &count, sizeof(uint32_t));
+  memcpy(header + 16, &recordSize, sizeof(uint32_t));
+  memcpy(header + 24, &tocOffset, sizeof(uint64_t));
+  memcpy(header + 32, &tocChecksum, sizeof(uint64_t));
+  if (!writeAt(out, to, sizeof(SIGNALRECORD) * numbRecords, tocOffset) || !writeAt(out, header, SIGNAL_HEADER, 0)
+      || ftruncate(out, offset) != 0 || close(out) != 0){
+    perror ("error on writing the output file");
+    exit(EXIT_FAILURE);
+  }
+
+  printf("%lu records written to %s\n", numbRecords, outputName);
+  free(from);
+  free(to);
+  return EXIT_SUCCESS;
+}
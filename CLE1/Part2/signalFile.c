@@ -0,0 +1,389 @@
+/**
+ *  \file signalFile.c (implementation file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - April 2020
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <math.h>
+#include <float.h>
+
+#include "probConst.h"
+#include "SIGNALRECORD.h"
+#include "signalFile.h"
+#include "fileList.h"
+#include "READBLOCK.h"
+#include "readEngine.h"
+
+/** \brief size of the samples of each type */
+static const size_t sampleSize[] = { sizeof(double), sizeof(float), sizeof(int16_t) };
+
+/**
+ *  \brief Read exactly count bytes at a position, retrying short reads.
+ *
+ *  Reads larger than a buffer of the read engine, when it was started, are split in reads all outstanding at once.
+ *
+ *  Internal operation.
+ */
+static bool readAt(int fd, void *buffer, size_t count, off_t position)
+{
+  if (readEngineActive() && count > readBlockSize())
+    return engineReadAt(fd, buffer, count, position);
+  while (count > 0){
+    ssize_t n = pread(fd, buffer, count, position);
+    if (n <= 0)
+      return false;
+    buffer = (char *) buffer + n;
+    count -= n;
+    position += n;
+  }
+  return true;
+}
+
+/**
+ *  \brief 64-bit FNV-1a hash, chained through hash (start with SIGNAL_CHECKSUM_SEED).
+ *
+ *  \param hash hash of the previous bytes
+ *  \param *data bytes
+ *  \param size number of bytes
+ *
+ *  \return hash
+ */
+uint64_t signalChecksum(uint64_t hash, const void *data, size_t size)
+{
+  const unsigned char *p = data;
+
+  while (size-- > 0){
+    hash ^= *p++;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+/**
+ *  \brief Read the table of contents of a signal file and one of its records.
+ *
+ *  A legacy file has a single record.
+ *
+ *  \param fd descriptor of the file
+ *  \param record index of the record
+ *  \param *r where the record is stored, may be NULL
+ *  \param *numbRecords where the number of records is stored, may be NULL
+ *
+ *  \return false if the file is not a signal file or the record does not exist
+ */
+bool readSignalHeader(int fd, size_t record, SIGNALRECORD *r, size_t *numbRecords)
+{
+  unsigned char header[SIGNAL_HEADER];
+  uint32_t version, records, recordSize;
+  uint64_t tocOffset, tocChecksum;
+  SIGNALRECORD *toc;
+  int32_t samples;
+
+  if (!readAt(fd, header, sizeof(int32_t), 0))
+    return false;
+  if (memcmp(header, SIGNAL_MAGIC, sizeof(int32_t)) != 0 || !readAt(fd, header, SIGNAL_HEADER, 0)
+      || memcmp(header, SIGNAL_MAGIC, strlen(SIGNAL_MAGIC)) != 0){
+    memcpy(&samples, header, sizeof(int32_t));                              /* legacy: int, x, y and expected */
+    if (samples <= 0 || record != 0)
+      return false;
+    if (numbRecords != NULL)
+      *numbRecords = 1;
+    if (r != NULL){
+      memset(r, 0, sizeof(SIGNALRECORD));
+      r->numbSamples = samples;
+      r->sampleType = SAMPLE_DOUBLE;
+      r->scale = 1;
+      for (int a = 0; a < 3; a++)
+        r->offset[a] = sizeof(int32_t) + (uint64_t) a * samples * sizeof(double);
+    }
+    return true;
+  }
+
+  memcpy(&version, header + 8, sizeof(uint32_t));
+  memcpy(&records, header + 12, sizeof(uint32_t));
+  memcpy(&recordSize, header + 16, sizeof(uint32_t));
+  memcpy(&tocOffset, header + 24, sizeof(uint64_t));
+  memcpy(&tocChecksum, header + 32, sizeof(uint64_t));
+  if (version != SIGNAL_VERSION || recordSize != sizeof(SIGNALRECORD) || record >= records)
+    return false;
+
+  if ((toc = (SIGNALRECORD *) malloc(sizeof(SIGNALRECORD) * records)) == NULL)
+    return false;
+  if (!readAt(fd, toc, sizeof(SIGNALRECORD) * records, tocOffset)
+      || signalChecksum(SIGNAL_CHECKSUM_SEED, toc, sizeof(SIGNALRECORD) * records) != tocChecksum
+      || toc[record].numbSamples == 0 || toc[record].sampleType > SAMPLE_INT16){
+    free(toc);
+    return false;
+  }
+  if (numbRecords != NULL)
+    *numbRecords = records;
+  if (r != NULL)
+    *r = toc[record];
+  free(toc);
+  return true;
+}
+
+/**
+ *  \brief Verify the checksum of a section of a record, read STREAM_COPY bytes at a time.
+ *
+ *  \param fd descriptor of the file
+ *  \param *r record
+ *  \param array 0 for x, 1 for y, 2 for the expected result
+ *
+ *  \return false on a read error or a wrong checksum, true when the section has no checksum
+ */
+bool verifySignalSection(int fd, const SIGNALRECORD *r, int array)
+{
+  unsigned char buffer[STREAM_COPY];
+  size_t size = (size_t) r->numbSamples * sampleSize[array == 2 ? SAMPLE_DOUBLE : r->sampleType];
+  uint64_t hash = SIGNAL_CHECKSUM_SEED;
+
+  if (r->checksum[array] == 0)
+    return true;
+  for (size_t i = 0; i < size; i += STREAM_COPY){
+    size_t chunk = size - i < STREAM_COPY ? size - i : STREAM_COPY;
+    if (!readAt(fd, buffer, chunk, r->offset[array] + i))
+      return false;
+    hash = signalChecksum(hash, buffer, chunk);
+  }
+  return hash == r->checksum[array];
+}
+
+/**
+ *  \brief Read consecutive samples of x (0), y (1) or expected (2) of a record, converted to double.
+ *
+ *  The checksum of the section is verified when it is read whole. A part of a section is not verified: the callers
+ *  which read a section in parts verify it first with verifySignalSection.
+ *
+ *  \param fd descriptor of the file
+ *  \param *r record
+ *  \param array 0 for x, 1 for y, 2 for the expected result
+ *  \param first index of the first sample
+ *  \param count number of samples
+ *  \param *buffer where the samples are stored
+ *
+ *  \return false on a read error or a wrong checksum
+ */
+bool readSignalSamples(int fd, const SIGNALRECORD *r, int array, size_t first, size_t count, double *buffer)
+{
+  uint32_t type = array == 2 ? SAMPLE_DOUBLE : r->sampleType;
+  size_t size = sampleSize[type];
+  void *raw = type == SAMPLE_DOUBLE ? (void *) buffer : malloc(size * count);    /* doubles need no conversion */
+  bool ok;
+
+  if (raw == NULL)
+    return false;
+  ok = readAt(fd, raw, size * count, r->offset[array] + first * size);
+  if (ok && first == 0 && count == r->numbSamples && r->checksum[array] != 0)
+    ok = signalChecksum(SIGNAL_CHECKSUM_SEED, raw, size * count) == r->checksum[array];
+  if (ok && type == SAMPLE_FLOAT)
+    for (size_t i = 0; i < count; i++)
+      buffer[i] = ((float *) raw)[i];
+  else if (ok && type == SAMPLE_INT16)
+    for (size_t i = 0; i < count; i++)
+      buffer[i] = ((int16_t *) raw)[i] * r->scale;
+
+  if (raw != buffer)
+    free(raw);
+  return ok;
+}
+
+/**
+ *  \brief Read consecutive samples of x (0) or y (1) of a record, converted to float.
+ *
+ *  The checksum of the section is verified when it is read whole. A part of a section is not verified: the callers
+ *  which read a section in parts verify it first with verifySignalSection.
+ *
+ *  \param fd descriptor of the file
+ *  \param *r record
+ *  \param array 0 for x, 1 for y
+ *  \param first index of the first sample
+ *  \param count number of samples
+ *  \param *buffer where the samples are stored
+ *
+ *  \return false on a read error or a wrong checksum
+ */
+bool readSignalSingles(int fd, const SIGNALRECORD *r, int array, size_t first, size_t count, float *buffer)
+{
+  uint32_t type = r->sampleType;
+  size_t size = sampleSize[type];
+  void *raw = type == SAMPLE_FLOAT ? (void *) buffer : malloc(size * count);      /* floats need no conversion */
+  bool ok;
+
+  if (raw == NULL)
+    return false;
+  ok = readAt(fd, raw, size * count, r->offset[array] + first * size);
+  if (ok && first == 0 && count == r->numbSamples && r->checksum[array] != 0)
+    ok = signalChecksum(SIGNAL_CHECKSUM_SEED, raw, size * count) == r->checksum[array];
+  if (ok && type == SAMPLE_DOUBLE)
+    for (size_t i = 0; i < count; i++)
+      buffer[i] = (float) ((double *) raw)[i];
+  else if (ok && type == SAMPLE_INT16)
+    for (size_t i = 0; i < count; i++)
+      buffer[i] = (float) (((int16_t *) raw)[i] * r->scale);
+
+  if (raw != buffer)
+    free(raw);
+  return ok;
+}
+
+/**
+ *  \brief Allocate memory for samples, aligned to SIGNAL_ALIGN bytes.
+ *
+ *  \param count number of samples
+ *
+ *  \return pointer to the memory (to be released with free), NULL if it could not be allocated
+ */
+double *allocSamples(size_t count)
+{
+  void *p;
+
+  if (posix_memalign(&p, SIGNAL_ALIGN, sizeof(double) * (count > 0 ? count : 1)) != 0)
+    return NULL;
+  return (double *) p;
+}
+
+/**
+ *  \brief Allocate memory for samples stored as float, aligned to SIGNAL_ALIGN bytes.
+ *
+ *  \param count number of samples
+ *
+ *  \return pointer to the memory (to be released with free), NULL if it could not be allocated
+ */
+float *allocSingles(size_t count)
+{
+  void *p;
+
+  if (posix_memalign(&p, SIGNAL_ALIGN, sizeof(float) * (count > 0 ? count : 1)) != 0)
+    return NULL;
+  return (float *) p;
+}
+
+/**
+ *  \brief Bound of the error of a correlation caused by the type of the samples of a record.
+ *
+ *  A float sample has a relative error of at most FLT_EPSILON / 2, an int16 sample an absolute error of at most
+ *  scale / 2, so each product x * y is off by at most |x| dy + |y| dx + dx dy. Summed over n lags, this is bound
+ *  through Cauchy-Schwarz by the norms of x and y. The bound is doubled to cover the rounding of the sum itself.
+ *
+ *  \param *r record
+ *  \param sumX2 sum of the squares of x
+ *  \param sumY2 sum of the squares of y
+ *
+ *  \return 0 for doubles
+ */
+double sampleErrorBound(const SIGNALRECORD *r, double sumX2, double sumY2)
+{
+  double n = r->numbSamples, d;
+
+  switch (r->sampleType){
+    case SAMPLE_FLOAT: return singleErrorBound(sumX2, sumY2);
+    case SAMPLE_INT16: d = r->scale / 2;
+                       return 2 * (d * sqrt(n) * (sqrt(sumX2) + sqrt(sumY2)) + n * d * d);
+    default:           return 0;
+  }
+}
+
+/**
+ *  \brief Bound of the error of a correlation caused by rounding the samples to float.
+ *
+ *  Each sample has a relative error of at most FLT_EPSILON / 2, bound over the lags as in sampleErrorBound. The
+ *  products of two floats are exact in double, so the sum of a lag accumulated in double adds no error of its own
+ *  beyond the one of the same sum of doubles.
+ *
+ *  \param sumX2 sum of the squares of x
+ *  \param sumY2 sum of the squares of y
+ *
+ *  \return bound
+ */
+double singleErrorBound(double sumX2, double sumY2)
+{
+  double d = FLT_EPSILON / 2;
+
+  return 2 * (2 * d + d * d) * sqrt(sumX2 * sumY2);
+}
+
+/**
+ *  \brief Expand a list of signal files into one entry per record.
+ *
+ *  Files that can not be read are kept as a single entry, the error is reported when they are loaded. Directories
+ *  and @lists are expanded first.
+ *
+ *  \param *names[] names of the files
+ *  \param numbNames number of files
+ *  \param ***paths where the array with the file of each entry is stored
+ *  \param **records where the array with the record of each entry is stored
+ *  \param ***labels where the array with the label of each entry is stored
+ *
+ *  \return number of entries
+ */
+size_t listSignalRecords(char *names[], size_t numbNames, char ***paths, size_t **records, char ***labels)
+{
+  size_t i, r, numbEntries = 0, size;
+
+  numbNames = expandFileNames(names, numbNames, &names);
+  size = numbNames > 0 ? numbNames : 1;
+  *paths = (char **) malloc(sizeof(char *) * size);
+  *records = (size_t *) malloc(sizeof(size_t) * size);
+  *labels = (char **) malloc(sizeof(char *) * size);
+
+  for (i = 0; i < numbNames; i++){
+    size_t numbRecords = 1;
+    int fd;
+
+    if (strcmp(names[i], "-") != 0 && (fd = open(names[i], O_RDONLY)) >= 0){
+      if (!readSignalHeader(fd, 0, NULL, &numbRecords))
+        numbRecords = 1;
+      close(fd);
+    }
+    if (numbEntries + numbRecords > size){
+      size = 2 * size + numbRecords;
+      *paths = (char **) realloc(*paths, sizeof(char *) * size);
+      *records = (size_t *) realloc(*records, sizeof(size_t) * size);
+      *labels = (char **) realloc(*labels, sizeof(char *) * size);
+    }
+    for (r = 0; r < numbRecords; r++, numbEntries++){
+      (*paths)[numbEntries] = names[i];
+      (*records)[numbEntries] = r;
+      (*labels)[numbEntries] = names[i];
+      if (numbRecords > 1){
+        (*labels)[numbEntries] = (char *) malloc(strlen(names[i]) + 24);
+        sprintf((*labels)[numbEntries], "%s#%lu", names[i], r);
+      }
+    }
+  }
+  free(names);                                                      /* the names themselves are the paths */
+  return numbEntries;
+}
+
+/**
+ *  \brief Release the entries listed by listSignalRecords.
+ *
+ *  \param **paths file of each entry
+ *  \param *records record of each entry
+ *  \param **labels label of each entry
+ *  \param numbEntries number of entries
+ */
+void freeSignalRecords(char **paths, size_t *records, char **labels, size_t numbEntries)
+{
+  size_t i;
+
+  for (i = 0; i < numbEntries; i++){
+    if (labels[i] != paths[i])                                                 /* name#record */
+      free(labels[i]);
+    if (records[i] == 0)                                                   /* the records of a file share its name */
+      free(paths[i]);
+  }
+  free(paths);
+  free(records);
+  free(labels);
+}
@@ -0,0 +1,315 @@
+/**
+ *  \file streamCorrelation.c (implementation file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - April 2020
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <limits.h>
+#include <math.h>
+#include <complex.h>
+
+#include "probConst.h"
+#include "STREAMINFO.h"
+#include "streamCorrelation.h"
+#include "SIGNALRECORD.h"
+#include "signalFile.h"
+#include "fft.h"
+#include "TUNING.h"
+#include "autotune.h"
+#include "ERRORSTATS.h"
+#include "resultCheck.h"
+
+/**
+ *  \brief Open a record of a signal file for reading in blocks, "-" is the standard input (spooled to a temporary file).
+ *
+ *  The samples of a container may not be doubles, x and y are then read once to bound the error they cause.
+ *
+ *  Operation carried out by the main thread.
+ *
+ *  \param *name name of the file
+ *  \param record index of the record
+ *  \param *s pointer to the stream
+ *
+ *  \return false if the file could not be opened
+ */
+bool openStream(char *name, size_t record, STREAMINFO *s)
+{
+  memset(s, 0, sizeof(STREAMINFO));
+  s->outputFd = -1;
+  if (strcmp(name, "-") == 0){                                 /* pipes can not be read twice, spool them to disk */
+    char buffer[STREAM_COPY];
+    size_t n;
+    if ((s->spool = tmpfile()) == NULL)
+      return false;
+    while ((n = fread(buffer, 1, STREAM_COPY, stdin)) > 0)
+      if (fwrite(buffer, 1, n, s->spool) != n)
+        return false;
+    if (fflush(s->spool) != 0)
+      return false;
+    s->fd = fileno(s->spool);
+  }
+  else if ((s->fd = open(name, O_RDONLY)) < 0)
+    return false;
+
+  if (!readSignalHeader(s->fd, record, &s->record, NULL)){
+    closeStream(s);
+    return false;
+  }
+  s->numbSamples = s->record.numbSamples;
+
+  if (s->record.sampleType != SAMPLE_DOUBLE){
+    double buffer[STREAM_COPY / sizeof(double)], sum[2] = {0, 0};
+    size_t count = STREAM_COPY / sizeof(double);
+    for (int a = 0; a < 2; a++)
+      for (size_t i = 0; i < s->numbSamples; i += count){
+        size_t chunk = s->numbSamples - i < count ? s->numbSamples - i : count;
+        if (!readSignalSamples(s->fd, &s->record, a, i, chunk, buffer)){
+          closeStream(s);
+          return false;
+        }
+        for (size_t j = 0; j < chunk; j++)
+          sum[a] += buffer[j] * buffer[j];
+      }
+    s->sampleError = sampleErrorBound(&s->record, sum[0], sum[1]);
+  }
+  return true;
+}
+
+/**
+ *  \brief Close a signal file opened by openStream.
+ *
+ *  Operation carried out by the main thread.
+ *
+ *  \param *s pointer to the stream
+ */
+void closeStream(STREAMINFO *s)
+{
+  if (s->spool != NULL)
+    fclose(s->spool);
+  else if (s->fd >= 0)
+    close(s->fd);
+  if (s->outputFd >= 0)
+    close(s->outputFd);
+  s->spool = NULL;
+  s->fd = s->outputFd = -1;
+}
+
+/**
+ *  \brief Read consecutive samples of x (0), y (1) or expected (2), wrapping around the end of the signal.
+ *
+ *  Operation carried out by the worker threads.
+ *
+ *  \param *s pointer to the stream
+ *  \param array 0 for x, 1 for y, 2 for the expected result
+ *  \param first index of the first sample
+ *  \param count number of samples
+ *  \param *buffer where the samples are stored
+ *
+ *  \return false on a read error
+ */
+bool readSamples(STREAMINFO *s, int array, size_t first, size_t count, double *buffer)
+{
+  size_t n = s->numbSamples;
+
+  first %= n;
+  while (count > 0){
+    size_t chunk = count < n - first ? count : n - first;
+    if (!readSignalSamples(s->fd, &s->record, array, first, chunk, buffer))
+      return false;
+    buffer += chunk;
+    count -= chunk;
+    first = 0;
+  }
+  return true;
+}
+
+/**
+ *  \brief Allocate the scratch memory of a worker.
+ *
+ *  Wide blocks use overlap-save FFT segments, narrow ones the direct method (see autotune.h).
+ *
+ *  Operation carried out by the worker threads.
+ *
+ *  \param *b pointer to the scratch memory
+ *  \param blockSize number of samples (and lags) of a block
+ *
+ *  \return false if the memory could not be allocated
+ */
+bool initStreamBlock(STREAMBLOCK *b, size_t blockSize)
+{
+  memset(b, 0, sizeof(STREAMBLOCK));
+  b->blockSize = blockSize;
+  b->fft = blockSize > tuning.fftCrossover * log2((double) blockSize);
+  for (b->fftSize = 1; b->fftSize < 2 * blockSize - 1; b->fftSize <<= 1)
+    ;
+  b->xBlock = (double *) malloc(sizeof(double) * blockSize);
+  b->ySegment = (double *) malloc(sizeof(double) * 2 * blockSize);
+  if (b->fft){
+    b->X = (double complex *) malloc(sizeof(double complex) * b->fftSize);
+    b->Y = (double complex *) malloc(sizeof(double complex) * b->fftSize);
+  }
+  return b->xBlock != NULL && b->ySegment != NULL && (!b->fft || (b->X != NULL && b->Y != NULL));
+}
+
+/**
+ *  \brief Free the scratch memory of a worker.
+ *
+ *  Operation carried out by the worker threads.
+ *
+ *  \param *b pointer to the scratch memory
+ */
+void freeStreamBlock(STREAMBLOCK *b)
+{
+  free(b->xBlock);
+  free(b->ySegment);
+  free(b->X);
+  free(b->Y);
+}
+
+/**
+ *  \brief Compute a block of lags of the circular cross correlation, reading x and y block by block.
+ *
+ *  For the lags [k0, k0+L) and the samples [j0, j0+J) of x, only the segment [j0+k0, j0+k0+J+L-1) of y is needed
+ *  (modulo n). The direct method adds the terms of each lag in the same order as the in-memory kernel; the FFT
+ *  method correlates the zero padded block of x with the segment of y, whose first L values need no wrap around.
+ *
+ *  Operation carried out by the worker threads.
+ *
+ *  \param *s pointer to the stream
+ *  \param *b pointer to the scratch memory
+ *  \param firstLag first lag of the block
+ *  \param numbLags number of lags, at most the block size
+ *  \param *values where the correlation at each lag is stored
+ *
+ *  \return false on a read or allocation error
+ */
+bool correlateStreamBlock(STREAMINFO *s, STREAMBLOCK *b, size_t firstLag, size_t numbLags, double *values)
+{
+  size_t n = s->numbSamples, j0, i, k;
+
+  for (k = 0; k < numbLags; k++)
+    values[k] = 0;
+
+  for (j0 = 0; j0 < n; j0 += b->blockSize){
+    size_t numbX = n - j0 < b->blockSize ? n - j0 : b->blockSize;
+    size_t numbY = numbX + numbLags - 1;
+
+    if (!readSamples(s, 0, j0, numbX, b->xBlock) || !readSamples(s, 1, j0 + firstLag, numbY, b->ySegment))
+      return false;
+
+    if (b->fft){
+      for (i = 0; i < b->fftSize; i++){
+        b->X[i] = i < numbX ? b->xBlock[i] : 0;
+        b->Y[i] = i < numbY ? b->ySegment[i] : 0;
+      }
+      if (!fftTransform(b->X, b->fftSize, false) || !fftTransform(b->Y, b->fftSize, false))
+        return false;
+      for (i = 0; i < b->fftSize; i++)
+        b->X[i] = conj(b->X[i]) * b->Y[i];
+      if (!fftTransform(b->X, b->fftSize, true))
+        return false;
+      for (k = 0; k < numbLags; k++)
+        values[k] += creal(b->X[k]);
+    }
+    else
+      for (k = 0; k < numbLags; k++)
+        for (i = 0; i < numbX; i++)
+          values[k] += b->xBlock[i] * b->ySegment[i+k];
+  }
+  return true;
+}
+
+/**
+ *  \brief Compare a block of lags with the expected result, read from the file.
+ *
+ *  Operation carried out by the worker threads.
+ *
+ *  \param *s pointer to the stream
+ *  \param *b pointer to the scratch memory
+ *  \param firstLag first lag of the block
+ *  \param numbLags number of lags
+ *  \param *values correlation at each lag
+ *  \param *errors where the errors of the block are counted, every lag being wrong when the expected result
+ *                 could not be read
+ */
+void verifyStreamBlock(STREAMINFO *s, STREAMBLOCK *b, size_t firstLag, size_t numbLags, double *values,
+                       ERRORSTATS *errors)
+{
+  size_t k;
+  double *expected = b->ySegment;
+
+  if (!readSamples(s, 2, firstLag, numbLags, expected)){
+    if (errors->numbErrors == 0)
+      errors->firstError = firstLag;
+    errors->numbChecked += numbLags;
+    errors->numbErrors += numbLags;
+    return;
+  }
+  for (k = 0; k < numbLags; k++)
+    checkLag(errors, firstLag + k, expected[k], values[k],
+             b->fft ? FFT_TOLERANCE * (fabs(expected[k]) > 1 ? fabs(expected[k]) : 1) + s->sampleError : s->sampleError);
+}
+
+/**
+ *  \brief Create the file where the result of a stream is written, named after the input inside a directory.
+ *
+ *  The file has the same layout as the signal files: the number of samples followed by rxy.
+ *
+ *  Operation carried out by the main thread.
+ *
+ *  \param *name name of the input file
+ *  \param *directory directory of the output file
+ *  \param *s pointer to the stream
+ *
+ *  \return false if the file could not be created
+ */
+bool createStreamOutput(char *name, char *directory, STREAMINFO *s)
+{
+  char path[PATH_MAX], copy[PATH_MAX];
+  int samples = s->numbSamples;
+
+  strncpy(copy, strcmp(name, "-") == 0 ? "stdin" : name, PATH_MAX - 1);
+  copy[PATH_MAX - 1] = '\0';
+  snprintf(path, PATH_MAX, "%s/%s.rxy", directory, basename(copy));
+  if ((s->outputFd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0)
+    return false;
+  return pwrite(s->outputFd, &samples, sizeof(int), 0) == sizeof(int);
+}
+
+/**
+ *  \brief Write a block of lags to the output file, at its position.
+ *
+ *  Operation carried out by the worker threads.
+ *
+ *  \param *s pointer to the stream
+ *  \param firstLag first lag of the block
+ *  \param numbLags number of lags
+ *  \param *values correlation at each lag
+ *
+ *  \return false on a write error
+ */
+bool writeStreamBlock(STREAMINFO *s, size_t firstLag, size_t numbLags, double *values)
+{
+  off_t position = sizeof(int) + (off_t) firstLag * sizeof(double);
+  size_t count = numbLags * sizeof(double);
+  char *buffer = (char *) values;
+
+  while (count > 0){
+    ssize_t n = pwrite(s->outputFd, buffer, count, position);
+    if (n <= 0)
+      return false;
+    buffer += n;
+    count -= n;
+    position += n;
+  }
+  return true;
+}
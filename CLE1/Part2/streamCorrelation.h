@@ -0,0 +1,132 @@
+/**
+ *  \file streamCorrelation.h (interface file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  Circular cross correlation of signals that do not fit in memory: the signals are read from the file in blocks
+ *  and each block of lags is computed by overlap-save FFT segments or by a blocked direct method, both wrapping
+ *  around the end of the signal.
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - April 2020
+ */
+
+#ifndef STREAMCORRELATION_H
+#define STREAMCORRELATION_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <complex.h>
+
+#include "STREAMINFO.h"
+
+/** \brief scratch memory of a worker, bounded by the block size */
+typedef struct
+{
+   size_t blockSize;
+   size_t fftSize;
+   bool fft;
+   double *xBlock;
+   double *ySegment;
+   double complex *X;
+   double complex *Y;
+} STREAMBLOCK;
+
+/**
+ *  \brief Open a record of a signal file for reading in blocks, "-" is the standard input (spooled to a temporary file).
+ *
+ *  \param *name name of the file
+ *  \param record index of the record
+ *  \param *s pointer to the stream
+ *
+ *  \return false if the file could not be opened
+ */
+extern bool openStream(char *name, size_t record, STREAMINFO *s);
+
+/**
+ *  \brief Close a signal file opened by openStream.
+ *
+ *  \param *s pointer to the stream
+ */
+extern void closeStream(STREAMINFO *s);
+
+/**
+ *  \brief Read consecutive samples of x (0), y (1) or expected (2), wrapping around the end of the signal.
+ *
+ *  \param *s pointer to the stream
+ *  \param array 0 for x, 1 for y, 2 for the expected result
+ *  \param first index of the first sample
+ *  \param count number of samples
+ *  \param *buffer where the samples are stored
+ *
+ *  \return false on a read error
+ */
+extern bool readSamples(STREAMINFO *s, int array, size_t first, size_t count, double *buffer);
+
+/**
+ *  \brief Allocate the scratch memory of a worker.
+ *
+ *  \param *b pointer to the scratch memory
+ *  \param blockSize number of samples (and lags) of a block
+ *
+ *  \return false if the memory could not be allocated
+ */
+extern bool initStreamBlock(STREAMBLOCK *b, size_t blockSize);
+
+/**
+ *  \brief Free the scratch memory of a worker.
+ *
+ *  \param *b pointer to the scratch memory
+ */
+extern void freeStreamBlock(STREAMBLOCK *b);
+
+/**
+ *  \brief Compute a block of lags of the circular cross correlation, reading x and y block by block.
+ *
+ *  \param *s pointer to the stream
+ *  \param *b pointer to the scratch memory
+ *  \param firstLag first lag of the block
+ *  \param numbLags number of lags, at most the block size
+ *  \param *values where the correlation at each lag is stored
+ *
+ *  \return false on a read or allocation error
+ */
+extern bool correlateStreamBlock(STREAMINFO *s, STREAMBLOCK *b, size_t firstLag, size_t numbLags, double *values);
+
+/**
+ *  \brief Compare a block of lags with the expected result, read from the file.
+ *
+ *  \param *s pointer to the stream
+ *  \param *b pointer to the scratch memory
+ *  \param firstLag first lag of the block
+ *  \param numbLags number of lags
+ *  \param *values correlation at each lag
+ *  \param *errors where the errors of the block are counted, every lag being wrong when the expected result
+ *                 could not be read
+ */
+extern void verifyStreamBlock(STREAMINFO *s, STREAMBLOCK *b, size_t firstLag, size_t numbLags, double *values,
+                              ERRORSTATS *errors);
+
+/**
+ *  \brief Create the file where the result of a stream is written, named after the input inside a directory.
+ *
+ *  \param *name name of the input file
+ *  \param *directory directory of the output file
+ *  \param *s pointer to the stream
+ *
+ *  \return false if the file could not be created
+ */
+extern bool createStreamOutput(char *name, char *directory, STREAMINFO *s);
+
+/**
+ *  \brief Write a block of lags to the output file, at its position.
+ *
+ *  \param *s pointer to the stream
+ *  \param firstLag first lag of the block
+ *  \param numbLags number of lags
+ *  \param *values correlation at each lag
+ *
+ *  \return false on a write error
+ */
+extern bool writeStreamBlock(STREAMINFO *s, size_t firstLag, size_t numbLags, double *values);
+
+#endif /* STREAMCORRELATION_H */
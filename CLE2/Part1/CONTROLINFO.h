@@ -3,7 +3,8 @@
  *
  *  \brief Problem name: Problem 1.
  *
- *  File with the data shared accross all threads.
+ *  File with the data shared accross all threads: a chunk and the counts of its words (see TEXTCOUNTS.h of
+ *  libclestats).
  *
  *  \author Francisco Gonalves Tiago Lucas - June 2020
  */
@@ -13,14 +14,14 @@
 
 #include <stdlib.h>
 #include "probConst.h"
+#include "TEXTCOUNTS.h"
 
 typedef struct
 {
    size_t filePosition;
    size_t numbBytes;
-   size_t numbWords;
-   size_t maxWordLength;
-   int bidi[MAX_SIZE_WORD][MAX_SIZE_WORD];
+   size_t sampleChunk;
+   TEXTCOUNTS counts;
 }CONTROLINFO;
 
 #endif /* end of include guard: CONTROLINFO_H */
@@ -0,0 +1,44 @@
+/**
+ *  \file DECODERINFO.h (interface file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  Decompression of a text read as a stream: its compressed bytes, the state of the decompressor and, for a zstd
+ *  file made of frames of known sizes, the mapping of the file and the position of each frame.
+ *
+ *  \author Francisco Gonalves Tiago Lucas - June 2020
+ */
+ 
+#ifndef DECODERINFO_H
+#define DECODERINFO_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+typedef struct
+{
+   int fd;
+   int format;
+   unsigned char *input;
+   size_t inputLength;
+   size_t inputOffset;
+   bool inputEnded;
+   bool ended;
+   bool inFrame;
+   z_stream gzip;
+#ifdef HAVE_ZSTD
+   ZSTD_DCtx *zstd;
+#endif
+   unsigned char *map;
+   size_t mapSize;
+   uint64_t *frames;
+   uint64_t *frameSizes;
+   size_t numbFrames;
+} DECODERINFO;
+
+#endif /* end of include guard: DECODERINFO_H */
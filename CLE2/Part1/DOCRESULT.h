@@ -0,0 +1,25 @@
+/**
+ *  \file DOCRESULT.h (interface file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  Results of a document as they are kept in the result cache: its counts and the sketch of its distinct words.
+ *
+ *  \author Francisco Gonalves Tiago Lucas - June 2020
+ */
+ 
+#ifndef DOCRESULT_H
+#define DOCRESULT_H
+
+#include <stdlib.h>
+
+#include "probConst.h"
+#include "CONTROLINFO.h"
+
+typedef struct
+{
+   CONTROLINFO counts;
+   unsigned char registers[HLL_REGISTERS];
+} DOCRESULT;
+
+#endif /* end of include guard: DOCRESULT_H */
@@ -0,0 +1,25 @@
+/**
+ *  \file PACKENTRY.h (interface file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  Entry of the index of a corpus pack, referencing one document.
+ *  It is stored as is in the file, so only fixed size fields are used.
+ *
+ *  \author Francisco Gonalves Tiago Lucas - June 2020
+ */
+ 
+#ifndef PACKENTRY_H
+#define PACKENTRY_H
+
+#include <stdint.h>
+
+typedef struct
+{
+   uint64_t id;
+   uint64_t offset;
+   uint64_t size;
+   uint64_t nameOffset;
+}PACKENTRY;
+
+#endif /* end of include guard: PACKENTRY_H */
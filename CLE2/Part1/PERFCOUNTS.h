@@ -0,0 +1,27 @@
+/**
+ *  \file PERFCOUNTS.h (interface file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  Hardware counters of a thread over some work: cycles, instructions, last level cache misses and branch
+ *  misses, with the number of bytes the work went through and the number of work units.
+ *
+ *  \author Francisco Gonalves Tiago Lucas - June 2020
+ */
+ 
+#ifndef PERFCOUNTS_H
+#define PERFCOUNTS_H
+
+#include <stdint.h>
+
+typedef struct
+{
+   uint64_t cycles;
+   uint64_t instructions;
+   uint64_t cacheMisses;
+   uint64_t branchMisses;
+   uint64_t bytes;
+   uint64_t units;
+} PERFCOUNTS;
+
+#endif /* end of include guard: PERFCOUNTS_H */
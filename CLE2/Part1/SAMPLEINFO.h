@@ -0,0 +1,41 @@
+/**
+ *  \file SAMPLEINFO.h (interface file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  Sample of the chunks of a document: its chunks split in strata of consecutive chunks, the chunks of each stratum
+ *  taken in a random order (an affine permutation), and for each stratum the chunks taken and processed, the sums
+ *  of their numbers of words (total and of each length) and of their squares, and the sum of their results.
+ *
+ *  \author Francisco Gonalves Tiago Lucas - June 2020
+ */
+ 
+#ifndef SAMPLEINFO_H
+#define SAMPLEINFO_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "probConst.h"
+#include "CONTROLINFO.h"
+
+typedef struct
+{
+   uint64_t size;
+   uint64_t numbChunks;
+   size_t numbStrata;
+   size_t nextStratum;
+   bool finished;
+   uint64_t first[SAMPLE_STRATA];
+   uint64_t numbInStratum[SAMPLE_STRATA];
+   uint64_t step[SAMPLE_STRATA];
+   uint64_t shift[SAMPLE_STRATA];
+   uint64_t taken[SAMPLE_STRATA];
+   uint64_t done[SAMPLE_STRATA];
+   double sum[SAMPLE_STRATA][MAX_SIZE_WORD + 1];
+   double sumSquares[SAMPLE_STRATA][MAX_SIZE_WORD + 1];
+   CONTROLINFO strata[SAMPLE_STRATA];
+} SAMPLEINFO;
+
+#endif /* end of include guard: SAMPLEINFO_H */
@@ -0,0 +1,27 @@
+/**
+ *  \file TRACEEVENT.h (interface file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  Event of the timeline of a run: what was done (one of the TRACE_ constants), by which thread of which process,
+ *  when it began and how long it took, in microseconds.
+ *
+ *  \author Francisco Gonalves Tiago Lucas - June 2020
+ */
+ 
+#ifndef TRACEEVENT_H
+#define TRACEEVENT_H
+
+#include <stdint.h>
+
+typedef struct
+{
+   double start;
+   double duration;
+   uint32_t event;
+   uint32_t thread;
+   int32_t process;
+   uint32_t pad;
+} TRACEEVENT;
+
+#endif /* end of include guard: TRACEEVENT_H */
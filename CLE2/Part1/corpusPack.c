@@ -0,0 +1,400 @@
+/**
+ *  \file corpusPack.c (implementation file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  \author Francisco Gonalves and Tiago Lucas - June 2020
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "probConst.h"
+#include "PACKENTRY.h"
+#include "READBLOCK.h"
+#include "DOCINFO.h"
+#include "corpusPack.h"
+#include "fileList.h"
+#include "readEngine.h"
+#include "streamReader.h"
+#include "textDecoder.h"
+
+/** \brief mapped packs */
+static unsigned char **packs;
+
+/** \brief size of each mapped pack */
+static size_t *packSizes;
+
+/** \brief number of mapped packs */
+static size_t numbPacks;
+
+/**
+ *  \brief Map a corpus pack in memory, checking its header and index.
+ *
+ *  Internal operation.
+ *
+ *  \return pointer to the mapping, NULL if the file is not a pack (or is damaged, *damaged being set)
+ */
+static unsigned char *mapPack(char *name, size_t *size, bool *damaged)
+{
+  unsigned char *map, magic[8];
+  uint32_t version;
+  uint64_t numbDocs, indexOffset, namesOffset, namesSize;
+  struct stat st;
+  int fd;
+
+  *damaged = false;
+  if ((fd = open(name, O_RDONLY)) < 0)
+    return NULL;
+  if (read(fd, magic, sizeof(magic)) != sizeof(magic) || memcmp(magic, PACK_MAGIC, sizeof(magic)) != 0
+      || fstat(fd, &st) != 0 || st.st_size < PACK_HEADER){
+    close(fd);
+    return NULL;
+  }
+  map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  *damaged = true;
+  if (map == MAP_FAILED)
+    return NULL;
+  madvise(map, st.st_size, MADV_SEQUENTIAL);                                 /* read once, front to back */
+
+  memcpy(&version, map + 8, sizeof(uint32_t));
+  memcpy(&numbDocs, map + 16, sizeof(uint64_t));
+  memcpy(&indexOffset, map + 24, sizeof(uint64_t));
+  memcpy(&namesOffset, map + 32, sizeof(uint64_t));
+  memcpy(&namesSize, map + 40, sizeof(uint64_t));
+  if (version != PACK_VERSION || indexOffset + numbDocs * sizeof(PACKENTRY) > (uint64_t) st.st_size
+      || namesOffset + namesSize > (uint64_t) st.st_size || namesSize == 0 || map[namesOffset + namesSize - 1] != '\0'){
+    munmap(map, st.st_size);
+    return NULL;
+  }
+  for (uint64_t i = 0; i < numbDocs; i++){
+    PACKENTRY e;
+    memcpy(&e, map + indexOffset + i * sizeof(PACKENTRY), sizeof(PACKENTRY));
+    if (e.offset + e.size > (uint64_t) st.st_size || e.nameOffset >= namesSize){
+      munmap(map, st.st_size);
+      return NULL;
+    }
+  }
+  *damaged = false;
+  *size = st.st_size;
+  return map;
+}
+
+/**
+ *  \brief Expand a list of files into the documents to process, a corpus pack giving one document per entry of its index.
+ *
+ *  The packs are mapped in memory until closeDocuments. The name of a document of a pack is pack:name. Directories
+ *  and @lists are expanded first (see fileList.h). A stream (- for standard input, a pipe, or a file compressed
+ *  with gzip or zstd) is a single document with no known size, read once from start to end.
+ *
+ *  \param *names[] names of the files
+ *  \param numbNames number of files
+ *  \param **documents where the array of documents is stored
+ *
+ *  \return number of documents, 0 if a pack is damaged
+ */
+size_t listDocuments(char *names[], size_t numbNames, DOCINFO **documents)
+{
+  size_t i, numbDocuments = 0, size;
+  DOCINFO *d;
+
+  numbNames = expandFileNames(names, numbNames, &names);
+  size = numbNames > 0 ? numbNames : 1;
+  d = (DOCINFO *) calloc(size, sizeof(DOCINFO));
+
+  packs = (unsigned char **) malloc(sizeof(unsigned char *) * size);
+  packSizes = (size_t *) malloc(sizeof(size_t) * size);
+  numbPacks = 0;
+
+  for (i = 0; i < numbNames; i++){
+    size_t mapSize;
+    struct stat st;
+    bool damaged, stream = isStream(names[i]) || textFormat(names[i]) != TEXT_PLAIN;
+    unsigned char *map = stream ? NULL : mapPack(names[i], &mapSize, &damaged);    /* checking it would consume it */
+    uint64_t numbDocs, indexOffset, namesOffset;
+
+    if (stream){
+      if (numbDocuments == size)
+        d = (DOCINFO *) realloc(d, sizeof(DOCINFO) * (size *= 2));
+      memset(&d[numbDocuments], 0, sizeof(DOCINFO));
+      d[numbDocuments].name = strcmp(names[i], "-") == 0 ? (char *) "stdin" : names[i];
+      d[numbDocuments].path = names[i];
+      d[numbDocuments].id = numbDocuments;
+      d[numbDocuments].size = SIZE_MAX;
+      d[numbDocuments].stream = newStream();
+      numbDocuments++;
+      continue;
+    }
+    if (damaged){
+      fprintf(stderr, "error on reading the corpus pack %s\n", names[i]);
+      free(d);
+      return 0;
+    }
+    if (map == NULL){                                                         /* a text file */
+      if (numbDocuments == size)
+        d = (DOCINFO *) realloc(d, sizeof(DOCINFO) * (size *= 2));
+      memset(&d[numbDocuments], 0, sizeof(DOCINFO));
+      d[numbDocuments].name = d[numbDocuments].path = names[i];
+      d[numbDocuments].id = numbDocuments;
+      if (stat(names[i], &st) == 0)                                           /* read up to this size */
+        d[numbDocuments].size = st.st_size;
+      numbDocuments++;
+      continue;
+    }
+
+    packs[numbPacks] = map;
+    packSizes[numbPacks++] = mapSize;
+    memcpy(&numbDocs, map + 16, sizeof(uint64_t));
+    memcpy(&indexOffset, map + 24, sizeof(uint64_t));
+    memcpy(&namesOffset, map + 32, sizeof(uint64_t));
+    if (numbDocuments + numbDocs > size)
+      d = (DOCINFO *) realloc(d, sizeof(DOCINFO) * (size = 2 * size + numbDocs));
+    for (uint64_t j = 0; j < numbDocs; j++, numbDocuments++){
+      PACKENTRY e;
+      char *docName;
+      memcpy(&e, map + indexOffset + j * sizeof(PACKENTRY), sizeof(PACKENTRY));
+      docName = (char *) map + namesOffset + e.nameOffset;
+      memset(&d[numbDocuments], 0, sizeof(DOCINFO));
+      d[numbDocuments].name = (char *) malloc(strlen(names[i]) + strlen(docName) + 2);
+      sprintf(d[numbDocuments].name, "%s:%s", names[i], docName);
+      d[numbDocuments].data = map + e.offset;
+      d[numbDocuments].size = e.size;
+      d[numbDocuments].id = e.id;
+    }
+  }
+
+  *documents = d;
+  return numbDocuments;
+}
+
+/**
+ *  \brief Release the reads ahead of a text file and close it.
+ *
+ *  Internal operation.
+ */
+static void closeAhead(DOCINFO *d)
+{
+  for (size_t i = 0; i < d->numbAhead; i++){
+    waitRead(d->ahead[i]);
+    releaseRead(d->ahead[i]);
+  }
+  free(d->ahead);
+  d->ahead = NULL;
+  d->numbAhead = 0;
+  close(d->fd);
+}
+
+/**
+ *  \brief Read the next bytes of a text file through the read engine.
+ *
+ *  Each open file keeps up to a share of the depth of the engine of reads ahead of its position, so that the
+ *  reads of all the active files are outstanding at the same time. The blocks already consumed are only given
+ *  back on the next call, the bytes given back by unreadDocument being still in them. When no buffer of the pool
+ *  is free the bytes are read directly.
+ *
+ *  Internal operation.
+ */
+static size_t readAhead(DOCINFO *d, unsigned char *buffer, size_t count)
+{
+  size_t share = readQueueDepth() / ACTIVE_FILES > 0 ? readQueueDepth() / ACTIVE_FILES : 1;
+  size_t n = 0, i;
+
+  while (d->numbAhead > 0 && d->ahead[0]->offset + d->ahead[0]->length <= d->position){     /* consumed */
+    waitRead(d->ahead[0]);
+    releaseRead(d->ahead[0]);
+    memmove(d->ahead, d->ahead + 1, sizeof(READBLOCK *) * --d->numbAhead);
+  }
+  if (d->numbAhead == 0)
+    d->nextOffset = d->position;
+  while (d->numbAhead < share && d->nextOffset < d->size){
+    size_t length = d->size - d->nextOffset < readBlockSize() ? d->size - d->nextOffset : readBlockSize();
+    READBLOCK *b = submitRead(d->fd, d->nextOffset, length, false);
+    if (b == NULL)
+      break;
+    d->ahead[d->numbAhead++] = b;
+    d->nextOffset += length;
+  }
+
+  for (i = 0; i < d->numbAhead && n < count && d->position < d->size; i++){
+    READBLOCK *b = d->ahead[i];
+    size_t m;
+    if (!waitRead(b) || b->result < (ssize_t) b->length){                  /* error, or the file got shorter */
+      d->size = b->offset + (b->result > 0 ? b->result : 0);
+      if (d->position >= d->size)
+        break;
+    }
+    m = b->offset + b->length - d->position < count - n ? b->offset + b->length - d->position : count - n;
+    m = d->position + m > d->size ? d->size - d->position : m;
+    memcpy(buffer + n, b->buffer + (d->position - b->offset), m);
+    n += m;
+    d->position += m;
+  }
+  while (n < count && d->position < d->size){                               /* past the reads ahead */
+    ssize_t m = pread(d->fd, buffer + n, count - n, d->position);
+    if (m <= 0)
+      break;
+    n += m;
+    d->position += m;
+  }
+  return n;
+}
+
+/**
+ *  \brief Open a document for reading, only text files need it.
+ *
+ *  A text file is read from the position of the document (after a prefix whose results are cached) up to its
+ *  size. With the read engine started, it is read in blocks of the pool of the engine, ahead of the position. A
+ *  stream is read by its own thread, in blocks of STREAM_BLOCK bytes (see streamReader.h).
+ *
+ *  \param *d document
+ *
+ *  \return false if the file could not be opened
+ */
+bool openDocument(DOCINFO *d)
+{
+  if (d->data != NULL || d->file != NULL || d->ahead != NULL)
+    return true;
+  if (d->stream != NULL)
+    return startStream(d->stream, d->path);
+  if (readEngineActive()){
+    size_t share = readQueueDepth() / ACTIVE_FILES > 0 ? readQueueDepth() / ACTIVE_FILES : 1;
+    if ((d->fd = open(d->path, O_RDONLY)) < 0)
+      return false;
+    d->ahead = (READBLOCK **) malloc(sizeof(READBLOCK *) * share);
+    d->numbAhead = 0;
+    d->nextOffset = d->position;
+    return true;
+  }
+  if ((d->file = fopen(d->path, "rb")) == NULL)
+    return false;
+  if (d->position > 0)
+    fseek(d->file, (long) d->position, SEEK_SET);
+  return true;
+}
+
+/**
+ *  \brief Read the next bytes of a document.
+ *
+ *  \param *d document
+ *  \param *buffer where the bytes are stored
+ *  \param count number of bytes to read
+ *
+ *  \return number of bytes read, less than count at the end of the document (the document is then closed)
+ */
+size_t readDocument(DOCINFO *d, unsigned char *buffer, size_t count)
+{
+  size_t n;
+
+  if (d->data != NULL){                                                       /* straight from the mapping */
+    n = d->size - d->position < count ? d->size - d->position : count;
+    memcpy(buffer, d->data + d->position, n);
+    d->position += n;
+    return n;
+  }
+  if (d->stream != NULL){
+    n = readStream(d->stream, buffer, count);
+    d->position += n;
+    if (n < count)
+      closeStream(d->stream);
+    return n;
+  }
+  if (d->ahead != NULL){
+    n = readAhead(d, buffer, count);
+    if (n < count)
+      closeAhead(d);
+    return n;
+  }
+  n = fread(buffer, 1, d->size - d->position < count ? d->size - d->position : count, d->file);
+  d->position += n;
+  if (n < count){
+    fclose(d->file);
+    d->file = NULL;
+  }
+  return n;
+}
+
+/**
+ *  \brief Read bytes of a document at a position, without moving it (a text file is kept open to be read again).
+ *
+ *  \param *d document
+ *  \param *buffer where the bytes are stored
+ *  \param count number of bytes to read
+ *  \param offset position of the first byte
+ *
+ *  \return number of bytes read, less than count past the end of the document
+ */
+size_t readDocumentAt(DOCINFO *d, unsigned char *buffer, size_t count, uint64_t offset)
+{
+  size_t n = 0;
+
+  if (offset >= d->size)
+    return 0;
+  count = d->size - offset < count ? d->size - offset : count;
+  if (d->data != NULL){
+    memcpy(buffer, d->data + offset, count);
+    return count;
+  }
+  if (d->file == NULL && (d->file = fopen(d->path, "rb")) == NULL)
+    return 0;
+  while (n < count){
+    ssize_t m = pread(fileno(d->file), buffer + n, count - n, offset + n);
+    if (m <= 0)
+      break;
+    n += m;
+  }
+  return n;
+}
+
+/**
+ *  \brief Give back the last bytes read of a document, so that they are read again.
+ *
+ *  A stream cannot go back, the bytes are kept to start its next read.
+ *
+ *  \param *d document
+ *  \param count number of bytes
+ */
+void unreadDocument(DOCINFO *d, size_t count)
+{
+  d->position -= count;
+  if (d->stream != NULL)
+    unreadStream(d->stream, count);
+  else if (d->data == NULL && d->ahead == NULL)
+    fseek(d->file, -(long) count, SEEK_CUR);
+}
+
+/**
+ *  \brief Release the documents and unmap the packs.
+ *
+ *  \param *documents array of documents
+ *  \param numbDocuments number of documents
+ */
+void closeDocuments(DOCINFO *documents, size_t numbDocuments)
+{
+  size_t i;
+
+  for (i = 0; i < numbDocuments; i++){
+    if (documents[i].file != NULL)
+      fclose(documents[i].file);
+    if (documents[i].ahead != NULL)
+      closeAhead(&documents[i]);
+    if (documents[i].stream != NULL)
+      freeStream(documents[i].stream);
+    free(documents[i].resume);
+    if (documents[i].data != NULL)
+      free(documents[i].name);
+  }
+  for (i = 0; i < numbPacks; i++)
+    munmap(packs[i], packSizes[i]);
+  free(packs);
+  free(packSizes);
+  free(documents);
+  numbPacks = 0;
+}
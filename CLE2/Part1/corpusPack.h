@@ -0,0 +1,99 @@
+/**
+ *  \file corpusPack.h (interface file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  Documents to process, either text files or the documents of a corpus pack: many small documents concatenated
+ *  in a single file, which is mapped in memory instead of opening each document.
+ *
+ *     header, 64 bytes       magic "CLECORPS", uint32 version, uint32 reserved, uint64 number of documents,
+ *                            uint64 offset of the index, uint64 offset and uint64 size of the names,
+ *                            uint64 offset of the data, zero padding
+ *     index                  one PACKENTRY per document (id, offset and size of its text, offset of its name)
+ *     names                  name of each document, '\0' terminated
+ *     data                   text of the documents, one after the other
+ *
+ *  \author Francisco Gonalves and Tiago Lucas - June 2020
+ */
+
+#ifndef CORPUSPACK_H
+#define CORPUSPACK_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "DOCINFO.h"
+
+/** \brief magic number of a corpus pack */
+#define  PACK_MAGIC          "CLECORPS"
+
+/** \brief version of a corpus pack */
+#define  PACK_VERSION        1
+
+/** \brief size of the header of a corpus pack */
+#define  PACK_HEADER         64
+
+/**
+ *  \brief Expand a list of files into the documents to process, a corpus pack giving one document per entry of its index.
+ *
+ *  The packs are mapped in memory until closeDocuments. The name of a document of a pack is pack:name. Directories
+ *  and @lists are expanded first (see fileList.h).
+ *
+ *  \param *names[] names of the files
+ *  \param numbNames number of files
+ *  \param **documents where the array of documents is stored
+ *
+ *  \return number of documents, 0 if a pack is damaged
+ */
+extern size_t listDocuments(char *names[], size_t numbNames, DOCINFO **documents);
+
+/**
+ *  \brief Open a document for reading, only text files need it.
+ *
+ *  \param *d document
+ *
+ *  \return false if the file could not be opened
+ */
+extern bool openDocument(DOCINFO *d);
+
+/**
+ *  \brief Read the next bytes of a document.
+ *
+ *  \param *d document
+ *  \param *buffer where the bytes are stored
+ *  \param count number of bytes to read
+ *
+ *  \return number of bytes read, less than count at the end of the document (the document is then closed)
+ */
+extern size_t readDocument(DOCINFO *d, unsigned char *buffer, size_t count);
+
+/**
+ *  \brief Read bytes of a document at a position, without moving it (a text file is kept open to be read again).
+ *
+ *  \param *d document
+ *  \param *buffer where the bytes are stored
+ *  \param count number of bytes to read
+ *  \param offset position of the first byte
+ *
+ *  \return number of bytes read, less than count past the end of the document
+ */
+extern size_t readDocumentAt(DOCINFO *d, unsigned char *buffer, size_t count, uint64_t offset);
+
+/**
+ *  \brief Give back the last bytes read of a document, so that they are read again.
+ *
+ *  \param *d document
+ *  \param count number of bytes
+ */
+extern void unreadDocument(DOCINFO *d, size_t count);
+
+/**
+ *  \brief Release the documents and unmap the packs.
+ *
+ *  \param *documents array of documents
+ *  \param numbDocuments number of documents
+ */
+extern void closeDocuments(DOCINFO *documents, size_t numbDocuments);
+
+#endif /* CORPUSPACK_H */
@@ -0,0 +1,335 @@
+/**
+ *  \file documentCache.c (implementation file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  \author Francisco Gonalves and Tiago Lucas - June 2020
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "probConst.h"
+#include "CONTROLINFO.h"
+#include "DOCRESULT.h"
+#include "TUNING.h"
+#include "autotune.h"
+#include "HASHSTATE.h"
+#include "RESUMESTATE.h"
+#include "DOCINFO.h"
+#include "resultCache.h"
+#include "documentCache.h"
+
+/** \brief seed of the content hashes */
+#define  CONTENT_SEED        0
+
+/** \brief seed of the keys of the names of the documents */
+#define  NAME_SEED           0x6e616d65ULL
+
+/** \brief seed of the keys of the saved states of the text files */
+#define  RESUME_SEED         0x726573756d65ULL
+
+/** \brief text files that only grew are resumed from their saved state */
+static bool resume;
+
+/**
+ *  \brief Key of the results of a content, the parameters that change them included.
+ *
+ *  Internal operation.
+ */
+static uint64_t resultKey(uint64_t contentHash)
+{
+  uint64_t parameters[4] = {tuning.chunkSize, MAX_SIZE_WORD, sizeof(DOCRESULT), offsetof(CONTROLINFO, counts)};
+  return hashBytes(parameters, sizeof(parameters), contentHash);
+}
+
+/**
+ *  \brief Look up the results of a content, its counts and the sketch of its distinct words.
+ *
+ *  Internal operation.
+ *
+ *  \return false if they are not in the cache
+ */
+static bool lookupResult(uint64_t contentHash, CONTROLINFO *ci, unsigned char *registers)
+{
+  DOCRESULT saved;
+
+  if (!cacheLookup(resultKey(contentHash), &saved, sizeof(DOCRESULT)))
+    return false;
+  *ci = saved.counts;
+  memcpy(registers, saved.registers, HLL_REGISTERS);
+  return true;
+}
+
+/**
+ *  \brief Key of the name of a document, the full path of a text file.
+ *
+ *  Internal operation.
+ */
+static uint64_t nameKey(DOCINFO *d, uint64_t seed)
+{
+  char path[PATH_MAX];
+  const char *name = d->data == NULL && realpath(d->path, path) != NULL ? path : d->name;
+  return hashBytes(name, strlen(name), seed);
+}
+
+/**
+ *  \brief Whether a byte ends a word whatever comes after it (a stop character of a single byte).
+ *
+ *  Internal operation.
+ */
+static bool isWordBoundary(unsigned char c)
+{
+  return c != '\0' && strchr(" \t\n-\"()[].,:;?!", c) != NULL;
+}
+
+/**
+ *  \brief Hash of count bytes of a file at a position.
+ *
+ *  Internal operation.
+ *
+ *  \return false if the bytes could not be read
+ */
+static bool hashRange(int fd, uint64_t offset, uint64_t count, uint64_t *hash)
+{
+  unsigned char buffer[READ_BLOCK];
+  HASHSTATE h;
+
+  hashStart(&h, CONTENT_SEED);
+  while (count > 0){
+    ssize_t n = pread(fd, buffer, count < sizeof(buffer) ? count : sizeof(buffer), offset);
+    if (n <= 0)
+      return false;
+    hashUpdate(&h, buffer, n);
+    offset += n;
+    count -= n;
+  }
+  *hash = hashDigest(&h);
+  return true;
+}
+
+/**
+ *  \brief Look up a text file by its saved state, only its first bytes and the bytes before the offset it
+ *  resumes from being read.
+ *
+ *  Internal operation.
+ *
+ *  \return CACHE_HIT if it did not change, CACHE_PREFIX if it only grew, CACHE_MISS otherwise
+ */
+static int resumeDocument(DOCINFO *d, CONTROLINFO *ci, unsigned char *registers)
+{
+  RESUMESTATE saved;
+  struct stat st;
+  uint64_t head, tail, from;
+  int fd, found = CACHE_MISS;
+
+  if ((fd = open(d->path, O_RDONLY)) < 0 || fstat(fd, &st) != 0){
+    if (fd >= 0)
+      close(fd);
+    return CACHE_MISS;
+  }
+  d->resume = (RESUMESTATE *) calloc(1, sizeof(RESUMESTATE));               /* what is saved after the run */
+  d->resume->modified = st.st_mtim.tv_sec;
+  d->resume->modifiedNsec = st.st_mtim.tv_nsec;
+  d->resume->inode = st.st_ino;
+
+  if (cacheLookup(nameKey(d, RESUME_SEED), &saved, sizeof(saved))
+      && saved.inode == (uint64_t) st.st_ino && saved.fileSize <= (uint64_t) st.st_size
+      && hashRange(fd, 0, saved.fileSize < RESUME_CHECK ? saved.fileSize : RESUME_CHECK, &head) && head == saved.headHash){
+    from = saved.offset < RESUME_CHECK ? 0 : saved.offset - RESUME_CHECK;
+    if (saved.fileSize == (uint64_t) st.st_size && saved.modified == st.st_mtim.tv_sec
+        && saved.modifiedNsec == st.st_mtim.tv_nsec){                       /* untouched */
+      *ci = saved.whole;
+      memcpy(registers, saved.registers, HLL_REGISTERS);
+      found = CACHE_HIT;
+    }
+    else if (saved.fileSize < (uint64_t) st.st_size && hashRange(fd, from, saved.fileSize - from, &tail)
+             && tail == saved.tailHash){                                      /* only appended to */
+      *ci = saved.prefix;
+      memcpy(registers, saved.registers, HLL_REGISTERS);
+      d->position = saved.offset;
+      found = CACHE_PREFIX;
+    }
+  }
+  close(fd);
+  if (found != CACHE_MISS)
+    d->size = st.st_size;
+  return found;
+}
+
+/**
+ *  \brief Save the state of a text file to resume it on the next run.
+ *
+ *  The results up to the last word boundary are the results of the whole file minus the results of the text after
+ *  it, which is processed on its own (it starts a word, as the text from a boundary does). The sketch of the distinct
+ *  words is kept whole, the words after the boundary being seen again when the file is resumed.
+ *
+ *  Internal operation.
+ */
+static void saveResume(DOCINFO *d, const CONTROLINFO *ci, const unsigned char *registers,
+                       void (*process)(unsigned char *, CONTROLINFO *))
+{
+  RESUMESTATE *s = d->resume;
+  unsigned char buffer[MAX_K + 3] = {0};                                     /* process may look 2 bytes ahead */
+  size_t n = d->size < tuning.chunkSize ? d->size : tuning.chunkSize, i;
+  CONTROLINFO tail = {0};
+  int fd;
+
+  if ((fd = open(d->path, O_RDONLY)) < 0)
+    return;
+  if (pread(fd, buffer, n, d->size - n) != (ssize_t) n){
+    close(fd);
+    return;
+  }
+  for (i = n; i > 0 && !isWordBoundary(buffer[i - 1]); i--)
+    ;
+  if (i == 0 && n < d->size){                                                 /* no boundary near the end */
+    close(fd);
+    return;
+  }
+  s->fileSize = d->size;
+  s->offset = d->size - n + i;
+  s->whole = *ci;
+  s->prefix = *ci;
+  memcpy(s->registers, registers, HLL_REGISTERS);
+  tail.numbBytes = n - i;
+  memmove(buffer, buffer + i, n - i);
+  memset(buffer + (n - i), 0, i);
+  process(buffer, &tail);
+  s->prefix.numbBytes -= tail.numbBytes;
+  s->prefix.counts.numbWords -= tail.counts.numbWords;
+  for (size_t x = 0; x < MAX_SIZE_WORD; x++)
+    for (size_t y = 0; y < MAX_SIZE_WORD; y++)
+      s->prefix.counts.bidi[x][y] -= tail.counts.bidi[x][y];
+
+  uint64_t from = s->offset < RESUME_CHECK ? 0 : s->offset - RESUME_CHECK;
+  if (hashRange(fd, 0, d->size < RESUME_CHECK ? d->size : RESUME_CHECK, &s->headHash)
+      && hashRange(fd, from, d->size - from, &s->tailHash))
+    cacheStore(nameKey(d, RESUME_SEED), s, sizeof(RESUMESTATE));
+  close(fd);
+}
+
+/**
+ *  \brief Resume the text files that only grew since the last run from their saved state.
+ *
+ *  Operation carried out by the main thread, before the documents are looked up.
+ */
+void enableResume(void)
+{
+  resume = true;
+}
+
+/**
+ *  \brief Look up the results of a document, hashing its content.
+ *
+ *  The size of the document becomes the number of bytes hashed, the document is never read past it.
+ *
+ *  \param *d document
+ *  \param *ci where the results found are stored
+ *  \param *registers where the sketch of the distinct words found is stored
+ *
+ *  \return CACHE_MISS, CACHE_HIT or CACHE_PREFIX (the position of the document is then set after the prefix)
+ */
+int lookupDocument(DOCINFO *d, CONTROLINFO *ci, unsigned char *registers)
+{
+  uint64_t prefix[2] = {0, 0};                                                /* size and content hash */
+  uint64_t prefixHash = 0;
+  unsigned char last = '\0';
+  HASHSTATE h;
+
+  if (!resultCacheActive() || d->stream != NULL)                            /* a stream can only be read once */
+    return CACHE_MISS;
+  if (resume && d->data == NULL){
+    int found = resumeDocument(d, ci, registers);
+    if (found != CACHE_MISS)
+      return found;
+  }
+  if (!cacheLookup(nameKey(d, NAME_SEED), prefix, sizeof(prefix)))
+    prefix[0] = 0;
+
+  hashStart(&h, CONTENT_SEED);
+  if (d->data != NULL){
+    if (prefix[0] <= d->size){
+      hashUpdate(&h, d->data, prefix[0]);
+      prefixHash = hashDigest(&h);
+      hashUpdate(&h, d->data + prefix[0], d->size - prefix[0]);
+    }
+    else
+      hashUpdate(&h, d->data, d->size);
+    last = d->size > 0 ? d->data[d->size - 1] : '\0';
+  }
+  else {
+    unsigned char buffer[READ_BLOCK];
+    uint64_t position = 0;
+    ssize_t n;
+    int fd;
+    if ((fd = open(d->path, O_RDONLY)) < 0)
+      return CACHE_MISS;
+    while ((n = read(fd, buffer, sizeof(buffer))) > 0){
+      if (position < prefix[0] && position + n >= prefix[0]){                 /* the prefix ends in this block */
+        hashUpdate(&h, buffer, prefix[0] - position);
+        prefixHash = hashDigest(&h);
+        hashUpdate(&h, buffer + (prefix[0] - position), position + n - prefix[0]);
+      }
+      else
+        hashUpdate(&h, buffer, n);
+      position += n;
+      last = buffer[n - 1];
+    }
+    close(fd);
+    if (n < 0)
+      return CACHE_MISS;
+    d->size = position;
+  }
+  d->contentHash = hashDigest(&h);
+  d->contentHashed = true;
+  d->wordBoundary = isWordBoundary(last);
+
+  if (lookupResult(d->contentHash, ci, registers))
+    return CACHE_HIT;
+  if (prefix[0] > 0 && prefix[0] <= d->size && prefixHash == prefix[1]
+      && lookupResult(prefix[1], ci, registers)){                               /* text appended since */
+    d->position = prefix[0];
+    return CACHE_PREFIX;
+  }
+  return CACHE_MISS;
+}
+
+/**
+ *  \brief Store the results of a document looked up before.
+ *
+ *  \param *d document
+ *  \param *ci results of the whole document
+ *  \param *registers sketch of the distinct words of the whole document
+ *  \param process function that processes a chunk of text, used to take the text after the last word boundary
+ *  of a text file out of the results saved to resume it
+ */
+void storeDocument(DOCINFO *d, const CONTROLINFO *ci, const unsigned char *registers,
+                   void (*process)(unsigned char *, CONTROLINFO *))
+{
+  uint64_t prefix[2] = {d->size, d->contentHash};
+  DOCRESULT result;
+
+  if (!resultCacheActive())
+    return;
+  if (d->contentHashed){
+    result.counts = *ci;
+    memcpy(result.registers, registers, HLL_REGISTERS);
+    cacheStore(resultKey(d->contentHash), &result, sizeof(DOCRESULT));
+    if (d->wordBoundary)                                                      /* text appended later starts a word */
+      cacheStore(nameKey(d, NAME_SEED), prefix, sizeof(prefix));
+  }
+  if (d->resume != NULL){
+    saveResume(d, ci, registers, process);
+    free(d->resume);
+    d->resume = NULL;
+  }
+}
@@ -0,0 +1,75 @@
+/**
+ *  \file documentCache.h (interface file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  Results of the documents kept in the result cache (see resultCache.h) across runs.
+ *
+ *  The results of a document are stored under the content hash of the document (and the parameters they depend
+ *  on). When the document ends at a word boundary, its name is also stored with its size and content hash, so that
+ *  once more text is appended to it only the new text is processed, the results of the prefix being taken from the
+ *  cache.
+ *
+ *  With resuming enabled, a text file is also saved after a run with its size, time of modification, inode, the
+ *  hash of its first bytes and of the bytes before the offset of its last word boundary, and the results up to
+ *  that offset. On the next run, a file that only grew is resumed from that offset without reading the rest of it
+ *  (the partial word at its end being processed again with the appended text), and an unchanged one is not read
+ *  at all. A truncated or rewritten file fails those checks and is looked up by its content hash.
+ *
+ *  \author Francisco Gonalves and Tiago Lucas - June 2020
+ */
+
+#ifndef DOCUMENTCACHE_H
+#define DOCUMENTCACHE_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "CONTROLINFO.h"
+#include "DOCRESULT.h"
+#include "RESUMESTATE.h"
+#include "DOCINFO.h"
+
+/** \brief the document has to be processed */
+#define  CACHE_MISS          0
+
+/** \brief the results of the whole document were found */
+#define  CACHE_HIT           1
+
+/** \brief the results of a prefix of the document were found, the rest of it has to be processed */
+#define  CACHE_PREFIX        2
+
+/**
+ *  \brief Resume the text files that only grew since the last run from their saved state.
+ *
+ *  Operation carried out by the main thread, before the documents are looked up.
+ */
+extern void enableResume(void);
+
+/**
+ *  \brief Look up the results of a document, hashing its content.
+ *
+ *  The size of the document becomes the number of bytes hashed, the document is never read past it.
+ *
+ *  \param *d document
+ *  \param *ci where the results found are stored
+ *  \param *registers where the sketch of the distinct words found is stored
+ *
+ *  \return CACHE_MISS, CACHE_HIT or CACHE_PREFIX (the position of the document is then set after the prefix)
+ */
+extern int lookupDocument(DOCINFO *d, CONTROLINFO *ci, unsigned char *registers);
+
+/**
+ *  \brief Store the results of a document looked up before.
+ *
+ *  \param *d document
+ *  \param *ci results of the whole document
+ *  \param *registers sketch of the distinct words of the whole document
+ *  \param process function that processes a chunk of text, used to take the text after the last word boundary
+ *  of a text file out of the results saved to resume it
+ */
+extern void storeDocument(DOCINFO *d, const CONTROLINFO *ci, const unsigned char *registers,
+                          void (*process)(unsigned char *, CONTROLINFO *));
+
+#endif /* DOCUMENTCACHE_H */
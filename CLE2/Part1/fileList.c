@@ -0,0 +1,180 @@
+/**
+ *  \file fileList.c (implementation file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  \author Francisco Gonalves and Tiago Lucas - June 2020
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "fileList.h"
+
+/** \brief names found so far */
+static char **found;
+
+/** \brief number of names found and size of the array */
+static size_t numbFound, sizeFound;
+
+/** \brief cost of the files being ordered */
+static const uint64_t *sortCost;
+
+/**
+ *  \brief Append a name to the names found.
+ *
+ *  Internal operation.
+ */
+static void addName(char *name)
+{
+  if (numbFound == sizeFound){
+    sizeFound = 2 * sizeFound + 16;
+    found = (char **) realloc(found, sizeof(char *) * sizeFound);
+  }
+  found[numbFound++] = name;
+}
+
+/**
+ *  \brief Name comparison, for qsort.
+ *
+ *  Internal operation.
+ */
+static int compareNames(const void *a, const void *b)
+{
+  return strcmp(*(char * const *) a, *(char * const *) b);
+}
+
+static void expandName(char *name);
+
+/**
+ *  \brief Add the files of a directory and of its subdirectories, hidden entries are skipped.
+ *
+ *  Internal operation.
+ */
+static void expandDirectory(char *name)
+{
+  DIR *dir;
+  struct dirent *entry;
+  char **entries = NULL;
+  size_t numbEntries = 0, size = 0, i;
+
+  if ((dir = opendir(name)) == NULL){
+    perror(name);
+    return;
+  }
+  while ((entry = readdir(dir)) != NULL){
+    if (entry->d_name[0] == '.')
+      continue;
+    if (numbEntries == size)
+      entries = (char **) realloc(entries, sizeof(char *) * (size = 2 * size + 16));
+    entries[numbEntries] = (char *) malloc(strlen(name) + strlen(entry->d_name) + 2);
+    sprintf(entries[numbEntries++], "%s/%s", name, entry->d_name);
+  }
+  closedir(dir);
+
+  qsort(entries, numbEntries, sizeof(char *), compareNames);                 /* the same order on every run */
+  for (i = 0; i < numbEntries; i++)
+    expandName(entries[i]);
+  free(entries);
+}
+
+/**
+ *  \brief Add the names listed in a file, one per line.
+ *
+ *  Internal operation.
+ */
+static void expandList(char *name)
+{
+  FILE *list;
+  char *line = NULL;
+  size_t size = 0;
+  ssize_t length;
+
+  if ((list = fopen(name, "r")) == NULL){
+    perror(name);
+    return;
+  }
+  while ((length = getline(&line, &size, list)) >= 0){
+    while (length > 0 && (line[length-1] == '\n' || line[length-1] == '\r'))
+      line[--length] = '\0';
+    if (length > 0)
+      expandName(strdup(line));
+  }
+  free(line);
+  fclose(list);
+}
+
+/**
+ *  \brief Add a name: a file, a directory or a file list.
+ *
+ *  Internal operation.
+ */
+static void expandName(char *name)
+{
+  struct stat st;
+
+  if (name[0] == '@')
+    expandList(name + 1);
+  else if (stat(name, &st) == 0 && S_ISDIR(st.st_mode))
+    expandDirectory(name);
+  else
+    addName(name);                                                            /* missing files are reported when opened */
+}
+
+/**
+ *  \brief Expand the arguments of the command line into the names of the files to process.
+ *
+ *  \param *args[] arguments
+ *  \param numbArgs number of arguments
+ *  \param ***names where the array of names is stored
+ *
+ *  \return number of names
+ */
+size_t expandFileNames(char *args[], size_t numbArgs, char ***names)
+{
+  size_t i;
+
+  found = NULL;
+  numbFound = sizeFound = 0;
+  for (i = 0; i < numbArgs; i++)
+    expandName(args[i]);
+  *names = found;
+  return numbFound;
+}
+
+/**
+ *  \brief Cost comparison, largest first, for qsort.
+ *
+ *  Internal operation.
+ */
+static int compareCost(const void *a, const void *b)
+{
+  size_t i = *(const size_t *) a, j = *(const size_t *) b;
+
+  if (sortCost[i] != sortCost[j])
+    return sortCost[i] < sortCost[j] ? 1 : -1;
+  return i < j ? -1 : i > j;
+}
+
+/**
+ *  \brief Order of the files, largest amount of work first (LPT), ties kept in the order of the command line.
+ *
+ *  \param *cost amount of work of each file
+ *  \param numbFiles number of files
+ *
+ *  \return array with the indices of the files, in the order they should be started
+ */
+size_t *largestFirst(const uint64_t *cost, size_t numbFiles)
+{
+  size_t i, *order = (size_t *) malloc(sizeof(size_t) * (numbFiles > 0 ? numbFiles : 1));
+
+  for (i = 0; i < numbFiles; i++)
+    order[i] = i;
+  sortCost = cost;
+  qsort(order, numbFiles, sizeof(size_t), compareCost);
+  return order;
+}
@@ -13,26 +13,88 @@
 #include <stdbool.h>
 #include <math.h>
 #include <string.h>
+#include <stdint.h>
 
 #include "probConst.h"
 #include "CONTROLINFO.h"
+#include "DOCINFO.h"
+#include "corpusPack.h"
+#include "fileList.h"
+#include "readEngine.h"
+#include "HASHSTATE.h"
+#include "resultCache.h"
+#include "documentCache.h"
+#include "WORDENTRY.h"
+#include "WORDTABLE.h"
+#include "wordTable.h"
+#include "wordSketch.h"
+#include "ANALYZER.h"
+#include "textAnalyzer.h"
+#include "SAMPLEINFO.h"
+#include "sampling.h"
+#include "placement.h"
+#include "PERFCOUNTS.h"
+#include "perfCounters.h"
+#include "TRACEEVENT.h"
+#include "traceLog.h"
+#include "progressMetrics.h"
+#include "TUNING.h"
+#include "autotune.h"
 
 /* General definitions */
 
 # define  WORKTODO       1
 # define  NOMOREWORK     0
 
+/** \brief bytes of a word record of the reduction before the bytes of the word: file, length and count */
+# define  WORD_RECORD    16
+
+/** \brief number of files whose sketches of the distinct words are reduced at once */
+# define  SKETCH_FILES   256
+
 /** \brief results of processed text */
 CONTROLINFO *results;
 
 /** \brief max word length for each file */
 int *maxWordLEN;
 
+/** \brief words of each file: of the text processed by a worker, then the most frequent ones at the dispatcher */
+WORDTABLE *words;
+
+/** \brief number of tables of words */
+size_t numbTables;
+
+/** \brief number of most frequent words printed for each file, 0 if the words are not counted */
+int numbTopWords;
+
+/** \brief sketches of the distinct words of each file (HLL_REGISTERS each): of the text processed by a worker, then
+    of the whole file at the dispatcher */
+unsigned char *sketches;
+
+/** \brief number of sketches */
+size_t numbSketches;
+
+/** \brief relative error of the number of words of a sampled document, 0 if the documents are processed whole */
+double sampleError;
+
+/** \brief samples of the documents at the dispatcher, NULL for a document processed whole */
+SAMPLEINFO **samples;
+
+/** \brief kernels whose hardware counters are reported */
+static const char *const kernelNames[] = {"scanText"};
+
 /* Allusion to internal functions */
 static void savePartialResults(CONTROLINFO*);
-static int isValidStopCharacter(char);
-static void printResults(unsigned int, char**);
+static void printResults(unsigned int, DOCINFO*);
 static void processText(unsigned char*, CONTROLINFO*);
+static void reduceWords(int, int, unsigned int);
+static void reduceSketches(int, unsigned int);
+static void reportBinding(int, int);
+static void gatherCounters(int, int);
+static void alignTrace(int, int);
+static void writeTimeline(int, int, char*);
+static void sendTraced(void*, int, MPI_Datatype, int);
+static void recvTraced(void*, int, MPI_Datatype, int);
 
 /**
  *  \brief Main function.
@@ -42,19 +104,144 @@ static void processText(unsigned char*, CONTROLINFO*);
  *  \param argc number of words of the command line
  *  \param argv list of words of the command line
  *
+ *  Options:
+ *     -i engine   the dispatcher reads the text files through the asynchronous read engine: uring (io_uring, or
+ *                 threads where it is not available) or threads (a pool of threads calling pread)
+ *     -q n        read engine: number of reads outstanding at once (default READ_DEPTH)
+ *     -c dir      the dispatcher keeps the results of each document in the result cache dir (created if needed,
+ *                 at most CACHE_LIMIT bytes), documents already seen are not processed again
+ *     -R          with -c, a text file that only grew since the last run is resumed from its saved state, only the
+ *                 appended text being read (its size, time of modification and some of its bytes are checked
+ *                 instead of its whole content)
+ *     -w n        print the n most frequent words of each file (the result cache is then not used)
+ *     -s error    the dispatcher sends a random sample of the chunks of each document of at least SAMPLE_MIN bytes,
+ *                 until the margin of error of its number of words is below the relative error given (for instance
+ *                 0.01), its results being estimated from them, and prints the margins of error (the result cache
+ *                 is then not used)
+ *     -B          print the CPUs and the NUMA nodes each process is bound to
+ *     -P          count the cycles, instructions, cache misses and branch misses of each worker over each chunk,
+ *                 the dispatcher reporting them per worker and per kernel (see perfCounters.h)
+ *     -T file     record the timeline of every process (chunks read and processed, results merged, MPI sends and
+ *                 receives), the clocks being aligned on the one of the dispatcher, which writes it to file as a
+ *                 Chrome trace (see traceLog.h)
+ *     -M file     the dispatcher exports the progress of the run (bytes sent, words counted, progress of each file,
+ *                 rate of each worker, estimated time left) to file as a Prometheus textfile, rewritten every
+ *                 METRICS_PERIOD seconds (see progressMetrics.h), from the results the workers send back
+ *     -U          the dispatcher calibrates the number of bytes of a chunk on this host (see autotune.h) and saves it
+ *                 as its profile, which the next runs load, then the files are processed if any
+ *
+ *  A file named - is the standard input of the dispatcher (mpirun forwards its own to it), read as a stream like a
+ *  pipe (see streamReader.h): it is sent in chunks while it is being read, and is neither cached nor sampled. As
+ *  the standard input of the dispatcher is never a terminal, it has to be named. A file compressed with gzip, or
+ *  zstd when built with HAVE_ZSTD, is decompressed by threads of the dispatcher while its chunks are sent, the
+ *  same way (see textDecoder.h).
+ *
+ *  The number of bytes of a chunk is the one of the profile of the host of the dispatcher when there is one, K
+ *  otherwise, and is sent to the workers.
+ *
  *  \return status of operation
  */
 int main (int argc, char *argv[]){
   int rank,                                /* number of processes in the group */
   totProc;                                 /* group size */
-  unsigned int numbFiles = argc - 1;       /* number of files to process*/
+  unsigned int numbFiles = 0;              /* number of files to process, the documents of a corpus pack counting as files */
+  DOCINFO *documents = NULL;               /* files to process */
   double start, finish;                    /* variables to calculate how much time the execution took */
+  int opt, engine = READ_SYNC;             /* command line option and read engine of the dispatcher */
+  unsigned int readDepth = READ_DEPTH;     /* number of reads outstanding of the read engine */
+  char *cacheName = NULL;                  /* directory of the result cache of the dispatcher */
+  bool *cached = NULL;                     /* documents whose results were found whole in the cache */
+  bool resume = false;                     /* text files that only grew are resumed from their saved state */
+  bool binding = false;                    /* the binding of the processes is printed */
+  bool counters = false;                   /* the hardware counters of the workers are reported */
+  char *traceName = NULL;                  /* file where the timeline is written */
+  char *metricsName = NULL;                /* file where the progress metrics are exported */
+  bool autotune = false;                   /* the chunk size is calibrated */
+  double t;                                /* start of an event of the timeline */
 
   /* get processing configuration */
 
   MPI_Init (&argc, &argv);
   MPI_Comm_rank (MPI_COMM_WORLD, &rank);
   MPI_Comm_size (MPI_COMM_WORLD, &totProc);
+  while ((opt = getopt (argc, argv, "i:q:c:Rw:s:BPT:M:U")) != -1)
+    switch (opt){
+      case 'i': if (strcmp (optarg, "uring") == 0)
+                  engine = READ_URING;
+                else if (strcmp (optarg, "threads") == 0)
+                  engine = READ_THREADS;
+                else {
+                  if (rank == 0)
+                    printf("Unknown read engine %s\n", optarg);
+                  MPI_Finalize ();
+                  return EXIT_FAILURE;
+                }
+                break;
+      case 'q': if ((readDepth = atoi (optarg)) == 0){
+                  if (rank == 0)
+                    printf("Invalid number of reads %s\n", optarg);
+                  MPI_Finalize ();
+                  return EXIT_FAILURE;
+                }
+                break;
+      case 'c': cacheName = optarg;
+                break;
+      case 'R': resume = true;
+                break;
+      case 'w': if ((numbTopWords = atoi (optarg)) <= 0){
+                  if (rank == 0)
+                    printf("Invalid number of words %s\n", optarg);
+                  MPI_Finalize ();
+                  return EXIT_FAILURE;
+                }
+                break;
+      case 's': if ((sampleError = atof (optarg)) <= 0 || sampleError >= 1){
+                  if (rank == 0)
+                    printf("Invalid relative error %s\n", optarg);
+                  MPI_Finalize ();
+                  return EXIT_FAILURE;
+                }
+                break;
+      case 'B': binding = true;
+                break;
+      case 'P': counters = true;
+                break;
+      case 'T': traceName = optarg;
+                break;
+      case 'M': metricsName = optarg;
+                break;
+      case 'U': autotune = true;
+                break;
+      default:  if (rank == 0)
+                  printf("Usage: %s [-i engine] [-q reads] [-c cache] [-R] [-w words] [-s error] [-B] [-P] [-T trace] [-M metrics] [-U] files\n", argv[0]);
+                MPI_Finalize ();
+                return EXIT_FAILURE;
+    }
+
+  if (rank == 0){
+    loadTuning ();
+    if (autotune){
+      tuneText (processText);
+      if (!saveTuning ())
+        perror ("error on saving the profile");
+      printf("%zu bytes per chunk, profile %s\n", tuning.chunkSize, tuningProfile ());
+    }
+  }
+  MPI_Bcast (&tuning, sizeof (TUNING), MPI_BYTE, 0, MPI_COMM_WORLD);
+  if (autotune && optind >= argc){
+    MPI_Finalize ();
+    return EXIT_SUCCESS;
+  }
+
+  if (binding)
+    reportBinding (rank, totProc);
+  if (counters)
+    startCounters (rank == 0 ? totProc : 1, 1);    /* a row per process at the dispatcher */
+  if (traceName != NULL){
+    if (!startTrace (1, TRACE_EVENTS))
+      fprintf(stderr, "the timeline could not be allocated, it is not recorded\n");
+    alignTrace (rank, totProc);
+  }
 
   MPI_Barrier (MPI_COMM_WORLD);
   start = MPI_Wtime();
@@ -63,19 +250,35 @@ int main (int argc, char *argv[]){
 
   if (rank == 0){                          /* dispatcher process it is the first process of the group */
 
-    FILE *f = NULL;                        /* pointer to the text stream associated with the file name */
+    DOCINFO *d = NULL;                     /* document being read */
     unsigned int whatToDo;                 /* command */
     unsigned int workProc, x;              /* counting variables */
     size_t i, aux;                          /* auxiliary variables*/
     CONTROLINFO ci = {0};                  /* data transfer variable */
-    unsigned char dataToBeProcessed[K+1] = {0}; /* text to process */
-    size_t filePos = 1;                         /* current file being processed*/
-    results = (CONTROLINFO*) calloc(numbFiles, sizeof(CONTROLINFO));
-    maxWordLEN = (int *) calloc(numbFiles, sizeof(int));
+    unsigned char dataToBeProcessed[MAX_K+1] = {0}; /* text to process */
+    size_t *schedule = NULL;                    /* documents in the order they are started, largest first */
+    SAMPLEINFO *s = NULL;                       /* sample of the document being read, NULL if it is read whole */
+    size_t activeFiles[ACTIVE_FILES];           /* documents read at the same time, their chunks sent in round robin */
+    size_t numbActive = 0, nextActive = 0,      /* number of active documents and next one to serve */
+    nextStart = 0,                              /* position in the schedule of the next document to start */
+    numbScheduled = 0;                          /* number of documents to process */
 
     /* check running parameters and load list of names into memory */
 
-    if (argc < 2){ 
+    if (engine != READ_SYNC && startReadEngine (engine, readDepth, READ_BLOCK) == READ_SYNC)
+      fprintf(stderr, "the read engine could not be started, reading synchronously\n");
+    if (cacheName != NULL && numbTopWords > 0)                /* the words of a cached document are not kept */
+      fprintf(stderr, "the result cache is not used with -w, all the documents are processed\n");
+    else if (cacheName != NULL && sampleError > 0)           /* looking a document up reads the whole of it */
+      fprintf(stderr, "the result cache is not used with -s\n");
+    else if (cacheName != NULL && !openResultCache (cacheName, CACHE_LIMIT))
+      fprintf(stderr, "the result cache %s could not be opened, it is not used\n", cacheName);
+    if (resume && !resultCacheActive ())
+      fprintf(stderr, "-R needs the result cache (-c), the files are read whole\n");
+    else if (resume)
+      enableResume ();
+
+    if (optind >= argc || (numbFiles = listDocuments(argv + optind, argc - optind, &documents)) == 0){ 
       perror("Please insert text files to be processed as arguments!");
       whatToDo = NOMOREWORK;
       for (x = 1; x < totProc; x++)
@@ -83,48 +286,81 @@ int main (int argc, char *argv[]){
       MPI_Finalize ();
       return EXIT_FAILURE;
     }
+    results = (CONTROLINFO*) calloc(numbFiles, sizeof(CONTROLINFO));
+    sketches = (unsigned char *) calloc(numbFiles, HLL_REGISTERS);      /* those of the cached documents */
+    numbSketches = numbFiles;
+    maxWordLEN = (int *) calloc(numbFiles, sizeof(int));
+    cached = (bool *) calloc(numbFiles, sizeof(bool));
+    if (sampleError > 0)
+      samples = (SAMPLEINFO **) calloc(numbFiles, sizeof(SAMPLEINFO *));
+
+    /* the largest documents first, so that a big one is not left alone at the end of the run, the ones whose
+       results are cached are left out and only the text appended to a document since it was cached is sent, and
+       only a sample of the chunks of a large document when sampling */
+    uint64_t *cost = (uint64_t *) malloc(sizeof(uint64_t) * numbFiles);
+    for (i = 0; i < numbFiles; i++){
+      cached[i] = lookupDocument(&documents[i], &results[i], sketches + HLL_REGISTERS * i) == CACHE_HIT;
+      results[i].filePosition = i;
+      maxWordLEN[i] = results[i].counts.maxWordLength;
+      cost[i] = documents[i].size - documents[i].position;
+      if (samples != NULL && documents[i].size >= SAMPLE_MIN && documents[i].stream == NULL)
+        samples[i] = startSample(documents[i].size, i);
+    }
+    if (metricsName != NULL && !startMetrics (metricsName, totProc))
+      perror ("error on writing the metrics, they are not exported");
+    presentMetricFiles (numbFiles);
+    for (i = 0; i < numbFiles; i++)
+      nameMetricFile (i, documents[i].name, cached[i] || documents[i].stream != NULL ? 0 : cost[i]);
+    schedule = largestFirst(cost, numbFiles);
+    free(cost);
+    for (i = numbScheduled = 0; i < numbFiles; i++)
+      if (!cached[schedule[i]])
+        schedule[numbScheduled++] = schedule[i];
     
     /* loop until all files have been processed*/
-    while(filePos <= numbFiles) {
+    while(numbActive > 0 || nextStart < numbScheduled) {
       
       workProc = 1;
       
       /* send text to process to all workers */
       for (x = 1; x < totProc; x++, workProc++){
-        if(filePos > numbFiles){
+        while(true){
+          while(numbActive < ACTIVE_FILES && nextStart < numbScheduled)
+            activeFiles[numbActive++] = schedule[nextStart++];
+          setQueueDepth (numbActive + numbScheduled - nextStart);
+          if(numbActive == 0)
+            break;
+          nextActive %= numbActive;
+          s = samples == NULL ? NULL : samples[activeFiles[nextActive]];
+          if (s == NULL || nextSampleChunk(s, &ci.sampleChunk))
+            break;
+          activeFiles[nextActive] = activeFiles[--numbActive];        /* enough of the document sampled */
+        }
+        if(numbActive == 0){
           break;
         }
 
         /* open file if necessary */
-        if(f == NULL) {
-          if((f = fopen (argv[filePos], "rb")) == NULL){
-            perror ("error on file opening for reading");
-            whatToDo = NOMOREWORK;
-            for (x = 1; x < totProc; x++)
-              MPI_Send (&whatToDo, 1, MPI_UNSIGNED, x, 0, MPI_COMM_WORLD);
-            MPI_Finalize ();
-            exit (EXIT_FAILURE);
-          }
-          ci.filePosition = filePos - 1;
-          ci.numbBytes = 0;
-          ci.numbWords = 0;
-          ci.maxWordLength = 0;
+        t = traceClock ();
+        d = &documents[activeFiles[nextActive]];
+        if(s == NULL && !openDocument (d)){
+          perror ("error on file opening for reading");
+          whatToDo = NOMOREWORK;
+          for (x = 1; x < totProc; x++)
+            MPI_Send (&whatToDo, 1, MPI_UNSIGNED, x, 0, MPI_COMM_WORLD);
+          MPI_Finalize ();
+          exit (EXIT_FAILURE);
         }
+        ci.filePosition = activeFiles[nextActive];      /* the chunks of several files are interleaved */
+        ci.numbBytes = 0;
+        ci.counts.numbWords = 0;
+        ci.counts.maxWordLength = 0;
 
-        i = fread(dataToBeProcessed, 1, K, f);
-        if(i < K) {
-          /* close file */
-          if (fclose (f) == EOF){
-            perror ("error on closing file");
-            whatToDo = NOMOREWORK;
-            for (x = 1; x < totProc; x++)
-              MPI_Send (&whatToDo, 1, MPI_UNSIGNED, x, 0, MPI_COMM_WORLD);
-            MPI_Finalize ();
-            exit (EXIT_FAILURE);
-          }
-
-          filePos++;
-          f = NULL;
+        if (s != NULL){                                 /* the next chunk of its sample */
+          i = readSampleChunk(d, ci.sampleChunk, dataToBeProcessed);
+          nextActive++;
+        } else if((i = readDocument(d, dataToBeProcessed, tuning.chunkSize)) < tuning.chunkSize) {   /* closed at its end */
+          activeFiles[nextActive] = activeFiles[--numbActive];
 
         } else {
           aux = i;
@@ -133,54 +369,105 @@ int main (int argc, char *argv[]){
           }
           if(i == 0)
             i = aux;
-          fseek(f, i-K, 1);
+          unreadDocument(d, tuning.chunkSize-i);
+          nextActive++;
         }
         ci.numbBytes = i;
+        traceSpan (0, TRACE_FETCH, t);
      
       	/* distribute sorting task */
         whatToDo = WORKTODO;
-        MPI_Send (&whatToDo, 1, MPI_UNSIGNED, x, 0, MPI_COMM_WORLD);
-        MPI_Send (&ci, sizeof (CONTROLINFO), MPI_BYTE, x, 0, MPI_COMM_WORLD);
-        MPI_Send (&dataToBeProcessed, K+1, MPI_UNSIGNED_CHAR, x, 0, MPI_COMM_WORLD);
-        memset(dataToBeProcessed, 0, K+1);
+        sendTraced (&whatToDo, 1, MPI_UNSIGNED, x);
+        sendTraced (&ci, sizeof (CONTROLINFO), MPI_BYTE, x);
+        sendTraced (&dataToBeProcessed, tuning.chunkSize+1, MPI_UNSIGNED_CHAR, x);
+        memset(dataToBeProcessed, 0, tuning.chunkSize+1);
       }
       
       /* receive results of processing from workers*/
       for (x = 1; x < workProc; x++) {
-        MPI_Recv (&ci, sizeof(CONTROLINFO), MPI_BYTE, x, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        recvTraced (&ci, sizeof(CONTROLINFO), MPI_BYTE, x);
+        countWork (x, ci.filePosition, ci.numbBytes, ci.numbBytes, ci.counts.numbWords);
+        t = traceClock ();
         savePartialResults(&ci);
+        traceSpan (0, TRACE_MERGE, t);
       }
 
     }
     
+    stopMetrics ();
+
     /* dismiss worker processes */
     
     whatToDo = NOMOREWORK;
     for (x = 1; x < totProc; x++)
       MPI_Send (&whatToDo, 1, MPI_UNSIGNED, x, 0, MPI_COMM_WORLD);
+    free(schedule);
     
 
   } else { /* worker processes the remainder processes of the group */
 
     unsigned int whatToDo;                /* command */
     CONTROLINFO ci;                       /* data transfer variable */
-    unsigned char dataToBeProcessed[K+1]; /* text to process */
+    ANALYZER analyzer;                    /* started on the results of each chunk */
+    unsigned char dataToBeProcessed[MAX_K+1]; /* text to process */
+    int group[PERF_EVENTS];               /* hardware counters */
+    PERFCOUNTS begin, total = {0};        /* counters before a chunk and over all of them */
 
+    openCounters (group);
     while (true){
-      MPI_Recv (&whatToDo, 1, MPI_UNSIGNED, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+      recvTraced (&whatToDo, 1, MPI_UNSIGNED, 0);
       if (whatToDo == NOMOREWORK)
         break;
-      MPI_Recv (&ci, sizeof (CONTROLINFO), MPI_BYTE, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-      MPI_Recv (&dataToBeProcessed, K+1, MPI_UNSIGNED_CHAR, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-      processText(dataToBeProcessed, &ci);
-      MPI_Send (&ci, sizeof (CONTROLINFO), MPI_BYTE, 0, 0, MPI_COMM_WORLD);
+      recvTraced (&ci, sizeof (CONTROLINFO), MPI_BYTE, 0);
+      recvTraced (&dataToBeProcessed, tuning.chunkSize+1, MPI_UNSIGNED_CHAR, 0);
+      t = traceClock ();
+      readCounters (group, &begin);
+      if (numbTopWords > 0 && ci.filePosition >= numbTables){      /* the number of files is not known here */
+        size_t n = 2 * ci.filePosition + 1;
+        words = (WORDTABLE *) realloc(words, sizeof(WORDTABLE) * n);
+        memset(words + numbTables, 0, sizeof(WORDTABLE) * (n - numbTables));
+        numbTables = n;
+      }
+      if (ci.filePosition >= numbSketches){
+        size_t n = 2 * ci.filePosition + 1;
+        sketches = (unsigned char *) realloc(sketches, HLL_REGISTERS * n);
+        memset(sketches + HLL_REGISTERS * numbSketches, 0, HLL_REGISTERS * (n - numbSketches));
+        numbSketches = n;
+      }
+      startAnalyzer (&analyzer, &ci.counts, sketches + HLL_REGISTERS * ci.filePosition,   /* reduced at the end, not sent */
+                     numbTopWords > 0 ? &words[ci.filePosition] : NULL);
+      feedAnalyzer (&analyzer, dataToBeProcessed, ci.numbBytes);
+      finishAnalyzer (&analyzer);
+      countUnit (group, &begin, &total, ci.numbBytes);
+      traceSpan (0, TRACE_COMPUTE, t);
+      sendTraced (&ci, sizeof (CONTROLINFO), MPI_BYTE, 0);
     }
+    saveCounters (0, 0, &total);
+    closeCounters (group);
   }
 
+  /* distinct and most frequent words, all the processes taking part */
+  MPI_Bcast (&numbFiles, 1, MPI_UNSIGNED, 0, MPI_COMM_WORLD);
+  reduceSketches(rank, numbFiles);
+  if (numbTopWords > 0)
+    reduceWords(rank, totProc, numbFiles);
+  if (counters)
+    gatherCounters(rank, totProc);
+  if (traceName != NULL)
+    writeTimeline(rank, totProc, traceName);
+
   /* print results and execution time */
   MPI_Barrier (MPI_COMM_WORLD);
   if(rank == 0) {
-    printResults(numbFiles, argv+1);
+    for (size_t i = 0; i < numbFiles; i++)
+      if (!cached[i])
+        storeDocument(&documents[i], &results[i], sketches + HLL_REGISTERS * i, processText);
+    printResults(numbFiles, documents);
+    printCounters("process", kernelNames);
+    closeDocuments(documents, numbFiles);
+    stopReadEngine ();
+    closeResultCache ();
+    free(cached);
     finish = MPI_Wtime();
     printf("Execution time: %f seconds\n", finish - start);
   }
@@ -195,51 +482,336 @@ int main (int argc, char *argv[]){
  *
  *  Operation carried out by dispatcher process.
  *
+ *  The results of a chunk of a sampled document are added to its sample.
+ *
  *  \param *ci    pointer to the shared data structure
  *
  */
 void savePartialResults(CONTROLINFO *ci){                                                                          
 
   size_t filePosition = ci->filePosition;
-  results[filePosition].numbBytes += ci->numbBytes;
-  results[filePosition].numbWords += ci->numbWords;
-  ci->numbWords = 0;
-  if (ci->maxWordLength > results[filePosition].maxWordLength) {
-    results[filePosition].maxWordLength = ci->maxWordLength;
-    maxWordLEN[filePosition] = ci->maxWordLength;
+  SAMPLEINFO *s = samples == NULL ? NULL : samples[filePosition];
+  CONTROLINFO *into = s == NULL ? &results[filePosition]
+                                : addSample(s, ci, sampleError);          /* the results of the stratum of the chunk */
+  into->numbBytes += ci->numbBytes;
+  into->counts.numbWords += ci->counts.numbWords;
+  ci->counts.numbWords = 0;
+  if (ci->counts.maxWordLength > into->counts.maxWordLength) {
+    into->counts.maxWordLength = ci->counts.maxWordLength;
+    if (s == NULL)
+      maxWordLEN[filePosition] = ci->counts.maxWordLength;
   }
 
-  for (size_t i = 0; i < ci->maxWordLength+1; i++){
-    for (size_t j = 0; j < ci->maxWordLength; j++){
-      results[filePosition].bidi[i][j] += ci->bidi[i][j];
-      ci->bidi[i][j] = 0;
+  for (size_t i = 0; i < ci->counts.maxWordLength+1; i++){
+    for (size_t j = 0; j < ci->counts.maxWordLength; j++){
+      into->counts.bidi[i][j] += ci->counts.bidi[i][j];
+      ci->counts.bidi[i][j] = 0;
     }
   }
 }
 
 /**
- *  \brief Validate if a character is a stop character.
+ *  \brief Merge the sketches of the distinct words of the workers into the ones of the files at the dispatcher.
  *
- *  Operation carried out by dispatcher process.
+ *  Operation carried out by all the processes once the text is processed, the sketches being reduced by their
+ *  register by register maximum a few files at a time.
  *
- * \param character   character to which the validation is done.
+ *  \param rank      rank of the process
+ *  \param numbFiles number of files
+ */
+static void reduceSketches(int rank, unsigned int numbFiles)
+{
+  unsigned char *local = (unsigned char *) malloc(HLL_REGISTERS * SKETCH_FILES),
+                *merged = (unsigned char *) malloc(HLL_REGISTERS * SKETCH_FILES);
+  size_t f, n, i;
+
+  for (f = 0; f < numbFiles; f += n){
+    n = numbFiles - f < SKETCH_FILES ? numbFiles - f : SKETCH_FILES;
+    memset(local, 0, HLL_REGISTERS * n);
+    for (i = f; i < f + n && i < numbSketches; i++)
+      memcpy(local + HLL_REGISTERS * (i - f), sketches + HLL_REGISTERS * i, HLL_REGISTERS);
+    MPI_Reduce (local, merged, HLL_REGISTERS * n, MPI_UNSIGNED_CHAR, MPI_MAX, 0, MPI_COMM_WORLD);
+    if (rank == 0)
+      memcpy(sketches + HLL_REGISTERS * f, merged, HLL_REGISTERS * n);    /* its own ones were part of the reduction */
+  }
+  free(local);
+  free(merged);
+  if (rank != 0){
+    free(sketches);
+    sketches = NULL;
+    numbSketches = 0;
+  }
+}
+
+/**
+ *  \brief Print the CPUs each process is bound to and their NUMA nodes, as given by the job launcher (mpirun
+ *  --bind-to), which is kept: the threads of a process are created within its binding.
  *
- * \return    0 if the character provided is not a stop character, otherwise is the number of bytes the character should have. Can be used as true/false.
+ *  \param rank    rank of the process
+ *  \param totProc number of processes
+ */
+static void reportBinding(int rank, int totProc)
+{
+  char text[BINDING_TEXT] = {0}, *all = NULL;
+
+  describeBinding(text, sizeof(text));
+  if (rank == 0)
+    all = (char *) malloc(BINDING_TEXT * totProc);
+  MPI_Gather (text, BINDING_TEXT, MPI_CHAR, all, BINDING_TEXT, MPI_CHAR, 0, MPI_COMM_WORLD);
+  if (rank == 0){
+    for (int r = 0; r < totProc; r++)
+      fprintf(stderr, "process %d: %s\n", r, all + BINDING_TEXT * r);
+    free(all);
+  }
+}
+
+/**
+ *  \brief Gather the hardware counters of the workers at the dispatcher, a row per process.
+ *
+ *  A process where they could not be counted sends zeros, the dispatcher throws them away if it could not.
  *
+ *  \param rank    rank of the process
+ *  \param totProc number of processes
  */
-static int isValidStopCharacter(char character) {
-  char separation[15] = { (char)0x20, (char)0x9, (char)0xA, '-', '"', '(', ')', '[', ']', '.', ',', ':', ';', '?', '!' };
-  char separation3[4] = { (char)0x9C, (char)0x9D, (char)0x93, (char)0xA6 };
-  int x;
-  for (x = 0; x < 15; x++)
-    if (character == separation[x])
-      return 1;
-  for (x = 0; x < 4; x++)
-    if (character == separation3[x])
-      return 3;
-  return 0;
+static void gatherCounters(int rank, int totProc)
+{
+  PERFCOUNTS *table = counterTable(), none = {0}, *all = table;
+  int size = sizeof(PERFCOUNTS);
+
+  if (rank == 0 && table == NULL)
+    all = (PERFCOUNTS *) malloc(size * totProc);
+  MPI_Gather (rank == 0 ? MPI_IN_PLACE : table != NULL ? (void *) table : (void *) &none, size, MPI_BYTE,
+              all, size, MPI_BYTE, 0, MPI_COMM_WORLD);
+  if (rank == 0 && table == NULL)
+    free(all);
 }
 
+/**
+ *  \brief Align the clock of the timeline of every process on the one of the dispatcher.
+ *
+ *  Each worker asks the dispatcher for its clock TRACE_PINGS times, the round trip being the shortest one giving the
+ *  offset: the clock of the dispatcher was read half way through it.
+ *
+ *  \param rank    rank of the process
+ *  \param totProc number of processes
+ */
+static void alignTrace(int rank, int totProc)
+{
+  double sent, received, remote, shortest = -1, offset = 0;
+
+  for (int r = 1; r < totProc; r++)
+    for (int k = 0; k < TRACE_PINGS; k++)
+      if (rank == 0){
+        MPI_Recv (&remote, 1, MPI_DOUBLE, r, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        remote = traceClock();
+        MPI_Send (&remote, 1, MPI_DOUBLE, r, 0, MPI_COMM_WORLD);
+      } else if (rank == r){
+        sent = traceClock();
+        MPI_Send (&sent, 1, MPI_DOUBLE, 0, 0, MPI_COMM_WORLD);
+        MPI_Recv (&remote, 1, MPI_DOUBLE, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        received = traceClock();
+        if (shortest < 0 || received - sent < shortest){
+          shortest = received - sent;
+          offset = remote - (sent + received) / 2;
+        }
+      }
+  setTraceOffset(offset);
+}
+
+/**
+ *  \brief Gather the timelines of every process at the dispatcher, which writes them as a single Chrome trace.
+ *
+ *  \param rank    rank of the process
+ *  \param totProc number of processes
+ *  \param *name   name of the file
+ */
+static void writeTimeline(int rank, int totProc, char *name)
+{
+  TRACEEVENT *events, *all = NULL;
+  size_t numbEvents = collectTrace(rank, &events);
+  int size = numbEvents * sizeof(TRACEEVENT), *counts = NULL, *displs = NULL;
+
+  if (rank == 0){
+    counts = (int *) malloc(sizeof(int) * totProc);
+    displs = (int *) malloc(sizeof(int) * totProc);
+  }
+  MPI_Gather (&size, 1, MPI_INT, counts, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  if (rank == 0){
+    for (int r = 0; r < totProc; r++)
+      displs[r] = r == 0 ? 0 : displs[r-1] + counts[r-1];
+    all = (TRACEEVENT *) malloc(displs[totProc-1] + counts[totProc-1] + 1);
+  }
+  MPI_Gatherv (events, size, MPI_BYTE, all, counts, displs, MPI_BYTE, 0, MPI_COMM_WORLD);
+  if (rank == 0){
+    if (!writeTrace(name, all, (displs[totProc-1] + counts[totProc-1]) / sizeof(TRACEEVENT)))
+      perror("error on writing the timeline");
+    free(all);
+    free(counts);
+    free(displs);
+  }
+  free(events);
+  stopTrace();
+}
+
+/**
+ *  \brief Send a message, recording it in the timeline from the time it is posted to the time it completes.
+ *
+ *  \param *buffer data
+ *  \param count   number of elements
+ *  \param type    type of the elements
+ *  \param dest    rank of the receiver
+ */
+static void sendTraced(void *buffer, int count, MPI_Datatype type, int dest)
+{
+  double t = traceClock();
+
+  MPI_Send (buffer, count, type, dest, 0, MPI_COMM_WORLD);
+  traceSpan(0, TRACE_SEND, t);
+}
+
+/**
+ *  \brief Receive a message, recording it in the timeline from the time it is posted to the time it completes.
+ *
+ *  \param *buffer where the data is stored
+ *  \param count   number of elements
+ *  \param type    type of the elements
+ *  \param source  rank of the sender
+ */
+static void recvTraced(void *buffer, int count, MPI_Datatype type, int source)
+{
+  double t = traceClock();
+
+  MPI_Recv (buffer, count, type, source, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+  traceSpan(0, TRACE_RECV, t);
+}
+
+/**
+ *  \brief Append a word record to a buffer of the reduction.
+ *
+ *  Internal operation.
+ *
+ *  \return position after the record
+ */
+static char *packWord(char *buffer, uint32_t file, const WORDENTRY *e)
+{
+  uint32_t length = e->length;
+
+  memcpy(buffer, &file, sizeof(uint32_t));
+  memcpy(buffer + 4, &length, sizeof(uint32_t));
+  memcpy(buffer + 8, &e->count, sizeof(uint64_t));
+  memcpy(buffer + WORD_RECORD, e->word, length);
+  return buffer + WORD_RECORD + length;
+}
+
+/**
+ *  \brief Add the word records of a buffer to a table per file.
+ *
+ *  Internal operation.
+ */
+static void unpackWords(const char *buffer, size_t size, WORDTABLE *tables)
+{
+  const char *end = buffer + size;
+  uint32_t file, length;
+  uint64_t count;
+
+  while (buffer < end){
+    memcpy(&file, buffer, sizeof(uint32_t));
+    memcpy(&length, buffer + 4, sizeof(uint32_t));
+    memcpy(&count, buffer + 8, sizeof(uint64_t));
+    addWord(&tables[file], (const unsigned char *) buffer + WORD_RECORD, length, count);
+    buffer += WORD_RECORD + length;
+  }
+}
+
+/**
+ *  \brief Distributed selection of the most frequent words of each file.
+ *
+ *  Operation carried out by all the processes once the text is processed. Every word counted by a worker is sent
+ *  (all to all) to the worker owning its hash, so that the counts of a word are summed in a single place; each
+ *  owner selects the most frequent of its words of each file, and only those are gathered by the dispatcher, where
+ *  they make up the table of the file.
+ *
+ *  \param rank      rank of the process
+ *  \param totProc   group size
+ *  \param numbFiles number of files
+ */
+static void reduceWords(int rank, int totProc, unsigned int numbFiles)
+{
+  int *sendCounts = (int *) calloc(totProc, sizeof(int)), *sendDispl = (int *) calloc(totProc, sizeof(int)),
+      *recvCounts = (int *) calloc(totProc, sizeof(int)), *recvDispl = (int *) calloc(totProc, sizeof(int));
+  char *sendBuffer, *recvBuffer, **next, *position;
+  WORDTABLE *owned;
+  WORDENTRY *top;
+  size_t f, s, n;
+  int x, size;
+
+  /* words sent to their owners */
+  for (f = 0; f < numbTables; f++)
+    for (s = 0; s < words[f].numbSlots; s++)
+      if (words[f].slots[s].word != NULL)
+        sendCounts[1 + words[f].slots[s].hash % (totProc - 1)] += WORD_RECORD + words[f].slots[s].length;
+  for (x = 1; x < totProc; x++)
+    sendDispl[x] = sendDispl[x-1] + sendCounts[x-1];
+  sendBuffer = (char *) malloc(sendDispl[totProc-1] + sendCounts[totProc-1] + 1);
+  next = (char **) malloc(sizeof(char *) * totProc);
+  for (x = 0; x < totProc; x++)
+    next[x] = sendBuffer + sendDispl[x];
+  for (f = 0; f < numbTables; f++){
+    for (s = 0; s < words[f].numbSlots; s++)
+      if (words[f].slots[s].word != NULL){
+        x = 1 + words[f].slots[s].hash % (totProc - 1);
+        next[x] = packWord(next[x], f, &words[f].slots[s]);
+      }
+    freeWordTable(&words[f]);
+  }
+  free(words);
+  free(next);
+  MPI_Alltoall (sendCounts, 1, MPI_INT, recvCounts, 1, MPI_INT, MPI_COMM_WORLD);
+  for (x = 1; x < totProc; x++)
+    recvDispl[x] = recvDispl[x-1] + recvCounts[x-1];
+  recvBuffer = (char *) malloc(recvDispl[totProc-1] + recvCounts[totProc-1] + 1);
+  MPI_Alltoallv (sendBuffer, sendCounts, sendDispl, MPI_BYTE, recvBuffer, recvCounts, recvDispl, MPI_BYTE,
+                 MPI_COMM_WORLD);
+  free(sendBuffer);
+
+  /* the most frequent words of each owner gathered by the dispatcher */
+  owned = (WORDTABLE *) calloc(numbFiles, sizeof(WORDTABLE));
+  unpackWords(recvBuffer, recvDispl[totProc-1] + recvCounts[totProc-1], owned);
+  free(recvBuffer);
+  sendBuffer = NULL;
+  size = 0;
+  for (f = 0; f < numbFiles; f++){
+    n = (size_t) numbTopWords < owned[f].numbWords ? (size_t) numbTopWords : owned[f].numbWords;
+    top = (WORDENTRY *) malloc(sizeof(WORDENTRY) * (n + 1));
+    n = topWords(&owned[f], top, numbTopWords);
+    for (s = 0, x = size; s < n; s++)
+      size += WORD_RECORD + top[s].length;
+    sendBuffer = (char *) realloc(sendBuffer, size + 1);
+    for (s = 0, position = sendBuffer + x; s < n; s++)
+      position = packWord(position, f, &top[s]);
+    free(top);
+    freeWordTable(&owned[f]);
+  }
+  free(owned);
+  MPI_Gather (&size, 1, MPI_INT, recvCounts, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  for (x = 1; x < totProc; x++)
+    recvDispl[x] = recvDispl[x-1] + recvCounts[x-1];
+  recvBuffer = rank == 0 ? (char *) malloc(recvDispl[totProc-1] + recvCounts[totProc-1] + 1) : NULL;
+  MPI_Gatherv (sendBuffer, size, MPI_BYTE, recvBuffer, recvCounts, recvDispl, MPI_BYTE, 0, MPI_COMM_WORLD);
+  free(sendBuffer);
+  words = NULL;
+  numbTables = 0;
+  if (rank == 0){
+    words = (WORDTABLE *) calloc(numbFiles, sizeof(WORDTABLE));
+    numbTables = numbFiles;
+    unpackWords(recvBuffer, recvDispl[totProc-1] + recvCounts[totProc-1], words);
+    free(recvBuffer);
+  }
+  free(sendCounts);
+  free(sendDispl);
+  free(recvCounts);
+  free(recvDispl);
+}
 
 /**
  *  \brief Print the results of each file.
@@ -247,15 +819,26 @@ static int isValidStopCharacter(char character) {
  *  Operation carried out by dispatcher process at the end of processing.
  *
  */
-static void printResults(unsigned int numbFiles, char *filesToProcess[]){
+static void printResults(unsigned int numbFiles, DOCINFO *documents){
 
   size_t x, y, i, max_len;
+  double margin[MAX_SIZE_WORD + 1], fraction = 1;
+  SAMPLEINFO *s;
 
   for (i = 0; i < numbFiles; i++){
+    s = samples == NULL ? NULL : samples[i];
+    if (s != NULL){                                                                  /* estimates of the results */
+      fraction = sampleResults(s, &results[i], margin);
+      maxWordLEN[i] = results[i].counts.maxWordLength;
+      free(s);
+    }
     max_len = maxWordLEN[i];
     
-    printf("File name: %s\n", filesToProcess[i]);
-    printf("Total number of words: %lu \n", results[i].numbWords);
+    printf("File name: %s\n", documents[i].name);
+    printf("Total number of words: %lu \n", results[i].counts.numbWords);
+    if (s != NULL)
+      printf("Sample of %.2f%% of the text, margin of error: +/- %.0f \n", fraction * 100, margin[0]);
+    printf("Number of distinct words (estimate): %.0f \n", sketchEstimate(sketches + HLL_REGISTERS * i));
     printf("Word length\n");
 
     int Words[max_len];
@@ -264,7 +847,7 @@ static void printResults(unsigned int numbFiles, char *filesToProcess[]){
       Words[y] = 0;
       printf("%*ld\t", ALIGNMENT, y+1);
       for (x = 0; x <= max_len; x++)
-        Words[y] += results[i].bidi[x][y];
+        Words[y] += results[i].counts.bidi[x][y];
     }
     printf("\n\n");
 
@@ -274,9 +857,16 @@ static void printResults(unsigned int numbFiles, char *filesToProcess[]){
     
     printf("\n\n");
 
+    if (s != NULL){                                                              /* margins of error of the counts */
+      printf(" ");
+      for (x = 0; x < max_len; x++)
+        printf("+/-%*.0f\t", ALIGNMENT - 3, margin[x + 1]);
+      printf("\n\n");
+    }
+
     printf(" ");
     for (x = 0; x < max_len; x++)
-      printf("%*.2f\t", ALIGNMENT, (double) Words[x]/results[i].numbWords*100);
+      printf("%*.2f\t", ALIGNMENT, (double) Words[x]/results[i].counts.numbWords*100);
 
     printf("\n\n");
     
@@ -288,14 +878,29 @@ static void printResults(unsigned int numbFiles, char *filesToProcess[]){
         else if (Words[y] == 0)
           printf("%*.1d\t", ALIGNMENT, 0);
         else
-          printf("%*.1f\t", ALIGNMENT, (double) results[i].bidi[x][y]/Words[y]*100);
+          printf("%*.1f\t", ALIGNMENT, (double) results[i].counts.bidi[x][y]/Words[y]*100);
           
       }
     printf("\n\n");
     }
+
+    if (words != NULL){
+      size_t k = (size_t) numbTopWords < words[i].numbWords ? (size_t) numbTopWords : words[i].numbWords;
+      WORDENTRY *top = (WORDENTRY *) malloc(sizeof(WORDENTRY) * (k + 1));
+      size_t n = topWords(&words[i], top, numbTopWords);
+      printf("Most frequent words\n");
+      for (x = 0; x < n; x++)
+        printf(" %*lu\t%.*s\n", ALIGNMENT, top[x].count, (int) top[x].length, top[x].word);
+      printf("\n");
+      free(top);
+      freeWordTable(&words[i]);
+    }
   }
   free(results);
+  free(sketches);
   free(maxWordLEN);
+  free(words);
+  free(samples);
 }
 
 
@@ -308,75 +913,10 @@ static void printResults(unsigned int numbFiles, char *filesToProcess[]){
  *  \param ci structure where calculated statistics are saved
  */
 static void processText(unsigned char *dataToBeProcessed, CONTROLINFO *ci) {
-    char cha;
-    bool inWord = false;
-    int skip, nVowels = 0, nCharacters = 0, maxWordLength = 0, length = ci->numbBytes;
-    
-    for (int i = 0; i < length; i++) {
-      skip = 0;
-        if((char)dataToBeProcessed[i] == (char)0xC3) {
-          skip = 1;
-            i += 1;
-        } else if((char)dataToBeProcessed[i] == (char)0xE2) {
-          skip = 2;
-            i += 2;
-    }
-        cha = dataToBeProcessed[i];
-
-    if (cha >= 48 && cha <= 57) {
-      inWord = true;
-            nCharacters++;
-        } else if (skip == 0 && cha >= 65 && cha <= 90) {
-            inWord = true;
-            nCharacters++;
-          if (cha == 65 || cha == 69 || cha == 73 || cha == 79 || cha == 85)
-            nVowels++;
-        } else if (skip == 0 && cha >= 97 && cha <= 122) {
-            inWord = true;
-            nCharacters++;
-          if (cha == 97 || cha == 101 || cha == 105 || cha == 111 || cha == 117)
-            nVowels++;
-        } else if (skip == 0 && cha == '_') {
-            inWord = true;
-            nCharacters++;
-    } else if ((skip == 0 && cha == (char)0x27) || (skip == 2 && cha == (char)0x98) || (skip == 2 && cha == 0x99)) {
-            ;
-    } else if (skip == 1) {
-      if (cha == (char)0xA7 || cha == (char)0x87) {
-              inWord = true;
-              nCharacters++;
-          } else if (cha == (char)0xA1 || cha == (char)0xA0 || cha == (char)0xA2 || cha == (char)0xA3 || cha == (char)0x81 || cha == (char)0x80 || cha == (char)0x82 || cha == (char)0x83) {
-              inWord = true;
-              nCharacters++;
-              nVowels++;
-          } else if (cha == (char)0xA9 || cha == (char)0xA8 || cha == (char)0xAA || cha == (char)0x89 || cha == (char)0x88 || cha == (char)0x8A) {
-              inWord = true;
-              nCharacters++;
-              nVowels++;
-          } else if (cha == (char)0xAD || cha == (char)0xAC || cha == (char)0x8D || cha == (char)0x8C) {
-              inWord = true;
-              nCharacters++;
-              nVowels++;
-          } else if (cha == (char)0xB3 || cha == (char)0xB2 || cha == (char)0xB4 || cha == (char)0xB5 || cha == (char)0x93 || cha == (char)0x92 || cha == (char)0x94 || cha == (char)0x95) {
-          inWord = true;
-              nCharacters++;
-              nVowels++;
-          } else if (cha == (char)0xBA || cha == (char)0xB9 || cha == (char)0x9A || cha == (char)0x99) {
-              inWord = true;
-              nCharacters++;
-              nVowels++;
-        }
-        } else if ((inWord && (skip == 0 && isValidStopCharacter(cha) == 1)) || (inWord && skip == 2 && isValidStopCharacter(cha) == 3) ) {
-            ci->bidi[nVowels][nCharacters - 1]++;
-            ci->numbWords++;
-            if (nCharacters > maxWordLength)
-              maxWordLength = nCharacters;
-            nCharacters = 0;
-            nVowels = 0;
-            inWord = false;
-        }
-    }
-    
-    if (maxWordLength > ci->maxWordLength)
-      ci->maxWordLength = maxWordLength;
+    unsigned char registers[HLL_REGISTERS] = {0};                       /* the sketch of the text is not kept */
+    ANALYZER analyzer;
+
+    startAnalyzer(&analyzer, &ci->counts, registers, NULL);
+    feedAnalyzer(&analyzer, dataToBeProcessed, ci->numbBytes);
+    finishAnalyzer(&analyzer);
 }
@@ -11,15 +11,87 @@
 #ifndef PROBCONST_H_
 #define PROBCONST_H_
 
+/* Parameters of the word statistics: MAX_SIZE_WORD, HLL_REGISTERS (libclestats) */
+#include "statsConst.h"
+
 /* Generic parameters */
 
-/** \brief number of bytes to be processed each iteration */
+/** \brief default number of bytes to be processed each iteration (see autotune.h) */
 #define  K                  1024
 
-/** \brief max size of word */
-#define  MAX_SIZE_WORD      50
+/** \brief largest number of bytes to be processed each iteration, the size of the buffers a chunk is read into */
+#define  MAX_K              (1 << 16)
+
+/** \brief number of files whose chunks are sent at the same time */
+#define  ACTIVE_FILES       4
+
+/** \brief default number of reads outstanding of the read engine */
+#define  READ_DEPTH         16
+
+/** \brief size of a buffer of the read engine */
+#define  READ_BLOCK         (1 << 16)
+
+/** \brief size of the result cache above which the least recently used results are removed */
+#define  CACHE_LIMIT        (1ULL << 30)
+
+/** \brief number of bytes hashed at the start of a file, and before the offset it resumes from, to detect a rewrite */
+#define  RESUME_CHECK       4096
+
+/** \brief number of strata of a sample */
+#define  SAMPLE_STRATA      16
+
+/** \brief size of a document below which it is processed whole when sampling */
+#define  SAMPLE_MIN         (1 << 20)
+
+/** \brief number of standard errors of the margins of error of a sample (95% confidence) */
+#define  SAMPLE_Z           1.96
+
+/** \brief size of a block a stream (standard input, a pipe or a compressed file) is read into */
+#define  STREAM_BLOCK       (1 << 20)
+
+/** \brief number of compressed bytes of a stream read at a time */
+#define  STREAM_INPUT       (1 << 16)
+
+/** \brief number of threads decompressing the frames of a zstd file at the same time */
+#define  DECODE_THREADS     4
+
+/** \brief number of blocks of a stream, filled in turn */
+#define  STREAM_SLOTS       (2 * DECODE_THREADS)
+
+/** \brief largest decompressed size of a frame of a zstd file for its frames to be decompressed at the same time */
+#define  FRAME_MAX          (1 << 24)
 
 /** \brief alignment in print */
 #define ALIGNMENT			6
 
+/** \brief size of the description of the CPUs a process is bound to */
+#define  BINDING_TEXT        256
+
+/** \brief number of events of the timeline kept per process */
+#define  TRACE_EVENTS        (1 << 16)
+
+/** \brief number of round trips to the dispatcher to align the clock of a process on its clock */
+#define  TRACE_PINGS         8
+
+/** \brief seconds between two writings of the progress metrics */
+#define  METRICS_PERIOD      5
+
+/** \brief smallest number of bytes of a chunk tried by the calibration */
+#define  TUNE_MIN_K          256
+
+/** \brief size of the synthetic text of the calibration */
+#define  TUNE_TEXT           (1 << 23)
+
+/** \brief number of runs of each configuration of the calibration, the fastest one being kept */
+#define  TUNE_ROUNDS         3
+
+/** \brief relative gain below which the calibration keeps the smaller configuration */
+#define  TUNE_MARGIN         0.02
+
+/** \brief directory of the tuning profiles, in the home directory */
+#define  TUNING_DIR          ".cle"
+
+/** \brief name of the tuning profile of the program, after the host */
+#define  TUNING_PROFILE      "prob1-mpi"
+
 #endif /* PROBCONST_H_ */
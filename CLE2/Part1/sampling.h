@@ -0,0 +1,86 @@
+/**
+ *  \file sampling.h (interface file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  Approximate results of a large document from a stratified random sample of its chunks.
+ *
+ *  The document is split in chunks of SAMPLE_CHUNK bytes, and a chunk accounts for the words whose stop character
+ *  lies in it: its text goes from the last word boundary before it to the last one in it, which makes the chunks
+ *  a partition of the words of the document. The chunks are taken a stratum at a time, in round robin, until the
+ *  margin of error of the estimate of the number of words, at a confidence of SAMPLE_Z standard errors, is below
+ *  the relative error asked for (or the whole document is taken). Each count is then extrapolated stratum by
+ *  stratum, and its margin of error follows from the variance between the chunks of each stratum.
+ *
+ *  The sketch of the distinct words and the most frequent words only cover the text sampled.
+ *
+ *  \author Francisco Gonalves and Tiago Lucas - June 2020
+ */
+
+#ifndef SAMPLING_H
+#define SAMPLING_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "CONTROLINFO.h"
+#include "DOCINFO.h"
+#include "SAMPLEINFO.h"
+
+/**
+ *  \brief New sample of a document.
+ *
+ *  \param size size of the document
+ *  \param seed seed of the random order of the chunks
+ *
+ *  \return sample
+ */
+extern SAMPLEINFO *startSample(uint64_t size, unsigned int seed);
+
+/**
+ *  \brief Next chunk to process.
+ *
+ *  \param *s sample
+ *  \param *chunk where the chunk is stored
+ *
+ *  \return false if the sample is complete, or every chunk has been taken
+ */
+extern bool nextSampleChunk(SAMPLEINFO *s, size_t *chunk);
+
+/**
+ *  \brief Read the text of a chunk.
+ *
+ *  \param *d document
+ *  \param chunk chunk
+ *  \param *buffer where the text is stored, MAX_K + 1 bytes (a chunk is at most MAX_K bytes long)
+ *
+ *  \return number of bytes of the text
+ */
+extern size_t readSampleChunk(DOCINFO *d, size_t chunk, unsigned char *buffer);
+
+/**
+ *  \brief Add the results of a chunk to the sample, the sample being complete once the margin of error of the
+ *  number of words is below the relative error given.
+ *
+ *  \param *s sample
+ *  \param *ci results of the chunk (its sampleChunk set)
+ *  \param error relative error
+ *
+ *  \return results of the stratum of the chunk, where the results of the chunk are to be added
+ */
+extern CONTROLINFO *addSample(SAMPLEINFO *s, const CONTROLINFO *ci, double error);
+
+/**
+ *  \brief Estimates of the results of the document, and their margins of error.
+ *
+ *  \param *s sample
+ *  \param *ci where the estimates are stored
+ *  \param *margin where the margins of error are stored: of the number of words, and of the number of words of
+ *  each length (MAX_SIZE_WORD + 1 values)
+ *
+ *  \return fraction of the chunks sampled
+ */
+extern double sampleResults(const SAMPLEINFO *s, CONTROLINFO *ci, double *margin);
+
+#endif /* SAMPLING_H */
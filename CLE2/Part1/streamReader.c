@@ -0,0 +1,180 @@
+/**
+ *  \file streamReader.c (implementation file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  \author Francisco Gonalves and Tiago Lucas - June 2020
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include "probConst.h"
+#include "DECODERINFO.h"
+#include "STREAMINFO.h"
+#include "textDecoder.h"
+#include "streamReader.h"
+
+/**
+ *  \brief Life cycle of a reader thread of a stream: decompress the next part of the text into its block, once the
+ *  block was consumed. A part is the next STREAM_BLOCK bytes of the text (a shorter one being the last), or a
+ *  frame of a zstd file whose frames are listed, several threads decompressing them at the same time.
+ *
+ *  Internal operation.
+ */
+static void *streamReader(void *arg)
+{
+  STREAMINFO *s = (STREAMINFO *) arg;
+  bool frames = s->decoder.numbFrames > 0;
+
+  pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);                 /* only while reading, see closeStream */
+  pthread_mutex_lock(&s->access);
+  while (!s->stopping && (!frames || s->nextPart < s->decoder.numbFrames)){
+    size_t j = s->nextPart++, size, length;
+    unsigned int i = j % s->numbSlots;
+    while ((s->part[i] != j || s->full[i]) && !s->stopping)
+      pthread_cond_wait(&s->changed, &s->access);
+    if (s->stopping)
+      break;
+    pthread_mutex_unlock(&s->access);
+
+    size = frames ? s->decoder.frameSizes[j] : STREAM_BLOCK;
+    if (s->capacity[i] < size && (s->block[i] = (unsigned char *) realloc(s->block[i], s->capacity[i] = size)) == NULL){
+      perror("error on allocating a block of a stream");
+      exit(EXIT_FAILURE);
+    }
+    pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
+    length = frames ? decodeFrame(&s->decoder, j, s->block[i]) : decodeText(&s->decoder, s->block[i], size);
+    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+
+    pthread_mutex_lock(&s->access);
+    s->length[i] = length;
+    s->last[i] = frames ? j + 1 == s->decoder.numbFrames : length < STREAM_BLOCK;
+    s->full[i] = true;
+    pthread_cond_broadcast(&s->changed);
+    if (s->last[i])
+      break;
+  }
+  pthread_mutex_unlock(&s->access);
+  return NULL;
+}
+
+bool isStream(const char *name)
+{
+  struct stat st;
+
+  if (strcmp(name, "-") == 0)
+    return true;
+  return stat(name, &st) == 0 && (S_ISFIFO(st.st_mode) || S_ISCHR(st.st_mode) || S_ISSOCK(st.st_mode));
+}
+
+STREAMINFO *newStream(void)
+{
+  STREAMINFO *s = (STREAMINFO *) calloc(1, sizeof(STREAMINFO));
+
+  if (s == NULL){
+    perror("error on allocating a stream");
+    exit(EXIT_FAILURE);
+  }
+  s->decoder.fd = -1;
+  pthread_mutex_init(&s->access, NULL);
+  pthread_cond_init(&s->changed, NULL);
+  return s;
+}
+
+bool startStream(STREAMINFO *s, const char *name)
+{
+  int fd;
+
+  if (s->started)
+    return true;
+  if ((fd = strcmp(name, "-") == 0 ? STDIN_FILENO : open(name, O_RDONLY)) < 0)
+    return false;
+  startDecoder(&s->decoder, fd);
+  s->numbThreads = s->decoder.numbFrames == 0 ? 1
+                 : s->decoder.numbFrames < DECODE_THREADS ? s->decoder.numbFrames : DECODE_THREADS;
+  s->numbSlots = 2 * s->numbThreads;
+  for (unsigned int i = 0; i < s->numbSlots; i++)
+    s->part[i] = i;
+  for (unsigned int i = 0; i < s->numbThreads; i++)
+    if (pthread_create(&s->readers[i], NULL, streamReader, s) != 0){
+      perror("error on starting the reader of a stream");
+      exit(EXIT_FAILURE);
+    }
+  s->started = true;
+  return true;
+}
+
+size_t readStream(STREAMINFO *s, unsigned char *buffer, size_t count)
+{
+  size_t n = s->givenBack < count ? s->givenBack : count;
+
+  memcpy(buffer, s->kept + s->keptLength - s->givenBack, n);                /* the unfinished word first */
+  s->givenBack -= n;
+  while (n < count && !s->ended){
+    pthread_mutex_lock(&s->access);
+    while (!s->full[s->current])
+      pthread_cond_wait(&s->changed, &s->access);
+    pthread_mutex_unlock(&s->access);
+
+    size_t m = s->length[s->current] - s->offset;                       /* the block belongs to this thread now */
+    m = m < count - n ? m : count - n;
+    memcpy(buffer + n, s->block[s->current] + s->offset, m);
+    n += m;
+    s->offset += m;
+    if (s->offset == s->length[s->current]){                                          /* consumed */
+      s->ended = s->last[s->current];
+      pthread_mutex_lock(&s->access);
+      s->full[s->current] = false;
+      s->part[s->current] += s->numbSlots;
+      pthread_cond_broadcast(&s->changed);
+      pthread_mutex_unlock(&s->access);
+      s->current = (s->current + 1) % s->numbSlots;
+      s->offset = 0;
+    }
+  }
+  s->keptLength = n < MAX_K ? n : MAX_K;                            /* at most a chunk is given back */
+  memcpy(s->kept, buffer + n - s->keptLength, s->keptLength);
+  return n;
+}
+
+void unreadStream(STREAMINFO *s, size_t count)
+{
+  s->givenBack = count;
+}
+
+void closeStream(STREAMINFO *s)
+{
+  if (!s->started || s->decoder.fd < 0)
+    return;
+  pthread_mutex_lock(&s->access);
+  s->stopping = true;
+  pthread_cond_broadcast(&s->changed);
+  pthread_mutex_unlock(&s->access);
+  for (unsigned int i = 0; i < s->numbThreads; i++){
+    if (!s->ended)                                              /* left before its end, a reader may be in read */
+      pthread_cancel(s->readers[i]);
+    pthread_join(s->readers[i], NULL);
+  }
+  stopDecoder(&s->decoder);
+  if (s->decoder.fd != STDIN_FILENO)
+    close(s->decoder.fd);
+  s->decoder.fd = -1;
+  for (unsigned int i = 0; i < s->numbSlots; i++)
+    free(s->block[i]);
+}
+
+void freeStream(STREAMINFO *s)
+{
+  closeStream(s);
+  pthread_mutex_destroy(&s->access);
+  pthread_cond_destroy(&s->changed);
+  free(s);
+}
@@ -0,0 +1,83 @@
+/**
+ *  \file streamReader.h (interface file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  Reading of a text that comes from a stream: standard input (the name -), a pipe or a compressed file. A reader
+ *  thread fills blocks of STREAM_BLOCK bytes in turn, decompressing the text if needed (see textDecoder.h), so
+ *  that the stream is read while the previous block is handed out in chunks; the frames of a zstd file that can
+ *  be decompressed on their own are decompressed by up to DECODE_THREADS threads at the same time, each one into
+ *  its block. As the stream cannot go back, the bytes of the unfinished word at the end of a chunk are carried
+ *  over to the next one instead.
+ *
+ *  \author Francisco Gonalves and Tiago Lucas - June 2020
+ */
+
+#ifndef STREAMREADER_H
+#define STREAMREADER_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "STREAMINFO.h"
+
+/**
+ *  \brief Whether a name is read as a stream: - (standard input), a pipe, a character device or a socket.
+ *
+ *  \param *name name of the file
+ *
+ *  \return true for a stream
+ */
+extern bool isStream(const char *name);
+
+/**
+ *  \brief New stream, not started.
+ *
+ *  \return stream
+ */
+extern STREAMINFO *newStream(void);
+
+/**
+ *  \brief Open a stream and start its reader thread, once.
+ *
+ *  \param *s stream
+ *  \param *name name of the file, - for standard input
+ *
+ *  \return false if it could not be opened
+ */
+extern bool startStream(STREAMINFO *s, const char *name);
+
+/**
+ *  \brief Read the next bytes of a stream, the ones given back first.
+ *
+ *  \param *s stream
+ *  \param *buffer where the bytes are stored
+ *  \param count number of bytes
+ *
+ *  \return number of bytes read, less than count at the end of the stream
+ */
+extern size_t readStream(STREAMINFO *s, unsigned char *buffer, size_t count);
+
+/**
+ *  \brief Give back the last bytes read, so that they start the next read.
+ *
+ *  \param *s stream
+ *  \param count number of bytes, at most MAX_K
+ */
+extern void unreadStream(STREAMINFO *s, size_t count);
+
+/**
+ *  \brief Stop the reader thread of a stream and close it, the bytes given back can still be read.
+ *
+ *  \param *s stream
+ */
+extern void closeStream(STREAMINFO *s);
+
+/**
+ *  \brief Close a stream and release it.
+ *
+ *  \param *s stream
+ */
+extern void freeStream(STREAMINFO *s);
+
+#endif /* STREAMREADER_H */
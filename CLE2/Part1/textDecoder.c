@@ -0,0 +1,264 @@
+/**
+ *  \file textDecoder.c (implementation file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  \author Francisco Gonalves and Tiago Lucas - June 2020
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "probConst.h"
+#include "DECODERINFO.h"
+#include "textDecoder.h"
+
+/** \brief first bytes of a gzip member */
+static const unsigned char gzipMagic[] = {0x1f, 0x8b};
+
+/** \brief first bytes of a zstd frame */
+static const unsigned char zstdMagic[] = {0x28, 0xb5, 0x2f, 0xfd};
+
+/**
+ *  \brief Format of a text from its first bytes.
+ *
+ *  Internal operation.
+ */
+static int formatOf(const unsigned char *bytes, size_t length)
+{
+  if (length >= sizeof(gzipMagic) && memcmp(bytes, gzipMagic, sizeof(gzipMagic)) == 0)
+    return TEXT_GZIP;
+  if (length >= sizeof(zstdMagic) && memcmp(bytes, zstdMagic, sizeof(zstdMagic)) == 0)
+    return TEXT_ZSTD;
+  return TEXT_PLAIN;
+}
+
+int textFormat(const char *name)
+{
+  unsigned char magic[sizeof(zstdMagic)];
+  ssize_t n;
+  int fd;
+
+  if ((fd = open(name, O_RDONLY)) < 0)
+    return TEXT_PLAIN;
+  n = read(fd, magic, sizeof(magic));
+  close(fd);
+  return formatOf(magic, n > 0 ? n : 0);
+}
+
+/**
+ *  \brief Read the next compressed bytes, once the ones read before were consumed.
+ *
+ *  Internal operation.
+ *
+ *  \return false at the end of the file
+ */
+static bool fillInput(DECODERINFO *c)
+{
+  if (c->inputOffset < c->inputLength)
+    return true;
+  c->inputOffset = c->inputLength = 0;
+  while (!c->inputEnded){
+    ssize_t n = read(c->fd, c->input, STREAM_INPUT);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0)
+      perror("error on reading a stream");
+    if (n <= 0)
+      c->inputEnded = true;
+    else {
+      c->inputLength = n;
+      return true;
+    }
+  }
+  return false;
+}
+
+#ifdef HAVE_ZSTD
+/**
+ *  \brief List the frames of a zstd regular file, if they all have a known size of at most FRAME_MAX bytes and
+ *  there are more than one.
+ *
+ *  Internal operation.
+ */
+static void listFrames(DECODERINFO *c)
+{
+  struct stat st;
+  off_t start;
+  size_t offset, size = 0;
+
+  if (fstat(c->fd, &st) != 0 || !S_ISREG(st.st_mode) || (start = lseek(c->fd, 0, SEEK_CUR)) < 0)
+    return;
+  c->map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, c->fd, 0);
+  if (c->map == MAP_FAILED){
+    c->map = NULL;
+    return;
+  }
+  c->mapSize = st.st_size;
+  for (offset = start - c->inputLength; offset < c->mapSize; c->numbFrames++){        /* the headers only */
+    size_t length = ZSTD_findFrameCompressedSize(c->map + offset, c->mapSize - offset);
+    unsigned long long content = ZSTD_getFrameContentSize(c->map + offset, c->mapSize - offset);
+    if (ZSTD_isError(length) || content == ZSTD_CONTENTSIZE_UNKNOWN || content == ZSTD_CONTENTSIZE_ERROR
+        || content > FRAME_MAX)
+      break;
+    if (c->numbFrames + 1 >= size){
+      size = 2 * size + 16;
+      c->frames = (uint64_t *) realloc(c->frames, sizeof(uint64_t) * size);
+      c->frameSizes = (uint64_t *) realloc(c->frameSizes, sizeof(uint64_t) * size);
+    }
+    c->frames[c->numbFrames] = offset;
+    c->frameSizes[c->numbFrames] = content;
+    offset += length;
+  }
+  if (offset < c->mapSize || c->numbFrames < 2){                 /* decompressed as it is read instead */
+    munmap(c->map, c->mapSize);
+    free(c->frames);
+    free(c->frameSizes);
+    c->map = NULL;
+    c->frames = c->frameSizes = NULL;
+    c->numbFrames = 0;
+    return;
+  }
+  c->frames[c->numbFrames] = offset;
+}
+#endif
+
+void startDecoder(DECODERINFO *c, int fd)
+{
+  memset(c, 0, sizeof(DECODERINFO));
+  c->fd = fd;
+  if ((c->input = (unsigned char *) malloc(STREAM_INPUT)) == NULL){
+    perror("error on allocating a decompressor");
+    exit(EXIT_FAILURE);
+  }
+  while (c->inputLength < sizeof(zstdMagic) && !c->inputEnded){       /* a pipe may give fewer bytes at a time */
+    ssize_t n = read(fd, c->input + c->inputLength, STREAM_INPUT - c->inputLength);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0)
+      perror("error on reading a stream");
+    if (n <= 0)
+      c->inputEnded = true;
+    else
+      c->inputLength += n;
+  }
+
+  c->format = formatOf(c->input, c->inputLength);
+  if (c->format == TEXT_GZIP && inflateInit2(&c->gzip, 16 + MAX_WBITS) != Z_OK){       /* gzip header expected */
+    fprintf(stderr, "error on starting a gzip decompressor\n");
+    c->ended = true;
+  }
+  if (c->format == TEXT_ZSTD){
+#ifdef HAVE_ZSTD
+    if ((c->zstd = ZSTD_createDCtx()) == NULL){
+      fprintf(stderr, "error on starting a zstd decompressor\n");
+      c->ended = true;
+    }
+    listFrames(c);
+#else
+    fprintf(stderr, "zstd is not supported by this build (HAVE_ZSTD), the text is left out\n");
+    c->ended = true;
+#endif
+  }
+}
+
+size_t decodeText(DECODERINFO *c, unsigned char *buffer, size_t count)
+{
+  size_t n = 0;
+
+  while (n < count && !c->ended){
+    bool more = fillInput(c);
+    size_t before = n;
+
+    if (c->format == TEXT_PLAIN){
+      size_t m = c->inputLength - c->inputOffset < count - n ? c->inputLength - c->inputOffset : count - n;
+      memcpy(buffer + n, c->input + c->inputOffset, m);
+      c->inputOffset += m;
+      n += m;
+    }
+    else if (c->format == TEXT_GZIP){
+      int status;
+      c->gzip.next_in = c->input + c->inputOffset;
+      c->gzip.avail_in = c->inputLength - c->inputOffset;
+      c->gzip.next_out = buffer + n;
+      c->gzip.avail_out = count - n;
+      status = inflate(&c->gzip, Z_NO_FLUSH);
+      n = count - c->gzip.avail_out;
+      c->inputOffset = c->inputLength - c->gzip.avail_in;
+      if (status == Z_STREAM_END){                                               /* the next member, if any */
+        inflateReset(&c->gzip);
+        c->inFrame = false;
+      }
+      else if (status == Z_OK)
+        c->inFrame = true;
+      else if (status != Z_BUF_ERROR){
+        fprintf(stderr, "error on decompressing a gzip text: %s\n", c->gzip.msg != NULL ? c->gzip.msg : "bad data");
+        c->ended = true;
+      }
+    }
+#ifdef HAVE_ZSTD
+    else {
+      ZSTD_inBuffer in = {c->input, c->inputLength, c->inputOffset};
+      ZSTD_outBuffer out = {buffer, count, n};
+      size_t status = ZSTD_decompressStream(c->zstd, &out, &in);
+      n = out.pos;
+      if (ZSTD_isError(status)){
+        fprintf(stderr, "error on decompressing a zstd text: %s\n", ZSTD_getErrorName(status));
+        c->ended = true;
+      }
+      else if (n > before || in.pos > c->inputOffset)
+        c->inFrame = status != 0;                                                  /* 0 at the end of a frame */
+      c->inputOffset = in.pos;
+    }
+#endif
+
+    if (!more && n == before){                              /* nothing left either in the decompressor */
+      if (c->inFrame)
+        fprintf(stderr, "a compressed text is truncated\n");
+      c->ended = true;
+    }
+  }
+  return n;
+}
+
+size_t decodeFrame(const DECODERINFO *c, size_t frame, unsigned char *buffer)
+{
+#ifdef HAVE_ZSTD
+  size_t n = ZSTD_decompress(buffer, c->frameSizes[frame], c->map + c->frames[frame],
+                             c->frames[frame + 1] - c->frames[frame]);
+  if (ZSTD_isError(n)){
+    fprintf(stderr, "error on decompressing a zstd frame: %s\n", ZSTD_getErrorName(n));
+    return 0;
+  }
+  return n;
+#else
+  return 0;
+#endif
+}
+
+void stopDecoder(DECODERINFO *c)
+{
+  if (c->format == TEXT_GZIP)
+    inflateEnd(&c->gzip);
+#ifdef HAVE_ZSTD
+  ZSTD_freeDCtx(c->zstd);
+#endif
+  if (c->map != NULL)
+    munmap(c->map, c->mapSize);
+  free(c->frames);
+  free(c->frameSizes);
+  free(c->input);
+  c->input = NULL;
+}
@@ -0,0 +1,80 @@
+/**
+ *  \file textDecoder.h (interface file)
+ *
+ *  \brief Problem name: Problem 1.
+ *
+ *  Decompression of the texts read as streams, the format being found from their first bytes: gzip (all the
+ *  members of a file in turn), zstd when built with HAVE_ZSTD, or plain text. The frames of a zstd file whose
+ *  sizes are all known (several files concatenated, pzstd or the seekable format) can be decompressed each one
+ *  on its own, at the same time.
+ *
+ *  \author Francisco Gonalves and Tiago Lucas - June 2020
+ */
+
+#ifndef TEXTDECODER_H
+#define TEXTDECODER_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "DECODERINFO.h"
+
+/** \brief plain text */
+#define  TEXT_PLAIN          0
+
+/** \brief gzip file, of one or more members */
+#define  TEXT_GZIP           1
+
+/** \brief zstd file, of one or more frames */
+#define  TEXT_ZSTD           2
+
+/**
+ *  \brief Format of a file, from its first bytes.
+ *
+ *  \param *name name of the file
+ *
+ *  \return TEXT_PLAIN, TEXT_GZIP or TEXT_ZSTD (TEXT_PLAIN if it could not be read)
+ */
+extern int textFormat(const char *name);
+
+/**
+ *  \brief Start decompressing a text, its format being found from its first bytes.
+ *
+ *  A zstd regular file whose frames all have a known size of at most FRAME_MAX bytes is mapped in memory and its
+ *  frames listed, to be decompressed by decodeFrame.
+ *
+ *  \param *c decompression
+ *  \param fd file descriptor, read from its position
+ */
+extern void startDecoder(DECODERINFO *c, int fd);
+
+/**
+ *  \brief Decompress the next bytes of a text, in order.
+ *
+ *  \param *c decompression
+ *  \param *buffer where the bytes are stored
+ *  \param count number of bytes
+ *
+ *  \return number of bytes, less than count only at the end of the text (or on an error, which is reported)
+ */
+extern size_t decodeText(DECODERINFO *c, unsigned char *buffer, size_t count);
+
+/**
+ *  \brief Decompress a frame of a zstd file listed by startDecoder, it can be called by several threads at once.
+ *
+ *  \param *c decompression
+ *  \param frame number of the frame
+ *  \param *buffer where the frame is stored, of c->frameSizes[frame] bytes
+ *
+ *  \return number of bytes, 0 on an error (which is reported)
+ */
+extern size_t decodeFrame(const DECODERINFO *c, size_t frame, unsigned char *buffer);
+
+/**
+ *  \brief Stop decompressing a text and release its decompressor, the file descriptor is left open.
+ *
+ *  \param *c decompression
+ */
+extern void stopDecoder(DECODERINFO *c);
+
+#endif /* TEXTDECODER_H */
@@ -17,9 +17,14 @@
 typedef struct
 {
    bool processing;
+   bool autocorrelation;
+   bool single;
    size_t filePosition;
    size_t numbSamples;
    size_t rxyIndex;
+   size_t leaf;
+   size_t leafSize;
+   size_t numbLags;
    double result;
 } CONTROLINFO;
 
@@ -0,0 +1,32 @@
+/**
+ *  \file ERRORSTATS.h (interface file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  Errors of the lags of a file checked so far: how many were out of tolerance and the first of them, the largest
+ *  absolute error and its lag, the largest relative error and distance in units in the last place, and the number of
+ *  lags in each decade of relative error.
+ *
+ *  \author Francisco Gonçalves Tiago Lucas - June 2020
+ */
+ 
+#ifndef ERRORSTATS_H
+#define ERRORSTATS_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "probConst.h"
+
+typedef struct
+{
+   size_t numbChecked;
+   size_t numbErrors;
+   size_t firstError;
+   double maxError;
+   size_t maxErrorLag;
+   double maxRelative;
+   uint64_t maxUlps;
+   size_t histogram[ERROR_BINS];
+} ERRORSTATS;
+
+#endif /* end of include guard: ERRORSTATS_H */
@@ -13,6 +13,8 @@
 
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include "ERRORSTATS.h"
 
 typedef struct
 {
@@ -22,6 +24,22 @@ typedef struct
    size_t rxyIndex;
    double* result;
    double* expected;
+   size_t numbLeaves;
+   double** partials;
+   size_t* leavesDone;
+   double norm;
+   double sampleError;
+   bool autocorrelation;
+   double* x;
+   double* y;
+   float* xSingle;
+   float* ySingle;
+   size_t nextTask;
+   size_t numbTasks;
+   uint64_t cacheKey;
+   bool cached;
+   bool failed;
+   ERRORSTATS errors;
 } FILEINFO;
 
 #endif /* end of include guard: CONTROLINFO_H */
\ No newline at end of file
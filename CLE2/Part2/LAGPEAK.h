@@ -0,0 +1,22 @@
+/**
+ *  \file LAGPEAK.h (interface file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  File with the data shared accross all threads, referencing one lag of the circular cross correlation.
+ *
+ *  \author Francisco Gonçalves Tiago Lucas - June 2020
+ */
+ 
+#ifndef LAGPEAK_H
+#define LAGPEAK_H
+
+#include <stdlib.h>
+
+typedef struct
+{
+   size_t lag;
+   double value;
+} LAGPEAK;
+
+#endif /* end of include guard: LAGPEAK_H */
@@ -0,0 +1,26 @@
+/**
+ *  \file PAIRINFO.h (interface file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  File with the data shared accross all threads, referencing one pair of signals of the batch (all-pairs) mode.
+ *
+ *  \author Francisco Gonçalves Tiago Lucas - June 2020
+ */
+ 
+#ifndef PAIRINFO_H
+#define PAIRINFO_H
+
+#include <stdlib.h>
+
+typedef struct
+{
+   size_t first;
+   size_t second;
+   size_t numbSamples;
+   size_t peakLag;
+   double peakValue;
+   long outputOffset;
+} PAIRINFO;
+
+#endif /* end of include guard: PAIRINFO_H */
@@ -0,0 +1,28 @@
+/**
+ *  \file SIGNALINFO.h (interface file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  File with the data shared accross all threads, referencing one signal of the batch (all-pairs) mode.
+ *
+ *  \author Francisco Gonçalves Tiago Lucas - June 2020
+ */
+ 
+#ifndef SIGNALINFO_H
+#define SIGNALINFO_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <complex.h>
+
+typedef struct
+{
+   bool isTemplate;
+   size_t filePosition;
+   char component;
+   size_t numbSamples;
+   double *samples;
+   double complex *spectrum;
+} SIGNALINFO;
+
+#endif /* end of include guard: SIGNALINFO_H */
@@ -0,0 +1,24 @@
+/**
+ *  \file TOLERANCE.h (interface file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  Tolerances of the check of the results against the expected ones, on top of the error bound of each lag: an
+ *  absolute one, one relative to the expected value and a number of units in the last place.
+ *
+ *  \author Francisco Gonçalves Tiago Lucas - June 2020
+ */
+ 
+#ifndef TOLERANCE_H
+#define TOLERANCE_H
+
+#include <stdint.h>
+
+typedef struct
+{
+   double absolute;
+   double relative;
+   uint64_t ulps;
+} TOLERANCE;
+
+#endif /* end of include guard: TOLERANCE_H */
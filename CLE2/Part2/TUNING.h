@@ -0,0 +1,21 @@
+/**
+ *  \file TUNING.h (interface file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  Parameters of a run which depend on the machine: crossover of the FFT engine.
+ *
+ *  \author Francisco Gonçalves Tiago Lucas - June 2020
+ */
+ 
+#ifndef TUNING_H
+#define TUNING_H
+
+#include <stdlib.h>
+
+typedef struct
+{
+   double fftCrossover;
+} TUNING;
+
+#endif /* end of include guard: TUNING_H */
@@ -0,0 +1,190 @@
+/**
+ *  \file autotune.c (implementation file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - June 2020
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <complex.h>
+#include <sys/stat.h>
+
+#include "probConst.h"
+#include "CONTROLINFO.h"
+#include "TUNING.h"
+#include "autotune.h"
+#include "fft.h"
+
+/** \brief parameters of the run */
+TUNING tuning = {FFT_CROSSOVER};
+
+/** \brief name of the profile of the host */
+static char profileName[PATH_MAX];
+
+/** \brief synthetic signals of the calibration and their correlation */
+static double *x, *y, *rxy;
+
+/** \brief kernel being calibrated */
+static void (*correlateRange)(double*, double*, CONTROLINFO*, double*);
+
+const char *tuningProfile(void)
+{
+  char host[HOST_NAME_MAX + 1] = "localhost";
+  const char *home = getenv("HOME");
+
+  if (profileName[0] == '\0'){
+    gethostname(host, sizeof(host));
+    host[HOST_NAME_MAX] = '\0';
+    snprintf(profileName, PATH_MAX, "%s/%s/%s-%s.tune", home != NULL ? home : ".", TUNING_DIR, host, TUNING_PROFILE);
+  }
+  return profileName;
+}
+
+bool loadTuning(void)
+{
+  FILE *f = fopen(tuningProfile(), "r");
+  TUNING t = tuning;
+  char line[256], key[64];
+  double value;
+  bool valid = true;
+
+  if (f == NULL)
+    return false;
+  while (fgets(line, sizeof(line), f) != NULL)
+    if (line[0] != '#' && sscanf(line, "%63s %lf", key, &value) == 2){
+      if (strcmp(key, "fftCrossover") == 0){
+        valid = valid && value > 0;
+        t.fftCrossover = value;
+      }
+    }
+  fclose(f);
+  if (!valid){
+    fprintf(stderr, "the profile %s has a parameter out of range, it is not used\n", profileName);
+    return false;
+  }
+  tuning = t;
+  return true;
+}
+
+bool saveTuning(void)
+{
+  char dirName[PATH_MAX], tempName[PATH_MAX + 4], host[HOST_NAME_MAX + 1] = "localhost";
+  const char *home = getenv("HOME");
+  FILE *f;
+
+  snprintf(dirName, PATH_MAX, "%s/%s", home != NULL ? home : ".", TUNING_DIR);
+  if (mkdir(dirName, 0755) != 0 && errno != EEXIST)
+    return false;
+  snprintf(tempName, sizeof(tempName), "%s.tmp", tuningProfile());
+  if ((f = fopen(tempName, "w")) == NULL)
+    return false;
+  gethostname(host, sizeof(host));
+  host[HOST_NAME_MAX] = '\0';
+  fprintf(f, "# %s, calibrated on %s\n", TUNING_PROFILE, host);
+  fprintf(f, "fftCrossover %.2f\n", tuning.fftCrossover);
+  if (fclose(f) != 0 || rename(tempName, profileName) != 0){
+    unlink(tempName);
+    return false;
+  }
+  return true;
+}
+
+/**
+ *  \brief Seconds of the monotonic clock.
+ *
+ *  Internal operation.
+ */
+static double now(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+/**
+ *  \brief Make the synthetic signals, uniform in [-1, 1[ (xorshift, the same signals on every machine).
+ *
+ *  Internal operation.
+ */
+static void makeSignals(size_t n)
+{
+  uint64_t state = 0x9E3779B97F4A7C15ULL;
+
+  x = (double *) malloc(sizeof(double) * n);
+  y = (double *) malloc(sizeof(double) * n);
+  rxy = (double *) malloc(sizeof(double) * n);
+  for (size_t i = 0; i < 2 * n; i++){
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    (i < n ? x : y)[i % n] = (double) (state >> 11) / (1ULL << 52) - 1;
+  }
+}
+
+/**
+ *  \brief Crossover of the FFT engine on a signal of n samples: the number of lags the direct method computes in the
+ *  time of the FFT engine, over log2(n).
+ *
+ *  Internal operation.
+ *
+ *  \return the crossover, 0 if the scratch memory of the FFT engine could not be allocated
+ */
+static double measureCrossover(size_t n)
+{
+  double complex *X = (double complex *) malloc(sizeof(double complex) * n),
+                 *Y = (double complex *) malloc(sizeof(double complex) * n),
+                 *work = (double complex *) malloc(sizeof(double complex) * n);
+  double values[TUNE_LAGS], start, direct = INFINITY, fft = INFINITY;
+  CONTROLINFO ci = {0};
+  bool done = true;
+
+  ci.numbSamples = n;
+  ci.numbLags = TUNE_LAGS < n ? TUNE_LAGS : n;
+  for (int round = 0; round < TUNE_ROUNDS && done; round++){
+    start = now();
+    correlateRange(x, y, &ci, values);
+    direct = fmin(direct, (now() - start) / ci.numbLags);
+    start = now();
+    done = fftRealSpectrum(x, n, X) && fftRealSpectrum(y, n, Y) && fftCircularCorrelation(X, Y, n, rxy, work);
+    fft = fmin(fft, now() - start);
+  }
+  free(X);
+  free(Y);
+  free(work);
+  if (!done)
+    return 0;
+  printf("%7zu samples: direct %.3g s per lag, FFT engine %.3g s, crossover %.2f\n", n, direct, fft,
+         fft / direct / log2((double) n));
+  return fft / direct / log2((double) n);
+}
+
+void tuneCorrelation(void (*lagRange)(double*, double*, CONTROLINFO*, double*))
+{
+  size_t n;
+  double crossover, sum = 0;
+  int numbSizes = 0;
+
+  correlateRange = lagRange;
+  makeSignals(TUNE_MAX_SAMPLES);
+  for (n = TUNE_MIN_SAMPLES; n <= TUNE_MAX_SAMPLES; n *= 4)
+    if ((crossover = measureCrossover(n)) > 0){
+      sum += crossover;
+      numbSizes++;
+    }
+  if (numbSizes > 0)
+    tuning.fftCrossover = sum / numbSizes;
+  free(x);
+  free(y);
+  free(rxy);
+}
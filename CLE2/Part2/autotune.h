@@ -0,0 +1,63 @@
+/**
+ *  \file autotune.h (interface file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  Parameters of the run which depend on the machine, the crossover of the FFT engine: the default of probConst.h,
+ *  replaced by the profile of the host when there is one, or found by a calibration. The number of processes is the
+ *  one given to mpirun.
+ *
+ *  The calibration correlates synthetic signals with the kernel of the lag query mode and with the FFT engine. The
+ *  crossover is the number of lags the direct method computes in the time of the FFT engine, over the logarithm of
+ *  the number of samples, averaged over signals of TUNE_MIN_SAMPLES to TUNE_MAX_SAMPLES samples, each one being
+ *  timed TUNE_ROUNDS times and its fastest run kept.
+ *
+ *  The profile is a text file, a parameter per line, named after the host and the program (TUNING_PROFILE) in the
+ *  directory TUNING_DIR of the home directory, so that a home directory shared by several machines keeps one for each.
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - June 2020
+ */
+
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+#include <stdbool.h>
+
+#include "TUNING.h"
+#include "CONTROLINFO.h"
+
+/** \brief parameters of the run */
+extern TUNING tuning;
+
+/**
+ *  \brief Load the profile of the host into the parameters of the run.
+ *
+ *  Operation carried out by the dispatcher, before the work starts. A profile with a parameter out of its range is
+ *  ignored, with a message.
+ *
+ *  \return false if there is no profile, the defaults being kept
+ */
+extern bool loadTuning(void);
+
+/**
+ *  \brief Save the parameters of the run as the profile of the host, the directory being created if needed.
+ *
+ *  \return false on a write error
+ */
+extern bool saveTuning(void);
+
+/**
+ *  \brief Name of the profile of the host.
+ *
+ *  \return the name, in a static buffer
+ */
+extern const char *tuningProfile(void);
+
+/**
+ *  \brief Find the parameters of the run which correlate signals the fastest.
+ *
+ *  \param lagRange correlation of a block of lags, the kernel of the lag query mode
+ */
+extern void tuneCorrelation(void (*lagRange)(double*, double*, CONTROLINFO*, double*));
+
+#endif /* AUTOTUNE_H */
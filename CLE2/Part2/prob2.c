@@ -15,15 +15,67 @@
 #include <math.h>
 #include <unistd.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <complex.h>
+#include <float.h>
+#include <stdint.h>
 #include <mpi.h>
 
+#include "probConst.h"
 #include "FILEINFO.h"
 #include "CONTROLINFO.h"
+#include "SIGNALINFO.h"
+#include "PAIRINFO.h"
+#include "LAGPEAK.h"
+#include "fft.h"
+#include "signalCorrelator.h"
+#include "STREAMINFO.h"
+#include "streamCorrelation.h"
+#include "SIGNALRECORD.h"
+#include "signalFile.h"
+#include "fileList.h"
+#include "READBLOCK.h"
+#include "readEngine.h"
+#include "HASHSTATE.h"
+#include "resultCache.h"
+#include "placement.h"
+#include "PERFCOUNTS.h"
+#include "perfCounters.h"
+#include "TRACEEVENT.h"
+#include "traceLog.h"
+#include "progressMetrics.h"
+#include "TUNING.h"
+#include "autotune.h"
+#include "TOLERANCE.h"
+#include "ERRORSTATS.h"
+#include "resultCheck.h"
 
 /* Allusion to internal functions */
 static void circularCrossCorrelation(double*, double*, CONTROLINFO*);
-static void savePartialResults(CONTROLINFO*);
-static void printResults(unsigned int, char**);
+static void savePartialResults(CONTROLINFO*, int);
+static void partialCorrelation(double*, double*, CONTROLINFO*, size_t);
+static void circularCrossCorrelationSingle(float*, float*, CONTROLINFO*);
+static void partialCorrelationSingle(float*, float*, CONTROLINFO*, size_t);
+static void saveLeafResult(CONTROLINFO*, int);
+static void storeLag(FILEINFO*, size_t, double);
+static bool printResults(unsigned int, char**);
+static void batchCorrelation(int, int, unsigned int, char*, char**);
+static void lagRangeCorrelation(double*, double*, CONTROLINFO*, double*);
+static void lagRangeCorrelationSingle(float*, float*, CONTROLINFO*, double*);
+static bool lagQuery(int, int, size_t, size_t, unsigned int, char**);
+static bool streamCorrelation(int, int, size_t, char*, char**);
+static void scheduleFiles(void);
+static void reportBinding(int, int);
+static void beginUnit(PERFCOUNTS*);
+static void endUnit(unsigned int, const PERFCOUNTS*, uint64_t);
+static void gatherCounters(int, int);
+static void alignTrace(int, int);
+static void writeTimeline(int, int, char*);
+static void sendTraced(void*, int, MPI_Datatype, int);
+static void recvTraced(void*, int, MPI_Datatype, int);
+static int nextScheduledFile(size_t, size_t*);
+static bool parseCount(const char*, long, long*);
 
 /* Globlal variables */
 /* contains the results of processing for each file*/
@@ -32,10 +84,67 @@ FILEINFO* filesManager;
 /*numb of files to process*/
 unsigned int numbFiles;
 
+/* file and index in the file of each record to process, records of containers are processed apart */
+char **filePaths;
+size_t *fileRecords;
+
+/* distinct signals of the batch (all-pairs) mode */
+SIGNALINFO* signals;
+
+/* number of distinct signals */
+size_t numbSignals;
+
+/* pairs of signals to correlate in the batch mode */
+PAIRINFO* pairs;
+
+/* number of pairs to correlate and pairs skipped because the signals have different sizes */
+size_t numbPairs, numbSkipped;
+
+/* every file is taken as an autocorrelation, y is ignored */
+bool forceAutocorrelation;
+
+/* x and y are stored as float, and sent as float to the workers */
+static bool singleStorage;
+
+/* the errors of the results of each file are reported */
+static bool errorReport;
+
+/* names of the records to process, as given to the exported metrics */
+static char **metricNames;
+
+/* files in the order they are started, largest first */
+static size_t *schedule;
+
+/* files whose lags are sent at the same time, in round robin, their number and the next one to serve */
+static size_t activeFiles[ACTIVE_FILES], numbActive, nextActive;
+
+/* position in the schedule of the next file to start */
+static size_t nextStart;
+
 /* \brief Working state definitions */
 # define  WORKTODO       1
 # define  NOMOREWORK     0
 
+/* kernels whose hardware counters are reported, numbered by the KERNEL_ constants */
+static const char *const kernelNames[] = {"circularCrossCorrelation", "partialCorrelation", "lagRangeCorrelation",
+                                          "fft of a lag window", "correlateStreamBlock", "fftRealSpectrum",
+                                          "fftCircularCorrelation"};
+
+# define  KERNEL_CIRCULAR     0
+# define  KERNEL_PARTIAL      1
+# define  KERNEL_LAG_RANGE    2
+# define  KERNEL_LAG_FFT      3
+# define  KERNEL_STREAM       4
+# define  KERNEL_SPECTRUM     5
+# define  KERNEL_PAIR         6
+# define  NUMB_KERNELS        7
+
+/* hardware counters of the process, all -1 when they are not counted */
+static int counterGroup[PERF_EVENTS];
+
+/* start of the unit of work being done, in the timeline */
+static double unitStart;
+
 /**
  *  \brief Main function.
  *
@@ -44,6 +153,51 @@ unsigned int numbFiles;
  *  \param argc number of words of the command line
  *  \param argv list of words of the command line
  *
+ *  Options:
+ *     -a          batch mode: correlate every distinct signal (x and y of each file) with every other one
+ *     -t n        batch mode: the signals of the first n files are templates, correlated with all the others
+ *     -o file     batch mode: write the full rxy vector of every pair to file
+ *                 streaming mode: directory where the rxy of each file is written (default: current directory)
+ *     -r a:b      lag query mode: only compute the lags a to b
+ *     -k n        lag query mode: only report the n highest peaks (of the whole signal or of the lags given by -r)
+ *     -s          streaming mode: read the signals in blocks (bounded memory), "-" reads a file from stdin
+ *     -b n        streaming mode: number of samples of a block
+ *     -A          take every file as an autocorrelation (y is ignored), files whose x and y are equal are always
+ *                 detected as such: only the lags 0 to n/2 are computed, the others are mirrored
+ *     -S n        split the sum of each lag in parts of n samples, spread over the workers and reduced by a pairwise
+ *                 sum, so that the result does not depend on the number of processes
+ *     -i engine   read the signals through the asynchronous read engine: uring (io_uring, or threads where it is
+ *                 not available) or threads (a pool of threads calling pread)
+ *     -q n        read engine: number of reads outstanding at once (default READ_DEPTH)
+ *     -c dir      the dispatcher keeps the rxy of each file in the result cache dir (created if needed, at most
+ *                 CACHE_LIMIT bytes), files whose signals were already correlated with the same parameters are not
+ *                 computed again
+ *     -B          print the CPUs and the NUMA nodes each process is bound to
+ *     -P          count the cycles, instructions, cache misses and branch misses of each process over each unit of
+ *                 work, the dispatcher reporting them per process and per kernel (see perfCounters.h), the bytes
+ *                 of a unit being the bytes of the signals it goes through
+ *     -T file     record the timeline of every process (lags scheduled and computed, results merged, MPI sends and
+ *                 receives), the clocks being aligned on the one of the dispatcher, which writes it to file as a
+ *                 Chrome trace (see traceLog.h)
+ *     -M file     the dispatcher exports the progress of the run (lags computed on each file, bytes and rate of
+ *                 each process, estimated time left) to file as a Prometheus textfile, rewritten every
+ *                 METRICS_PERIOD seconds (see progressMetrics.h), from the results the workers send back
+ *     -U          the dispatcher calibrates the crossover of the FFT engine on this host (see autotune.h) and saves
+ *                 it as its profile, which the next runs load, then the files are processed if any
+ *     -f          store x and y as float (lag and lag query modes), half the bytes sent to the workers and gone
+ *                 through by them on long signals: the samples are converted as they are read and the sums are still
+ *                 accumulated in double, so the only error is the rounding of the samples to float, which the check
+ *                 against the expected results allows for (none for samples stored as float in the file, see
+ *                 signalFile.h)
+ *     -E a:r:u    tolerances of the check against the expected results: a lag is correct when its error is within
+ *                 the largest of a and r times the expected value, on top of the error the run allows for, or within
+ *                 u units in the last place (see resultCheck.h); none by default
+ *     -e          report, for each file, the largest absolute error and its lag, the largest relative and ulp
+ *                 errors, the first lag out of tolerance, a histogram of the relative errors and the error bound of
+ *                 its samples (lag, lag query and streaming modes)
+ *
+ *  The files may be given as directories (every file in them) or as @list (the files listed in list, one per line).
+ *
  *  \return status of operation
  */
 int main (int argc, char *argv[]){
@@ -51,31 +205,225 @@ int main (int argc, char *argv[]){
     rank,                                   /* number of processes in the group */
     whatToDo;                               /* command */
     double start, finish;                      /* variables to calculate how much time the execution took */
-    numbFiles = argc - 1;
     CONTROLINFO ci = {0};                      /* data transfer variable */
-    double* x;                                  /* first signal */
-    double* y;                                  /* second signal */
+    PERFCOUNTS begin;                          /* hardware counters before a unit of work */
+    double* x = NULL;                           /* first signal */
+    double* y = NULL;                           /* second signal */
+    int opt;                                    /* command line option */
+    bool batch = false;                         /* batch (all-pairs) mode */
+    unsigned int numbTemplates = 0;             /* number of files whose signals are templates */
+    char *outputName = NULL;                    /* file for the full rxy vectors of the batch mode */
+    char **fileNames;                           /* names of the records to process (name#record in a container) */
+    bool query = false;                         /* lag query mode */
+    size_t firstLag = 0, lastLag = (size_t) -1; /* lag window of the query */
+    unsigned int numbPeaks = 0;                 /* number of peaks of the query */
+    bool stream = false;                        /* streaming mode */
+    size_t blockSize = STREAM_BLOCK;            /* number of samples of a block in the streaming mode */
+    size_t leafSize = 0;                        /* number of samples of each part of a lag, 0 to not split */
+    int engine = READ_SYNC;                     /* read engine */
+    unsigned int readDepth = READ_DEPTH;        /* number of reads outstanding of the read engine */
+    char *cacheName = NULL;                     /* directory of the result cache of the dispatcher */
+    bool binding = false;                       /* the binding of the processes is printed */
+    bool counters = false;                      /* the hardware counters of the processes are reported */
+    char *traceName = NULL;                     /* file where the timeline is written */
+    char *metricsName = NULL;                   /* file where the progress metrics are exported */
+    bool autotune = false;                      /* the parameters of the host are calibrated */
+    double t;                                   /* start of an event of the timeline */
+    int status = EXIT_SUCCESS;                  /* exit status, a failure when a file was not fully checked */
+    long count;                                 /* count given as the argument of an option */
+    float* xSingle = NULL;                      /* first signal, stored as float */
+    float* ySingle = NULL;                      /* second signal, stored as float */
 
     /* get processing configuration */
     MPI_Init (&argc, &argv);
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &nProc);
 
+    while ((opt = getopt (argc, argv, "at:o:r:k:sb:S:Ai:q:c:BPT:M:UfE:e")) != -1)
+        switch (opt) {
+            case 'a': batch = true;
+                      break;
+            case 't': batch = true;
+                      if (!parseCount (optarg, UINT_MAX, &count)) {
+                          if (rank == 0)
+                              printf("Invalid number of templates %s\n", optarg);
+                          MPI_Finalize ();
+                          exit(EXIT_FAILURE);
+                      }
+                      numbTemplates = count;
+                      break;
+            case 'o': outputName = optarg;
+                      break;
+            case 'r': query = true;
+                      if (sscanf (optarg, "%lu:%lu", &firstLag, &lastLag) != 2 || firstLag > lastLag) {
+                          if (rank == 0)
+                              printf("Invalid lag window %s, expected first:last\n", optarg);
+                          MPI_Finalize ();
+                          exit(EXIT_FAILURE);
+                      }
+                      break;
+            case 'k': query = true;
+                      if (!parseCount (optarg, UINT_MAX, &count)) {
+                          if (rank == 0)
+                              printf("Invalid number of peaks %s\n", optarg);
+                          MPI_Finalize ();
+                          exit(EXIT_FAILURE);
+                      }
+                      numbPeaks = count;
+                      break;
+            case 's': stream = true;
+                      break;
+            case 'b': if ((blockSize = atol (optarg)) == 0) {
+                          if (rank == 0)
+                              printf("Invalid block size %s\n", optarg);
+                          MPI_Finalize ();
+                          exit(EXIT_FAILURE);
+                      }
+                      break;
+            case 'S': if (!parseCount (optarg, LONG_MAX, &count)) {
+                          if (rank == 0)
+                              printf("Invalid leaf size %s\n", optarg);
+                          MPI_Finalize ();
+                          exit(EXIT_FAILURE);
+                      }
+                      leafSize = count;
+                      break;
+            case 'A': forceAutocorrelation = true;
+                      break;
+            case 'i': if (strcmp(optarg, "uring") == 0)
+                          engine = READ_URING;
+                      else if (strcmp(optarg, "threads") == 0)
+                          engine = READ_THREADS;
+                      else {
+                          if (rank == 0)
+                              printf("Unknown read engine %s\n", optarg);
+                          MPI_Finalize ();
+                          exit(EXIT_FAILURE);
+                      }
+                      break;
+            case 'q': if ((readDepth = atoi (optarg)) == 0) {
+                          if (rank == 0)
+                              printf("Invalid number of reads %s\n", optarg);
+                          MPI_Finalize ();
+                          exit(EXIT_FAILURE);
+                      }
+                      break;
+            case 'c': cacheName = optarg;
+                      break;
+            case 'B': binding = true;
+                      break;
+            case 'P': counters = true;
+                      break;
+            case 'T': traceName = optarg;
+                      break;
+            case 'M': metricsName = optarg;
+                      break;
+            case 'U': autotune = true;
+                      break;
+            case 'f': singleStorage = true;
+                      break;
+            case 'E': if (!parseTolerance (optarg)) {                   /* every process checks results */
+                          if (rank == 0)
+                              printf("Invalid tolerances %s, expected absolute:relative:ulps\n", optarg);
+                          MPI_Finalize ();
+                          exit(EXIT_FAILURE);
+                      }
+                      break;
+            case 'e': errorReport = true;
+                      break;
+            default:  if (rank == 0)
+                          printf("Usage: %s [-a] [-t templates] [-o output] [-r first:last] [-k peaks] [-s] [-b block] [-S leaf] [-A] [-i engine] [-q reads] [-c cache] [-B] [-P] [-T trace] [-M metrics] [-U] [-f] [-E a:r:u] [-e] files\n", argv[0]);
+                      MPI_Finalize ();
+                      exit(EXIT_FAILURE);
+        }
+    if (singleStorage && (batch || stream)) {
+        if (rank == 0)
+            printf("The signals are only stored as float in the lag and lag query modes\n");
+        MPI_Finalize ();
+        exit(EXIT_FAILURE);
+    }
+
+    if (rank == 0) {
+        loadTuning ();
+        if (autotune) {
+            tuneCorrelation (lagRangeCorrelation);
+            if (!saveTuning ())
+                perror ("error on saving the profile");
+            printf("FFT crossover %.2f, profile %s\n", tuning.fftCrossover, tuningProfile ());
+        }
+    }
+    MPI_Bcast (&tuning, sizeof (TUNING), MPI_BYTE, 0, MPI_COMM_WORLD);
+    if (autotune && optind >= argc) {
+        MPI_Finalize ();
+        return EXIT_SUCCESS;
+    }
+
+    if (engine != READ_SYNC && startReadEngine(engine, readDepth, READ_BLOCK) == READ_SYNC)   /* every process reads */
+        fprintf(stderr, "the read engine could not be started, reading synchronously\n");
+    numbFiles = listSignalRecords(argv + optind, argc - optind, &filePaths, &fileRecords, &fileNames);
+    if (binding)
+        reportBinding(rank, nProc);
+    if (counters)
+        startCounters(rank == 0 ? nProc : 1, NUMB_KERNELS);   /* a row per process at the dispatcher */
+    openCounters(counterGroup);
+    if (traceName != NULL) {
+        if (!startTrace(1, TRACE_EVENTS))
+            fprintf(stderr, "the timeline could not be allocated, it is not recorded\n");
+        alignTrace(rank, nProc);
+    }
+    metricNames = fileNames;
+    if (rank == 0 && metricsName != NULL) {
+        if (!startMetrics(metricsName, nProc))
+            perror ("error on writing the metrics, they are not exported");
+        presentMetricFiles(numbFiles);
+        for (size_t i = 0; i < numbFiles; i++)
+            nameMetricFile(i, fileNames[i], 0);                             /* the lags are known once read */
+    }
+
     MPI_Barrier (MPI_COMM_WORLD);
     start = MPI_Wtime();
 
+    if ((batch || query || stream) && numbFiles > 0) {
+        if (batch)
+            batchCorrelation(rank, nProc, numbTemplates, outputName, fileNames);
+        else if (stream)
+            status = streamCorrelation(rank, nProc, blockSize, outputName != NULL ? outputName : ".", fileNames)
+                     ? EXIT_SUCCESS : EXIT_FAILURE;
+        else
+            status = lagQuery(rank, nProc, firstLag, lastLag, numbPeaks > MAX_PEAKS ? MAX_PEAKS : numbPeaks, fileNames)
+                     ? EXIT_SUCCESS : EXIT_FAILURE;
+        stopMetrics();
+        if (counters)
+            gatherCounters(rank, nProc);
+        if (traceName != NULL)
+            writeTimeline(rank, nProc, traceName);
+        MPI_Barrier (MPI_COMM_WORLD);
+        if (rank == 0) {
+            printCounters("process", kernelNames);
+            finish = MPI_Wtime();
+            printf("\nElapsed time = %.6f s\n", finish - start);
+        }
+        stopReadEngine();
+        MPI_Finalize ();
+        return status;
+    }
+
     if (rank == 0) {                     /* dispatcher process it is the first process of the group */
 
-        FILE *f;                                                            /* pointer to the text stream associated with the file name */
         filesManager = (FILEINFO*) calloc(numbFiles, sizeof(FILEINFO));
-        unsigned int workProc,                                              /* counting variable */
-        aux,                                                                /* auxiliary variable */
-        samples;                                                            /* size of signals */
-        int filePos = 1;
+        unsigned int workProc;                                              /* counting variable */
+        size_t fileId,                                                      /* file of the lag sent to a worker */
+        task,                                                               /* lag (and part of the lag) sent to a worker */
+        first;                                                              /* first sample of the part sent to a worker */
+        unsigned int length;                                                /* number of samples of the part */
+        double *ySegment = NULL;                                            /* samples of y of a part, unwrapped */
+        float *ySegmentSingle = NULL;                                       /* the same, y being stored as float */
+        int available = 1;                                                  /* there are lags to send */
+        FILEINFO *fi;
 
         /* check running parameters and load list of names into memory */
         
-        if(argc < 2) {
+        if(numbFiles < 1) {
             perror("Please insert binary files to be processed as arguments!");
             whatToDo = NOMOREWORK;
             for (int i = 1; i < nProc; i++)
@@ -83,92 +431,133 @@ int main (int argc, char *argv[]){
             MPI_Finalize ();
             exit(EXIT_FAILURE);    
         }
+        if (leafSize > 0 && singleStorage)
+            ySegmentSingle = allocSingles(leafSize);
+        else if (leafSize > 0)
+            ySegment = (double *) malloc(sizeof(double) * leafSize);
+        if (cacheName != NULL && !openResultCache(cacheName, CACHE_LIMIT))
+            fprintf(stderr, "the result cache %s could not be opened, it is not used\n", cacheName);
 
-        /* processing the circular cross correlation between two signals */
-        while (filePos <= numbFiles) {
-            
-            /* read file, i.e. both signals and result */
-            if((f = fopen (argv[filePos], "rb")) == NULL){
-                perror ("error on file opening for reading");
-                whatToDo = NOMOREWORK;
-                for (int i = 1; i < nProc; i++)
-                    MPI_Send (&whatToDo, 1, MPI_UNSIGNED, i, 0, MPI_COMM_WORLD);
-                MPI_Finalize ();
-                exit (EXIT_FAILURE);
-            }
+        /* the files are started largest first and the lags of several of them are sent at the same time, so that
+           a big file is not left alone at the end of the run and no worker waits for the last lags of a file */
+        scheduleFiles();
+        while (available > 0) {
+            workProc = 1;
 
-            fread(&samples, sizeof(int), 1, f);
-            if (filePos == 1) {
-                x = (double *) malloc(sizeof(double) * samples);
-                y = (double *) malloc(sizeof(double) * samples);
-            } else {
-                x = (double *) realloc(x, sizeof(double) * samples);
-                y = (double *) realloc(y, sizeof(double) * samples);
-            }
-            ci.numbSamples = samples;
-            ci.filePosition = filePos - 1;
-
-            fread(x, sizeof(double), samples, f);
-            fread(y, sizeof(double), samples, f);
-            filesManager[filePos - 1].result = (double *) malloc(sizeof(double) * samples);
-            filesManager[filePos - 1].expected = (double *) malloc(sizeof(double) * samples);
-            fread(filesManager[filePos - 1].expected, sizeof(double), samples, f);
-            filesManager[filePos - 1].rxyIndex = 0;
-            filesManager[filePos - 1].filePosition = filePos - 1;
-            filesManager[filePos - 1].numbSamples = samples;
-
-            /* close file */
-            if (fclose (f) == EOF){ 
-                perror ("error on closing file");
-                whatToDo = NOMOREWORK;
-                for (int i = 1; i < nProc; i++)
-                    MPI_Send (&whatToDo, 1, MPI_UNSIGNED, i, 0, MPI_COMM_WORLD);
-                MPI_Finalize ();
-                exit (EXIT_FAILURE);
-            }
+            for (int i = nProc > 1 ? 1 : 0; i < nProc; i++) {
+                t = traceClock();
+                available = nextScheduledFile(leafSize, &fileId);
+                traceSpan(0, TRACE_FETCH, t);
+                if (available <= 0)
+                    break;
+                fi = &filesManager[fileId];
+                task = fi->nextTask++;
+                ci.filePosition = fileId;
+                ci.numbSamples = fi->numbSamples;
+                ci.autocorrelation = fi->autocorrelation;
+                ci.leafSize = leafSize;
+                ci.single = singleStorage;
+                ci.result = 0;
 
-            filePos++;
-            aux = 0;
-            
-            /* loop until all positions of result array (circular cross correlation) have been calculated */
-            while (aux < samples){ 
-                workProc = 1;
-                
-                /* distribute sorting task */
-                for (int i = 1; i < nProc && aux < samples; i++, workProc++, aux++){
+                if (leafSize > 0) {                                         /* each worker only gets its part of x and y */
+                    ci.rxyIndex = task / fi->numbLeaves;
+                    ci.leaf = task % fi->numbLeaves;
+                    first = ci.leaf * leafSize;
+                    length = first + leafSize < fi->numbSamples ? leafSize : fi->numbSamples - first;
+                    for (size_t j = 0; j < length && ci.single; j++)
+                        ySegmentSingle[j] = fi->ySingle[(ci.rxyIndex + first + j) % fi->numbSamples];
+                    for (size_t j = 0; j < length && !ci.single; j++)
+                        ySegment[j] = fi->y[(ci.rxyIndex + first + j) % fi->numbSamples];
+                    if (nProc == 1) {                                       /* no workers, the dispatcher does it */
+                        beginUnit(&begin);
+                        if (ci.single)
+                            partialCorrelationSingle(fi->xSingle + first, ySegmentSingle, &ci, length);
+                        else
+                            partialCorrelation(fi->x + first, ySegment, &ci, length);
+                        endUnit(KERNEL_PARTIAL, &begin, 2 * (ci.single ? sizeof(float) : sizeof(double)) * length);
+                        saveLeafResult(&ci, 0);
+                        continue;
+                    }
                     whatToDo = WORKTODO;
-                    MPI_Send (&whatToDo, 1, MPI_UNSIGNED, i, 0, MPI_COMM_WORLD);
-                    MPI_Send (&samples, 1, MPI_UNSIGNED, i, 0, MPI_COMM_WORLD);
-                    ci.rxyIndex = aux;
-                    MPI_Send (&ci, sizeof (CONTROLINFO), MPI_BYTE, i, 0, MPI_COMM_WORLD);
-                    MPI_Send (x, samples, MPI_DOUBLE, i, 0, MPI_COMM_WORLD);
-                    MPI_Send (y, samples, MPI_DOUBLE, i, 0, MPI_COMM_WORLD);
+                    sendTraced (&whatToDo, 1, MPI_UNSIGNED, i);
+                    sendTraced (&length, 1, MPI_UNSIGNED, i);
+                    sendTraced (&ci, sizeof (CONTROLINFO), MPI_BYTE, i);
+                    if (ci.single) {
+                        sendTraced (fi->xSingle + first, length, MPI_FLOAT, i);
+                        sendTraced (ySegmentSingle, length, MPI_FLOAT, i);                      /* always, shifted */
+                    } else {
+                        sendTraced (fi->x + first, length, MPI_DOUBLE, i);
+                        sendTraced (ySegment, length, MPI_DOUBLE, i);                           /* always, shifted */
+                    }
+                } else {
+                    ci.rxyIndex = task;
+                    if (nProc == 1) {
+                        beginUnit(&begin);
+                        if (ci.single)
+                            circularCrossCorrelationSingle(fi->xSingle, fi->ySingle, &ci);
+                        else
+                            circularCrossCorrelation(fi->x, fi->y, &ci);
+                        endUnit(KERNEL_CIRCULAR, &begin,
+                                2 * (ci.single ? sizeof(float) : sizeof(double)) * fi->numbSamples);
+                        savePartialResults(&ci, 0);
+                        continue;
+                    }
+                    length = fi->numbSamples;
+                    whatToDo = WORKTODO;
+                    sendTraced (&whatToDo, 1, MPI_UNSIGNED, i);
+                    sendTraced (&length, 1, MPI_UNSIGNED, i);
+                    sendTraced (&ci, sizeof (CONTROLINFO), MPI_BYTE, i);
+                    if (ci.single) {
+                        sendTraced (fi->xSingle, length, MPI_FLOAT, i);
+                        if (!ci.autocorrelation)
+                            sendTraced (fi->ySingle, length, MPI_FLOAT, i);
+                    } else {
+                        sendTraced (fi->x, length, MPI_DOUBLE, i);
+                        if (!ci.autocorrelation)
+                            sendTraced (fi->y, length, MPI_DOUBLE, i);
+                    }
                 }
+                workProc++;
+            }
 
-                /* receive results of processing from workers*/
-                for (int i = 1; i < workProc; i++) {
-                    MPI_Recv (&ci, sizeof(CONTROLINFO), MPI_CHAR, i, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-                    savePartialResults(&ci);
-                }
+            /* receive results of processing from workers */
+            for (int i = 1; i < workProc; i++) {
+                recvTraced (&ci, sizeof(CONTROLINFO), MPI_CHAR, i);
+                t = traceClock();
+                if (ci.leafSize != 0)
+                    saveLeafResult(&ci, i);
+                else
+                    savePartialResults(&ci, i);
+                traceSpan(0, TRACE_MERGE, t);
             }
         }
 
+        stopMetrics();
+
         /* dismiss worker processes */
         whatToDo = NOMOREWORK;
         for (int i = 1; i < nProc; i++)
             MPI_Send (&whatToDo, 1, MPI_UNSIGNED, i, 0, MPI_COMM_WORLD);
+        free(ySegment);
+        free(ySegmentSingle);
 
     } else {                                            /* worker processes */
         unsigned int size_signal,                       /* size of signals to process */
-        t = 0;                                          /* auxiliary variable */
+        t = 0,                                          /* auxiliary variable */
+        tSingle = 0;                                    /* the same for the signals stored as float */
 
         while (true) {
 
-            MPI_Recv (&whatToDo, 1, MPI_UNSIGNED, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            recvTraced (&whatToDo, 1, MPI_UNSIGNED, 0);
             if (whatToDo == NOMOREWORK)
                 break;
-            MPI_Recv (&size_signal, 1, MPI_UNSIGNED, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-            if (size_signal > t) {
+            recvTraced (&size_signal, 1, MPI_UNSIGNED, 0);
+            recvTraced (&ci, sizeof (CONTROLINFO), MPI_BYTE, 0);
+            if (ci.single && size_signal > tSingle) {      /* only the buffers of the type of the run */
+                xSingle = (float *) realloc(xSingle, sizeof(float) * size_signal);
+                ySingle = (float *) realloc(ySingle, sizeof(float) * size_signal);
+                tSingle = size_signal;
+            } else if (!ci.single && size_signal > t) {
                 if (t == 0) {
                     x = (double *) malloc(sizeof(double) * size_signal);
                     y = (double *) malloc(sizeof(double) * size_signal);
@@ -178,74 +567,229 @@ int main (int argc, char *argv[]){
                 }
                 t = size_signal;
             }
-            MPI_Recv (&ci, sizeof (CONTROLINFO), MPI_BYTE, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-            MPI_Recv (x, size_signal, MPI_DOUBLE, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-            MPI_Recv (y, size_signal, MPI_DOUBLE, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-            circularCrossCorrelation(x, y, &ci);
-            MPI_Send (&ci, sizeof (CONTROLINFO), MPI_BYTE, 0, 0, MPI_COMM_WORLD);
+            if (ci.single) {
+                recvTraced (xSingle, size_signal, MPI_FLOAT, 0);
+                if (ci.leafSize != 0 || !ci.autocorrelation)
+                    recvTraced (ySingle, size_signal, MPI_FLOAT, 0);
+            } else {
+                recvTraced (x, size_signal, MPI_DOUBLE, 0);
+                if (ci.leafSize != 0 || !ci.autocorrelation)
+                    recvTraced (y, size_signal, MPI_DOUBLE, 0);
+            }
+            beginUnit(&begin);
+            if (ci.single && ci.leafSize != 0)
+                partialCorrelationSingle(xSingle, ySingle, &ci, size_signal);
+            else if (ci.single)
+                circularCrossCorrelationSingle(xSingle, ci.autocorrelation ? xSingle : ySingle, &ci);
+            else if (ci.leafSize != 0)
+                partialCorrelation(x, y, &ci, size_signal);
+            else
+                circularCrossCorrelation(x, ci.autocorrelation ? x : y, &ci);
+            endUnit(ci.leafSize != 0 ? KERNEL_PARTIAL : KERNEL_CIRCULAR, &begin,
+                    2 * (ci.single ? sizeof(float) : sizeof(double)) * size_signal);
+            sendTraced (&ci, sizeof (CONTROLINFO), MPI_BYTE, 0);
         }
     }
 
     free(x);
     free(y);
+    free(xSingle);
+    free(ySingle);
+    if (counters)
+        gatherCounters(rank, nProc);
+    if (traceName != NULL)
+        writeTimeline(rank, nProc, traceName);
 
     /* print results and execution time */
     MPI_Barrier (MPI_COMM_WORLD);
     if (rank == 0) {
         printf("\nFinal report\n");
-        printResults(numbFiles, argv+1);
+        status = printResults(numbFiles, fileNames) ? EXIT_SUCCESS : EXIT_FAILURE;
+        printCounters("process", kernelNames);
+        closeResultCache();
         finish = MPI_Wtime();
         printf("\nElapsed time = %.6f s\n", finish - start);
     }
+    stopReadEngine();
     MPI_Finalize ();
-    return EXIT_SUCCESS;
+    return status;
+}
+
+/**
+ *  \brief Read a count given as the argument of an option.
+ *
+ *  Operation carried out by every process.
+ *
+ *  \param text  argument of the option
+ *  \param max   largest count allowed
+ *  \param value where the count is stored
+ *
+ *  \return false if the argument is not a whole number from 1 to max
+ */
+static bool parseCount(const char *text, long max, long *value) {
+    char *end;
+
+    errno = 0;
+    *value = strtol (text, &end, 10);
+    return (end != text) && (*end == '\0') && (errno == 0) && (*value > 0) && (*value <= max);
 }
 
 /**
- *  \brief Calculate circular cross correlation for two signals
+ *  \brief Calculate circular cross correlation for two signals (libclestats kernel).
  *
  *  Operation carried out by the workers.
  *
  */
 static void circularCrossCorrelation(double *x, double *y, CONTROLINFO *ci) {
+   ci->result += correlateLagPart(x, y, ci->numbSamples, ci->rxyIndex, 0, ci->numbSamples);
+}
+
+/**
+ *  \brief Calculate one part of the sum of a lag, x and y are the samples of the part, y already shifted
+ *  (libclestats kernel, the part being taken as a whole signal at lag 0).
+ *
+ *  Operation carried out by the workers.
+ *
+ */
+static void partialCorrelation(double *x, double *y, CONTROLINFO *ci, size_t length) {
+   ci->result += correlateLagPart(x, y, length, 0, 0, length);
+}
 
-   size_t i;
-   size_t n = ci->numbSamples;
-   size_t temp = ci->rxyIndex; 
+/**
+ *  \brief circularCrossCorrelation for signals stored as float, accumulated in double.
+ *
+ *  Operation carried out by the workers.
+ *
+ */
+static void circularCrossCorrelationSingle(float *x, float *y, CONTROLINFO *ci) {
+   ci->result += correlateLagPartSingle(x, y, ci->numbSamples, ci->rxyIndex, 0, ci->numbSamples);
+}
 
-   for(i = 0; i < n; i++){
-      ci->result += x[i] * y[(temp+i)%n];
-   }
+/**
+ *  \brief partialCorrelation for signals stored as float, accumulated in double.
+ *
+ *  Operation carried out by the workers.
+ *
+ */
+static void partialCorrelationSingle(float *x, float *y, CONTROLINFO *ci, size_t length) {
+   ci->result += correlateLagPartSingle(x, y, length, 0, 0, length);
+}
+
+/**
+ *  \brief Pairwise (tree) sum of the parts of a lag, always in the same order.
+ *
+ *  Operation carried out by the dispatcher.
+ *
+ */
+static double pairwiseSum(double *parts, size_t numbParts) {
+  if (numbParts == 1)
+    return parts[0];
+  return pairwiseSum(parts, numbParts / 2) + pairwiseSum(parts + numbParts / 2, numbParts - numbParts / 2);
+}
+
+/**
+ *  \brief Save one part of the sum of a lag, the lag is reduced once all its parts arrived.
+ *
+ *  Operation carried out by the dispatcher.
+ *
+ *  \param *ci pointer to the shared data structure
+ *  \param worker rank of the process which computed it
+ *
+ */
+static void saveLeafResult(CONTROLINFO *ci, int worker) {
+  FILEINFO *fi = &filesManager[ci->filePosition];
+  uint64_t lagsDone = 0;
+
+  if (fi->partials[ci->rxyIndex] == NULL)
+    fi->partials[ci->rxyIndex] = (double *) malloc(sizeof(double) * fi->numbLeaves);
+  fi->partials[ci->rxyIndex][ci->leaf] = ci->result;
+  if (++fi->leavesDone[ci->rxyIndex] == fi->numbLeaves) {
+    storeLag(fi, ci->rxyIndex, pairwiseSum(fi->partials[ci->rxyIndex], fi->numbLeaves));
+    free(fi->partials[ci->rxyIndex]);
+    fi->partials[ci->rxyIndex] = NULL;
+    lagsDone = 1;
+  }
+  countWork(worker, ci->filePosition, lagsDone, 2 * sizeof(double) * (ci->leafSize < fi->numbSamples ? ci->leafSize : fi->numbSamples), 0);
+  ci->result = 0;
 }
 
 /**
  *  \brief Print all the results stored in result data storage.
  *
+ *  The lags were checked as their results arrived (see storeLag), those found in the result cache when the file was
+ *  started. The files which could not be read have no results. The rxy computed are kept in the result cache if all
+ *  of their lags are right.
+ *
  *  Operation carried out by the dispatcher.
  *
+ *  \return false if a file could not be read or not all of its lags were checked
  */
-static void printResults(unsigned int numbFiles, char** filesToProcess){
+static bool printResults(unsigned int numbFiles, char** filesToProcess){
   
-  size_t i, x, numbErrors;
+  size_t i;
+  bool ok = true;
 
   for (i = 0; i < numbFiles; i++){
-    numbErrors = 0;
-    for (x = 0; x < filesManager[i].numbSamples; x++){
-      if (filesManager[i].expected[x] != filesManager[i].result[x]) {
-          numbErrors++;
-      }
+    if (filesManager[i].failed){
+      printf("File %s could not be read.\n", filesToProcess[i]);
+      ok = false;
+      continue;
     }
-    if(numbErrors==0)
-      printf("File %s was calculated correctly.\n", filesToProcess[i]);
-    else 
-      printf("File %s had %lu errors in total.\n", filesToProcess[i], numbErrors);
-
+    if (filesManager[i].errors.numbChecked != filesManager[i].numbSamples){        /* some lags never came back */
+      printf("File %s was not computed completely, %lu of its %lu lags were checked.\n", filesToProcess[i],
+             filesManager[i].errors.numbChecked, filesManager[i].numbSamples);
+      ok = false;
+    } else {
+      if (!filesManager[i].cached && filesManager[i].errors.numbErrors == 0 && resultCacheActive())   /* only right ones */
+        cacheStore(filesManager[i].cacheKey, filesManager[i].result, sizeof(double) * filesManager[i].numbSamples);
+      if(filesManager[i].errors.numbErrors==0)
+        printf("File %s was calculated correctly.\n", filesToProcess[i]);
+      else 
+        printf("File %s had %lu errors in total.\n", filesToProcess[i], filesManager[i].errors.numbErrors);
+    }
+    if (errorReport)
+      printErrors(&filesManager[i].errors, filesManager[i].sampleError);
 
     free(filesManager[i].result);
     free(filesManager[i].expected);
+    free(filesManager[i].partials);
+    free(filesManager[i].leavesDone);
   }
   
   free(filesManager);
+  return ok;
+}
+
+/**
+ *  \brief Error a lag of a file is allowed on top of the tolerances of the run (see resultCheck.h).
+ *
+ *  When the sum of each lag was split, the result is not added in the same order as the expected one, so it is
+ *  compared with the error bound of a sum of n terms, 2 * n * eps * sqrt(sum x^2 * sum y^2). The same holds for the
+ *  mirrored half of an autocorrelation. Samples stored as float or int16 add the error bound of their type.
+ *
+ *  Operation carried out by the dispatcher.
+ *
+ */
+static double lagBound(FILEINFO *fi, size_t lag) {
+  return fi->sampleError + (fi->numbLeaves > 1 || (fi->autocorrelation && lag > fi->numbSamples / 2)
+                            ? 2 * fi->numbSamples * DBL_EPSILON * fi->norm : 0);
+}
+
+/**
+ *  \brief Store the result of a lag, and of its mirror lag n - lag when the file is an autocorrelation, and check
+ *  them against the expected ones as they arrive.
+ *
+ *  Operation carried out by the dispatcher.
+ *
+ */
+static void storeLag(FILEINFO *fi, size_t lag, double value) {
+  fi->result[lag] = value;
+  checkLag(&fi->errors, lag, fi->expected[lag], value, lagBound(fi, lag));
+  if (fi->autocorrelation && lag > 0 && fi->numbSamples - lag != lag) {             /* r[n-k] = r[k] */
+    fi->result[fi->numbSamples - lag] = value;
+    checkLag(&fi->errors, fi->numbSamples - lag, fi->expected[fi->numbSamples - lag], value,
+             lagBound(fi, fi->numbSamples - lag));
+  }
 }
 
 /**
@@ -254,10 +798,12 @@ static void printResults(unsigned int numbFiles, char** filesToProcess){
  *  Operation carried out by the dispatcher.
  *
  *  \param *ci pointer to the shared data structure
+ *  \param worker rank of the process which computed it
  *
  */
-static void savePartialResults(CONTROLINFO *ci) {
-  filesManager[ci->filePosition].result[ci->rxyIndex] = ci->result;
+static void savePartialResults(CONTROLINFO *ci, int worker) {
+  countWork(worker, ci->filePosition, 1, 2 * sizeof(double) * filesManager[ci->filePosition].numbSamples, 0);
+  storeLag(&filesManager[ci->filePosition], ci->rxyIndex, ci->result);
   filesManager[ci->filePosition].rxyIndex++;
   ci->rxyIndex = filesManager[ci->filePosition].rxyIndex;
   ci->result = 0;
@@ -266,3 +812,1046 @@ static void savePartialResults(CONTROLINFO *ci) {
     ci->processing = false;
   }
 }
+
+/**
+ *  \brief Print the CPUs each process is bound to and their NUMA nodes, as given by the job launcher (mpirun
+ *  --bind-to), which is kept: the threads of a process are created within its binding.
+ *
+ *  \param rank    rank of the process
+ *  \param totProc number of processes
+ */
+static void reportBinding(int rank, int totProc)
+{
+  char text[BINDING_TEXT] = {0}, *all = NULL;
+
+  describeBinding(text, sizeof(text));
+  if (rank == 0)
+    all = (char *) malloc(BINDING_TEXT * totProc);
+  MPI_Gather (text, BINDING_TEXT, MPI_CHAR, all, BINDING_TEXT, MPI_CHAR, 0, MPI_COMM_WORLD);
+  if (rank == 0){
+    for (int r = 0; r < totProc; r++)
+      fprintf(stderr, "process %d: %s\n", r, all + BINDING_TEXT * r);
+    free(all);
+  }
+}
+
+/**
+ *  \brief Read the hardware counters of the process before a unit of work, whose computation starts in the timeline.
+ *
+ *  \param *begin where they are stored
+ */
+static void beginUnit(PERFCOUNTS *begin)
+{
+  unitStart = traceClock();
+  readCounters(counterGroup, begin);
+}
+
+/**
+ *  \brief Add a unit of work of a kernel to the counters of the process, and its computation to the timeline.
+ *
+ *  \param kernel number of the kernel
+ *  \param *begin counters read before the unit
+ *  \param bytes  bytes of the signals the unit went through
+ */
+static void endUnit(unsigned int kernel, const PERFCOUNTS *begin, uint64_t bytes)
+{
+  PERFCOUNTS unit = {0};
+
+  countUnit(counterGroup, begin, &unit, bytes);
+  saveCounters(0, kernel, &unit);
+  traceSpan(0, TRACE_COMPUTE, unitStart);
+}
+
+/**
+ *  \brief Gather the hardware counters of every process at the dispatcher, a row per process.
+ *
+ *  A process where they could not be counted sends zeros, the dispatcher throws them away if it could not.
+ *
+ *  \param rank    rank of the process
+ *  \param totProc number of processes
+ */
+static void gatherCounters(int rank, int totProc)
+{
+  PERFCOUNTS *table = counterTable(), none[NUMB_KERNELS] = {{0}}, *all = table;
+  int size = sizeof(PERFCOUNTS) * NUMB_KERNELS;
+
+  closeCounters(counterGroup);
+  if (rank == 0 && table == NULL)
+    all = (PERFCOUNTS *) malloc(size * totProc);
+  MPI_Gather (rank == 0 ? MPI_IN_PLACE : table != NULL ? (void *) table : (void *) none, size, MPI_BYTE,
+              all, size, MPI_BYTE, 0, MPI_COMM_WORLD);
+  if (rank == 0 && table == NULL)
+    free(all);
+}
+
+/**
+ *  \brief Align the clock of the timeline of every process on the one of the dispatcher.
+ *
+ *  Each worker asks the dispatcher for its clock TRACE_PINGS times, the round trip being the shortest one giving the
+ *  offset: the clock of the dispatcher was read half way through it.
+ *
+ *  \param rank    rank of the process
+ *  \param totProc number of processes
+ */
+static void alignTrace(int rank, int totProc)
+{
+  double sent, received, remote, shortest = -1, offset = 0;
+
+  for (int r = 1; r < totProc; r++)
+    for (int k = 0; k < TRACE_PINGS; k++)
+      if (rank == 0){
+        MPI_Recv (&remote, 1, MPI_DOUBLE, r, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        remote = traceClock();
+        MPI_Send (&remote, 1, MPI_DOUBLE, r, 0, MPI_COMM_WORLD);
+      } else if (rank == r){
+        sent = traceClock();
+        MPI_Send (&sent, 1, MPI_DOUBLE, 0, 0, MPI_COMM_WORLD);
+        MPI_Recv (&remote, 1, MPI_DOUBLE, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        received = traceClock();
+        if (shortest < 0 || received - sent < shortest){
+          shortest = received - sent;
+          offset = remote - (sent + received) / 2;
+        }
+      }
+  setTraceOffset(offset);
+}
+
+/**
+ *  \brief Gather the timelines of every process at the dispatcher, which writes them as a single Chrome trace.
+ *
+ *  \param rank    rank of the process
+ *  \param totProc number of processes
+ *  \param *name   name of the file
+ */
+static void writeTimeline(int rank, int totProc, char *name)
+{
+  TRACEEVENT *events, *all = NULL;
+  size_t numbEvents = collectTrace(rank, &events);
+  int size = numbEvents * sizeof(TRACEEVENT), *counts = NULL, *displs = NULL;
+
+  if (rank == 0){
+    counts = (int *) malloc(sizeof(int) * totProc);
+    displs = (int *) malloc(sizeof(int) * totProc);
+  }
+  MPI_Gather (&size, 1, MPI_INT, counts, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  if (rank == 0){
+    for (int r = 0; r < totProc; r++)
+      displs[r] = r == 0 ? 0 : displs[r-1] + counts[r-1];
+    all = (TRACEEVENT *) malloc(displs[totProc-1] + counts[totProc-1] + 1);
+  }
+  MPI_Gatherv (events, size, MPI_BYTE, all, counts, displs, MPI_BYTE, 0, MPI_COMM_WORLD);
+  if (rank == 0){
+    if (!writeTrace(name, all, (displs[totProc-1] + counts[totProc-1]) / sizeof(TRACEEVENT)))
+      perror("error on writing the timeline");
+    free(all);
+    free(counts);
+    free(displs);
+  }
+  free(events);
+  stopTrace();
+}
+
+/**
+ *  \brief Send a message, recording it in the timeline from the time it is posted to the time it completes.
+ *
+ *  \param *buffer data
+ *  \param count   number of elements
+ *  \param type    type of the elements
+ *  \param dest    rank of the receiver
+ */
+static void sendTraced(void *buffer, int count, MPI_Datatype type, int dest)
+{
+  double t = traceClock();
+
+  MPI_Send (buffer, count, type, dest, 0, MPI_COMM_WORLD);
+  traceSpan(0, TRACE_SEND, t);
+}
+
+/**
+ *  \brief Receive a message, recording it in the timeline from the time it is posted to the time it completes.
+ *
+ *  \param *buffer where the data is stored
+ *  \param count   number of elements
+ *  \param type    type of the elements
+ *  \param source  rank of the sender
+ */
+static void recvTraced(void *buffer, int count, MPI_Datatype type, int source)
+{
+  double t = traceClock();
+
+  MPI_Recv (buffer, count, type, source, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+  traceSpan(0, TRACE_RECV, t);
+}
+
+/**
+ *  \brief Read the size of every file, the files being started largest first (the work of a file grows with the
+ *  square of its size).
+ *
+ *  Operation carried out by the dispatcher.
+ *
+ */
+static void scheduleFiles(void) {
+  uint64_t *cost = (uint64_t *) calloc(numbFiles > 0 ? numbFiles : 1, sizeof(uint64_t));
+  SIGNALRECORD r;
+  int fd;
+
+  for (size_t i = 0; i < numbFiles; i++)
+    if ((fd = open (filePaths[i], O_RDONLY)) >= 0) {
+      if (readSignalHeader(fd, fileRecords[i], &r, NULL))
+        cost[i] = (uint64_t) r.numbSamples * r.numbSamples;
+      close(fd);
+    }
+  schedule = largestFirst(cost, numbFiles);
+  free(cost);
+  numbActive = nextActive = nextStart = 0;
+}
+
+/**
+ *  \brief Key of the rxy of a file in the result cache: content hash of its signals and the parameters the result
+ *  depends on.
+ *
+ *  Operation carried out by the dispatcher.
+ *
+ */
+static uint64_t resultKey(FILEINFO *fi, size_t leafSize) {
+  uint64_t parameters[3] = {fi->numbSamples, fi->autocorrelation, leafSize};
+  HASHSTATE h;
+
+  hashStart(&h, 0);                                                     /* floats and doubles are keyed apart */
+  if (singleStorage) {
+    hashUpdate(&h, fi->xSingle, sizeof(float) * fi->numbSamples);
+    if (!fi->autocorrelation)
+      hashUpdate(&h, fi->ySingle, sizeof(float) * fi->numbSamples);
+  } else {
+    hashUpdate(&h, fi->x, sizeof(double) * fi->numbSamples);
+    if (!fi->autocorrelation)
+      hashUpdate(&h, fi->y, sizeof(double) * fi->numbSamples);
+  }
+  return hashBytes(parameters, sizeof(parameters), hashDigest(&h));
+}
+
+/**
+ *  \brief Read a file, i.e. both signals and result, to be started.
+ *
+ *  Operation carried out by the dispatcher.
+ *
+ *  With the result cache open, the rxy of a file found there is taken as is, no lag being sent.
+ *
+ *  \param fileId file to start
+ *  \param leafSize number of samples of each part of a lag, 0 to not split
+ *
+ *  \return false if the file could not be opened or read, a checksum being wrong
+ */
+static bool startFile(size_t fileId, size_t leafSize) {
+  FILEINFO *fi = &filesManager[fileId];
+  SIGNALRECORD r;
+  size_t samples;
+  int fd;
+
+  if ((fd = open (filePaths[fileId], O_RDONLY)) < 0)
+    return false;
+  if (!readSignalHeader(fd, fileRecords[fileId], &r, NULL)) {
+    close(fd);
+    return false;
+  }
+  samples = r.numbSamples;
+  if (singleStorage) {                                        /* converted as they are read, never as double */
+    fi->xSingle = allocSingles(samples);
+    fi->ySingle = allocSingles(samples);
+  } else {
+    fi->x = allocSamples(samples);
+    fi->y = allocSamples(samples);
+  }
+  fi->result = (double *) malloc(sizeof(double) * samples);
+  fi->expected = (double *) malloc(sizeof(double) * samples);
+  if (!(singleStorage ? readSignalSingles(fd, &r, 0, 0, samples, fi->xSingle)
+                        && readSignalSingles(fd, &r, 1, 0, samples, fi->ySingle)
+                      : readSignalSamples(fd, &r, 0, 0, samples, fi->x)
+                        && readSignalSamples(fd, &r, 1, 0, samples, fi->y))
+      || !readSignalSamples(fd, &r, 2, 0, samples, fi->expected)) {
+    close(fd);
+    free(fi->x); free(fi->y); free(fi->xSingle); free(fi->ySingle); free(fi->result); free(fi->expected);
+    fi->x = fi->y = fi->result = fi->expected = NULL;
+    fi->xSingle = fi->ySingle = NULL;
+    return false;
+  }
+  if (close (fd) != 0)
+    return false;
+  fi->rxyIndex = 0;
+  fi->filePosition = fileId;
+  fi->numbSamples = samples;
+
+  /* an autocorrelation is symmetric, r[n-k] = r[k], and the workers only need x */
+  if (singleStorage) {
+    fi->autocorrelation = forceAutocorrelation || memcmp(fi->xSingle, fi->ySingle, sizeof(float) * samples) == 0;
+    if (forceAutocorrelation)
+      memcpy(fi->ySingle, fi->xSingle, sizeof(float) * samples);
+  } else {
+    fi->autocorrelation = forceAutocorrelation || memcmp(fi->x, fi->y, sizeof(double) * samples) == 0;
+    if (forceAutocorrelation)
+      memcpy(fi->y, fi->x, sizeof(double) * samples);
+  }
+
+  double xx = 0, yy = 0;                                                /* bounds of the rounding errors */
+  for (size_t j = 0; j < samples; j++) {
+    double xj = singleStorage ? fi->xSingle[j] : fi->x[j], yj = singleStorage ? fi->ySingle[j] : fi->y[j];
+    xx += xj * xj;
+    yy += yj * yj;
+  }
+  fi->norm = sqrt(xx * yy);
+  fi->sampleError = sampleErrorBound(&r, xx, yy);
+  if (singleStorage && r.sampleType != SAMPLE_FLOAT)                    /* rounded to float when they were read */
+    fi->sampleError += singleErrorBound(xx, yy);
+
+  fi->numbLeaves = leafSize == 0 ? 1 : (samples + leafSize - 1) / leafSize;
+  fi->numbTasks = (fi->autocorrelation ? samples / 2 + 1 : samples) * fi->numbLeaves;
+  fi->nextTask = 0;
+  if (resultCacheActive()) {                                            /* rxy of the same signals */
+    fi->cacheKey = resultKey(fi, leafSize);
+    if ((fi->cached = cacheLookup(fi->cacheKey, fi->result, sizeof(double) * samples))) {
+      fi->numbTasks = 0;                                                /* no lag to send */
+      for (size_t lag = 0; lag < samples; lag++)
+        checkLag(&fi->errors, lag, fi->expected[lag], fi->result[lag], lagBound(fi, lag));
+      return true;
+    }
+  }
+  nameMetricFile(fileId, metricNames[fileId], fi->numbTasks / fi->numbLeaves);
+  if (leafSize > 0) {
+    fi->partials = (double **) calloc(samples, sizeof(double *));
+    fi->leavesDone = (size_t *) calloc(samples, sizeof(size_t));
+  }
+  return true;
+}
+
+/**
+ *  \brief Choose the file of the next lag to send: the active files are served in round robin and, once all the
+ *  lags of one were sent, its signals are released and the largest file not started yet takes its place. A file
+ *  which can not be read is marked as failed and left out, the others going on.
+ *
+ *  Operation carried out by the dispatcher.
+ *
+ *  \param leafSize number of samples of each part of a lag, 0 to not split
+ *  \param *fileId where the file is stored
+ *
+ *  \return 1 if there is a lag to send, 0 if all were sent
+ */
+static int nextScheduledFile(size_t leafSize, size_t *fileId) {
+  while (true) {
+    while (numbActive < ACTIVE_FILES && nextStart < numbFiles) {            /* start the largest pending ones */
+      size_t id = schedule[nextStart++];
+      if (startFile(id, leafSize))
+        activeFiles[numbActive++] = id;
+      else {
+        fprintf(stderr, "error on reading %s\n", metricNames[id]);
+        filesManager[id].failed = true;
+      }
+    }
+    setQueueDepth(numbActive + numbFiles - nextStart);
+    if (numbActive == 0) {
+      free(schedule);
+      return 0;
+    }
+    nextActive %= numbActive;
+    FILEINFO *fi = &filesManager[activeFiles[nextActive]];
+    if (fi->nextTask < fi->numbTasks) {
+      *fileId = activeFiles[nextActive++];
+      return 1;
+    }
+    free(fi->x);
+    free(fi->y);
+    free(fi->xSingle);
+    free(fi->ySingle);
+    activeFiles[nextActive] = activeFiles[--numbActive];
+  }
+}
+
+/**
+ *  \brief Read both signals of a file, keeping only the ones not seen before.
+ *
+ *  Operation carried out by the dispatcher.
+ *
+ *  \param fileName name of the file
+ *  \param fileId index of the file in the command line
+ *  \param isTemplate true if the signals of this file are templates
+ *
+ *  \return false if the file could not be read
+ */
+static bool loadSignalsOfFile(char *fileName, size_t fileId, bool isTemplate) {
+  int fd;
+  size_t samples;
+  size_t c, s;
+  SIGNALRECORD r;
+
+  if ((fd = open (filePaths[fileId], O_RDONLY)) < 0) {
+    perror ("error on file opening for reading");
+    return false;
+  }
+  if (!readSignalHeader(fd, fileRecords[fileId], &r, NULL)) {
+    fprintf(stderr, "error on reading the size of the signals in %s\n", fileName);
+    close(fd);
+    return false;
+  }
+  samples = r.numbSamples;
+
+  for (c = 0; c < 2; c++) {
+    double *data = allocSamples(samples);
+    if (data == NULL || !readSignalSamples(fd, &r, c, 0, samples, data)) {
+      fprintf(stderr, "error on reading the signals in %s\n", fileName);
+      free(data);
+      close(fd);
+      return false;
+    }
+    for (s = 0; s < numbSignals; s++)                                         /* the same signal is only correlated once */
+      if (signals[s].numbSamples == (size_t) samples && signals[s].isTemplate == isTemplate
+          && memcmp(signals[s].samples, data, sizeof(double) * samples) == 0)
+        break;
+    if (s < numbSignals) {
+      free(data);
+      continue;
+    }
+    signals[numbSignals].isTemplate = isTemplate;
+    signals[numbSignals].filePosition = fileId;
+    signals[numbSignals].component = c == 0 ? 'x' : 'y';
+    signals[numbSignals].numbSamples = samples;
+    signals[numbSignals].samples = data;
+    numbSignals++;
+  }
+
+  close(fd);
+  return true;
+}
+
+/**
+ *  \brief Correlate every requested pair of distinct signals, computing each spectrum only once.
+ *
+ *  The dispatcher loads and broadcasts the signals, the spectra are computed by blocks of signals in the workers
+ *  and gathered in every process, then the pairs are correlated by the workers in a round robin fashion and their
+ *  peaks (and full rxy vectors, if requested) are sent to the dispatcher.
+ *
+ *  Operation carried out by all the processes.
+ *
+ *  \param rank rank of the process
+ *  \param nProc group size
+ *  \param numbTemplates number of files, at the start of the list, whose signals are templates (0 for all pairs)
+ *  \param outputName name of the file where the full rxy vectors are written, NULL for only the peaks
+ *  \param fileNames names of the files to process
+ */
+static void batchCorrelation(int rank, int nProc, unsigned int numbTemplates, char *outputName, char **fileNames) {
+  size_t i, j, total;
+  unsigned long *meta;                                           /* size and template flag of each signal */
+  double *samples;                                               /* all the signals, one after the other */
+  double complex *spectra, *work = NULL;                         /* all the spectra and scratch memory */
+  double *rxy = NULL;                                            /* correlation of a pair */
+  size_t size = 0, *offset;                                      /* size of the scratch memory and offsets of each signal */
+  int nWorkers = nProc > 1 ? nProc - 1 : 1,                      /* rank 0 only computes if it is alone */
+  worker = nProc > 1 ? rank - 1 : 0,
+  *counts, *displs;
+  FILE *out = NULL;
+  unsigned long numb;
+  PERFCOUNTS begin;
+
+  /* load the signals */
+  if (rank == 0) {
+    signals = (SIGNALINFO *) calloc(2 * numbFiles, sizeof(SIGNALINFO));
+    numbSignals = 0;
+    for (i = 0; i < numbFiles; i++)
+      if (!loadSignalsOfFile(fileNames[i], i, i < numbTemplates))
+        MPI_Abort (MPI_COMM_WORLD, EXIT_FAILURE);
+    if (outputName != NULL && (out = fopen (outputName, "wb")) == NULL) {
+      perror ("error on file opening for writing");
+      MPI_Abort (MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+  }
+  numb = numbSignals;
+  MPI_Bcast (&numb, 1, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+  numbSignals = numb;
+  meta = (unsigned long *) malloc(sizeof(unsigned long) * 2 * numbSignals);
+  if (rank == 0)
+    for (i = 0; i < numbSignals; i++) {
+      meta[2*i] = signals[i].numbSamples;
+      meta[2*i+1] = signals[i].isTemplate;
+    }
+  MPI_Bcast (meta, 2 * numbSignals, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+
+  offset = (size_t *) malloc(sizeof(size_t) * (numbSignals + 1));
+  for (i = 0, offset[0] = 0; i < numbSignals; i++)
+    offset[i+1] = offset[i] + meta[2*i];
+  total = offset[numbSignals];
+  samples = (double *) malloc(sizeof(double) * total);
+  spectra = (double complex *) malloc(sizeof(double complex) * total);
+  if (rank == 0)
+    for (i = 0; i < numbSignals; i++) {
+      memcpy(samples + offset[i], signals[i].samples, sizeof(double) * signals[i].numbSamples);
+      free(signals[i].samples);
+    }
+  MPI_Bcast (samples, total, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+  if (rank != 0)
+    signals = (SIGNALINFO *) calloc(numbSignals, sizeof(SIGNALINFO));
+  for (i = 0; i < numbSignals; i++) {
+    signals[i].numbSamples = meta[2*i];
+    signals[i].isTemplate = meta[2*i+1];
+    signals[i].samples = samples + offset[i];
+    signals[i].spectrum = spectra + offset[i];
+  }
+
+  /* list the pairs, the same way in every process */
+  pairs = (PAIRINFO *) malloc(sizeof(PAIRINFO) * (numbSignals * numbSignals / 2 + 1));
+  numbPairs = numbSkipped = 0;
+  for (i = 0; i < numbSignals; i++)
+    for (j = i + 1; j < numbSignals; j++) {
+      if (numbTemplates > 0 && signals[i].isTemplate == signals[j].isTemplate)
+        continue;
+      if (signals[i].numbSamples != signals[j].numbSamples) {
+        numbSkipped++;
+        continue;
+      }
+      pairs[numbPairs].first = i;                                /* templates are loaded first */
+      pairs[numbPairs].second = j;
+      pairs[numbPairs].numbSamples = signals[i].numbSamples;
+      numbPairs++;
+    }
+
+  /* compute the spectra, a block of signals per worker, and gather them in every process */
+  counts = (int *) calloc(nProc, sizeof(int));
+  displs = (int *) calloc(nProc, sizeof(int));
+  for (i = 0; i < (size_t) nWorkers; i++) {
+    size_t first = i * numbSignals / nWorkers, last = (i + 1) * numbSignals / nWorkers;
+    counts[nProc > 1 ? i + 1 : 0] = 2 * (offset[last] - offset[first]);
+    displs[nProc > 1 ? i + 1 : 0] = 2 * offset[first];
+  }
+  if (nProc == 1 || rank != 0)
+    for (i = worker * numbSignals / nWorkers; i < (worker + 1) * numbSignals / nWorkers; i++) {
+      beginUnit(&begin);
+      if (!fftRealSpectrum(signals[i].samples, signals[i].numbSamples, signals[i].spectrum)) {
+        perror ("error on computing the spectrum");
+        MPI_Abort (MPI_COMM_WORLD, EXIT_FAILURE);
+      }
+      endUnit(KERNEL_SPECTRUM, &begin, sizeof(double) * signals[i].numbSamples);
+    }
+  MPI_Allgatherv (MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, spectra, counts, displs, MPI_DOUBLE, MPI_COMM_WORLD);
+
+  /* correlate the pairs, in a round robin fashion */
+  for (i = 0; i < numbPairs; i++) {
+    int owner = i % nWorkers;
+    PAIRINFO *pair = &pairs[i];
+
+    if (pair->numbSamples > size) {
+      size = pair->numbSamples;
+      rxy = (double *) realloc(rxy, sizeof(double) * size);
+      work = (double complex *) realloc(work, sizeof(double complex) * size);
+    }
+    if ((nProc == 1 || rank == owner + 1)) {
+      beginUnit(&begin);
+      if (!fftCircularCorrelation(signals[pair->first].spectrum, signals[pair->second].spectrum, pair->numbSamples, rxy, work)) {
+        perror ("error on correlating a pair");
+        MPI_Abort (MPI_COMM_WORLD, EXIT_FAILURE);
+      }
+      endUnit(KERNEL_PAIR, &begin, 2 * sizeof(double complex) * pair->numbSamples);
+      pair->peakLag = 0;
+      for (j = 1; j < pair->numbSamples; j++)
+        if (rxy[j] > rxy[pair->peakLag])
+          pair->peakLag = j;
+      pair->peakValue = rxy[pair->peakLag];
+      if (nProc > 1) {
+        MPI_Send (pair, sizeof (PAIRINFO), MPI_BYTE, 0, 0, MPI_COMM_WORLD);
+        if (outputName != NULL)
+          MPI_Send (rxy, pair->numbSamples, MPI_DOUBLE, 0, 0, MPI_COMM_WORLD);
+      }
+    }
+    if (rank == 0) {
+      if (nProc > 1) {
+        MPI_Recv (pair, sizeof (PAIRINFO), MPI_BYTE, owner + 1, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        if (outputName != NULL)
+          MPI_Recv (rxy, pair->numbSamples, MPI_DOUBLE, owner + 1, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+      }
+      countWork(nProc > 1 ? owner + 1 : 0, SIZE_MAX, 0, 2 * sizeof(double complex) * pair->numbSamples, 0);   /* no file */
+      if (out != NULL) {
+        int header[3] = { pair->first, pair->second, pair->numbSamples };
+        fwrite(header, sizeof(int), 3, out);
+        fwrite(rxy, sizeof(double), pair->numbSamples, out);
+      }
+    }
+  }
+
+  /* print the peaks */
+  if (rank == 0) {
+    printf("\nFinal report\n");
+    for (i = 0; i < numbPairs; i++) {
+      SIGNALINFO *a = &signals[pairs[i].first], *b = &signals[pairs[i].second];
+      printf("Signals %s:%c and %s:%c have their peak at lag %lu with value %f.\n",
+             fileNames[a->filePosition], a->component, fileNames[b->filePosition], b->component,
+             pairs[i].peakLag, pairs[i].peakValue);
+    }
+    if (numbSkipped > 0)
+      printf("%lu pairs were skipped because the signals have different sizes.\n", numbSkipped);
+    if (out != NULL)
+      fclose(out);
+  }
+
+  free(rxy); free(work);
+  free(counts); free(displs);
+  free(samples); free(spectra); free(offset); free(meta);
+  free(signals); free(pairs);
+}
+
+/**
+ *  \brief Calculate the circular cross correlation for a block of consecutive lags (libclestats kernel).
+ *
+ *  The samples are added in the same order as in circularCrossCorrelation, without the modulo.
+ *
+ *  Operation carried out by the workers.
+ *
+ */
+static void lagRangeCorrelation(double *x, double *y, CONTROLINFO *ci, double *values) {
+   correlateLags(x, y, ci->numbSamples, ci->rxyIndex, ci->numbLags, values);
+}
+
+/**
+ *  \brief lagRangeCorrelation for signals stored as float, accumulated in double.
+ *
+ *  Operation carried out by the workers.
+ *
+ */
+static void lagRangeCorrelationSingle(float *x, float *y, CONTROLINFO *ci, double *values) {
+   correlateLagsSingle(x, y, ci->numbSamples, ci->rxyIndex, ci->numbLags, values);
+}
+
+/**
+ *  \brief Insert a lag in a list of peaks sorted by decreasing value, keeping at most max of them.
+ *
+ *  Operation carried out by all the processes.
+ *
+ */
+static void insertPeak(LAGPEAK *peaks, size_t *numbPeaks, size_t max, size_t lag, double value) {
+  size_t i = *numbPeaks;
+
+  if (i == max) {
+    if (max == 0 || value <= peaks[max-1].value)
+      return;
+    i--;
+  }
+  else
+    (*numbPeaks)++;
+  for (; i > 0 && value > peaks[i-1].value; i--)
+    peaks[i] = peaks[i-1];
+  peaks[i].lag = lag;
+  peaks[i].value = value;
+}
+
+/**
+ *  \brief Error a lag of the lag query mode is allowed on top of the tolerances of the run (see resultCheck.h): the
+ *  lag windows computed with the FFT engine are allowed FFT_TOLERANCE of the expected value.
+ *
+ *  Operation carried out by all the processes.
+ *
+ */
+static double queryBound(double expected, bool fft, double sampleError) {
+  if (fft)
+    return FFT_TOLERANCE * (fabs(expected) > 1 ? fabs(expected) : 1) + sampleError;
+  return sampleError;
+}
+
+/**
+ *  \brief Compute only a window of lags, or only its highest peaks, of each file.
+ *
+ *  The dispatcher broadcasts the signals of each file and the window is split in contiguous blocks of lags, one per
+ *  worker. Narrow windows use the direct kernel, wide ones the FFT engine (computed by a single worker). Each worker
+ *  selects the peaks of its block and the dispatcher merges them, so the full result array is never allocated. The
+ *  expected values of each block are scattered with it, each worker checking its own lags and the dispatcher
+ *  merging their errors. Signals stored as float are broadcast as float, a wide window being then computed from
+ *  them by overlap-save (see signalCorrelator.h).
+ *
+ *  Operation carried out by all the processes.
+ *
+ *  \param rank rank of the process
+ *  \param nProc group size
+ *  \param firstLag first lag of the window
+ *  \param lastLag last lag of the window (clamped to the size of each file, the files which end before the first
+ *                lag being reported as such)
+ *  \param numbPeaks number of peaks to report, 0 to keep every lag of the window
+ *  \param fileNames names of the files to process
+ *
+ *  \return false, in the dispatcher, if not all the lags of the window of a file were checked
+ */
+static bool lagQuery(int rank, int nProc, size_t firstLag, size_t lastLag, unsigned int numbPeaks, char **fileNames) {
+  int nWorkers = nProc > 1 ? nProc - 1 : 1,                      /* rank 0 only computes if it is alone */
+  *counts = (int *) calloc(nProc, sizeof(int)),
+  *displs = (int *) calloc(nProc, sizeof(int));
+  LAGPEAK peaks[MAX_PEAKS], *allPeaks = (LAGPEAK *) malloc(sizeof(LAGPEAK) * MAX_PEAKS * nProc);
+  size_t i, k, numbLocal, numbMerged;
+  unsigned long samples = 0;
+  double *x = NULL, *y = NULL, *values = NULL, *result = NULL, *expected = NULL, *myExpected;
+  float *xSingle = NULL, *ySingle = NULL;
+  size_t sampleSize = singleStorage ? sizeof(float) : sizeof(double);
+  ERRORSTATS *allErrors = (ERRORSTATS *) malloc(sizeof(ERRORSTATS) * nProc);
+  double complex *X = NULL, *Y = NULL;
+  PERFCOUNTS begin;
+  bool ok = true;
+
+  if (rank == 0)
+    printf("\nFinal report\n");
+
+  for (i = 0; i < numbFiles; i++) {
+    int fd = -1;
+    SIGNALRECORD r;
+    double sampleError = 0;
+    size_t first, last, window, myFirst, myLags;
+    bool fft, autocorrelation;
+    CONTROLINFO ci = {0};
+    ERRORSTATS errors = {0};
+
+    /* read and broadcast the signals */
+    if (rank == 0) {
+      if ((fd = open (filePaths[i], O_RDONLY)) < 0 || !readSignalHeader(fd, fileRecords[i], &r, NULL)) {
+        fprintf(stderr, "error on reading %s\n", fileNames[i]);
+        MPI_Abort (MPI_COMM_WORLD, EXIT_FAILURE);
+      }
+      samples = r.numbSamples;
+    }
+    MPI_Bcast (&samples, 1, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+    if (singleStorage) {
+      xSingle = (float *) realloc(xSingle, sizeof(float) * samples);
+      ySingle = (float *) realloc(ySingle, sizeof(float) * samples);
+    } else {
+      x = (double *) realloc(x, sizeof(double) * samples);
+      y = (double *) realloc(y, sizeof(double) * samples);
+    }
+    if (firstLag >= samples) {                                   /* the window starts past the end of the signal */
+      if (rank == 0) {
+        close(fd);
+        printf("File %s has no lags %lu to %lu, its signals have %lu samples.\n", fileNames[i], firstLag, lastLag,
+               samples);
+      }
+      continue;
+    }
+    first = firstLag;
+    last = lastLag < samples ? lastLag : samples - 1;
+    window = last + 1 - first;
+    if (rank == 0) {
+      nameMetricFile(i, fileNames[i], window);
+      setQueueDepth(numbFiles - i);
+      expected = (double *) realloc(expected, sizeof(double) * (window + 1));
+      if (!(singleStorage ? readSignalSingles(fd, &r, 0, 0, samples, xSingle)
+                            && readSignalSingles(fd, &r, 1, 0, samples, ySingle)
+                          : readSignalSamples(fd, &r, 0, 0, samples, x) && readSignalSamples(fd, &r, 1, 0, samples, y))
+          || !readSignalSamples(fd, &r, 2, first, window, expected)
+          || (window < samples && !verifySignalSection(fd, &r, 2))) {             /* a part is not verified */
+        fprintf(stderr, "error on reading %s\n", fileNames[i]);
+        MPI_Abort (MPI_COMM_WORLD, EXIT_FAILURE);
+      }
+      close(fd);
+      if (r.sampleType != SAMPLE_DOUBLE || singleStorage) {
+        double xx = 0, yy = 0;
+        for (k = 0; k < samples; k++) {
+          double xk = singleStorage ? xSingle[k] : x[k], yk = singleStorage ? ySingle[k] : y[k];
+          xx += xk * xk;
+          yy += yk * yk;
+        }
+        sampleError = sampleErrorBound(&r, xx, yy);
+        if (singleStorage && r.sampleType != SAMPLE_FLOAT)              /* rounded to float when they were read */
+          sampleError += singleErrorBound(xx, yy);
+      }
+    }
+    if (singleStorage) {
+      MPI_Bcast (xSingle, samples, MPI_FLOAT, 0, MPI_COMM_WORLD);
+      MPI_Bcast (ySingle, samples, MPI_FLOAT, 0, MPI_COMM_WORLD);
+    } else {
+      MPI_Bcast (x, samples, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+      MPI_Bcast (y, samples, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    }
+    MPI_Bcast (&sampleError, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    autocorrelation = forceAutocorrelation || (singleStorage ? memcmp(xSingle, ySingle, sizeof(float) * samples)
+                                                             : memcmp(x, y, sizeof(double) * samples)) == 0;
+
+    /* split the window, wide windows are computed at once with the FFT engine */
+    fft = window > tuning.fftCrossover * log2((double) samples);
+    for (k = 0; k < (size_t) nWorkers; k++) {
+      size_t from = fft ? (k == 0 ? 0 : window) : k * window / nWorkers,      /* the FFT goes to the first worker */
+      to = fft ? window : (k + 1) * window / nWorkers;
+      counts[nProc > 1 ? k + 1 : 0] = to - from;
+      displs[nProc > 1 ? k + 1 : 0] = from;
+    }
+    myFirst = displs[rank];
+    myLags = counts[rank];
+    if (rank != 0)
+      expected = (double *) realloc(expected, sizeof(double) * (myLags + 1));
+    MPI_Scatterv (expected, counts, displs, MPI_DOUBLE, rank == 0 ? MPI_IN_PLACE : expected, myLags, MPI_DOUBLE, 0,
+                  MPI_COMM_WORLD);
+    myExpected = rank == 0 ? expected + myFirst : expected;
+
+    numbLocal = 0;
+    if (myLags > 0) {
+      ci.numbSamples = samples;
+      ci.rxyIndex = first + myFirst;
+      ci.numbLags = myLags;
+      beginUnit(&begin);
+      if (fft && singleStorage) {                                    /* overlap-save, on the floats */
+        values = (double *) realloc(values, sizeof(double) * myLags);
+        X = (double complex *) realloc(X, sizeof(double complex) * lagBlockWork(myLags));
+        if (X == NULL || !correlateLagBlockSingle(xSingle, autocorrelation ? xSingle : ySingle, samples, ci.rxyIndex,
+                                                  myLags, values, X)) {
+          perror ("error on correlating a file");
+          MPI_Abort (MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+        endUnit(KERNEL_LAG_FFT, &begin, 2 * sizeof(float) * samples);
+      } else if (fft) {
+        values = (double *) realloc(values, sizeof(double) * samples);
+        X = (double complex *) realloc(X, sizeof(double complex) * samples);
+        Y = (double complex *) realloc(Y, sizeof(double complex) * samples);
+        if (autocorrelation ? !fftRealSpectrum(x, samples, X) || !fftAutoCorrelation(X, samples, values, X)    /* one transform */
+                            : !fftRealSpectrum(x, samples, X) || !fftRealSpectrum(y, samples, Y) || !fftCircularCorrelation(X, Y, samples, values, X)) {
+          perror ("error on correlating a file");
+          MPI_Abort (MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+        endUnit(KERNEL_LAG_FFT, &begin, 2 * sizeof(double) * samples);
+        memmove(values, values + ci.rxyIndex, sizeof(double) * myLags);
+      } else {
+        values = (double *) realloc(values, sizeof(double) * myLags);
+        if (singleStorage)
+          lagRangeCorrelationSingle(xSingle, autocorrelation ? xSingle : ySingle, &ci, values);
+        else
+          lagRangeCorrelation(x, autocorrelation ? x : y, &ci, values);
+        endUnit(KERNEL_LAG_RANGE, &begin, 2 * sampleSize * samples);
+      }
+      for (k = 0; numbPeaks > 0 && k < myLags; k++)                  /* partial selection */
+        insertPeak(peaks, &numbLocal, numbPeaks, ci.rxyIndex + k, values[k]);
+      for (k = 0; k < myLags; k++)
+        checkLag(&errors, ci.rxyIndex + k, myExpected[k], values[k], queryBound(myExpected[k], fft, sampleError));
+    }
+    MPI_Gather (&errors, sizeof (ERRORSTATS), MPI_BYTE, allErrors, sizeof (ERRORSTATS), MPI_BYTE, 0, MPI_COMM_WORLD);
+
+    /* gather the window or merge the peaks in the dispatcher */
+    if (numbPeaks == 0) {
+      if (rank == 0)
+        result = (double *) realloc(result, sizeof(double) * (window + 1));
+      MPI_Gatherv (values, myLags, MPI_DOUBLE, result, counts, displs, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    } else {
+      int peakCounts[nProc], peakDispls[nProc], numb = numbLocal * sizeof(LAGPEAK);
+      MPI_Gather (&numb, 1, MPI_INT, peakCounts, 1, MPI_INT, 0, MPI_COMM_WORLD);
+      if (rank == 0)
+        for (k = 0, peakDispls[0] = 0; k < (size_t) nProc; k++)
+          peakDispls[k] = k == 0 ? 0 : peakDispls[k-1] + peakCounts[k-1];
+      MPI_Gatherv (peaks, numb, MPI_BYTE, allPeaks, peakCounts, peakDispls, MPI_BYTE, 0, MPI_COMM_WORLD);
+      if (rank == 0) {
+        numbMerged = 0;
+        for (k = 0; k < (peakDispls[nProc-1] + peakCounts[nProc-1]) / sizeof(LAGPEAK); k++)
+          insertPeak(peaks, &numbMerged, numbPeaks, allPeaks[k].lag, allPeaks[k].value);
+      }
+    }
+
+    /* report */
+    if (rank == 0) {
+      for (k = 0; k < (size_t) nProc; k++)                           /* the lags of each process */
+        if (counts[k] > 0)
+          countWork(k, i, counts[k], 2 * sampleSize * samples, 0);
+      for (k = 1; k < (size_t) nProc; k++)                           /* the errors of each process */
+        mergeErrors(&errors, &allErrors[k]);
+      if (errors.numbChecked != window) {
+        printf("File %s was not computed completely, %lu of its %lu lags were checked.\n", fileNames[i],
+               errors.numbChecked, window);
+        ok = false;
+      } else if (numbPeaks == 0) {
+        if (errors.numbErrors == 0)
+          printf("File %s was calculated correctly for lags %lu to %lu.\n", fileNames[i], first, last);
+        else
+          printf("File %s had %lu errors in lags %lu to %lu.\n", fileNames[i], errors.numbErrors, first, last);
+      } else {
+        printf("File %s, top %lu peaks in lags %lu to %lu:\n", fileNames[i], numbMerged, first, last);
+        for (k = 0; k < numbMerged; k++) {
+          double e = expected[peaks[k].lag - first];
+          printf("   lag %lu: %f%s\n", peaks[k].lag, peaks[k].value,
+                 withinTolerance(e, peaks[k].value, queryBound(e, fft, sampleError)) ? "" : " (wrong)");
+        }
+      }
+      if (errorReport)
+        printErrors(&errors, sampleError);
+    }
+  }
+
+  free(x); free(y); free(xSingle); free(ySingle); free(values); free(result); free(expected);
+  free(X); free(Y);
+  free(counts); free(displs); free(allPeaks); free(allErrors);
+  return ok;
+}
+
+/**
+ *  \brief Correlate signals that do not fit in memory, block of lags by block of lags.
+ *
+ *  The dispatcher hands blocks of lags to the workers, which read the signals from the files themselves (the
+ *  standard input is spooled by the dispatcher to a temporary file, so the processes must share the file system),
+ *  compute and verify the block and send it back, with its errors, to be written to the output file as the run
+ *  progresses.
+ *
+ *  Operation carried out by all the processes.
+ *
+ *  \param rank rank of the process
+ *  \param nProc group size
+ *  \param blockSize number of samples (and lags) of a block
+ *  \param outputDirectory directory where the rxy of each file is written
+ *  \param fileNames names of the files to process
+ *
+ *  \return false, in the dispatcher, if not all the lags of a file were checked
+ */
+static bool streamCorrelation(int rank, int nProc, size_t blockSize, char *outputDirectory, char **fileNames) {
+  char spoolName[PATH_MAX] = "";                                 /* temporary copy of the standard input */
+  STREAMINFO *streams = (STREAMINFO *) calloc(numbFiles, sizeof(STREAMINFO));
+  STREAMBLOCK block;
+  CONTROLINFO ci = {0};
+  double *values = (double *) malloc(sizeof(double) * blockSize);
+  ERRORSTATS errors;
+  unsigned int whatToDo;
+  size_t i, current = numbFiles;
+  int x, workProc;
+  PERFCOUNTS begin;
+  bool ok = true;
+
+  if (values == NULL || !initStreamBlock(&block, blockSize)) {
+    perror ("error on allocating the stream buffers");
+    MPI_Abort (MPI_COMM_WORLD, EXIT_FAILURE);
+  }
+
+  if (rank == 0) {
+    for (i = 0; i < numbFiles; i++) {
+      if (strcmp(filePaths[i], "-") == 0 && spoolName[0] == '\0') {            /* the workers can not read our stdin */
+        char buffer[STREAM_COPY];
+        size_t n;
+        int fd;
+        snprintf(spoolName, PATH_MAX, "%s/prob2XXXXXX", getenv("TMPDIR") != NULL ? getenv("TMPDIR") : "/tmp");
+        if ((fd = mkstemp(spoolName)) < 0) {
+          perror ("error on spooling the standard input");
+          MPI_Abort (MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+        while ((n = fread(buffer, 1, STREAM_COPY, stdin)) > 0)
+          if (write(fd, buffer, n) != (ssize_t) n) {
+            perror ("error on spooling the standard input");
+            MPI_Abort (MPI_COMM_WORLD, EXIT_FAILURE);
+          }
+        close(fd);
+      }
+      if (!openStream(strcmp(filePaths[i], "-") == 0 ? spoolName : filePaths[i], fileRecords[i], &streams[i])
+          || !verifySignalSection(streams[i].fd, &streams[i].record, 0)          /* the blocks are not verified */
+          || !verifySignalSection(streams[i].fd, &streams[i].record, 1)
+          || !verifySignalSection(streams[i].fd, &streams[i].record, 2)
+          || !createStreamOutput(fileNames[i], outputDirectory, &streams[i])) {
+        fprintf(stderr, "error on opening %s or its output file\n", fileNames[i]);
+        MPI_Abort (MPI_COMM_WORLD, EXIT_FAILURE);
+      }
+      nameMetricFile(i, fileNames[i], streams[i].numbSamples);
+    }
+  }
+  MPI_Bcast (spoolName, PATH_MAX, MPI_CHAR, 0, MPI_COMM_WORLD);
+
+  if (rank == 0) {
+    size_t file = 0, *order;
+    uint64_t *cost = (uint64_t *) malloc(sizeof(uint64_t) * numbFiles);
+
+    for (i = 0; i < numbFiles; i++)                              /* the largest files first */
+      cost[i] = (uint64_t) streams[i].numbSamples * streams[i].numbSamples;
+    order = largestFirst(cost, numbFiles);
+    free(cost);
+
+    while (file < numbFiles) {
+      workProc = 0;
+      setQueueDepth(numbFiles - file);
+
+      /* hand a block of lags to each worker, or compute it when alone */
+      for (x = nProc > 1 ? 1 : 0; x < nProc && file < numbFiles; x++, workProc++) {
+        STREAMINFO *s = &streams[order[file]];
+        ci.filePosition = order[file];
+        ci.numbSamples = s->numbSamples;
+        ci.rxyIndex = s->nextLag;
+        ci.numbLags = s->numbSamples - s->nextLag < blockSize ? s->numbSamples - s->nextLag : blockSize;
+        s->nextLag += ci.numbLags;
+        if (s->nextLag == s->numbSamples)
+          file++;
+
+        if (nProc == 1) {
+          beginUnit(&begin);
+          if (!correlateStreamBlock(s, &block, ci.rxyIndex, ci.numbLags, values)) {
+            perror ("error on reading a signal");
+            MPI_Abort (MPI_COMM_WORLD, EXIT_FAILURE);
+          }
+          endUnit(KERNEL_STREAM, &begin, 2 * sizeof(double) * s->numbSamples);
+          verifyStreamBlock(s, &block, ci.rxyIndex, ci.numbLags, values, &s->errors);
+          writeStreamBlock(s, ci.rxyIndex, ci.numbLags, values);
+          countWork(0, ci.filePosition, ci.numbLags, 2 * sizeof(double) * s->numbSamples, 0);
+          continue;
+        }
+        whatToDo = WORKTODO;
+        sendTraced (&whatToDo, 1, MPI_UNSIGNED, x);
+        sendTraced (&ci, sizeof (CONTROLINFO), MPI_BYTE, x);
+      }
+
+      /* receive the blocks and write them to the output files, as they are computed */
+      for (x = 1; nProc > 1 && x <= workProc; x++) {
+        recvTraced (&ci, sizeof (CONTROLINFO), MPI_BYTE, x);
+        recvTraced (&errors, sizeof (ERRORSTATS), MPI_BYTE, x);
+        recvTraced (values, ci.numbLags, MPI_DOUBLE, x);
+        mergeErrors(&streams[ci.filePosition].errors, &errors);
+        countWork(x, ci.filePosition, ci.numbLags, 2 * sizeof(double) * streams[ci.filePosition].numbSamples, 0);
+        if (!writeStreamBlock(&streams[ci.filePosition], ci.rxyIndex, ci.numbLags, values)) {
+          perror ("error on writing the output file");
+          MPI_Abort (MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+      }
+    }
+
+    /* dismiss worker processes */
+    whatToDo = NOMOREWORK;
+    for (x = 1; x < nProc; x++)
+      MPI_Send (&whatToDo, 1, MPI_UNSIGNED, x, 0, MPI_COMM_WORLD);
+    free(order);
+
+    printf("\nFinal report\n");
+    for (i = 0; i < numbFiles; i++) {
+      if (streams[i].errors.numbChecked != streams[i].numbSamples) {
+        printf("File %s was not computed completely, %lu of its %lu lags were checked.\n", fileNames[i],
+               streams[i].errors.numbChecked, streams[i].numbSamples);
+        ok = false;
+      } else if (streams[i].errors.numbErrors == 0)
+        printf("File %s was calculated correctly.\n", fileNames[i]);
+      else
+        printf("File %s had %lu errors in total.\n", fileNames[i], streams[i].errors.numbErrors);
+      if (errorReport)
+        printErrors(&streams[i].errors, streams[i].sampleError);
+      closeStream(&streams[i]);
+    }
+    if (spoolName[0] != '\0')
+      unlink(spoolName);
+
+  } else {
+    while (true) {
+      recvTraced (&whatToDo, 1, MPI_UNSIGNED, 0);
+      if (whatToDo == NOMOREWORK)
+        break;
+      recvTraced (&ci, sizeof (CONTROLINFO), MPI_BYTE, 0);
+      if (ci.filePosition != current) {                          /* open the file of the block */
+        if (current < numbFiles)
+          closeStream(&streams[current]);
+        current = ci.filePosition;
+        if (!openStream(strcmp(filePaths[current], "-") == 0 ? spoolName : filePaths[current], fileRecords[current], &streams[current])) {
+          fprintf(stderr, "error on opening %s\n", fileNames[current]);
+          MPI_Abort (MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+      }
+      beginUnit(&begin);
+      if (!correlateStreamBlock(&streams[current], &block, ci.rxyIndex, ci.numbLags, values)) {
+        perror ("error on reading a signal");
+        MPI_Abort (MPI_COMM_WORLD, EXIT_FAILURE);
+      }
+      endUnit(KERNEL_STREAM, &begin, 2 * sizeof(double) * streams[current].numbSamples);
+      memset(&errors, 0, sizeof (ERRORSTATS));
+      verifyStreamBlock(&streams[current], &block, ci.rxyIndex, ci.numbLags, values, &errors);
+      sendTraced (&ci, sizeof (CONTROLINFO), MPI_BYTE, 0);
+      sendTraced (&errors, sizeof (ERRORSTATS), MPI_BYTE, 0);
+      sendTraced (values, ci.numbLags, MPI_DOUBLE, 0);
+    }
+    if (current < numbFiles)
+      closeStream(&streams[current]);
+  }
+
+  freeStreamBlock(&block);
+  free(values);
+  free(streams);
+  return ok;
+}
@@ -0,0 +1,76 @@
+/**
+ *  \file probConst.h (interface file)
+ *
+ *  \brief Problem name: Second CLE Project - Problem 2.
+ *
+ *  Problem 2 parameters.
+ *
+ *  \author Francisco Gonçalves Tiago Lucas - June 2020
+ */
+
+#ifndef PROBCONST_H_
+#define PROBCONST_H_
+
+/* Generic parameters */
+
+/** \brief number of files whose lags are sent at the same time */
+#define  ACTIVE_FILES        4
+
+/** \brief max number of peaks of the top-k query */
+#define  MAX_PEAKS           64
+
+/** \brief lag windows wider than FFT_CROSSOVER * log2(samples) use the FFT engine instead of the direct one */
+#define  FFT_CROSSOVER       8
+
+/** \brief relative tolerance of the results computed with the FFT engine */
+#define  FFT_TOLERANCE       1e-9
+
+/** \brief number of bins of the histogram of the relative errors: exact, one per decade from 1e-16 to 1e-1, above */
+#define  ERROR_BINS          18
+
+/** \brief default number of samples (and lags) of a block in the streaming mode */
+#define  STREAM_BLOCK        65536
+
+/** \brief default number of reads outstanding of the read engine */
+#define  READ_DEPTH          32
+
+/** \brief size of a buffer of the read engine */
+#define  READ_BLOCK          (1 << 18)
+
+/** \brief size of the result cache above which the least recently used results are removed */
+#define  CACHE_LIMIT         (1ULL << 30)
+
+/** \brief size of the buffer used to spool the standard input to disk */
+#define  STREAM_COPY         65536
+
+/** \brief size of the description of the CPUs a process is bound to */
+#define  BINDING_TEXT        256
+
+/** \brief number of events of the timeline kept per process */
+#define  TRACE_EVENTS        (1 << 16)
+
+/** \brief number of round trips to the dispatcher to align the clock of a process on its clock */
+#define  TRACE_PINGS         8
+
+/** \brief seconds between two writings of the progress metrics */
+#define  METRICS_PERIOD      5
+
+/** \brief number of samples of the smallest signal the crossover of the FFT engine is calibrated on */
+#define  TUNE_MIN_SAMPLES    (1 << 10)
+
+/** \brief number of samples of the largest one, the sizes between them growing fourfold */
+#define  TUNE_MAX_SAMPLES    (1 << 16)
+
+/** \brief number of lags the direct method computes to be timed */
+#define  TUNE_LAGS           64
+
+/** \brief number of runs of each configuration of the calibration, the fastest one being kept */
+#define  TUNE_ROUNDS         3
+
+/** \brief directory of the tuning profiles, in the home directory */
+#define  TUNING_DIR          ".cle"
+
+/** \brief name of the tuning profile of the program, after the host */
+#define  TUNING_PROFILE      "prob2-mpi"
+
+#endif /* PROBCONST_H_ */
@@ -0,0 +1,264 @@
+/**
+ *  \file progressMetrics.c (implementation file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - June 2020
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "probConst.h"
+#include "progressMetrics.h"
+
+/** \brief the metrics are exported */
+static bool exporting;
+
+/** \brief name of the textfile and of its temporary copy */
+static char *textName, *tempName;
+
+/** \brief totals of the run */
+static uint64_t bytesRead, wordsCounted, queueDepth;
+
+/** \brief units of work and bytes of each worker, and units at the previous writing (for the rates) */
+static unsigned int numbWorkers;
+static uint64_t *workerUnits, *workerBytes, *lastUnits;
+
+/** \brief name, work done and work to do of each file */
+static size_t numbFiles;
+static const char **fileNames;
+static uint64_t *fileDone, *fileWork;
+
+/** \brief start of the run and time of the previous writing */
+static struct timespec origin;
+static double lastTime;
+
+/** \brief writing thread, and its end */
+static pthread_t writer;
+static bool stopping;
+static pthread_cond_t stop = PTHREAD_COND_INITIALIZER;
+
+/** \brief locking flag which warrants mutual exclusion inside the files and the writing */
+static pthread_mutex_t accessM = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ *  \brief Seconds since the start of the run.
+ *
+ *  Internal operation.
+ */
+static double elapsed(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - origin.tv_sec) + (now.tv_nsec - origin.tv_nsec) / 1e9;
+}
+
+/**
+ *  \brief Write a label value, escaped as the exposition format requires.
+ *
+ *  Internal operation.
+ */
+static void writeLabel(FILE *f, const char *value)
+{
+  for (; *value != '\0'; value++)
+    if (*value == '\\' || *value == '"')
+      fprintf(f, "\\%c", *value);
+    else if (*value == '\n')
+      fputs("\\n", f);
+    else
+      fputc(*value, f);
+}
+
+/**
+ *  \brief Write a metric header.
+ *
+ *  Internal operation.
+ */
+static void writeHeader(FILE *f, const char *metric, const char *type, const char *help)
+{
+  fprintf(f, "# HELP %s %s\n# TYPE %s %s\n", metric, help, metric, type);
+}
+
+/**
+ *  \brief Write the textfile, to its temporary copy first so that it is never read half written.
+ *
+ *  Internal operation, inside the monitor.
+ */
+static void writeMetrics(void)
+{
+  FILE *f;
+  double now = elapsed(), interval = now - lastTime;
+  uint64_t done = 0, work = 0;
+
+  if ((f = fopen(tempName, "w")) == NULL)
+    return;
+
+  writeHeader(f, "cle_bytes_total", "counter", "Bytes of input processed.");
+  fprintf(f, "cle_bytes_total %lu\n", __atomic_load_n(&bytesRead, __ATOMIC_RELAXED));
+  writeHeader(f, "cle_words_total", "counter", "Words counted.");
+  fprintf(f, "cle_words_total %lu\n", __atomic_load_n(&wordsCounted, __ATOMIC_RELAXED));
+  writeHeader(f, "cle_queue_depth", "gauge", "Documents waiting or in progress.");
+  fprintf(f, "cle_queue_depth %lu\n", __atomic_load_n(&queueDepth, __ATOMIC_RELAXED));
+
+  writeHeader(f, "cle_worker_units_total", "counter", "Units of work done by each worker.");
+  for (unsigned int w = 0; w < numbWorkers; w++)
+    fprintf(f, "cle_worker_units_total{worker=\"%u\"} %lu\n", w, __atomic_load_n(&workerUnits[w], __ATOMIC_RELAXED));
+  writeHeader(f, "cle_worker_bytes_total", "counter", "Bytes processed by each worker.");
+  for (unsigned int w = 0; w < numbWorkers; w++)
+    fprintf(f, "cle_worker_bytes_total{worker=\"%u\"} %lu\n", w, __atomic_load_n(&workerBytes[w], __ATOMIC_RELAXED));
+  writeHeader(f, "cle_worker_units_per_second", "gauge", "Units of work done by each worker per second since the previous writing.");
+  for (unsigned int w = 0; w < numbWorkers; w++){
+    uint64_t units = __atomic_load_n(&workerUnits[w], __ATOMIC_RELAXED);
+    fprintf(f, "cle_worker_units_per_second{worker=\"%u\"} %.3f\n", w, interval > 0 ? (units - lastUnits[w]) / interval : 0);
+    lastUnits[w] = units;
+  }
+
+  writeHeader(f, "cle_file_work_done", "counter", "Work done on each file, bytes of a text or lags of a signal.");
+  for (size_t i = 0; i < numbFiles; i++)
+    if (fileNames[i] != NULL){
+      fputs("cle_file_work_done{file=\"", f);
+      writeLabel(f, fileNames[i]);
+      fprintf(f, "\"} %lu\n", __atomic_load_n(&fileDone[i], __ATOMIC_RELAXED));
+    }
+  writeHeader(f, "cle_file_work", "gauge", "Work to do on each file, 0 if it is not known.");
+  for (size_t i = 0; i < numbFiles; i++)
+    if (fileNames[i] != NULL){
+      fputs("cle_file_work{file=\"", f);
+      writeLabel(f, fileNames[i]);
+      fprintf(f, "\"} %lu\n", fileWork[i]);
+      if (fileWork[i] > 0){                                              /* the progress of the known work only */
+        uint64_t d = __atomic_load_n(&fileDone[i], __ATOMIC_RELAXED);
+        done += d < fileWork[i] ? d : fileWork[i];
+        work += fileWork[i];
+      }
+    }
+
+  writeHeader(f, "cle_elapsed_seconds", "gauge", "Seconds since the start of the run.");
+  fprintf(f, "cle_elapsed_seconds %.3f\n", now);
+  writeHeader(f, "cle_progress_ratio", "gauge", "Part of the known work done.");
+  fprintf(f, "cle_progress_ratio %.6f\n", work > 0 ? (double) done / work : 0);
+  if (done > 0 && work > 0){
+    writeHeader(f, "cle_eta_seconds", "gauge", "Estimated seconds left, at the rate of the run so far.");
+    fprintf(f, "cle_eta_seconds %.3f\n", now * (work - done) / done);
+  }
+
+  lastTime = now;
+  if (fclose(f) == 0)
+    rename(tempName, textName);
+}
+
+/**
+ *  \brief Life cycle of the writing thread: the textfile is rewritten every METRICS_PERIOD seconds until the
+ *  export stops.
+ *
+ *  Internal operation.
+ */
+static void *writeMetricsPeriodically(void *arg)
+{
+  struct timespec deadline;
+
+  pthread_mutex_lock(&accessM);
+  while (!stopping){
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += METRICS_PERIOD;
+    if (pthread_cond_timedwait(&stop, &accessM, &deadline) == ETIMEDOUT)
+      writeMetrics();
+  }
+  pthread_mutex_unlock(&accessM);
+  return NULL;
+}
+
+bool startMetrics(const char *name, unsigned int workers)
+{
+  FILE *f;
+
+  textName = strdup(name);
+  tempName = (char *) malloc(strlen(name) + 5);
+  workerUnits = (uint64_t *) calloc(workers, sizeof(uint64_t));
+  workerBytes = (uint64_t *) calloc(workers, sizeof(uint64_t));
+  lastUnits = (uint64_t *) calloc(workers, sizeof(uint64_t));
+  if (textName == NULL || tempName == NULL || workerUnits == NULL || workerBytes == NULL || lastUnits == NULL)
+    return false;
+  sprintf(tempName, "%s.tmp", name);
+  if ((f = fopen(tempName, "w")) == NULL)
+    return false;
+  fclose(f);
+  numbWorkers = workers;
+  clock_gettime(CLOCK_MONOTONIC, &origin);
+  if (pthread_create(&writer, NULL, writeMetricsPeriodically, NULL) != 0)
+    return false;
+  exporting = true;
+  return true;
+}
+
+void presentMetricFiles(size_t files)
+{
+  if (!exporting)
+    return;
+  pthread_mutex_lock(&accessM);
+  fileNames = (const char **) calloc(files, sizeof(char *));
+  fileDone = (uint64_t *) calloc(files, sizeof(uint64_t));
+  fileWork = (uint64_t *) calloc(files, sizeof(uint64_t));
+  numbFiles = fileNames == NULL || fileDone == NULL || fileWork == NULL ? 0 : files;
+  pthread_mutex_unlock(&accessM);
+}
+
+void nameMetricFile(size_t file, const char *name, uint64_t numbWork)
+{
+  if (!exporting || file >= numbFiles)
+    return;
+  pthread_mutex_lock(&accessM);
+  fileNames[file] = name;
+  fileWork[file] = numbWork;
+  pthread_mutex_unlock(&accessM);
+}
+
+void countWork(unsigned int worker, size_t file, uint64_t numbWork, uint64_t bytes, uint64_t numbWords)
+{
+  if (!exporting)
+    return;
+  __atomic_add_fetch(&bytesRead, bytes, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&wordsCounted, numbWords, __ATOMIC_RELAXED);
+  if (worker < numbWorkers){
+    __atomic_add_fetch(&workerUnits[worker], 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&workerBytes[worker], bytes, __ATOMIC_RELAXED);
+  }
+  if (file < numbFiles)
+    __atomic_add_fetch(&fileDone[file], numbWork, __ATOMIC_RELAXED);
+}
+
+void setQueueDepth(uint64_t depth)
+{
+  if (exporting)
+    __atomic_store_n(&queueDepth, depth, __ATOMIC_RELAXED);
+}
+
+void stopMetrics(void)
+{
+  if (!exporting)
+    return;
+  pthread_mutex_lock(&accessM);
+  stopping = true;
+  pthread_cond_signal(&stop);
+  pthread_mutex_unlock(&accessM);
+  pthread_join(writer, NULL);
+
+  writeMetrics();
+  exporting = false;
+  free(textName);
+  free(tempName);
+  free(workerUnits);
+  free(workerBytes);
+  free(lastUnits);
+  free(fileNames);
+  free(fileDone);
+  free(fileWork);
+}
@@ -0,0 +1,175 @@
+/**
+ *  \file signalFile.h (interface file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  Reading of the signal files, both the legacy format (an int with the number of samples followed by x, y and
+ *  the expected result as doubles) and the signal container:
+ *
+ *     header, 64 bytes       magic "CLESIGNL", uint32 version, uint32 number of records, uint32 size of an entry
+ *                            of the table of contents, uint32 reserved, uint64 offset of the table of contents,
+ *                            uint64 checksum of the table of contents, zero padding
+ *     table of contents      one SIGNALRECORD per record
+ *     sections               x, y and expected of each record, each one starting at a multiple of 64 bytes
+ *
+ *  x and y are stored as double, float or int16 (times the scale of the record), the expected result is always
+ *  a double. The checksum of a section is the 64-bit FNV-1a hash of its bytes, 0 meaning not computed.
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - June 2020
+ */
+
+#ifndef SIGNALFILE_H
+#define SIGNALFILE_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "SIGNALRECORD.h"
+
+/** \brief magic number of the signal container */
+#define  SIGNAL_MAGIC        "CLESIGNL"
+
+/** \brief version of the signal container */
+#define  SIGNAL_VERSION      1
+
+/** \brief alignment of the sections of the signal container */
+#define  SIGNAL_ALIGN        64
+
+/** \brief size of the header of the signal container */
+#define  SIGNAL_HEADER       64
+
+/** \brief types of the samples of x and y */
+#define  SAMPLE_DOUBLE       0
+#define  SAMPLE_FLOAT        1
+#define  SAMPLE_INT16        2
+
+/**
+ *  \brief Read the table of contents of a signal file and one of its records.
+ *
+ *  A legacy file has a single record.
+ *
+ *  \param fd descriptor of the file
+ *  \param record index of the record
+ *  \param *r where the record is stored, may be NULL
+ *  \param *numbRecords where the number of records is stored, may be NULL
+ *
+ *  \return false if the file is not a signal file or the record does not exist
+ */
+extern bool readSignalHeader(int fd, size_t record, SIGNALRECORD *r, size_t *numbRecords);
+
+/**
+ *  \brief Verify the checksum of a section of a record, read STREAM_COPY bytes at a time.
+ *
+ *  \param fd descriptor of the file
+ *  \param *r record
+ *  \param array 0 for x, 1 for y, 2 for the expected result
+ *
+ *  \return false on a read error or a wrong checksum, true when the section has no checksum
+ */
+extern bool verifySignalSection(int fd, const SIGNALRECORD *r, int array);
+
+/**
+ *  \brief Read consecutive samples of x (0), y (1) or expected (2) of a record, converted to double.
+ *
+ *  The checksum of the section is verified when it is read whole. A part of a section is not verified: the callers
+ *  which read a section in parts verify it first with verifySignalSection.
+ *
+ *  \param fd descriptor of the file
+ *  \param *r record
+ *  \param array 0 for x, 1 for y, 2 for the expected result
+ *  \param first index of the first sample
+ *  \param count number of samples
+ *  \param *buffer where the samples are stored
+ *
+ *  \return false on a read error or a wrong checksum
+ */
+extern bool readSignalSamples(int fd, const SIGNALRECORD *r, int array, size_t first, size_t count, double *buffer);
+
+/**
+ *  \brief Read consecutive samples of x (0) or y (1) of a record, converted to float.
+ *
+ *  The checksum of the section is verified when it is read whole. A part of a section is not verified: the callers
+ *  which read a section in parts verify it first with verifySignalSection.
+ *
+ *  \param fd descriptor of the file
+ *  \param *r record
+ *  \param array 0 for x, 1 for y
+ *  \param first index of the first sample
+ *  \param count number of samples
+ *  \param *buffer where the samples are stored
+ *
+ *  \return false on a read error or a wrong checksum
+ */
+extern bool readSignalSingles(int fd, const SIGNALRECORD *r, int array, size_t first, size_t count, float *buffer);
+
+/**
+ *  \brief Allocate memory for samples, aligned to SIGNAL_ALIGN bytes.
+ *
+ *  \param count number of samples
+ *
+ *  \return pointer to the memory (to be released with free), NULL if it could not be allocated
+ */
+extern double *allocSamples(size_t count);
+
+/**
+ *  \brief Allocate memory for samples stored as float, aligned to SIGNAL_ALIGN bytes.
+ *
+ *  \param count number of samples
+ *
+ *  \return pointer to the memory (to be released with free), NULL if it could not be allocated
+ */
+extern float *allocSingles(size_t count);
+
+/**
+ *  \brief Bound of the error of a correlation caused by the type of the samples of a record.
+ *
+ *  \param *r record
+ *  \param sumX2 sum of the squares of x
+ *  \param sumY2 sum of the squares of y
+ *
+ *  \return 0 for doubles
+ */
+extern double sampleErrorBound(const SIGNALRECORD *r, double sumX2, double sumY2);
+
+/**
+ *  \brief Bound of the error of a correlation caused by rounding the samples to float.
+ *
+ *  \param sumX2 sum of the squares of x
+ *  \param sumY2 sum of the squares of y
+ *
+ *  \return bound
+ */
+extern double singleErrorBound(double sumX2, double sumY2);
+
+/**
+ *  \brief 64-bit FNV-1a hash, chained through hash (start with SIGNAL_CHECKSUM_SEED).
+ *
+ *  \param hash hash of the previous bytes
+ *  \param *data bytes
+ *  \param size number of bytes
+ *
+ *  \return hash
+ */
+extern uint64_t signalChecksum(uint64_t hash, const void *data, size_t size);
+
+/** \brief initial value of signalChecksum */
+#define  SIGNAL_CHECKSUM_SEED  14695981039346656037ULL
+
+/**
+ *  \brief Expand a list of signal files into one entry per record.
+ *
+ *  The label of a record of a container with several records is name#record, otherwise the name itself.
+ *  "-" (the standard input) is a single entry. Directories and @lists are expanded first (see fileList.h).
+ *
+ *  \param *names[] names of the files
+ *  \param numbNames number of files
+ *  \param ***paths where the array with the file of each entry is stored
+ *  \param **records where the array with the record of each entry is stored
+ *  \param ***labels where the array with the label of each entry is stored
+ *
+ *  \return number of entries
+ */
+extern size_t listSignalRecords(char *names[], size_t numbNames, char ***paths, size_t **records, char ***labels);
+
+#endif /* SIGNALFILE_H */
@@ -0,0 +1,148 @@
+/**
+ *  \file traceLog.c (implementation file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - June 2020
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "TRACEEVENT.h"
+#include "traceLog.h"
+
+/** \brief name and category of each event */
+static const char *const eventNames[] = {"fetch", "compute", "merge", "lock wait", "lock held", "MPI_Send", "MPI_Recv"};
+static const char *const eventCategories[] = {"work", "work", "work", "lock", "lock", "mpi", "mpi"};
+
+/** \brief events are recorded */
+static bool tracing;
+
+/** \brief rings of the threads, one after the other */
+static TRACEEVENT *rings;
+
+/** \brief number of rings and of events of a ring */
+static unsigned int numbRings;
+static size_t ringSize;
+
+/** \brief number of events recorded in each ring, the ring holding the last ringSize of them */
+static size_t *numbRecorded;
+
+/** \brief start of the recording */
+static struct timespec origin;
+
+/** \brief microseconds added to the times of this process */
+static double timeOffset;
+
+bool startTrace(unsigned int numbThreads, size_t numbEvents)
+{
+  rings = (TRACEEVENT *) malloc(sizeof(TRACEEVENT) * numbThreads * numbEvents);
+  numbRecorded = (size_t *) calloc(numbThreads, sizeof(size_t));
+  if (rings == NULL || numbRecorded == NULL){
+    free(rings);
+    free(numbRecorded);
+    return false;
+  }
+  numbRings = numbThreads;
+  ringSize = numbEvents;
+  clock_gettime(CLOCK_MONOTONIC, &origin);
+  tracing = true;
+  return true;
+}
+
+double traceClock(void)
+{
+  struct timespec now;
+
+  if (!tracing)
+    return 0;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - origin.tv_sec) * 1e6 + (now.tv_nsec - origin.tv_nsec) / 1e3;
+}
+
+void traceSpan(unsigned int thread, unsigned int event, double start)
+{
+  TRACEEVENT *e;
+
+  if (!tracing || thread >= numbRings)
+    return;
+  e = &rings[thread * ringSize + numbRecorded[thread] % ringSize];
+  e->start = start;
+  e->duration = traceClock() - start;
+  e->event = event;
+  e->thread = thread;
+  numbRecorded[thread]++;
+}
+
+void setTraceOffset(double offset)
+{
+  timeOffset = offset;
+}
+
+size_t collectTrace(int process, TRACEEVENT **events)
+{
+  size_t n = 0;
+
+  *events = NULL;
+  if (!tracing)
+    return 0;
+  for (unsigned int t = 0; t < numbRings; t++)
+    n += numbRecorded[t] < ringSize ? numbRecorded[t] : ringSize;
+  if (n == 0 || (*events = (TRACEEVENT *) malloc(sizeof(TRACEEVENT) * n)) == NULL)
+    return 0;
+
+  n = 0;
+  for (unsigned int t = 0; t < numbRings; t++){
+    size_t kept = numbRecorded[t] < ringSize ? numbRecorded[t] : ringSize;
+    for (size_t i = numbRecorded[t] - kept; i < numbRecorded[t]; i++){         /* from the oldest one */
+      TRACEEVENT *e = &(*events)[n++];
+      *e = rings[t * ringSize + i % ringSize];
+      e->start += timeOffset;
+      e->process = process;
+    }
+  }
+  return n;
+}
+
+bool writeTrace(const char *name, const TRACEEVENT *events, size_t numbEvents)
+{
+  FILE *f;
+  int maxProcess = 0;
+  unsigned int maxThread = 0;
+  const char *separator = "";
+
+  if ((f = fopen(name, "w")) == NULL)
+    return false;
+  fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  for (size_t i = 0; i < numbEvents; i++){
+    const TRACEEVENT *e = &events[i];
+    if (e->event >= sizeof(eventNames) / sizeof(eventNames[0]))
+      continue;
+    fprintf(f, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%u}",
+            separator, eventNames[e->event], eventCategories[e->event], e->start, e->duration, e->process, e->thread);
+    separator = ",\n";
+    maxProcess = e->process > maxProcess ? e->process : maxProcess;
+    maxThread = e->thread > maxThread ? e->thread : maxThread;
+  }
+  for (int p = 0; numbEvents > 0 && p <= maxProcess; p++){                     /* names of the tracks */
+    fprintf(f, "%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"process %d\"}}", separator, p, p);
+    separator = ",\n";
+    for (unsigned int t = 0; t <= maxThread; t++)
+      fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}", p, t, t);
+  }
+  fprintf(f, "\n]}\n");
+  return fclose(f) == 0;
+}
+
+void stopTrace(void)
+{
+  tracing = false;
+  free(rings);
+  free(numbRecorded);
+  rings = NULL;
+  numbRecorded = NULL;
+}
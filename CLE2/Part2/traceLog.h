@@ -0,0 +1,94 @@
+/**
+ *  \file traceLog.h (interface file)
+ *
+ *  \brief Problem name: Problem 2.
+ *
+ *  Timeline of a run, written as a Chrome trace (JSON, opened by chrome://tracing or Perfetto): each thread records
+ *  what it does (chunk fetched, computation, merge, lock wait and hold, MPI send and receive) in a ring buffer of
+ *  its own, the oldest events being overwritten, and the rings are merged at the end. When it is not started, a
+ *  span costs a test of a flag and nothing is recorded.
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - June 2020
+ */
+
+#ifndef TRACELOG_H
+#define TRACELOG_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "TRACEEVENT.h"
+
+/** \brief events of the timeline */
+#define  TRACE_FETCH         0
+#define  TRACE_COMPUTE       1
+#define  TRACE_MERGE         2
+#define  TRACE_LOCK_WAIT     3
+#define  TRACE_LOCK_HELD     4
+#define  TRACE_SEND          5
+#define  TRACE_RECV          6
+
+/**
+ *  \brief Start recording.
+ *
+ *  Operation carried out by the main thread, before the threads are created.
+ *
+ *  \param numbThreads number of threads recording, numbered from 0
+ *  \param numbEvents  number of events kept per thread
+ *
+ *  \return false if the rings could not be allocated, nothing being recorded then
+ */
+extern bool startTrace(unsigned int numbThreads, size_t numbEvents);
+
+/**
+ *  \brief Time since recording started.
+ *
+ *  \return microseconds, 0 when nothing is recorded
+ */
+extern double traceClock(void);
+
+/**
+ *  \brief Record an event which began at a given time and ends now.
+ *
+ *  \param thread number of the calling thread, which only writes to its own ring
+ *  \param event  one of the TRACE_ constants
+ *  \param start  time it began (traceClock)
+ */
+extern void traceSpan(unsigned int thread, unsigned int event, double start);
+
+/**
+ *  \brief Set what is added to the times of this process, to align them on the clock of another one.
+ *
+ *  \param offset microseconds
+ */
+extern void setTraceOffset(double offset);
+
+/**
+ *  \brief Events recorded by the threads, each ring from its oldest event.
+ *
+ *  Operation carried out once the threads ended.
+ *
+ *  \param process  number of the process, stored in the events
+ *  \param **events where the array of the events is stored (to free), NULL when nothing was recorded
+ *
+ *  \return number of events
+ */
+extern size_t collectTrace(int process, TRACEEVENT **events);
+
+/**
+ *  \brief Write events, of any threads and processes, as a Chrome trace.
+ *
+ *  \param *name    name of the file
+ *  \param *events  events
+ *  \param numbEvents number of events
+ *
+ *  \return false on an error (errno set)
+ */
+extern bool writeTrace(const char *name, const TRACEEVENT *events, size_t numbEvents);
+
+/**
+ *  \brief Stop recording and free the rings.
+ */
+extern void stopTrace(void);
+
+#endif /* TRACELOG_H */
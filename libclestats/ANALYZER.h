@@ -0,0 +1,33 @@
+/**
+ *  \file ANALYZER.h (interface file)
+ *
+ *  \brief Library libclestats.
+ *
+ *  Analyzer of a text fed in buffers: where the counts, the sketch of the distinct words and the words of the text
+ *  are added (storage of the caller), and the start of the word the last buffer ended in, completed by the next one.
+ *
+ *  \author Francisco Gonçalves Tiago Lucas - April 2020
+ */
+ 
+#ifndef ANALYZER_H
+#define ANALYZER_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "statsConst.h"
+#include "TEXTCOUNTS.h"
+#include "WORDENTRY.h"
+#include "WORDTABLE.h"
+
+typedef struct
+{
+   TEXTCOUNTS *counts;
+   unsigned char *registers;
+   WORDTABLE *words;
+   unsigned char carry[ANALYZER_CARRY];
+   size_t carryLength;
+   bool carryCut;
+} ANALYZER;
+
+#endif /* end of include guard: ANALYZER_H */
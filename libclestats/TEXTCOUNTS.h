@@ -0,0 +1,25 @@
+/**
+ *  \file TEXTCOUNTS.h (interface file)
+ *
+ *  \brief Library libclestats.
+ *
+ *  Counts of the words of a text: their number, the longest one and the histogram bidi[vowels][length - 1].
+ *
+ *  \author Francisco Gonçalves Tiago Lucas - June 2020
+ */
+ 
+#ifndef TEXTCOUNTS_H
+#define TEXTCOUNTS_H
+
+#include <stdlib.h>
+
+#include "statsConst.h"
+
+typedef struct
+{
+   size_t numbWords;
+   size_t maxWordLength;
+   int bidi[MAX_SIZE_WORD][MAX_SIZE_WORD];
+} TEXTCOUNTS;
+
+#endif /* end of include guard: TEXTCOUNTS_H */
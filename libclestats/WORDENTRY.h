@@ -0,0 +1,25 @@
+/**
+ *  \file WORDENTRY.h (interface file)
+ *
+ *  \brief Library libclestats.
+ *
+ *  Slot of a word table: a word (its bytes kept in the arena of the table) and the number of times it was seen.
+ *
+ *  \author Francisco Gonçalves Tiago Lucas - April 2020
+ */
+ 
+#ifndef WORDENTRY_H
+#define WORDENTRY_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+typedef struct
+{
+   const unsigned char *word;
+   uint32_t length;
+   uint32_t hash;
+   uint64_t count;
+} WORDENTRY;
+
+#endif /* end of include guard: WORDENTRY_H */
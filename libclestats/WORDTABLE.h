@@ -0,0 +1,29 @@
+/**
+ *  \file WORDTABLE.h (interface file)
+ *
+ *  \brief Library libclestats.
+ *
+ *  Word table: open addressing (linear probing) over a power of two number of slots, the bytes of the words being
+ *  allocated from blocks of an arena that are only released with the table.
+ *
+ *  \author Francisco Gonçalves Tiago Lucas - April 2020
+ */
+ 
+#ifndef WORDTABLE_H
+#define WORDTABLE_H
+
+#include <stdlib.h>
+
+#include "WORDENTRY.h"
+
+typedef struct
+{
+   WORDENTRY *slots;
+   size_t numbSlots;
+   size_t numbWords;
+   unsigned char **blocks;
+   size_t numbBlocks;
+   size_t blockUsed;
+} WORDTABLE;
+
+#endif /* end of include guard: WORDTABLE_H */
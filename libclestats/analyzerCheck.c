@@ -0,0 +1,210 @@
+/**
+ *  \file analyzerCheck.c (implementation file)
+ *
+ *  \brief Library libclestats.
+ *
+ *  Check of the analyzers of textAnalyzer.h: each text is analyzed in a single pass, then cut in parts (see
+ *  textBoundary), each part fed in buffers of varying sizes to an analyzer of its own, the analyzers being merged;
+ *  both must give the same histogram, sketch of the distinct words and words. With no files, a text of its own is
+ *  checked, with words longer than the histogram holds and than the carry of an analyzer.
+ *  Separate program, built from this file and linked with libclestats.a and libm; it has a main of its own, so it is
+ *  left out of the library (see clestats.h).
+ *
+ *  \author Francisco Gonçalves Tiago Lucas - April 2020
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "statsConst.h"
+#include "TEXTCOUNTS.h"
+#include "WORDENTRY.h"
+#include "WORDTABLE.h"
+#include "wordTable.h"
+#include "ANALYZER.h"
+#include "textAnalyzer.h"
+
+/** \brief number of parts a text is cut in */
+#define  CHECK_PARTS         4
+
+/** \brief largest buffer fed to an analyzer */
+#define  CHECK_BUFFER        (2 * ANALYZER_CARRY)
+
+/** \brief number of words of the text of its own */
+#define  CHECK_WORDS         20000
+
+/** \brief number of bytes a file is read in at a time */
+#define  CHECK_READ          (1 << 16)
+
+/**
+ *  \brief Read a whole file.
+ *
+ *  Internal operation.
+ *
+ *  \return text, NULL if the file could not be read
+ */
+static unsigned char *readText(const char *name, size_t *length)
+{
+  unsigned char *text = NULL;
+  size_t size = 0;
+  ssize_t n;
+  int fd;
+
+  if ((fd = open(name, O_RDONLY)) < 0)
+    return NULL;
+  *length = 0;
+  do {
+    if (*length == size){
+      size = 2 * size + CHECK_READ;
+      text = (unsigned char *) realloc(text, size);
+    }
+    n = read(fd, text + *length, size - *length);
+    *length += n > 0 ? n : 0;
+  } while (n > 0);
+  close(fd);
+  if (n < 0){
+    free(text);
+    return NULL;
+  }
+  return text;
+}
+
+/**
+ *  \brief Text of its own: words of every length up to past the histogram, accented letters, apostrophes and
+ *  separators of one and three bytes, and a word longer than the carry of an analyzer.
+ *
+ *  Internal operation.
+ */
+static unsigned char *makeText(size_t *length)
+{
+  static const char *const letters[] = {"a", "b", "e", "t", "r", "o", "s", "\xc3\xa3", "\xc3\xa7", "\xc3\xa9", "'"};
+  static const char *const separators[] = {" ", " ", "\n", ", ", ". ", "-", "\xe2\x80\x9c", "\xe2\x80\x9d ", "; "};
+  unsigned char *text = (unsigned char *) malloc(CHECK_WORDS * 3 * (MAX_SIZE_WORD + 4) + 3 * ANALYZER_CARRY);
+  uint64_t state = 1;
+  size_t n = 0, w, x, size;
+
+  for (w = 0; w < CHECK_WORDS; w++){
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    size = w == CHECK_WORDS / 2 ? ANALYZER_CARRY + 100 : 1 + (state >> 33) % (MAX_SIZE_WORD + 3);
+    for (x = 0; x < size; x++){
+      const char *c = letters[(state >> (x % 29)) % (x == 0 ? 10 : 11)];
+      memcpy(text + n, c, strlen(c));
+      n += strlen(c);
+    }
+    const char *s = separators[(state >> 40) % 9];
+    memcpy(text + n, s, strlen(s));
+    n += strlen(s);
+  }
+  *length = n;
+  return text;
+}
+
+/**
+ *  \brief Whether two analyzers have the same results and words.
+ *
+ *  Internal operation.
+ */
+static bool sameResults(const ANALYZER *x, const ANALYZER *y)
+{
+  const TEXTCOUNTS *a = analyzerHistogram(x), *b = analyzerHistogram(y);
+  WORDENTRY *topX, *topY;
+  size_t n, i;
+  bool same;
+
+  if (a->numbWords != b->numbWords || a->maxWordLength != b->maxWordLength
+      || memcmp(a->bidi, b->bidi, sizeof(a->bidi)) != 0 || memcmp(x->registers, y->registers, HLL_REGISTERS) != 0
+      || x->words->numbWords != y->words->numbWords)
+    return false;
+  n = x->words->numbWords;
+  topX = (WORDENTRY *) malloc(sizeof(WORDENTRY) * (n + 1));
+  topY = (WORDENTRY *) malloc(sizeof(WORDENTRY) * (n + 1));
+  same = analyzerTopWords(x, topX, n) == analyzerTopWords(y, topY, n);
+  for (i = 0; same && i < n; i++)
+    same = topX[i].count == topY[i].count && topX[i].length == topY[i].length
+           && memcmp(topX[i].word, topY[i].word, topX[i].length) == 0;
+  free(topX);
+  free(topY);
+  return same;
+}
+
+/**
+ *  \brief Analyze a text in a single pass and in parts fed in buffers, merged.
+ *
+ *  Internal operation.
+ *
+ *  \return true if both give the same results
+ */
+static bool checkText(const unsigned char *text, size_t length)
+{
+  ANALYZER *single = (ANALYZER *) malloc(sizeof(ANALYZER)),
+           *parts = (ANALYZER *) malloc(sizeof(ANALYZER) * CHECK_PARTS);
+  TEXTCOUNTS *counts = (TEXTCOUNTS *) calloc(CHECK_PARTS + 1, sizeof(TEXTCOUNTS));        /* the single pass last */
+  unsigned char *registers = (unsigned char *) calloc(CHECK_PARTS + 1, HLL_REGISTERS);
+  WORDTABLE *tables = (WORDTABLE *) calloc(CHECK_PARTS + 1, sizeof(WORDTABLE));
+  uint64_t state = length;
+  size_t from = 0, to, n, p;
+  bool same;
+
+  startAnalyzer(single, &counts[CHECK_PARTS], registers + CHECK_PARTS * HLL_REGISTERS, &tables[CHECK_PARTS]);
+  feedAnalyzer(single, text, length);
+  finishAnalyzer(single);
+
+  for (p = 0; p < CHECK_PARTS; p++){
+    to = p == CHECK_PARTS - 1 ? length : from + textBoundary(text + from, length * (p + 1) / CHECK_PARTS - from);
+    startAnalyzer(&parts[p], &counts[p], registers + p * HLL_REGISTERS, &tables[p]);
+    while (from < to){                                        /* small buffers in a part, large ones in the next */
+      state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+      n = 1 + (state >> 33) % (p % 2 == 0 ? 16 : CHECK_BUFFER);
+      n = n < to - from ? n : to - from;
+      feedAnalyzer(&parts[p], text + from, n);
+      from += n;
+    }
+    finishAnalyzer(&parts[p]);
+    if (p > 0)
+      mergeAnalyzer(&parts[0], &parts[p]);
+  }
+
+  same = sameResults(single, &parts[0]);
+  for (p = 0; p < CHECK_PARTS + 1; p++)
+    freeWordTable(&tables[p]);
+  free(tables);
+  free(registers);
+  free(counts);
+  free(parts);
+  free(single);
+  return same;
+}
+
+int main (int argc, char *argv[])
+{
+  unsigned char *text;
+  size_t length;
+  bool ok = true;
+
+  if (argc < 2){
+    text = makeText(&length);
+    ok = checkText(text, length);
+    printf("Text of %lu bytes: the analyzers %s.\n", length, ok ? "agree" : "disagree");
+    free(text);
+  }
+  for (int i = 1; i < argc; i++){
+    if ((text = readText(argv[i], &length)) == NULL){
+      perror(argv[i]);
+      ok = false;
+      continue;
+    }
+    if (checkText(text, length))
+      printf("File %s: the analyzers agree.\n", argv[i]);
+    else {
+      printf("File %s: the analyzers disagree.\n", argv[i]);
+      ok = false;
+    }
+    free(text);
+  }
+  exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,27 @@
+/**
+ *  \file clestats.h (interface file)
+ *
+ *  \brief Library libclestats.
+ *
+ *  Kernels shared by the programs of both projects: the word statistics of a text (textAnalyzer.h, with its word
+ *  tables and sketches of the distinct words) for prob1, and the circular cross correlation of signals
+ *  (signalCorrelator.h, with its FFT engine) for prob2. They keep no state of their own, the results and the scratch
+ *  memory being given by the caller, so that the worker threads of CLE1 and the worker processes of CLE2 call the same
+ *  code.
+ *
+ *  Built once as a static library, libclestats.a, from every file of this directory but analyzerCheck.c: each one is
+ *  compiled with this directory in the include path and the objects are archived. The programs are compiled with
+ *  this directory in their include path too, after their own, and linked with libclestats.a and libm.
+ *  analyzerCheck.c is a separate program, built from itself and the library.
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - June 2020
+ */
+
+#ifndef CLESTATS_H
+#define CLESTATS_H
+
+#include "statsConst.h"
+#include "textAnalyzer.h"
+#include "signalCorrelator.h"
+
+#endif /* CLESTATS_H */
@@ -0,0 +1,213 @@
+/**
+ *  \file fft.c (implementation file)
+ *
+ *  \brief Library libclestats.
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - April 2020
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <complex.h>
+#include <math.h>
+
+#include "fft.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/**
+ *  \brief Iterative radix-2 transform, n must be a power of two.
+ *
+ *  Internal operation.
+ */
+static void radix2(double complex *data, size_t n, bool inverse)
+{
+  size_t i, j, k, len;
+
+  for (i = 1, j = 0; i < n; i++){                                             /* bit reversal permutation */
+    size_t bit = n >> 1;
+    for (; j & bit; bit >>= 1)
+      j ^= bit;
+    j ^= bit;
+    if (i < j){
+      double complex t = data[i];
+      data[i] = data[j];
+      data[j] = t;
+    }
+  }
+
+  for (len = 2; len <= n; len <<= 1){
+    double angle = (inverse ? 2 : -2) * M_PI / len;
+    double complex wlen = cos(angle) + sin(angle) * I;
+    for (i = 0; i < n; i += len){
+      double complex w = 1;
+      for (k = 0; k < len / 2; k++){
+        double complex u = data[i+k];
+        double complex v = data[i+k+len/2] * w;
+        data[i+k] = u + v;
+        data[i+k+len/2] = u - v;
+        w *= wlen;
+      }
+    }
+  }
+}
+
+/**
+ *  \brief Bluestein transform, any n, through a radix-2 convolution.
+ *
+ *  Internal operation.
+ */
+static bool bluestein(double complex *data, size_t n, bool inverse)
+{
+  size_t m = 1, k;
+  while (m < 2 * n - 1)
+    m <<= 1;
+
+  double complex *w = malloc(sizeof(double complex) * n);
+  double complex *a = calloc(m, sizeof(double complex));
+  double complex *b = calloc(m, sizeof(double complex));
+  if (w == NULL || a == NULL || b == NULL){
+    free(w); free(a); free(b);
+    return false;
+  }
+
+  for (k = 0; k < n; k++){
+    size_t sq = (size_t) ((unsigned long long) k * k % (2 * n));             /* keep the chirp angle small */
+    double angle = (inverse ? 1 : -1) * M_PI * sq / n;
+    w[k] = cos(angle) + sin(angle) * I;
+    a[k] = data[k] * w[k];
+  }
+  b[0] = conj(w[0]);
+  for (k = 1; k < n; k++)
+    b[k] = b[m-k] = conj(w[k]);
+
+  radix2(a, m, false);
+  radix2(b, m, false);
+  for (k = 0; k < m; k++)
+    a[k] *= b[k];
+  radix2(a, m, true);
+
+  for (k = 0; k < n; k++)
+    data[k] = a[k] / m * w[k];
+
+  free(w); free(a); free(b);
+  return true;
+}
+
+/**
+ *  \brief In place discrete Fourier transform of any length.
+ *
+ *  Operation carried out by the workers.
+ *
+ *  \param *data    n complex values, replaced by their transform
+ *  \param n        number of values
+ *  \param inverse  true for the inverse transform (scaled by 1/n)
+ *
+ *  \return true on success, false if the scratch memory could not be allocated
+ */
+bool fftTransform(double complex *data, size_t n, bool inverse)
+{
+  size_t k;
+
+  if (n <= 1)
+    return true;
+  if ((n & (n - 1)) == 0)
+    radix2(data, n, inverse);
+  else if (!bluestein(data, n, inverse))
+    return false;
+
+  if (inverse)
+    for (k = 0; k < n; k++)
+      data[k] /= n;
+  return true;
+}
+
+/**
+ *  \brief Spectrum of a real signal.
+ *
+ *  Operation carried out by the workers.
+ *
+ *  \param *x     n real samples
+ *  \param n      number of samples
+ *  \param *spec  n complex values where the spectrum is stored
+ *
+ *  \return true on success
+ */
+bool fftRealSpectrum(const double *x, size_t n, double complex *spec)
+{
+  for (size_t k = 0; k < n; k++)
+    spec[k] = x[k];
+  return fftTransform(spec, n, false);
+}
+
+/**
+ *  \brief Spectrum of a real signal stored as float, computed in double.
+ *
+ *  Operation carried out by the workers.
+ *
+ *  \param *x     n real samples
+ *  \param n      number of samples
+ *  \param *spec  n complex values where the spectrum is stored
+ *
+ *  \return true on success
+ */
+bool fftSingleSpectrum(const float *x, size_t n, double complex *spec)
+{
+  for (size_t k = 0; k < n; k++)
+    spec[k] = x[k];
+  return fftTransform(spec, n, false);
+}
+
+/**
+ *  \brief Circular cross correlation of two signals given by their spectra.
+ *
+ *  Operation carried out by the workers.
+ *
+ *  \param *X     spectrum of the first signal
+ *  \param *Y     spectrum of the second signal
+ *  \param n      number of samples
+ *  \param *rxy   n values where the correlation is stored
+ *  \param *work  n complex values of scratch memory
+ *
+ *  \return true on success
+ */
+bool fftCircularCorrelation(const double complex *X, const double complex *Y, size_t n, double *rxy, double complex *work)
+{
+  size_t k;
+
+  for (k = 0; k < n; k++)
+    work[k] = conj(X[k]) * Y[k];
+  if (!fftTransform(work, n, true))
+    return false;
+  for (k = 0; k < n; k++)
+    rxy[k] = creal(work[k]);
+  return true;
+}
+
+/**
+ *  \brief Circular autocorrelation of a signal given by its spectrum, a single transform being needed.
+ *
+ *  Operation carried out by the workers.
+ *
+ *  \param *X     spectrum of the signal
+ *  \param n      number of samples
+ *  \param *r     n values where the autocorrelation is stored
+ *  \param *work  n complex values of scratch memory
+ *
+ *  \return true on success
+ */
+bool fftAutoCorrelation(const double complex *X, size_t n, double *r, double complex *work)
+{
+  size_t k;
+
+  for (k = 0; k < n; k++)
+    work[k] = creal(X[k]) * creal(X[k]) + cimag(X[k]) * cimag(X[k]);
+  if (!fftTransform(work, n, true))
+    return false;
+  for (k = 0; k < n; k++)
+    r[k] = creal(work[k]);
+  return true;
+}
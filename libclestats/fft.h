@@ -0,0 +1,83 @@
+/**
+ *  \file fft.h (interface file)
+ *
+ *  \brief Library libclestats.
+ *
+ *  Discrete Fourier transform of arbitrary length, used to compute the circular cross correlation
+ *  through the spectra of the signals.
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - April 2020
+ */
+
+#ifndef FFT_H
+#define FFT_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <complex.h>
+
+/**
+ *  \brief In place discrete Fourier transform of any length.
+ *
+ *  Radix-2 for powers of two, Bluestein (chirp-z) otherwise.
+ *
+ *  \param *data    n complex values, replaced by their transform
+ *  \param n        number of values
+ *  \param inverse  true for the inverse transform (scaled by 1/n)
+ *
+ *  \return true on success, false if the scratch memory could not be allocated
+ */
+extern bool fftTransform(double complex *data, size_t n, bool inverse);
+
+/**
+ *  \brief Spectrum of a real signal.
+ *
+ *  \param *x     n real samples
+ *  \param n      number of samples
+ *  \param *spec  n complex values where the spectrum is stored
+ *
+ *  \return true on success
+ */
+extern bool fftRealSpectrum(const double *x, size_t n, double complex *spec);
+
+/**
+ *  \brief Spectrum of a real signal stored as float, computed in double.
+ *
+ *  \param *x     n real samples
+ *  \param n      number of samples
+ *  \param *spec  n complex values where the spectrum is stored
+ *
+ *  \return true on success
+ */
+extern bool fftSingleSpectrum(const float *x, size_t n, double complex *spec);
+
+/**
+ *  \brief Circular cross correlation of two signals given by their spectra.
+ *
+ *  rxy[k] = sum_j x[j] * y[(j+k)%n]
+ *
+ *  \param *X     spectrum of the first signal
+ *  \param *Y     spectrum of the second signal
+ *  \param n      number of samples
+ *  \param *rxy   n values where the correlation is stored
+ *  \param *work  n complex values of scratch memory
+ *
+ *  \return true on success
+ */
+extern bool fftCircularCorrelation(const double complex *X, const double complex *Y, size_t n, double *rxy, double complex *work);
+
+/**
+ *  \brief Circular autocorrelation of a signal given by its spectrum, a single transform being needed.
+ *
+ *  r[k] = sum_j x[j] * x[(j+k)%n], the inverse transform of |X|^2
+ *
+ *  \param *X     spectrum of the signal
+ *  \param n      number of samples
+ *  \param *r     n values where the autocorrelation is stored
+ *  \param *work  n complex values of scratch memory
+ *
+ *  \return true on success
+ */
+extern bool fftAutoCorrelation(const double complex *X, size_t n, double *r, double complex *work);
+
+#endif /* FFT_H */
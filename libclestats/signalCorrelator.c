@@ -0,0 +1,230 @@
+/**
+ *  \file signalCorrelator.c (implementation file)
+ *
+ *  \brief Library libclestats.
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - April 2020
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+#include <complex.h>
+
+#include "fft.h"
+#include "signalCorrelator.h"
+
+size_t correlationWork(size_t n)
+{
+  return 2 * n;
+}
+
+/**
+ *  \brief Length of the transforms of a block of lags: a power of two, at least twice the number of lags, so that
+ *  the correlation of a part of x at the lags of the block never wraps around.
+ *
+ *  Internal operation.
+ */
+static size_t blockLength(size_t numbLags)
+{
+  size_t m = 1;
+
+  while (m < 2 * numbLags)
+    m *= 2;
+  return m;
+}
+
+size_t lagBlockWork(size_t numbLags)
+{
+  return 3 * blockLength(numbLags);
+}
+
+/**
+ *  \brief Engine of a whole correlation of n samples.
+ *
+ *  Internal operation.
+ */
+static int chooseEngine(size_t n, int engine, double crossover)
+{
+  if (engine == CORRELATE_AUTO)
+    return n > 1 && n > crossover * log2((double) n) ? CORRELATE_FFT : CORRELATE_DIRECT;
+  return engine;
+}
+
+/**
+ *  \brief Correlation by the spectra of the signals, a single one for the autocorrelation.
+ *
+ *  Internal operation.
+ *
+ *  \param *work 2n complex values, the spectrum of y being stored in the second half
+ */
+static bool fftCorrelation(const double *x, const double *y, size_t n, double *rxy, double complex *work)
+{
+  double complex *X = work, *Y = work + n;
+
+  if (x == y)
+    return fftRealSpectrum(x, n, X) && fftAutoCorrelation(X, n, rxy, X);
+  return fftRealSpectrum(x, n, X) && fftRealSpectrum(y, n, Y) && fftCircularCorrelation(X, Y, n, rxy, X);
+}
+
+/**
+ *  \brief Correlation by the spectra of the signals stored as float, computed in double.
+ *
+ *  Internal operation.
+ *
+ *  \param *work 2n complex values, the spectrum of y being stored in the second half
+ */
+static bool fftCorrelationSingle(const float *x, const float *y, size_t n, double *rxy, double complex *work)
+{
+  double complex *X = work, *Y = work + n;
+
+  if (x == y)
+    return fftSingleSpectrum(x, n, X) && fftAutoCorrelation(X, n, rxy, X);
+  return fftSingleSpectrum(x, n, X) && fftSingleSpectrum(y, n, Y) && fftCircularCorrelation(X, Y, n, rxy, X);
+}
+
+bool correlateSignals(const double *x, const double *y, size_t n, double *rxy, int engine, double crossover,
+                      double complex *work)
+{
+  double complex *scratch = work;
+  bool done;
+
+  engine = chooseEngine(n, engine, crossover);
+  if (engine == CORRELATE_DIRECT){
+    correlateLags(x, y, n, 0, n, rxy);
+    return true;
+  }
+  if (engine != CORRELATE_FFT)
+    return false;
+
+  if (scratch == NULL && (scratch = (double complex *) malloc(sizeof(double complex) * correlationWork(n))) == NULL)
+    return false;
+  done = fftCorrelation(x, y, n, rxy, scratch);
+  if (work == NULL)
+    free(scratch);
+  return done;
+}
+
+void correlateLags(const double *x, const double *y, size_t n, size_t firstLag, size_t numbLags, double *rxy)
+{
+  size_t j, k;
+
+  for(k = 0; k < numbLags; k++){
+    size_t lag = firstLag + k;
+    double sum = 0;
+    for(j = 0; j < n - lag; j++)
+      sum += x[j] * y[lag+j];
+    for(; j < n; j++)
+      sum += x[j] * y[lag+j-n];
+    rxy[k] = sum;
+  }
+}
+
+bool correlateLagBlock(const double *x, const double *y, size_t n, size_t firstLag, size_t numbLags, double *rxy,
+                       double complex *work)
+{
+  size_t m = blockLength(numbLags), first, length, j, k;
+  double complex *X = work, *Y = work + m;
+  double *part = (double *) (work + 2 * m), *r = part + m;
+
+  for(k = 0; k < numbLags; k++)
+    rxy[k] = 0;
+  for(first = 0; first < n; first += numbLags){                             /* a part of x as long as the block */
+    length = n - first < numbLags ? n - first : numbLags;
+    for(j = 0; j < m; j++)
+      part[j] = j < length ? x[first+j] : 0;
+    if (!fftRealSpectrum(part, m, X))
+      return false;
+    for(j = 0; j < m; j++)                                              /* the samples of y it reaches, circularly */
+      part[j] = y[(first + firstLag + j) % n];
+    if (!fftRealSpectrum(part, m, Y) || !fftCircularCorrelation(X, Y, m, r, X))
+      return false;
+    for(k = 0; k < numbLags; k++)
+      rxy[k] += r[k];
+  }
+  return true;
+}
+
+bool correlateSignalsSingle(const float *x, const float *y, size_t n, double *rxy, int engine, double crossover,
+                            double complex *work)
+{
+  double complex *scratch = work;
+  bool done;
+
+  engine = chooseEngine(n, engine, crossover);
+  if (engine == CORRELATE_DIRECT){
+    correlateLagsSingle(x, y, n, 0, n, rxy);
+    return true;
+  }
+  if (engine != CORRELATE_FFT)
+    return false;
+
+  if (scratch == NULL && (scratch = (double complex *) malloc(sizeof(double complex) * correlationWork(n))) == NULL)
+    return false;
+  done = fftCorrelationSingle(x, y, n, rxy, scratch);
+  if (work == NULL)
+    free(scratch);
+  return done;
+}
+
+void correlateLagsSingle(const float *x, const float *y, size_t n, size_t firstLag, size_t numbLags, double *rxy)
+{
+  size_t j, k;
+
+  for(k = 0; k < numbLags; k++){
+    size_t lag = firstLag + k;
+    double sum = 0;
+    for(j = 0; j < n - lag; j++)
+      sum += (double) x[j] * y[lag+j];                         /* the product of two floats is exact in double */
+    for(; j < n; j++)
+      sum += (double) x[j] * y[lag+j-n];
+    rxy[k] = sum;
+  }
+}
+
+bool correlateLagBlockSingle(const float *x, const float *y, size_t n, size_t firstLag, size_t numbLags, double *rxy,
+                             double complex *work)
+{
+  size_t m = blockLength(numbLags), first, length, j, k;
+  double complex *X = work, *Y = work + m;
+  double *part = (double *) (work + 2 * m), *r = part + m;
+
+  for(k = 0; k < numbLags; k++)
+    rxy[k] = 0;
+  for(first = 0; first < n; first += numbLags){                             /* a part of x as long as the block */
+    length = n - first < numbLags ? n - first : numbLags;
+    for(j = 0; j < m; j++)
+      part[j] = j < length ? x[first+j] : 0;
+    if (!fftRealSpectrum(part, m, X))
+      return false;
+    for(j = 0; j < m; j++)                                              /* the samples of y it reaches, circularly */
+      part[j] = y[(first + firstLag + j) % n];
+    if (!fftRealSpectrum(part, m, Y) || !fftCircularCorrelation(X, Y, m, r, X))
+      return false;
+    for(k = 0; k < numbLags; k++)
+      rxy[k] += r[k];
+  }
+  return true;
+}
+
+double correlateLagPart(const double *x, const double *y, size_t n, size_t lag, size_t first, size_t last)
+{
+  size_t j;
+  double sum = 0;
+
+  for(j = first; j < last; j++){
+    sum += x[j] * y[(lag+j)%n];
+  }
+  return sum;
+}
+
+double correlateLagPartSingle(const float *x, const float *y, size_t n, size_t lag, size_t first, size_t last)
+{
+  size_t j;
+  double sum = 0;
+
+  for(j = first; j < last; j++){
+    sum += (double) x[j] * y[(lag+j)%n];
+  }
+  return sum;
+}
@@ -0,0 +1,182 @@
+/**
+ *  \file signalCorrelator.h (interface file)
+ *
+ *  \brief Library libclestats.
+ *
+ *  Kernels of the circular cross correlation (the correlation half of libclestats, the word statistics being
+ *  textAnalyzer.h), reentrant so that they can be called from any thread or process: they keep no state, the signals
+ *  and the results are given by the caller and so is the scratch memory of the FFT engine, which can be reused from a
+ *  call to the next (see correlationWork). prob2 and its MPI version are drivers over them, their workers being
+ *  handed lags, parts of the sum of a lag, blocks of lags or whole correlations.
+ *
+ *  rxy[k] = sum_j x[j] * y[(j+k)%n]
+ *
+ *  The engine of a whole correlation is chosen by the caller, CORRELATE_AUTO taking the FFT engine when the number
+ *  of lags is above the crossover given (the one of the host for the programs, see their autotune.h). The direct
+ *  method adds the samples in the same order whatever the lags it is given, so that a block of lags has the values
+ *  of the whole correlation.
+ *
+ *  A block of lags is also computed with the FFT engine by overlap-save: x is cut in parts as long as the block, and
+ *  the correlation of each part with the samples of y it reaches at the lags of the block is taken from transforms
+ *  of twice the length of the block, so that the memory needed is the one of the block, not of the signals.
+ *
+ *  Every kernel has a version for signals stored as float, half the bytes to go through, which accumulates in
+ *  double: the product of two floats is exact in double, so the sums are the ones of the same samples stored as
+ *  double, in the same order, and the only error is the rounding of the samples to float (see singleErrorBound in
+ *  signalFile.h of the programs).
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - April 2020
+ */
+
+#ifndef SIGNALCORRELATOR_H
+#define SIGNALCORRELATOR_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <complex.h>
+
+/* Engines of a whole correlation */
+#define  CORRELATE_AUTO      0
+#define  CORRELATE_DIRECT    1
+#define  CORRELATE_FFT       2
+
+/**
+ *  \brief Number of complex values of the scratch memory of a correlation.
+ *
+ *  \param n number of samples
+ *
+ *  \return the spectra of both signals
+ */
+extern size_t correlationWork(size_t n);
+
+/**
+ *  \brief Circular cross correlation of two signals, all of its lags.
+ *
+ *  \param *x         n samples of the first signal
+ *  \param *y         n samples of the second signal, x for the autocorrelation
+ *  \param n          number of samples
+ *  \param *rxy       n values where the correlation is stored
+ *  \param engine     CORRELATE_AUTO, CORRELATE_DIRECT or CORRELATE_FFT
+ *  \param crossover  with CORRELATE_AUTO, the FFT engine is taken when n is above crossover * log2(n)
+ *  \param *work      correlationWork(n) complex values of scratch memory, NULL for it to be allocated
+ *
+ *  \return false if the scratch memory could not be allocated, or the engine is unknown
+ */
+extern bool correlateSignals(const double *x, const double *y, size_t n, double *rxy, int engine,
+                             double crossover, double complex *work);
+
+/**
+ *  \brief Circular cross correlation of two signals, a block of consecutive lags by the direct method.
+ *
+ *  \param *x         n samples of the first signal
+ *  \param *y         n samples of the second signal
+ *  \param n          number of samples
+ *  \param firstLag   first lag, below n
+ *  \param numbLags   number of lags, up to n - firstLag
+ *  \param *rxy       numbLags values where the correlation is stored
+ */
+extern void correlateLags(const double *x, const double *y, size_t n, size_t firstLag, size_t numbLags, double *rxy);
+
+/**
+ *  \brief Number of complex values of the scratch memory of a block of lags computed with the FFT engine.
+ *
+ *  \param numbLags number of lags of the block
+ *
+ *  \return the spectra of a part of each signal and the samples of the part
+ */
+extern size_t lagBlockWork(size_t numbLags);
+
+/**
+ *  \brief Circular cross correlation of two signals, a block of consecutive lags with the FFT engine (overlap-save).
+ *
+ *  \param *x         n samples of the first signal
+ *  \param *y         n samples of the second signal
+ *  \param n          number of samples
+ *  \param firstLag   first lag, below n
+ *  \param numbLags   number of lags, up to n - firstLag
+ *  \param *rxy       numbLags values where the correlation is stored
+ *  \param *work      lagBlockWork(numbLags) complex values of scratch memory
+ *
+ *  \return false if the scratch memory of a transform could not be allocated
+ */
+extern bool correlateLagBlock(const double *x, const double *y, size_t n, size_t firstLag, size_t numbLags,
+                              double *rxy, double complex *work);
+
+/**
+ *  \brief Circular cross correlation of two signals stored as float, all of its lags.
+ *
+ *  \param *x         n samples of the first signal
+ *  \param *y         n samples of the second signal, x for the autocorrelation
+ *  \param n          number of samples
+ *  \param *rxy       n values where the correlation is stored
+ *  \param engine     CORRELATE_AUTO, CORRELATE_DIRECT or CORRELATE_FFT
+ *  \param crossover  with CORRELATE_AUTO, the FFT engine is taken when n is above crossover * log2(n)
+ *  \param *work      correlationWork(n) complex values of scratch memory, NULL for it to be allocated
+ *
+ *  \return false if the scratch memory could not be allocated, or the engine is unknown
+ */
+extern bool correlateSignalsSingle(const float *x, const float *y, size_t n, double *rxy, int engine,
+                                   double crossover, double complex *work);
+
+/**
+ *  \brief Circular cross correlation of two signals stored as float, a block of consecutive lags by the direct
+ *  method.
+ *
+ *  \param *x         n samples of the first signal
+ *  \param *y         n samples of the second signal
+ *  \param n          number of samples
+ *  \param firstLag   first lag, below n
+ *  \param numbLags   number of lags, up to n - firstLag
+ *  \param *rxy       numbLags values where the correlation is stored
+ */
+extern void correlateLagsSingle(const float *x, const float *y, size_t n, size_t firstLag, size_t numbLags,
+                                double *rxy);
+
+/**
+ *  \brief Circular cross correlation of two signals stored as float, a block of consecutive lags with the FFT engine
+ *  (overlap-save), computed in double.
+ *
+ *  \param *x         n samples of the first signal
+ *  \param *y         n samples of the second signal
+ *  \param n          number of samples
+ *  \param firstLag   first lag, below n
+ *  \param numbLags   number of lags, up to n - firstLag
+ *  \param *rxy       numbLags values where the correlation is stored
+ *  \param *work      lagBlockWork(numbLags) complex values of scratch memory
+ *
+ *  \return false if the scratch memory of a transform could not be allocated
+ */
+extern bool correlateLagBlockSingle(const float *x, const float *y, size_t n, size_t firstLag, size_t numbLags,
+                                    double *rxy, double complex *work);
+
+/**
+ *  \brief Part of the sum of a lag of the circular cross correlation of two signals, by the direct method.
+ *
+ *  \param *x       n samples of the first signal
+ *  \param *y       n samples of the second signal
+ *  \param n        number of samples
+ *  \param lag      lag, below n
+ *  \param first    first term of the part
+ *  \param last     term past the end of the part, up to n
+ *
+ *  \return sum of x[j] * y[(j+lag)%n] for j from first to last, added in that order
+ */
+extern double correlateLagPart(const double *x, const double *y, size_t n, size_t lag, size_t first, size_t last);
+
+/**
+ *  \brief Part of the sum of a lag of the circular cross correlation of two signals stored as float, by the direct
+ *  method, accumulated in double.
+ *
+ *  \param *x       n samples of the first signal
+ *  \param *y       n samples of the second signal
+ *  \param n        number of samples
+ *  \param lag      lag, below n
+ *  \param first    first term of the part
+ *  \param last     term past the end of the part, up to n
+ *
+ *  \return sum of x[j] * y[(j+lag)%n] for j from first to last, added in that order
+ */
+extern double correlateLagPartSingle(const float *x, const float *y, size_t n, size_t lag, size_t first,
+                                     size_t last);
+
+#endif /* SIGNALCORRELATOR_H */
@@ -0,0 +1,26 @@
+/**
+ *  \file statsConst.h (interface file)
+ *
+ *  \brief Library libclestats.
+ *
+ *  Parameters of the word statistics, which the results of the programs are laid out by.
+ *
+ *  \author Francisco Gonçalves Tiago Lucas - June 2020
+ */
+
+#ifndef STATSCONST_H_
+#define STATSCONST_H_
+
+/** \brief max size of word */
+#define  MAX_SIZE_WORD      50
+
+/** \brief number of bits of the hash of a word selecting a register of the sketch of the distinct words */
+#define  HLL_PRECISION      10
+
+/** \brief number of registers of the sketch of the distinct words */
+#define  HLL_REGISTERS      (1 << HLL_PRECISION)
+
+/** \brief largest start of a word an analyzer keeps from a buffer to the next (see textAnalyzer.h) */
+#define  ANALYZER_CARRY     4096
+
+#endif /* STATSCONST_H_ */
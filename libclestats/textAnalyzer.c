@@ -0,0 +1,234 @@
+/**
+ *  \file textAnalyzer.c (implementation file)
+ *
+ *  \brief Library libclestats.
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - April 2020
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "statsConst.h"
+#include "TEXTCOUNTS.h"
+#include "WORDENTRY.h"
+#include "WORDTABLE.h"
+#include "wordTable.h"
+#include "wordSketch.h"
+#include "ANALYZER.h"
+#include "textAnalyzer.h"
+
+void scanText(const unsigned char *dataToBeProcessed, size_t length, TEXTCOUNTS *counts, unsigned char *registers,
+              WORDTABLE *words) {
+    char cha;
+    bool inWord = false, wasInWord;
+    int skip, nVowels = 0, nCharacters = 0, maxWordLength = 0, start = 0, end, cut = 0, cutVowels = 0;
+    
+    for (int i = 0; i < length; i++) {
+    	skip = 0;
+    	wasInWord = inWord;
+        if((char)dataToBeProcessed[i] == (char)0xC3) {
+        	skip = 1;
+            i += 1;
+        } else if((char)dataToBeProcessed[i] == (char)0xE2) {
+        	skip = 2;
+            i += 2;
+		}
+        cha = dataToBeProcessed[i];
+
+		if (cha >= 48 && cha <= 57) {
+			inWord = true;
+            nCharacters++;
+        } else if (skip == 0 && cha >= 65 && cha <= 90) {
+            inWord = true;
+            nCharacters++;
+        	if (cha == 65 || cha == 69 || cha == 73 || cha == 79 || cha == 85)
+        		nVowels++;
+        } else if (skip == 0 && cha >= 97 && cha <= 122) {
+            inWord = true;
+            nCharacters++;
+        	if (cha == 97 || cha == 101 || cha == 105 || cha == 111 || cha == 117)
+        		nVowels++;
+        } else if (skip == 0 && cha == '_') {
+            inWord = true;
+            nCharacters++;
+		} else if ((skip == 0 && cha == (char)0x27) || (skip == 2 && cha == (char)0x98) || (skip == 2 && cha == 0x99)) {
+            ;
+		} else if (skip == 1) {
+			if (cha == (char)0xA7 || cha == (char)0x87) {
+            	inWord = true;
+	            nCharacters++;
+	        } else if (cha == (char)0xA1 || cha == (char)0xA0 || cha == (char)0xA2 || cha == (char)0xA3 || cha == (char)0x81 || cha == (char)0x80 || cha == (char)0x82 || cha == (char)0x83) {
+	            inWord = true;
+	            nCharacters++;
+	            nVowels++;
+	        } else if (cha == (char)0xA9 || cha == (char)0xA8 || cha == (char)0xAA || cha == (char)0x89 || cha == (char)0x88 || cha == (char)0x8A) {
+	            inWord = true;
+	            nCharacters++;
+	            nVowels++;
+	        } else if (cha == (char)0xAD || cha == (char)0xAC || cha == (char)0x8D || cha == (char)0x8C) {
+	            inWord = true;
+	            nCharacters++;
+	            nVowels++;
+	        } else if (cha == (char)0xB3 || cha == (char)0xB2 || cha == (char)0xB4 || cha == (char)0xB5 || cha == (char)0x93 || cha == (char)0x92 || cha == (char)0x94 || cha == (char)0x95) {
+	    		inWord = true;
+	            nCharacters++;
+	            nVowels++;
+	        } else if (cha == (char)0xBA || cha == (char)0xB9 || cha == (char)0x9A || cha == (char)0x99) {
+	            inWord = true;
+	            nCharacters++;
+	            nVowels++;
+	    	}
+        } else if (inWord && (skip == 0 && isValidStopCharacter(cha) == 1) || (inWord && skip == 2 && isValidStopCharacter(cha) == 3) ) {
+            end = i - skip;                                              /* trailing apostrophes left out */
+            while (true)
+                if (end - start > 0 && dataToBeProcessed[end-1] == 0x27)
+                    end -= 1;
+                else if (end - start > 2 && dataToBeProcessed[end-3] == 0xE2 && dataToBeProcessed[end-2] == 0x80
+                         && (dataToBeProcessed[end-1] == 0x98 || dataToBeProcessed[end-1] == 0x99))
+                    end -= 3;
+                else
+                    break;
+            if (cut > 0){                                    /* a longer word is taken by its first letters */
+                end = cut;
+                nCharacters = MAX_SIZE_WORD - 1;
+                nVowels = cutVowels;
+                cut = 0;
+            }
+            addSketch(registers, dataToBeProcessed + start, end - start);
+            if (words != NULL)
+                addWord(words, dataToBeProcessed + start, end - start, 1);
+            counts->bidi[nVowels][nCharacters - 1]++;
+            counts->numbWords++;
+            if (nCharacters > maxWordLength)
+            	maxWordLength = nCharacters;
+            //printf("Chars: %lu, Vowels: %lu\n",nCharacters,nVowels);
+            nCharacters = 0;
+            nVowels = 0;
+            inWord = false;
+        }
+        if (inWord && !wasInWord)
+            start = i - skip;
+        if (inWord && cut == 0 && nCharacters == MAX_SIZE_WORD - 1){     /* the longest length the histogram holds */
+            cut = i + 1;
+            cutVowels = nVowels;
+        }
+    }
+    
+    if (maxWordLength > counts->maxWordLength)
+		counts->maxWordLength = maxWordLength;
+}
+
+/**
+ *  \brief Validate if a character is a stop character.
+ *
+ * \param character		character to which the validation is done.
+ *
+ * \return 				0 if the character provided is not a stop character, otherwise is the number of bytes the character should have. Can be used as true/false.
+ *
+ */
+int isValidStopCharacter(char character) {
+  char separation[15] = { (char)0x20, (char)0x9, (char)0xA, '-', '"', '(', ')', '[', ']', '.', ',', ':', ';', '?', '!' };
+  char separation3[4] = { (char)0x9C, (char)0x9D, (char)0x93, (char)0xA6 };
+  int x;
+  for (x = 0; x < 15; x++)
+    if (character == separation[x])
+      return 1;
+  for (x = 0; x < 4; x++)
+    if (character == separation3[x])
+      return 3;
+  return 0;
+}
+
+size_t textBoundary(const unsigned char *text, size_t length)
+{
+  while (length > 0 && isValidStopCharacter(text[length - 1]) != 1)       /* never a byte of a multibyte character */
+    length--;
+  return length;
+}
+
+void startAnalyzer(ANALYZER *a, TEXTCOUNTS *counts, unsigned char *registers, WORDTABLE *words)
+{
+  a->counts = counts;
+  a->registers = registers;
+  a->words = words;
+  a->carryLength = 0;
+  a->carryCut = false;
+}
+
+/**
+ *  \brief Add bytes to the start of the word the last buffer ended in, a byte being left for the separator that
+ *  ends it. Once it is full, the rest of the word is left out, the start kept ending with a whole character: the
+ *  word is taken by its first letters (see scanText), as in a single pass.
+ *
+ *  Internal operation.
+ */
+static void addCarry(ANALYZER *a, const unsigned char *text, size_t length)
+{
+  size_t n = ANALYZER_CARRY - 1 - a->carryLength < length ? ANALYZER_CARRY - 1 - a->carryLength : length;
+
+  if (a->carryCut)
+    return;
+  memcpy(a->carry + a->carryLength, text, n);
+  a->carryLength += n;
+  if (n < length){
+    a->carryCut = true;
+    if (a->carry[a->carryLength - 1] == 0xC3 || a->carry[a->carryLength - 1] == 0xE2)
+      a->carryLength -= 1;
+    else if (a->carryLength > 1 && a->carry[a->carryLength - 2] == 0xE2)
+      a->carryLength -= 2;
+  }
+}
+
+void feedAnalyzer(ANALYZER *a, const unsigned char *text, size_t length)
+{
+  size_t first = 0, last = textBoundary(text, length);
+
+  if (last > 0 && a->carryLength > 0){                              /* the word of the last buffer is completed */
+    while (isValidStopCharacter(text[first]) != 1)
+      first++;
+    addCarry(a, text, first);
+    a->carry[a->carryLength++] = text[first++];
+    finishAnalyzer(a);
+  }
+  if (last > first)
+    scanText(text + first, last - first, a->counts, a->registers, a->words);
+  addCarry(a, text + (last > first ? last : first), length - (last > first ? last : first));
+}
+
+void finishAnalyzer(ANALYZER *a)
+{
+  scanText(a->carry, a->carryLength, a->counts, a->registers, a->words);
+  a->carryLength = 0;
+  a->carryCut = false;
+}
+
+void mergeAnalyzer(ANALYZER *into, const ANALYZER *from)
+{
+  into->counts->numbWords += from->counts->numbWords;
+  if (from->counts->maxWordLength > into->counts->maxWordLength)
+    into->counts->maxWordLength = from->counts->maxWordLength;
+  for (size_t i = 0; i < from->counts->maxWordLength + 1; i++)
+    for (size_t j = 0; j < from->counts->maxWordLength; j++)
+      into->counts->bidi[i][j] += from->counts->bidi[i][j];
+  mergeSketch(into->registers, from->registers);
+  if (into->words != NULL && from->words != NULL)
+    mergeWordTable(into->words, from->words);
+}
+
+const TEXTCOUNTS *analyzerHistogram(const ANALYZER *a)
+{
+  return a->counts;
+}
+
+double analyzerDistinctWords(const ANALYZER *a)
+{
+  return sketchEstimate(a->registers);
+}
+
+size_t analyzerTopWords(const ANALYZER *a, WORDENTRY *top, size_t k)
+{
+  return a->words != NULL ? topWords(a->words, top, k) : 0;
+}
@@ -0,0 +1,135 @@
+/**
+ *  \file textAnalyzer.h (interface file)
+ *
+ *  \brief Library libclestats.
+ *
+ *  Word statistics of a text (the word statistics half of libclestats, the correlation of signals being
+ *  signalCorrelator.h): an analyzer is fed the text in buffers of any size, straight from the memory of the caller,
+ *  and adds the histogram of the lengths and vowels of its words, their sketch for the estimate of the number of
+ *  distinct words and the frequencies of the words to the storage it was started on. prob1, its server and its MPI
+ *  version are drivers over the analyzers, and so over scanText, their kernel: each worker feeds the chunks it is
+ *  handed to an analyzer started on the results of the chunk.
+ *
+ *  An analyzer is a structure of the caller (on its stack, static or allocated), and so are the counts, the sketch
+ *  and the word table it adds to, the library allocating nothing but the words of the table. The operations are
+ *  reentrant: different analyzers may be used by different threads at the same time, an analyzer and its storage by
+ *  one thread at a time. A pool of threads or processes of the caller analyzes a text in parts, cut with
+ *  textBoundary, an analyzer each on storage of its own, the results being merged at the end with mergeAnalyzer.
+ *
+ *  A word is counted once it is followed by a separator, as the programs count it; the end of the text is not one.
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - April 2020
+ */
+
+#ifndef TEXTANALYZER_H
+#define TEXTANALYZER_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "TEXTCOUNTS.h"
+#include "WORDENTRY.h"
+#include "WORDTABLE.h"
+#include "ANALYZER.h"
+
+/**
+ *  \brief Add the words of a text to results, the text starting out of a word.
+ *
+ *  A word longer than the histogram holds is counted as one of MAX_SIZE_WORD - 1 letters, and taken by them.
+ *
+ *  \param *text       UTF-8 text
+ *  \param length      number of bytes of the text
+ *  \param *counts     counts, increased
+ *  \param *registers  sketch where the distinct words are added
+ *  \param *words      table where the words are counted, NULL not to count them
+ */
+extern void scanText(const unsigned char *text, size_t length, TEXTCOUNTS *counts, unsigned char *registers,
+                     WORDTABLE *words);
+
+/**
+ *  \brief Validate if a character is a stop character.
+ *
+ * \param character		character to which the validation is done.
+ *
+ * \return 				0 if the character provided is not a stop character, otherwise is the number of bytes the character should have. Can be used as true/false.
+ */
+extern int isValidStopCharacter(char character);
+
+/**
+ *  \brief Position where a text may be cut, the parts being analyzed apart: after its last single byte separator.
+ *
+ *  \param *text   UTF-8 text
+ *  \param length  number of bytes of the text
+ *
+ *  \return number of bytes of the first part, 0 if the text has no such separator
+ */
+extern size_t textBoundary(const unsigned char *text, size_t length);
+
+/**
+ *  \brief Start an analyzer on the storage of the caller, which is not cleared: the words of the text are added to
+ *  the ones already there.
+ *
+ *  \param *a          analyzer
+ *  \param *counts     counts of the words
+ *  \param *registers  HLL_REGISTERS registers of the sketch of the distinct words
+ *  \param *words      table where the words are counted, for analyzerTopWords, NULL not to count them
+ */
+extern void startAnalyzer(ANALYZER *a, TEXTCOUNTS *counts, unsigned char *registers, WORDTABLE *words);
+
+/**
+ *  \brief Analyze the next buffer of a text.
+ *
+ *  The buffer is scanned where it is, only the start of a word it ends in being copied, up to ANALYZER_CARRY bytes
+ *  (the rest of a longer word is left out, the word being taken by its first letters in any case).
+ *
+ *  \param *a       analyzer
+ *  \param *text    buffer
+ *  \param length   number of bytes of the buffer
+ */
+extern void feedAnalyzer(ANALYZER *a, const unsigned char *text, size_t length);
+
+/**
+ *  \brief End the text: the rest of the last buffer is analyzed.
+ *
+ *  \param *a analyzer
+ */
+extern void finishAnalyzer(ANALYZER *a);
+
+/**
+ *  \brief Add the results of an analyzer to the ones of another, both being finished and on storage of their own.
+ *
+ *  \param *into analyzer whose results are increased
+ *  \param *from analyzer of another part of the text, its words being added when both count them
+ */
+extern void mergeAnalyzer(ANALYZER *into, const ANALYZER *from);
+
+/**
+ *  \brief Counts of an analyzer: words, longest word, and histogram bidi[vowels][length - 1] of the words.
+ *
+ *  \param *a analyzer
+ *
+ *  \return counts, the ones it was started on
+ */
+extern const TEXTCOUNTS *analyzerHistogram(const ANALYZER *a);
+
+/**
+ *  \brief Estimate of the number of distinct words of an analyzer.
+ *
+ *  \param *a analyzer
+ *
+ *  \return estimate
+ */
+extern double analyzerDistinctWords(const ANALYZER *a);
+
+/**
+ *  \brief Most frequent words of an analyzer, the words being counted.
+ *
+ *  \param *a    analyzer
+ *  \param *top  where the words are stored, most frequent first, k + 1 entries
+ *  \param k     number of words
+ *
+ *  \return number of words stored, 0 if the words are not counted
+ */
+extern size_t analyzerTopWords(const ANALYZER *a, WORDENTRY *top, size_t k);
+
+#endif /* TEXTANALYZER_H */
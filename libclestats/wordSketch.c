@@ -0,0 +1,93 @@
+/**
+ *  \file wordSketch.c (implementation file)
+ *
+ *  \brief Library libclestats.
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - April 2020
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "statsConst.h"
+#include "wordSketch.h"
+
+/** \brief multipliers of the hash of a word */
+#define  PRIME1              11400714785074694791ULL
+#define  PRIME2              14029467366897019727ULL
+
+/** \brief high bit of each byte of 8 */
+#define  HIGH_BITS           0x8080808080808080ULL
+
+/** \brief a byte repeated in the 8 bytes of a block */
+#define  BYTES(c)            (0x0101010101010101ULL * (c))
+
+/**
+ *  \brief Letters of 8 bytes of a word in lower case, as in the word tables (see foldWord): the ASCII ones all at
+ *  once, each of their upper case letters getting bit 0x20, the others one by one.
+ *
+ *  Internal operation.
+ */
+static uint64_t foldBlock(const unsigned char *word, size_t i, size_t n, uint64_t block)
+{
+  if ((block & HIGH_BITS) == 0){
+    uint64_t fromA = block + BYTES(0x80 - 'A'), pastZ = block + BYTES(0x80 - 'Z' - 1);
+    return block | ((fromA & ~pastZ & HIGH_BITS) >> 2);
+  }
+  for (size_t j = 0; j < n; j++){
+    unsigned char c = word[i + j];
+    if ((c >= 'A' && c <= 'Z') || (i + j > 0 && word[i + j - 1] == 0xC3 && c >= 0x80 && c <= 0x9E && c != 0x97))
+      block |= (uint64_t) 0x20 << (8 * j);
+  }
+  return block;
+}
+
+void addSketch(unsigned char *registers, const unsigned char *word, size_t length)
+{
+  uint64_t hash = length * PRIME1, block, rest;
+  unsigned char rank = 1;
+
+  for (size_t i = 0; i < length; i += 8){                       /* 8 bytes at a time, the last ones padded with 0 */
+    size_t n = length - i < 8 ? length - i : 8;
+    block = 0;
+    memcpy(&block, word + i, n);
+    hash ^= foldBlock(word, i, n, block) * PRIME2;
+    hash = ((hash << 31) | (hash >> 33)) * PRIME1;
+  }
+  hash ^= hash >> 33;                                           /* spread over the high bits as well */
+  hash *= PRIME2;
+  hash ^= hash >> 29;
+  hash *= PRIME1;
+  hash ^= hash >> 32;
+  rest = hash << HLL_PRECISION;                                 /* the first bits select the register */
+  while (rank <= 64 - HLL_PRECISION && (rest & (1ULL << 63)) == 0){
+    rank++;
+    rest <<= 1;
+  }
+  if (rank > registers[hash >> (64 - HLL_PRECISION)])
+    registers[hash >> (64 - HLL_PRECISION)] = rank;
+}
+
+void mergeSketch(unsigned char *into, const unsigned char *from)
+{
+  for (size_t i = 0; i < HLL_REGISTERS; i++)
+    if (from[i] > into[i])
+      into[i] = from[i];
+}
+
+double sketchEstimate(const unsigned char *registers)
+{
+  double m = HLL_REGISTERS, sum = 0, estimate;
+  size_t zeros = 0;
+
+  for (size_t i = 0; i < HLL_REGISTERS; i++){
+    sum += ldexp(1.0, -registers[i]);
+    zeros += registers[i] == 0;
+  }
+  estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+  if (estimate <= 2.5 * m && zeros > 0)                                      /* few words: linear counting */
+    estimate = m * log(m / zeros);
+  return estimate;
+}
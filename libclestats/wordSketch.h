@@ -0,0 +1,47 @@
+/**
+ *  \file wordSketch.h (interface file)
+ *
+ *  \brief Library libclestats.
+ *
+ *  Number of distinct words of a file, estimated by a HyperLogLog sketch of HLL_REGISTERS registers of a byte. The
+ *  sketch of a file is the register by register maximum of the sketches of its parts, so that they are merged in
+ *  any order, and seeing a word again leaves it unchanged. prob1 keeps it in the results of each chunk, its MPI
+ *  version apart from the results sent with each chunk, merged once at the end.
+ *
+ *  The words are taken as in the word tables (see wordTable.h), the letters in lower case.
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - April 2020
+ */
+
+#ifndef WORDSKETCH_H
+#define WORDSKETCH_H
+
+#include <stdlib.h>
+
+/**
+ *  \brief Add a word to a sketch.
+ *
+ *  \param *registers sketch
+ *  \param *word bytes of the word
+ *  \param length number of bytes
+ */
+extern void addSketch(unsigned char *registers, const unsigned char *word, size_t length);
+
+/**
+ *  \brief Merge a sketch into another one.
+ *
+ *  \param *into sketch where the other one is merged
+ *  \param *from sketch merged
+ */
+extern void mergeSketch(unsigned char *into, const unsigned char *from);
+
+/**
+ *  \brief Estimate of the number of distinct words added to a sketch.
+ *
+ *  \param *registers sketch
+ *
+ *  \return estimate, with a relative standard error of about 1.04 / sqrt(HLL_REGISTERS)
+ */
+extern double sketchEstimate(const unsigned char *registers);
+
+#endif /* WORDSKETCH_H */
@@ -0,0 +1,235 @@
+/**
+ *  \file wordTable.c (implementation file)
+ *
+ *  \brief Library libclestats.
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - April 2020
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "WORDENTRY.h"
+#include "WORDTABLE.h"
+#include "wordTable.h"
+
+/** \brief number of slots of a new table */
+#define  FIRST_SLOTS         256
+
+/** \brief size of a block of the arena, a longer word gets a block of its own */
+#define  ARENA_BLOCK         (1 << 16)
+
+/** \brief FNV-1a */
+#define  FNV_OFFSET          2166136261U
+#define  FNV_PRIME           16777619U
+
+/**
+ *  \brief Letters of a word in lower case: ASCII, and the Latin-1 letters of two bytes (0xC3 0x80 to 0x9E, but
+ *  the multiplication sign 0xC3 0x97).
+ */
+void foldWord(const unsigned char *word, size_t length, unsigned char *key)
+{
+  for (size_t i = 0; i < length; i++){
+    unsigned char c = word[i];
+    if (c >= 'A' && c <= 'Z')
+      c += 'a' - 'A';
+    else if (i > 0 && word[i-1] == 0xC3 && c >= 0x80 && c <= 0x9E && c != 0x97)
+      c += 0x20;
+    key[i] = c;
+  }
+}
+
+uint32_t wordHash(const unsigned char *word, size_t length)
+{
+  uint32_t hash = FNV_OFFSET;
+  for (size_t i = 0; i < length; i++)
+    hash = (hash ^ word[i]) * FNV_PRIME;
+  return hash;
+}
+
+/**
+ *  \brief Copy of the bytes of a word in the arena.
+ *
+ *  Internal operation.
+ */
+static unsigned char *arenaCopy(WORDTABLE *t, const unsigned char *word, size_t length)
+{
+  unsigned char *copy;
+
+  if (length > ARENA_BLOCK / 4){                                            /* kept apart, not to waste a block */
+    copy = (unsigned char *) malloc(length);
+    t->blocks = (unsigned char **) realloc(t->blocks, sizeof(unsigned char *) * (t->numbBlocks + 1));
+    t->blocks[t->numbBlocks++] = copy;
+    if (t->numbBlocks > 1){                                                   /* the last block stays the current one */
+      t->blocks[t->numbBlocks-1] = t->blocks[t->numbBlocks-2];
+      t->blocks[t->numbBlocks-2] = copy;
+    }
+    else
+      t->blockUsed = ARENA_BLOCK;
+  }
+  else {
+    if (t->numbBlocks == 0 || t->blockUsed + length > ARENA_BLOCK){
+      t->blocks = (unsigned char **) realloc(t->blocks, sizeof(unsigned char *) * (t->numbBlocks + 1));
+      t->blocks[t->numbBlocks++] = (unsigned char *) malloc(ARENA_BLOCK);
+      t->blockUsed = 0;
+    }
+    copy = t->blocks[t->numbBlocks-1] + t->blockUsed;
+    t->blockUsed += length;
+  }
+  if (copy == NULL){
+    perror("error on allocating a word");
+    exit(EXIT_FAILURE);
+  }
+  memcpy(copy, word, length);
+  return copy;
+}
+
+/**
+ *  \brief Slot of a word, the free slot where it goes if it is not in the table.
+ *
+ *  Internal operation.
+ */
+static WORDENTRY *findSlot(WORDENTRY *slots, size_t numbSlots, const unsigned char *key, size_t length, uint32_t hash)
+{
+  size_t i = hash & (numbSlots - 1);
+
+  while (slots[i].word != NULL && (slots[i].hash != hash || slots[i].length != length
+                                   || memcmp(slots[i].word, key, length) != 0))
+    i = (i + 1) & (numbSlots - 1);
+  return &slots[i];
+}
+
+/**
+ *  \brief Double the number of slots.
+ *
+ *  Internal operation.
+ */
+static void growTable(WORDTABLE *t)
+{
+  size_t numbSlots = t->numbSlots == 0 ? FIRST_SLOTS : 2 * t->numbSlots;
+  WORDENTRY *slots = (WORDENTRY *) calloc(numbSlots, sizeof(WORDENTRY));
+
+  if (slots == NULL){
+    perror("error on allocating a word table");
+    exit(EXIT_FAILURE);
+  }
+  for (size_t i = 0; i < t->numbSlots; i++)
+    if (t->slots[i].word != NULL)
+      *findSlot(slots, numbSlots, t->slots[i].word, t->slots[i].length, t->slots[i].hash) = t->slots[i];
+  free(t->slots);
+  t->slots = slots;
+  t->numbSlots = numbSlots;
+}
+
+/**
+ *  \brief Add occurrences of a word already in lower case.
+ *
+ *  Internal operation.
+ */
+static void addKey(WORDTABLE *t, const unsigned char *key, size_t length, uint32_t hash, uint64_t count)
+{
+  WORDENTRY *e;
+
+  if (10 * (t->numbWords + 1) > 7 * t->numbSlots)                                       /* load kept under 0.7 */
+    growTable(t);
+  e = findSlot(t->slots, t->numbSlots, key, length, hash);
+  if (e->word == NULL){
+    e->word = arenaCopy(t, key, length);
+    e->length = length;
+    e->hash = hash;
+    t->numbWords++;
+  }
+  e->count += count;
+}
+
+void addWord(WORDTABLE *t, const unsigned char *word, size_t length, uint64_t count)
+{
+  unsigned char key[length];
+
+  foldWord(word, length, key);
+  addKey(t, key, length, wordHash(key, length), count);
+}
+
+void mergeWordTable(WORDTABLE *into, const WORDTABLE *from)
+{
+  for (size_t i = 0; i < from->numbSlots; i++)
+    if (from->slots[i].word != NULL)
+      addKey(into, from->slots[i].word, from->slots[i].length, from->slots[i].hash, from->slots[i].count);
+}
+
+/**
+ *  \brief Order of the most frequent words: decreasing count, ties by increasing bytes.
+ *
+ *  Internal operation.
+ */
+static int compareWords(const void *a, const void *b)
+{
+  const WORDENTRY *x = (const WORDENTRY *) a, *y = (const WORDENTRY *) b;
+  int c;
+
+  if (x->count != y->count)
+    return x->count > y->count ? -1 : 1;
+  c = memcmp(x->word, y->word, x->length < y->length ? x->length : y->length);
+  if (c != 0)
+    return c;
+  return x->length < y->length ? -1 : x->length > y->length;
+}
+
+/**
+ *  \brief Restore the heap below a position, the least frequent word at the root.
+ *
+ *  Internal operation.
+ */
+static void siftDown(WORDENTRY *heap, size_t n, size_t i)
+{
+  for (;;){
+    size_t least = i, l = 2 * i + 1, r = l + 1;
+    if (l < n && compareWords(&heap[l], &heap[least]) > 0)
+      least = l;
+    if (r < n && compareWords(&heap[r], &heap[least]) > 0)
+      least = r;
+    if (least == i)
+      return;
+    WORDENTRY e = heap[i];
+    heap[i] = heap[least];
+    heap[least] = e;
+    i = least;
+  }
+}
+
+size_t topWords(const WORDTABLE *t, WORDENTRY *top, size_t k)
+{
+  size_t n = 0;
+
+  if (k == 0)
+    return 0;
+  for (size_t i = 0; i < t->numbSlots; i++){
+    const WORDENTRY *e = &t->slots[i];
+    if (e->word == NULL)
+      continue;
+    if (n < k){
+      top[n++] = *e;
+      if (n == k)
+        for (size_t j = k / 2; j-- > 0; )
+          siftDown(top, k, j);
+    }
+    else if (compareWords(e, &top[0]) < 0){                                   /* more frequent than the least one */
+      top[0] = *e;
+      siftDown(top, k, 0);
+    }
+  }
+  qsort(top, n, sizeof(WORDENTRY), compareWords);
+  return n;
+}
+
+void freeWordTable(WORDTABLE *t)
+{
+  for (size_t i = 0; i < t->numbBlocks; i++)
+    free(t->blocks[i]);
+  free(t->blocks);
+  free(t->slots);
+  memset(t, 0, sizeof(WORDTABLE));
+}
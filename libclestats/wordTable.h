@@ -0,0 +1,80 @@
+/**
+ *  \file wordTable.h (interface file)
+ *
+ *  \brief Library libclestats.
+ *
+ *  Frequencies of the words of a text and the most frequent ones. A word is kept as its UTF-8 bytes, with the
+ *  letters (ASCII and the Latin-1 letters of two bytes) in lower case.
+ *
+ *  Each worker fills its own tables, one per file, which are merged once all the text is processed (by the MPI
+ *  version of prob1, every word being sent to the process that owns its hash, which selects the most frequent words
+ *  of each file for the dispatcher).
+ *
+ *  \author Francisco Gonçalves and Tiago Lucas - April 2020
+ */
+
+#ifndef WORDTABLE_H_
+#define WORDTABLE_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "WORDENTRY.h"
+#include "WORDTABLE.h"
+
+/**
+ *  \brief Letters of a word in lower case, the bytes of the word as kept in a table.
+ *
+ *  \param *word bytes of the word
+ *  \param length number of bytes
+ *  \param *key where the bytes in lower case are stored
+ */
+extern void foldWord(const unsigned char *word, size_t length, unsigned char *key);
+
+/**
+ *  \brief Hash of the bytes of a word as kept in a table (lower case), the owner of a word in a reduction.
+ *
+ *  \param *word bytes of the word
+ *  \param length number of bytes
+ *
+ *  \return hash
+ */
+extern uint32_t wordHash(const unsigned char *word, size_t length);
+
+/**
+ *  \brief Add occurrences of a word to a table, the table is created on its first word.
+ *
+ *  \param *t table
+ *  \param *word bytes of the word
+ *  \param length number of bytes
+ *  \param count number of occurrences
+ */
+extern void addWord(WORDTABLE *t, const unsigned char *word, size_t length, uint64_t count);
+
+/**
+ *  \brief Add all the words of a table to another one.
+ *
+ *  \param *into table where the words are added
+ *  \param *from table whose words are added
+ */
+extern void mergeWordTable(WORDTABLE *into, const WORDTABLE *from);
+
+/**
+ *  \brief Most frequent words of a table, by decreasing count, ties by increasing bytes.
+ *
+ *  \param *t table
+ *  \param *top where the words are stored (they point to the arena of the table)
+ *  \param k number of words wanted
+ *
+ *  \return number of words stored, less than k if the table has fewer words
+ */
+extern size_t topWords(const WORDTABLE *t, WORDENTRY *top, size_t k);
+
+/**
+ *  \brief Release a table.
+ *
+ *  \param *t table
+ */
+extern void freeWordTable(WORDTABLE *t);
+
+#endif /* WORDTABLE_H_ */